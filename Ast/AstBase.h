@@ -26,9 +26,11 @@
 
 #include "Ast/AstFwd.h"
 #include "Ast/AstDefs.h"
+#include "Ast/AstPool.h"
 #include "Ast/AstVariety.h"
 #include "Common/Assert.h"
 #include "Common/Config.h"
+#include "Parsing/Lexeme.h"
 #include "Parsing/SourceLoc.h"
 #include <cstdint>
 #include <memory>
@@ -96,6 +98,21 @@ STMT_AST_MIXIN(MAKE_STMT_CASE)
 
     virtual ~Ast() {}
 
+    /*!
+     * \brief operator new
+     *
+     * AST nodes are allocated from the active AstPool, if any.
+     */
+    static void* operator new(std::size_t size)
+    {
+        return AstPool::acquire(size);
+    }
+
+    static void operator delete(void* ptr)
+    {
+        AstPool::relinquish(ptr);
+    }
+
     /*!
      * \brief kind
      * \return
@@ -162,6 +179,8 @@ STMT_AST_MIXIN(MAKE_STMT_CASE)
     }
 
 protected:
+    friend class AstSerializer;
+
     // Bits are assigned by specific AST nodes.
     struct BitFields
     {
@@ -186,7 +205,7 @@ private:
 template <class AstT>
 AstT* newAst()
 {
-    return new AstT; // TODO: Allocate on an AST pool.
+    return new AstT;
 }
 
 } // namespace uaiso
@@ -201,6 +220,14 @@ AstT* newAst()
         return std::unique_ptr<Self>(new Self); \
     }
 
+/* Pooled nodes aren't destroyed, so a member which holds memory of its own
+   is destroyed on its own once the pool is released. */
+#define RELEASE_WITH_POOL(MEMBER) \
+    AstPool::atRelease(this, [] (void* ast) { \
+        using MemberType = decltype(Self::MEMBER##_); \
+        static_cast<Self*>(ast)->MEMBER##_.~MemberType(); \
+    })
+
 #define NAMED_AST_PARAM(NAME, MEMBER, PARAM_TYPE) \
     Self* set##NAME(PARAM_TYPE* param) \
     { \
@@ -274,6 +301,14 @@ AstT* newAst()
     } \
     const SourceLoc& MEMBER##Loc() const { return MEMBER##Loc_; }
 
+#define NAMED_LEXEME_PARAM(NAME, MEMBER, PARAM_TYPE) \
+    Self* set##NAME(const PARAM_TYPE* param) \
+    { \
+        MEMBER##_ = param; \
+        return this; \
+    } \
+    const PARAM_TYPE* MEMBER() const { return MEMBER##_; }
+
 #define NAMED_LOC_PARAM__BASE__(NAME) \
     virtual Self* set##NAME(const SourceLoc&) { return nullptr; } \
 
@@ -68,6 +68,7 @@ public:
 
     virtual bool hasInit() const { return false; }
     virtual ExprAst* init() const { return nullptr; }
+    virtual const SourceLoc& assignLoc() const { return kEmptyLoc; }
 
     std::unique_ptr<NameAst> name_;
 
@@ -119,6 +120,7 @@ public:
 
     bool hasInit() const override { return InitT::checkInitializer__(); }
     ExprAst* init() const override { return InitT::init__(); }
+    const SourceLoc& assignLoc() const override { return InitT::assignLoc__(); }
 };
 
 /*!
@@ -155,6 +157,7 @@ public:
 
     virtual bool hasInits() const { return false; }
     virtual ExprAstList* inits() const { return nullptr; }
+    virtual const SourceLoc& assignLoc() const { return kEmptyLoc; }
 
     SourceLoc keyLoc_;
     std::unique_ptr<SpecAst> spec_;
@@ -207,6 +210,7 @@ public:
 
     bool hasInits() const override { return InitsT::checkInits__(); }
     ExprAstList* inits() const override { return InitsT::inits__(); }
+    const SourceLoc& assignLoc() const override { return InitsT::assignLoc__(); }
 };
 
 /*!
@@ -290,6 +294,7 @@ public:
 
     virtual bool hasDefaultArg() const { return false; }
     virtual ExprAst* defaultArg() const { return nullptr; }
+    virtual const SourceLoc& assignLoc() const { return kEmptyLoc; }
 
     virtual bool isVariadic() const { return false; }
     virtual const SourceLoc& variadicLoc() const { return kEmptyLoc; }
@@ -361,6 +366,7 @@ public:
 
     bool hasDefaultArg() const override { return DefaultArgT::checkDefaultArg__(); }
     ExprAst* defaultArg() const override { return DefaultArgT::defaultArg__(); }
+    const SourceLoc& assignLoc() const override { return DefaultArgT::assignLoc__(); }
 
     bool isVariadic() const override { return VariadicT::checkVariadic__(); }
     const SourceLoc& variadicLoc() const override { return VariadicT::variadicLoc__(); }
@@ -403,9 +409,11 @@ public:
 
     virtual bool hasDefaultArg() const { return false; }
     virtual Ast* defaultArg() const { return nullptr; }
+    virtual const SourceLoc& assignLoc() const { return kEmptyLoc; }
 
     virtual bool hasSpecialization() const { return false; }
     virtual Ast* specialization() const { return nullptr; }
+    virtual const SourceLoc& bindLoc() const { return kEmptyLoc; }
 
     bool isNonType() const { return spec_.get() != nullptr; }
 
@@ -487,9 +495,11 @@ public:
 
     virtual bool hasDefaultArg() const { return DefaultArgT::checkDefaultArg__(); }
     virtual Ast* defaultArg() const { return DefaultArgT::defaultArg__(); }
+    const SourceLoc& assignLoc() const override { return DefaultArgT::assignLoc__(); }
 
     virtual bool hasSpecialization() const { return SpecializationT::checkSpecialization__(); }
     virtual Ast* specialization() const { return SpecializationT::specialization__(); }
+    const SourceLoc& bindLoc() const override { return SpecializationT::bindLoc__(); }
 };
 
 class UAISO_API TemplateParamAliasDeclAst final : public TemplateParamDeclAst
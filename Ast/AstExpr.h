@@ -97,8 +97,10 @@ public:
     {}
 
     NAMED_LOC_PARAM(Lit, lit)
+    NAMED_LEXEME_PARAM(Lit, lit, StrLit)
 
     SourceLoc litLoc_;
+    const StrLit* lit_ { nullptr };
 };
 
 class UAISO_API NumLitExprAst final : public PrimaryExprAst
@@ -115,8 +117,10 @@ public:
     APPLY_VARIETY(NumLitVariety)
 
     NAMED_LOC_PARAM(Lit, lit)
+    NAMED_LEXEME_PARAM(Lit, lit, NumLit)
 
     SourceLoc litLoc_;
+    const NumLit* lit_ { nullptr };
 };
 
 class UAISO_API BoolLitExprAst final : public PrimaryExprAst
@@ -253,7 +257,9 @@ public:
 
     TypeQueryExprAst()
         : PrimaryExprAst(Kind::TypeQueryExpr)
-    {}
+    {
+        RELEASE_WITH_POOL(ty);
+    }
 
     NAMED_LOC_PARAM(Key, key)
     NAMED_LOC_PARAM(LDelim, lDelim)
@@ -604,6 +610,7 @@ public:
         : ExprAst(Kind::AssignExpr)
     {
         INIT_VARIETY(AssignVariety::Unknow);
+        RELEASE_WITH_POOL(syms);
     }
 
     APPLY_VARIETY(AssignVariety)
@@ -652,7 +659,9 @@ public:
 
     CastExprAst()
         : ExprAst(Kind::CastExpr)
-    {}
+    {
+        RELEASE_WITH_POOL(ty);
+    }
 
     NAMED_LOC_PARAM(LDelim, lDelim)
     NAMED_LOC_PARAM(RDelim, rDelim)
@@ -782,7 +791,9 @@ public:
 
     MakeExprAst()
         : ExprAst(Kind::MakeExpr)
-    {}
+    {
+        RELEASE_WITH_POOL(ty);
+    }
 
     NAMED_AST_PARAM(Base, base, ExprAst)
     NAMED_LOC_PARAM(LDelim, lDelim)
@@ -810,7 +821,9 @@ public:
 
     NewExprAst()
         : ExprAst(Kind::NewExpr)
-    {}
+    {
+        RELEASE_WITH_POOL(ty);
+    }
 
     NAMED_LOC_PARAM(Key, key)
     NAMED_LOC_PARAM(LAllocDelim, lAllocDelim)
@@ -1008,7 +1021,9 @@ public:
 
     TypeAssertExprAst()
         : ExprAst(Kind::TypeAssertExpr)
-    {}
+    {
+        RELEASE_WITH_POOL(ty);
+    }
 
     NAMED_AST_PARAM(Base, base, ExprAst)
     NAMED_LOC_PARAM(Opr, opr)
@@ -25,6 +25,7 @@
 #define UAISO_ASTLIST_H__
 
 #include "Ast/AstFwd.h"
+#include "Ast/AstPool.h"
 #include "Common/Assert.h"
 #include "Parsing/SourceLoc.h"
 #include <iostream>
@@ -73,6 +74,16 @@ public:
         return new ListType(ast, nullptr);
     }
 
+    static void* operator new(std::size_t size)
+    {
+        return AstPool::acquire(size);
+    }
+
+    static void operator delete(void* ptr)
+    {
+        AstPool::relinquish(ptr);
+    }
+
     virtual ~AstList()
     {
         // TODO: Debug-mode check
@@ -61,8 +61,10 @@ public:
     {}
 
     NAMED_LOC_PARAM(Name, name)
+    NAMED_LEXEME_PARAM(Ident, ident, Ident)
 
     SourceLoc nameLoc_;
+    const Ident* ident_ { nullptr };
 };
 
 class UAISO_API NestedNameAst final : public NameAst
@@ -113,17 +115,23 @@ public:
 
     GenNameAst()
         : NameAst(Kind::GenName)
-    {}
+    {
+        RELEASE_WITH_POOL(str);
+    }
 
     GenNameAst(const std::string& name)
         : NameAst(Kind::GenName)
         , str_(name)
-    {}
+    {
+        RELEASE_WITH_POOL(str);
+    }
 
     NAMED_LOC_PARAM(Gen, gen)
+    NAMED_LEXEME_PARAM(Ident, ident, Ident)
 
     SourceLoc genLoc_;
     std::string str_;
+    const Ident* ident_ { nullptr };
 };
 
 class UAISO_API CompletionNameAst final : public NameAst
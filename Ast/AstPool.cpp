@@ -0,0 +1,186 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#include "Ast/AstPool.h"
+#include "Common/Assert.h"
+#include <cstdint>
+#include <new>
+
+using namespace uaiso;
+
+namespace {
+
+// AST nodes are small, but a single file yields lots of them. Start with a
+// modest chunk and double it up to a cap, so tiny units stay cheap and big
+// ones don't waste much in a partially filled last chunk.
+const std::size_t kMinChunkSize = 4 * 1024;
+const std::size_t kMaxChunkSize = 64 * 1024;
+
+const std::size_t kAlign = alignof(std::max_align_t);
+
+inline std::size_t alignUp(std::size_t size)
+{
+    return (size + kAlign - 1) & ~(kAlign - 1);
+}
+
+// Memory handed out by acquire is preceded by a tag, so relinquish can tell
+// where it comes from without searching the chunks (nor relying on the pool
+// being active). It takes a whole alignment unit, to keep the memory after
+// it aligned.
+struct Tag
+{
+    AstPool* pool_;      // Null if from the free store.
+    bool relinquished_;
+};
+static_assert(sizeof(Tag) <= kAlign, "tag must fit an alignment unit");
+
+const std::size_t kTagSize = kAlign;
+
+inline Tag* tagOf(const void* ptr)
+{
+    return reinterpret_cast<Tag*>(const_cast<char*>(static_cast<const char*>(ptr)) - kTagSize);
+}
+
+thread_local AstPool* currentPool__ = nullptr;
+
+} // anonymous
+
+AstPool::AstPool()
+{}
+
+AstPool::~AstPool()
+{
+    clear();
+}
+
+AstPool::Scope::Scope(AstPool* pool)
+    : prev_(currentPool__)
+{
+    currentPool__ = pool;
+}
+
+AstPool::Scope::~Scope()
+{
+    currentPool__ = prev_;
+}
+
+AstPool* AstPool::current()
+{
+    return currentPool__;
+}
+
+void* AstPool::acquire(std::size_t size)
+{
+    void* mem = currentPool__ ? currentPool__->allocate(kTagSize + size)
+                              : ::operator new(kTagSize + size);
+    Tag* tag = new (mem) Tag { currentPool__, false };
+    return reinterpret_cast<char*>(tag) + kTagSize;
+}
+
+void AstPool::relinquish(void* ptr)
+{
+    if (!ptr)
+        return;
+    Tag* tag = tagOf(ptr);
+    if (tag->pool_) {
+        tag->relinquished_ = true;
+        return;
+    }
+    ::operator delete(tag);
+}
+
+AstPool* AstPool::ownerOf(const void* ptr)
+{
+    return ptr ? tagOf(ptr)->pool_ : nullptr;
+}
+
+void AstPool::atRelease(void* obj, void (*func)(void*))
+{
+    // The object is being constructed, so if it comes from the active pool,
+    // it's in the chunk last grown.
+    AstPool* pool = currentPool__;
+    if (!pool || pool->chunks_.empty())
+        return;
+    auto p = static_cast<const char*>(obj);
+    if (p < pool->chunks_.back().begin_ || p >= pool->curr_)
+        return;
+    pool->releasers_.emplace_back(obj, func);
+}
+
+void* AstPool::allocate(std::size_t size)
+{
+    size = alignUp(size);
+    if (static_cast<std::size_t>(limit_ - curr_) < size)
+        grow(size);
+
+    void* ptr = curr_;
+    curr_ += size;
+    ++nodeCount_;
+    bytesUsed_ += size;
+    return ptr;
+}
+
+void AstPool::grow(std::size_t size)
+{
+    std::size_t chunkSize = chunks_.empty() ? kMinChunkSize
+                                            : (chunks_.back().end_ - chunks_.back().begin_) * 2;
+    if (chunkSize > kMaxChunkSize)
+        chunkSize = kMaxChunkSize;
+    if (chunkSize < size)
+        chunkSize = size;
+
+    char* begin = static_cast<char*>(::operator new(chunkSize));
+    chunks_.push_back(Chunk { begin, begin + chunkSize });
+    curr_ = begin;
+    limit_ = begin + chunkSize;
+    bytesReserved_ += chunkSize;
+}
+
+bool AstPool::owns(const void* ptr) const
+{
+    // Not on the path of deletes (see relinquish), a linear scan over the
+    // chunks is fine.
+    auto p = static_cast<const char*>(ptr);
+    for (auto it = chunks_.rbegin(); it != chunks_.rend(); ++it) {
+        if (p >= it->begin_ && p < it->end_)
+            return true;
+    }
+    return false;
+}
+
+void AstPool::clear()
+{
+    for (const auto& releaser : releasers_) {
+        if (!tagOf(releaser.first)->relinquished_)
+            releaser.second(releaser.first);
+    }
+    releasers_.clear();
+
+    for (auto chunk : chunks_)
+        ::operator delete(chunk.begin_);
+    chunks_.clear();
+    curr_ = limit_ = nullptr;
+    nodeCount_ = 0;
+    bytesUsed_ = 0;
+    bytesReserved_ = 0;
+}
@@ -0,0 +1,194 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#ifndef UAISO_ASTPOOL_H__
+#define UAISO_ASTPOOL_H__
+
+#include "Common/Config.h"
+#include "Common/Test.h"
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace uaiso {
+
+/*!
+ * \brief The AstPool class
+ *
+ * A bump allocator from which AST nodes and AST lists are carved while the
+ * pool is active in the current thread (see Scope). Individual deletes of
+ * pooled nodes are no-ops, the memory is only given back when the pool is
+ * cleared or destroyed, all at once. Objects still alive by then aren't
+ * destroyed, see atRelease.
+ */
+class UAISO_API AstPool final
+{
+public:
+    AstPool();
+    ~AstPool();
+
+    AstPool(const AstPool&) = delete;
+    AstPool& operator=(const AstPool&) = delete;
+
+    /*!
+     * \brief The Scope class
+     *
+     * Make \a pool the active one in the current thread for the lifetime of
+     * the scope. Scopes may be nested, the previous pool is restored upon
+     * exit.
+     */
+    class UAISO_API Scope final
+    {
+    public:
+        Scope(AstPool* pool);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        AstPool* prev_;
+    };
+
+    /*!
+     * \brief current
+     * \return
+     *
+     * Return the pool active in the current thread, if any.
+     */
+    static AstPool* current();
+
+    /*!
+     * \brief acquire
+     * \param size
+     * \return
+     *
+     * Allocate \a size bytes from the active pool or, if there's none, from
+     * the free store. The memory is tagged with where it comes from.
+     */
+    static void* acquire(std::size_t size);
+
+    /*!
+     * \brief relinquish
+     * \param ptr
+     *
+     * Give back the memory at \a ptr, obtained through acquire. This is a
+     * no-op if \a ptr belongs to a pool (active or not), which is told in
+     * constant time from the memory's tag.
+     */
+    static void relinquish(void* ptr);
+
+    /*!
+     * \brief ownerOf
+     * \param ptr
+     * \return
+     *
+     * Return the pool the memory at \a ptr, obtained through acquire, belongs
+     * to, if any.
+     */
+    static AstPool* ownerOf(const void* ptr);
+
+    /*!
+     * \brief atRelease
+     * \param obj
+     * \param func
+     *
+     * Have \a func called on \a obj, if it's just been acquired from the
+     * active pool, when the pool is cleared, unless \a obj is relinquished
+     * before. Meant for objects with members holding memory of their own,
+     * which would leak since the pool doesn't run destructors.
+     */
+    static void atRelease(void* obj, void (*func)(void*));
+
+    /*!
+     * \brief allocate
+     * \param size
+     * \return
+     */
+    void* allocate(std::size_t size);
+
+    /*!
+     * \brief owns
+     * \param ptr
+     * \return
+     *
+     * Return whether \a ptr was allocated from this pool.
+     */
+    bool owns(const void* ptr) const;
+
+    /*!
+     * \brief clear
+     *
+     * Release all memory of the pool, without destroying the objects in it,
+     * which become invalid.
+     */
+    void clear();
+
+    /*!
+     * \brief nodeCount
+     * \return
+     *
+     * Return the number of allocations served by the pool.
+     */
+    std::size_t nodeCount() const { return nodeCount_; }
+
+    /*!
+     * \brief bytesUsed
+     * \return
+     *
+     * Return the number of bytes handed out by the pool (including padding).
+     */
+    std::size_t bytesUsed() const { return bytesUsed_; }
+
+    /*!
+     * \brief bytesReserved
+     * \return
+     *
+     * Return the number of bytes the pool holds from the free store.
+     */
+    std::size_t bytesReserved() const { return bytesReserved_; }
+
+private:
+    DECL_CLASS_TEST(AstPool)
+
+    void grow(std::size_t size);
+
+    struct Chunk
+    {
+        char* begin_;
+        char* end_;
+    };
+    std::vector<Chunk> chunks_;
+    std::vector<std::pair<void*, void (*)(void*)>> releasers_;
+
+    char* curr_ { nullptr };
+    char* limit_ { nullptr };
+
+    std::size_t nodeCount_ { 0 };
+    std::size_t bytesUsed_ { 0 };
+    std::size_t bytesReserved_ { 0 };
+};
+
+} // namespace uaiso
+
+#endif
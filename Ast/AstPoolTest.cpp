@@ -0,0 +1,169 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#include "Ast/AstPool.h"
+#include "Ast/Ast.h"
+
+using namespace uaiso;
+
+class AstPool::AstPoolTest final : public Test
+{
+public:
+    TEST_RUN(AstPoolTest
+             , &AstPoolTest::testCase1
+             , &AstPoolTest::testCase2
+             , &AstPoolTest::testCase3
+             , &AstPoolTest::testCase4
+             , &AstPoolTest::testCase5
+             , &AstPoolTest::testCase6
+             , &AstPoolTest::testCase7
+             )
+
+    void testCase1()
+    {
+        // No active pool, nodes come from the free store.
+        AstPool pool;
+        UAISO_EXPECT_FALSE(AstPool::current());
+        std::unique_ptr<IdentExprAst> ast(newAst<IdentExprAst>());
+        UAISO_EXPECT_FALSE(pool.owns(ast.get()));
+        UAISO_EXPECT_INT_EQ(0, pool.nodeCount());
+    }
+
+    void testCase2()
+    {
+        AstPool pool;
+        AstPool::Scope scope(&pool);
+        UAISO_EXPECT_PTR_EQ(&pool, AstPool::current());
+
+        std::unique_ptr<IdentExprAst> ast(newAst<IdentExprAst>());
+        ast->setName(newAst<SimpleNameAst>());
+        UAISO_EXPECT_TRUE(pool.owns(ast.get()));
+        UAISO_EXPECT_TRUE(pool.owns(ast->name_.get()));
+        UAISO_EXPECT_INT_EQ(2, pool.nodeCount());
+
+        // Deleting a pooled node doesn't give memory back.
+        size_t used = pool.bytesUsed();
+        ast.reset();
+        UAISO_EXPECT_INT_EQ(used, pool.bytesUsed());
+    }
+
+    void testCase3()
+    {
+        AstPool pool1;
+        AstPool pool2;
+        {
+            AstPool::Scope scope1(&pool1);
+            {
+                AstPool::Scope scope2(&pool2);
+                UAISO_EXPECT_PTR_EQ(&pool2, AstPool::current());
+            }
+            UAISO_EXPECT_PTR_EQ(&pool1, AstPool::current());
+        }
+        UAISO_EXPECT_FALSE(AstPool::current());
+    }
+
+    void testCase4()
+    {
+        // Lists are pooled too, and so are allocations larger than a chunk.
+        AstPool pool;
+        AstPool::Scope scope(&pool);
+        std::unique_ptr<ExprAstList> list(ExprAstList::create(newAst<IdentExprAst>()));
+        list->pushBack(newAst<IdentExprAst>());
+        UAISO_EXPECT_TRUE(pool.owns(list.get()));
+        UAISO_EXPECT_TRUE(pool.owns(list->subList()));
+        UAISO_EXPECT_INT_EQ(4, pool.nodeCount());
+
+        void* big = pool.allocate(4 * 1024 * 1024);
+        UAISO_EXPECT_TRUE(pool.owns(big));
+        UAISO_EXPECT_TRUE(pool.bytesReserved() >= 4 * 1024 * 1024);
+    }
+
+    void testCase5()
+    {
+        AstPool pool;
+        {
+            AstPool::Scope scope(&pool);
+            newAst<IdentExprAst>(); // Leaked into the pool on purpose.
+        }
+        UAISO_EXPECT_INT_EQ(1, pool.nodeCount());
+        pool.clear();
+        UAISO_EXPECT_INT_EQ(0, pool.nodeCount());
+        UAISO_EXPECT_INT_EQ(0, pool.bytesUsed());
+        UAISO_EXPECT_INT_EQ(0, pool.bytesReserved());
+    }
+
+    void testCase6()
+    {
+        // A pooled node deleted once its pool is no longer active doesn't
+        // reach the free store, the memory tells where it's from.
+        AstPool pool;
+        std::unique_ptr<IdentExprAst> ast;
+        {
+            AstPool::Scope scope(&pool);
+            ast.reset(newAst<IdentExprAst>());
+        }
+        std::unique_ptr<IdentExprAst> other(newAst<IdentExprAst>());
+        UAISO_EXPECT_PTR_EQ(&pool, AstPool::ownerOf(ast.get()));
+        UAISO_EXPECT_FALSE(AstPool::ownerOf(other.get()));
+
+        size_t used = pool.bytesUsed();
+        ast.reset();
+        other.reset();
+        UAISO_EXPECT_INT_EQ(used, pool.bytesUsed());
+    }
+
+    static int released__;
+
+    void testCase7()
+    {
+        // Objects still alive when the pool is cleared get what they hold
+        // released, the ones relinquished before don't.
+        released__ = 0;
+        auto release = [] (void*) { ++released__; };
+        AstPool pool;
+        void* dead;
+        {
+            AstPool::Scope scope(&pool);
+            AstPool::atRelease(AstPool::acquire(8), release);
+            dead = AstPool::acquire(8);
+            AstPool::atRelease(dead, release);
+        }
+        int notPooled = 0;
+        AstPool::atRelease(&notPooled, release);
+        AstPool::relinquish(dead);
+        pool.clear();
+        UAISO_EXPECT_INT_EQ(1, released__);
+
+        // A tree's nodes aren't destroyed, but what they hold is.
+        {
+            AstPool::Scope scope(&pool);
+            std::unique_ptr<GenNameAst> name(new GenNameAst(std::string(100, 'x')));
+            name.release();
+        }
+        pool.clear();
+    }
+};
+
+int AstPool::AstPoolTest::released__ = 0;
+
+MAKE_CLASS_TEST(AstPool)
@@ -17,1081 +17,2050 @@
  * USA
  *****************************************************************************/
 
-/*---------------------------------------------------------------*/
-/*---                    The UaiSo! Project                   ---*/
-/*---                                                         ---*/
-/*---         This file was AUTOMATICALLY GENERATED           ---*/
-/*--- It can be AUTOMATICALLY UPDATED if the formatting/style ---*/
-/*--- of the method declarations is preserved (it's fragile). ---*/
-/*---------------------------------------------------------------*/
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
 
 #include "Ast/AstSerializer.h"
-#include <sstream>
+#include "Ast/Ast.h"
+#include "Common/Assert.h"
+#include "Parsing/FileRegistry.h"
+#include "Parsing/Lexeme.h"
+#include "Parsing/LexemeMap.h"
+#include "Parsing/SourceLoc.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
 
 using namespace uaiso;
 
 namespace {
 
-std::ostream* output__ = nullptr;
+const char kMagic[] = "UAISOAST";
+
+// Bump whenever the AST or the format below changes.
+const uint32_t kFormatVersion = 1;
+
+// Amount of buffered bytes after which the writer flushes to its stream.
+const size_t kChunkSize = 1 << 16;
+
+/*
+ * Concrete classes that share a kind with their base class. The parsers
+ * instantiate the "member injection" templates and a couple of language
+ * specific subclasses, which don't have a kind of their own. A node's shape
+ * tells which class it is, 0 being the class of the kind itself.
+ */
+using VarInitDeclAst = VarDeclAst__<VarInit__>;
+using VarGroupInitsDeclAst = VarGroupDeclAst__<VarGroupInits__>;
+using VariadicParamDeclAst = ParamDeclAst__<ParamVariadic__>;
+using DefaultArgParamDeclAst = ParamDeclAst__<ParamVariadic__Empty__, ParamDefaultArg__>;
+using VariadicDefaultArgParamDeclAst = ParamDeclAst__<ParamVariadic__, ParamDefaultArg__>;
+using DefaultArgTemplateParamDeclAst = TemplateParamDeclAst__<TemplateParamDefaultArg__>;
+using SpecialTemplateParamDeclAst =
+    TemplateParamDeclAst__<TemplateParamDefaultArg__Empty__, TemplateParamSpecialization__>;
+using DefaultArgSpecialTemplateParamDeclAst =
+    TemplateParamDeclAst__<TemplateParamDefaultArg__, TemplateParamSpecialization__>;
+using NonTemplateFuncSpecAst = FuncSpecAst__<>;
+using TemplateFuncSpecAst = FuncSpecAst__<FuncTemplateParam__>;
 
-} // anonymous
+#define SHAPED_AST_MIXIN(GEN_CODE_FOR) \
+    GEN_CODE_FOR(FuncSpec, 1, NonTemplateFuncSpecAst) \
+    GEN_CODE_FOR(FuncSpec, 2, TemplateFuncSpecAst) \
+    GEN_CODE_FOR(FuncDecl, 1, FuncRecvDeclAst) \
+    GEN_CODE_FOR(ParamDecl, 1, VariadicParamDeclAst) \
+    GEN_CODE_FOR(ParamDecl, 2, DefaultArgParamDeclAst) \
+    GEN_CODE_FOR(ParamDecl, 3, VariadicDefaultArgParamDeclAst) \
+    GEN_CODE_FOR(TemplateParamDecl, 1, DefaultArgTemplateParamDeclAst) \
+    GEN_CODE_FOR(TemplateParamDecl, 2, SpecialTemplateParamDeclAst) \
+    GEN_CODE_FOR(TemplateParamDecl, 3, DefaultArgSpecialTemplateParamDeclAst) \
+    GEN_CODE_FOR(TemplateParamDecl, 4, TemplateParamAliasDeclAst) \
+    GEN_CODE_FOR(TemplateParamDecl, 5, TemplateParamThisDeclAst) \
+    GEN_CODE_FOR(VarDecl, 1, VarInitDeclAst) \
+    GEN_CODE_FOR(VarGroupDecl, 1, VarGroupInitsDeclAst) \
+    GEN_CODE_FOR(VarGroupDecl, 2, VarTagDeclAst)
 
-namespace uaiso {
+bool isShaped(Ast::Kind kind)
+{
+#define SHAPE_CASE(AST_KIND, SHAPE, AST_CLASS) \
+    if (kind == Ast::Kind::AST_KIND) \
+        return true;
+
+    SHAPED_AST_MIXIN(SHAPE_CASE)
+    return false;
+
+#undef SHAPE_CASE
+}
+
+unsigned shapeOf(const Ast* ast)
+{
+#define SHAPE_CASE(AST_KIND, SHAPE, AST_CLASS) \
+    if (ast->kind() == Ast::Kind::AST_KIND && dynamic_cast<const AST_CLASS*>(ast)) \
+        return SHAPE;
+
+    SHAPED_AST_MIXIN(SHAPE_CASE)
+    return 0;
+
+#undef SHAPE_CASE
+}
 
-std::string serialize(ProgramAst* ast)
+Ast* create(Ast::Kind kind, unsigned shape)
 {
-    std::ostringstream oss;
-    AstSerializer().serializeProgram(ast, oss);
-    return oss.str();
+#define SHAPE_CASE(AST_KIND, SHAPE, AST_CLASS) \
+    if (kind == Ast::Kind::AST_KIND && shape == SHAPE) \
+        return new AST_CLASS;
+
+    SHAPED_AST_MIXIN(SHAPE_CASE)
+    if (shape)
+        return nullptr;
+
+#undef SHAPE_CASE
+
+    switch (kind) {
+#define MAKE_CASE(AST_NODE, AST_KIND) \
+    case Ast::Kind::AST_NODE##AST_KIND: \
+        return new AST_NODE##AST_KIND##Ast;
+
+    NAME_AST_MIXIN(MAKE_NAME_CASE)
+    SPEC_AST_MIXIN(MAKE_SPEC_CASE)
+    ATTR_AST_MIXIN(MAKE_ATTR_CASE)
+    DECL_AST_MIXIN(MAKE_DECL_CASE)
+    EXPR_AST_MIXIN(MAKE_EXPR_CASE)
+    STMT_AST_MIXIN(MAKE_STMT_CASE)
+
+#undef MAKE_CASE
+
+    case Ast::Kind::Program:
+        return new ProgramAst;
+    case Ast::Kind::Generator:
+        return new GeneratorAst;
+    case Ast::Kind::Invalid: // Only template args don't have a kind.
+        return new TemplateArgAst;
+    default:
+        return nullptr;
+    }
 }
 
-std::unique_ptr<ProgramAst> deserialize(const std::string& s)
+/*
+ * Whether a node fits into a member of type AstT.
+ */
+bool fits(const Ast*, const Ast*) { return true; }
+bool fits(const Ast* ast, const NameAst*) { return ast->isName(); }
+bool fits(const Ast* ast, const SpecAst*) { return ast->isSpec(); }
+bool fits(const Ast* ast, const AttrAst*) { return ast->isAttr(); }
+bool fits(const Ast* ast, const DeclAst*) { return ast->isDecl(); }
+bool fits(const Ast* ast, const ExprAst*) { return ast->isExpr(); }
+bool fits(const Ast* ast, const StmtAst*) { return ast->isStmt(); }
+
+bool fits(const Ast* ast, const ProgramAst*)
 {
-    throw 1; // Not implemented
-    return std::unique_ptr<ProgramAst>(nullptr);
+    return ast->kind() == Ast::Kind::Program;
 }
 
-} // namespace uaiso
+bool fits(const Ast* ast, const GeneratorAst*)
+{
+    return ast->kind() == Ast::Kind::Generator;
+}
+
+bool fits(const Ast* ast, const TemplateArgAst*)
+{
+    return ast->kind() == Ast::Kind::Invalid;
+}
+
+/*
+ * The fields of each node, in declaration order, shared by the writer and
+ * the reader. An archive provides node, list, loc, lexeme, and str; the
+ * overloads that take a setter are for members injected by templates.
+ */
+
+    //--- Names ---//
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, CompletionNameAst* ast)
+{
+    ar.loc(ast->nameLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, ErrorNameAst* ast)
+{
+    ar.loc(ast->errorLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, GenNameAst* ast)
+{
+    ar.loc(ast->genLoc_);
+    ar.str(ast->str_);
+    ar.lexeme(ast->ident_, ast->genLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, NestedNameAst* ast)
+{
+    ar.list(ast->names_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, SimpleNameAst* ast)
+{
+    ar.loc(ast->nameLoc_);
+    ar.lexeme(ast->ident_, ast->nameLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, TemplateInstNameAst* ast)
+{
+    ar.node(ast->name_);
+    ar.loc(ast->markLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.list(ast->args_);
+    ar.loc(ast->rDelimLoc_);
+}
+
+    //--- Specifiers ---//
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, OpaqueSpecAst* ast)
+{
+    ar.node(ast->baseSpec_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, ArraySpecAst* ast)
+{
+    fields(ar, static_cast<OpaqueSpecAst*>(ast));
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->exprOrSpec_);
+    ar.loc(ast->rDelimLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, BuiltinSpecAst* ast)
+{
+    ar.loc(ast->keyLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, ChanSpecAst* ast)
+{
+    fields(ar, static_cast<OpaqueSpecAst*>(ast));
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->dirLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, DecoratedSpecAst* ast)
+{
+    ar.node(ast->spec_);
+    ar.list(ast->attrs_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, FuncSpecAst* ast)
+{
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->param_);
+    ar.node(ast->result_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, InferredSpecAst* ast)
+{
+    ar.loc(ast->keyLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, NamedSpecAst* ast)
+{
+    ar.node(ast->name_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, PtrSpecAst* ast)
+{
+    fields(ar, static_cast<OpaqueSpecAst*>(ast));
+    ar.loc(ast->oprLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, RecordSpecAst* ast)
+{
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->delimLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.loc(ast->rDelimLoc_);
+    ar.list(ast->bases_);
+    ar.node(ast->templ_);
+    ar.list(ast->decls_);
+    ar.node(ast->proto_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, TypeofSpecAst* ast)
+{
+    ar.loc(ast->oprLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->expr_);
+    ar.loc(ast->rDelimLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, VoidSpecAst* ast)
+{
+    ar.loc(ast->keyLoc_);
+}
+
+    //--- Attributes ---//
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, AnnotAttrAst* ast)
+{
+    ar.loc(ast->atLoc_);
+    ar.loc(ast->textLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, AutoAttrAst* ast)
+{
+    ar.loc(ast->keyLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, CodegenAttrAst* ast)
+{
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->expr_);
+    ar.loc(ast->rDelimLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, DeclAttrAst* ast)
+{
+    ar.loc(ast->keyLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, EvalStrategyAttrAst* ast)
+{
+    ar.loc(ast->keyLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, LinkageAttrAst* ast)
+{
+    ar.loc(ast->keyLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, ParamDirAttrAst* ast)
+{
+    ar.loc(ast->keyLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, StorageClassAttrAst* ast)
+{
+    ar.loc(ast->keyLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, TypeQualAttrAst* ast)
+{
+    ar.loc(ast->keyLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, VisibilityAttrAst* ast)
+{
+    ar.loc(ast->keyLoc_);
+}
+
+    //--- Declarations ---//
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, AliasDeclAst* ast)
+{
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->name_);
+    ar.loc(ast->eqLoc_);
+    ar.node(ast->spec_);
+    ar.loc(ast->terminLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, BaseDeclAst* ast)
+{
+    ar.node(ast->name_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, BlockDeclAst* ast)
+{
+    ar.list(ast->attrs_);
+    ar.loc(ast->lDelimLoc_);
+    ar.list(ast->decls_);
+    ar.loc(ast->rDelimLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, SelectiveDeclAst* ast)
+{
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->expr_);
+    ar.loc(ast->rDelimLoc_);
+    ar.node(ast->ifDecl_);
+    ar.loc(ast->otherKeyLoc_);
+    ar.node(ast->elseDecl_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, ConstraintDeclAst* ast)
+{
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->expr_);
+    ar.loc(ast->rDelimLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, DebugDeclAst* ast)
+{
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->delimLoc_);
+    ar.node(ast->expr_);
+    ar.loc(ast->terminLoc_);
+}
 
-template <class AstT> AstSerializer::VisitResult
-AstSerializer::traverse(VisitResult (Base::*function)(AstT*), AstT* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, EnumDeclAst* ast)
 {
-    if (!ast)
-        *output__ << "!";
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->name_);
+    ar.loc(ast->sepLoc_);
+    ar.node(ast->spec_);
+    ar.loc(ast->lDelimLoc_);
+    ar.list(ast->decls_);
+    ar.loc(ast->rDelimLoc_);
+    ar.loc(ast->terminLoc_);
+}
 
-    return ((this)->*(function))(ast);
+template <class ArchiveT>
+void fields(ArchiveT& ar, EnumMemberDeclAst* ast)
+{
+    ar.node(ast->name_);
+    ar.loc(ast->assignLoc_);
+    ar.node(ast->init_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseName(NameAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ErrorDeclAst* ast)
 {
-    return traverse(&Base::traverseName, ast);
+    ar.loc(ast->errorLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseSpec(SpecAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, FuncDeclAst* ast)
 {
-    return traverse(&Base::traverseSpec, ast);
+    ar.node(ast->name_);
+    ar.node(ast->spec_);
+    ar.node(ast->stmt_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseAttr(AttrAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ForwardDeclAst* ast)
 {
-    return traverse(&Base::traverseAttr, ast);
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->name_);
+    ar.loc(ast->terminLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseDecl(DeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ImportClauseDeclAst* ast)
 {
-    return traverse(&Base::traverseDecl, ast);
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->hintLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.loc(ast->rDelimLoc_);
+    ar.loc(ast->terminLoc_);
+    ar.list(ast->modules_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseExpr(ExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ImportItemDeclAst* ast)
 {
-    return traverse(&Base::traverseExpr, ast);
+    ar.node(ast->actualName_);
+    ar.loc(ast->asLoc_);
+    ar.node(ast->alternateName_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseStmt(StmtAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ImportModuleDeclAst* ast)
 {
-    return traverse(&Base::traverseStmt, ast);
+    ar.node(ast->expr_);
+    ar.loc(ast->asLoc_);
+    ar.node(ast->localName_);
+    ar.loc(ast->selectLoc_);
+    ar.list(ast->items_);
 }
 
-void AstSerializer::serializeProgram(ProgramAst *ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, InvariantDeclAst* ast)
 {
-    serializeProgram(ast, std::cout);
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.loc(ast->rDelimLoc_);
+    ar.node(ast->stmt_);
 }
 
-void AstSerializer::serializeProgram(ProgramAst *ast, std::ostream& os)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ModuleDeclAst* ast)
 {
-    output__ = &os;
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->name_);
+    ar.loc(ast->terminLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, PackageDeclAst* ast)
+{
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->name_);
+    ar.loc(ast->terminLoc_);
+}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, ParamDeclAst* ast)
+{
+    ar.node(ast->name_);
+}
 
-    traverseDecl(ast->module_.get());
-    traverseDecl(ast->package_.get());
-    std::for_each(ast->decls_->begin(), ast->decls_->end(),
-                  [this] (DeclAst* decl) { traverseDecl(decl); });
+template <class ArchiveT>
+void fields(ArchiveT& ar, ParamGroupDeclAst* ast)
+{
+    ar.node(ast->spec_);
+    ar.list(ast->decls_);
+}
 
-    *output__ << std::endl;
+template <class ArchiveT>
+void fields(ArchiveT& ar, ParamClauseDeclAst* ast)
+{
+    ar.loc(ast->lDelimLoc_);
+    ar.list(ast->decls_);
+    ar.loc(ast->variadicLoc_);
+    ar.loc(ast->rDelimLoc_);
 }
 
-void AstSerializer::enterList()
+template <class ArchiveT>
+void fields(ArchiveT& ar, RecordDeclAst* ast)
 {
-    *output__ << "[";
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->name_);
+    ar.node(ast->spec_);
+    ar.loc(ast->terminLoc_);
 }
 
-void AstSerializer::leaveList()
+template <class ArchiveT>
+void fields(ArchiveT& ar, SectionDeclAst* ast)
 {
-    *output__ << "]";
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.list(ast->decls_);
+    ar.loc(ast->rDelimLoc_);
+    ar.loc(ast->terminLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseSimpleName(SimpleNameAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, StaticAssertDeclAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseSimpleName(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->expr_);
+    ar.loc(ast->mDelimLoc_);
+    ar.node(ast->message_);
+    ar.loc(ast->rDelimLoc_);
+    ar.loc(ast->terminLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseTemplateInstName(TemplateInstNameAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, TemplateDeclAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseTemplateInstName(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->name_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseGenName(GenNameAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, TemplateParamDeclAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseGenName(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->spec_);
+    ar.node(ast->name_);
+    ar.loc(ast->packLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseNestedName(NestedNameAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, TemplateParamClauseDeclAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseNestedName(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->lDelimLoc_);
+    ar.list(ast->decls_);
+    ar.loc(ast->rDelimLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseRecordSpec(RecordSpecAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, UnitTestDeclAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseRecordSpec(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->stmt_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseArraySpec(ArraySpecAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, VarDeclAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseArraySpec(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->name_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseBuiltinSpec(BuiltinSpecAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, VarGroupDeclAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseBuiltinSpec(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->spec_);
+    ar.list(ast->decls_);
+    ar.loc(ast->terminLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseChanSpec(ChanSpecAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, VersionDeclAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseChanSpec(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->delimLoc_);
+    ar.node(ast->expr_);
+    ar.loc(ast->terminLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseDecoratedSpec(DecoratedSpecAst* ast)
+    //--- Expressions ---//
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, UnaryExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseDecoratedSpec(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->oprLoc_);
+    ar.node(ast->expr_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseOpaqueSpec(OpaqueSpecAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, BinaryExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseOpaqueSpec(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->expr1_);
+    ar.loc(ast->oprLoc_);
+    ar.node(ast->expr2_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseFuncSpec(FuncSpecAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, AddExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseFuncSpec(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<BinaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseInferredSpec(InferredSpecAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, AddrOfExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseInferredSpec(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<UnaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseNamedSpec(NamedSpecAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ArrayInitExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseNamedSpec(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->lDelimLoc_);
+    ar.list(ast->inits_);
+    ar.loc(ast->rDelimLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traversePtrSpec(PtrSpecAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ArrayIndexExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traversePtrSpec(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->base_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->index_);
+    ar.loc(ast->rDelimLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseTypeofSpec(TypeofSpecAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ArrayLengthExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseTypeofSpec(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseVoidSpec(VoidSpecAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ArraySliceExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseVoidSpec(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->base_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->range_);
+    ar.loc(ast->rDelimLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseAnnotAttr(AnnotAttrAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, AssertExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseAnnotAttr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->expr_);
+    ar.loc(ast->mDelimLoc_);
+    ar.node(ast->message_);
+    ar.loc(ast->rDelimLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseDeclAttr(DeclAttrAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, AssignExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseDeclAttr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.list(ast->exprs1_);
+    ar.loc(ast->oprLoc_);
+    ar.list(ast->exprs2_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseAutoAttr(AutoAttrAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, BitAndExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseAutoAttr(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<BinaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseCodegenAttr(CodegenAttrAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, BitCompExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseCodegenAttr(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<UnaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseEvalStrategyAttr(EvalStrategyAttrAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, BitOrExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseEvalStrategyAttr(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<BinaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseLinkageAttr(LinkageAttrAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, BitXorExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseLinkageAttr(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<BinaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseParamDirAttr(ParamDirAttrAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, BoolLitExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseParamDirAttr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->litLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseStorageClassAttr(StorageClassAttrAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, CallExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseStorageClassAttr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->base_);
+    ar.loc(ast->lDelimLoc_);
+    ar.list(ast->args_);
+    ar.loc(ast->packLoc_);
+    ar.loc(ast->rDelimLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseTypeQualAttr(TypeQualAttrAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, CastExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseTypeQualAttr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.loc(ast->rDelimLoc_);
+    ar.node(ast->spec_);
+    ar.node(ast->expr_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseVisibilityAttr(VisibilityAttrAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ChanExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseVisibilityAttr(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<UnaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseAliasDecl(AliasDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, CharLitExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseAliasDecl(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->litLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseBaseDecl(BaseDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, CommaExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseBaseDecl(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<BinaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseSelectiveDecl(SelectiveDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ConcatExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseSelectiveDecl(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<BinaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseConstraintDecl(ConstraintDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, CondExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseConstraintDecl(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->cond_);
+    ar.loc(ast->questionLoc_);
+    ar.node(ast->yes_);
+    ar.loc(ast->delimLoc_);
+    ar.node(ast->no_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseVersionDecl(VersionDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, DelExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseVersionDecl(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.list(ast->exprs_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseEnumDecl(EnumDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, DesignateExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseEnumDecl(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->id_);
+    ar.loc(ast->delimLoc_);
+    ar.node(ast->value_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseEnumMemberDecl(EnumMemberDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, DivExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseEnumMemberDecl(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<BinaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseBlockDecl(BlockDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ErrorExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseBlockDecl(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->errorLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseErrorDecl(ErrorDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, EqExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseErrorDecl(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<BinaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseFuncDecl(FuncDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, FuncLitExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseFuncDecl(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->spec_);
+    ar.node(ast->stmt_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseForwardDecl(ForwardDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, IdentExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseForwardDecl(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->name_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseImportModuleDecl(ImportModuleDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, InExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseImportModuleDecl(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<BinaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseInvariantDecl(InvariantDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, IncDecExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseInvariantDecl(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<UnaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseModuleDecl(ModuleDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, IsExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseModuleDecl(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<BinaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traversePackageDecl(PackageDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ListCompreExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traversePackageDecl(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->lDelimLoc_);
+    ar.loc(ast->rDelimLoc_);
+    ar.loc(ast->sepLoc_);
+    ar.node(ast->expr_);
+    ar.list(ast->gens_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseParamDecl(ParamDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, LogicAndExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseParamDecl(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<BinaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseParamGroupDecl(ParamGroupDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, LogicNotExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseParamGroupDecl(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<UnaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseParamClauseDecl(ParamClauseDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, LogicOrExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseParamClauseDecl(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<BinaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseSectionDecl(SectionDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, MakeExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseSectionDecl(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->base_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->spec_);
+    ar.loc(ast->splitLoc_);
+    ar.list(ast->args_);
+    ar.loc(ast->packLoc_);
+    ar.loc(ast->rDelimLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseStaticAssertDecl(StaticAssertDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, MemberAccessExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseStaticAssertDecl(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->exprOrSpec_);
+    ar.loc(ast->oprLoc_);
+    ar.node(ast->name_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseTemplateDecl(TemplateDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, MinusExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseTemplateDecl(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<UnaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseTemplateParamDecl(TemplateParamDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ModExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseTemplateParamDecl(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<BinaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseTemplateParamClauseDecl(TemplateParamClauseDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, MulExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseTemplateParamClauseDecl(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<BinaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseRecordDecl(RecordDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, NestedNewExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseRecordDecl(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->base_);
+    ar.loc(ast->oprLoc_);
+    ar.node(ast->nestedNew_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseUnitTestDecl(UnitTestDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, NewExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseUnitTestDecl(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lAllocDelimLoc_);
+    ar.list(ast->allocArgs_);
+    ar.loc(ast->rAllocDelimLoc_);
+    ar.node(ast->spec_);
+    ar.loc(ast->lArgDelimLoc_);
+    ar.list(ast->args_);
+    ar.loc(ast->rArgDelimLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseVarDecl(VarDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, NullLitExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseVarDecl(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->litLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseVarGroupDecl(VarGroupDeclAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, NumLitExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseVarGroupDecl(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->litLoc_);
+    ar.lexeme(ast->lit_, ast->litLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseAddExpr(AddExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, PlusExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseAddExpr(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<UnaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseAddrOfExpr(AddrOfExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT&, PrimaryExprAst*)
+{}
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, PrintExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseAddrOfExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->oprLoc_);
+    ar.list(ast->exprs_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseRecordLitExpr(RecordLitExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, PowerExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseRecordLitExpr(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<BinaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseRecordInitExpr(RecordInitExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, PtrDerefExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseRecordInitExpr(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<UnaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseArrayInitExpr(ArrayInitExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, RecordLitExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseArrayInitExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->exprOrSpec_);
+    ar.node(ast->init_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseArrayLengthExpr(ArrayLengthExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, RecordInitExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseArrayLengthExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->spec_);
+    ar.loc(ast->lDelimLoc_);
+    ar.list(ast->inits_);
+    ar.loc(ast->rDelimLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseArraySliceExpr(ArraySliceExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, RelExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseArraySliceExpr(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<BinaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseArrayIndexExpr(ArrayIndexExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ShiftExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseArrayIndexExpr(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<BinaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseAssertExpr(AssertExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, StrLitExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseAssertExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->litLoc_);
+    ar.lexeme(ast->lit_, ast->litLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseAssignExpr(AssignExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, SubExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseAssignExpr(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<BinaryExprAst*>(ast));
 }
 
-AstSerializer::VisitResult AstSerializer::traverseBinaryExpr(BinaryExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, SubrangeExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseBinaryExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->low_);
+    ar.loc(ast->delim1Loc_);
+    ar.node(ast->hi_);
+    ar.loc(ast->delim2Loc_);
+    ar.node(ast->max_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseBitAndExpr(BitAndExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, SuperExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseBitAndExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseBitCompExpr(BitCompExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ThisExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseBitCompExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseBitOrExpr(BitOrExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, TupleLitExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseBitOrExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->lDelimLoc_);
+    ar.list(ast->inits_);
+    ar.loc(ast->rDelimLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseBitXorExpr(BitXorExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, TypeidExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseBitXorExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->exprOrSpec_);
+    ar.loc(ast->rDelimLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseBoolLitExpr(BoolLitExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, TypeAssertExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseBoolLitExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->base_);
+    ar.loc(ast->oprLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->spec_);
+    ar.loc(ast->rDelimLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseCallExpr(CallExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, TypeQueryExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseCallExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->spec_);
+    ar.node(ast->name_);
+    ar.loc(ast->rDelimLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseCastExpr(CastExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, UnpackExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseCastExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->expr_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseChanExpr(ChanExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, MixinExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseChanExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->expr_);
+    ar.loc(ast->rDelimLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseCharLitExpr(CharLitExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, VoidInitExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseCharLitExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseCommaExpr(CommaExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, WrappedExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseCommaExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->expr_);
+    ar.loc(ast->rDelimLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseConcatExpr(ConcatExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, YieldExprAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseConcatExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.list(ast->exprs_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseCondExpr(CondExprAst* ast)
+    //--- Statements ---//
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, AsyncStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseCondExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->expr_);
+    ar.loc(ast->terminLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseDelExpr(DelExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, BlockStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseDelExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->lDelimLoc_);
+    ar.list(ast->stmts_);
+    ar.loc(ast->rDelimLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseDesignateExpr(DesignateExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, BodyStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseDesignateExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->bodyLoc_);
+    ar.node(ast->block_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseDivExpr(DivExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, BreakStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseDivExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->name_);
+    ar.loc(ast->terminLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseEqExpr(EqExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, CaseClauseStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseEqExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.list(ast->exprs_);
+    ar.loc(ast->delimLoc_);
+    ar.list(ast->stmts_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseFuncLitExpr(FuncLitExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, CatchClauseStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseFuncLitExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->decl_);
+    ar.loc(ast->rDelimLoc_);
+    ar.node(ast->stmt_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseIdentExpr(IdentExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ContractStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseIdentExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->stmt1_);
+    ar.node(ast->stmt2_);
+    ar.node(ast->stmt3_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseInExpr(InExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ContinueStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseInExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->name_);
+    ar.loc(ast->terminLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseIncDecExpr(IncDecExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, DeclStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseIncDecExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->decl_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseTypeQueryExpr(TypeQueryExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, DefaultClauseStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseTypeQueryExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->delimLoc_);
+    ar.list(ast->stmts_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseIsExpr(IsExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, DeferredStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseIsExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->name_);
+    ar.loc(ast->rDelimLoc_);
+    ar.node(ast->stmt_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseLogicAndExpr(LogicAndExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, DoWhileStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseLogicAndExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->doLoc_);
+    ar.node(ast->stmt_);
+    ar.loc(ast->whileLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->expr_);
+    ar.loc(ast->rDelimLoc_);
+    ar.loc(ast->terminLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseLogicNotExpr(LogicNotExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, EmptyStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseLogicNotExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseLogicOrExpr(LogicOrExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ErrorStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseLogicOrExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->errorLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseMakeExpr(MakeExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, EvalStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseMakeExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->expr_);
+    ar.loc(ast->terminLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseMemberAccessExpr(MemberAccessExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ExprStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseMemberAccessExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.list(ast->exprs_);
+    ar.loc(ast->terminLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseMinusExpr(MinusExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, FallthroughStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseMinusExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseModExpr(ModExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, FinallyClauseStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseModExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->stmt_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseMulExpr(MulExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ForStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseMulExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->preamble_);
+    ar.node(ast->cond_);
+    ar.loc(ast->delimLoc_);
+    ar.node(ast->post_);
+    ar.loc(ast->rDelimLoc_);
+    ar.node(ast->stmt_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseNestedNewExpr(NestedNewExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ForeachStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseNestedNewExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.loc(ast->rDelimLoc_);
+    ar.node(ast->decl_);
+    ar.node(ast->expr_);
+    ar.node(ast->stmt_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseNewExpr(NewExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, GotoStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseNewExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->name_);
+    ar.loc(ast->terminLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseNumLitExpr(NumLitExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, IfStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseNumLitExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->ifLoc_);
+    ar.loc(ast->elseLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.loc(ast->rDelimLoc_);
+    ar.node(ast->preamble_);
+    ar.node(ast->expr_);
+    ar.node(ast->then_);
+    ar.node(ast->notThen_);
 }
 
-AstSerializer::VisitResult AstSerializer::traversePlusExpr(PlusExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, InStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traversePlusExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->inLoc_);
+    ar.node(ast->block_);
 }
 
-AstSerializer::VisitResult AstSerializer::traversePrimaryExpr(PrimaryExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, LabeledStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traversePrimaryExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->label_);
+    ar.loc(ast->delimLoc_);
+    ar.node(ast->stmt_);
 }
 
-AstSerializer::VisitResult AstSerializer::traversePowerExpr(PowerExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, OutStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traversePowerExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->outLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->name_);
+    ar.loc(ast->rDelimLoc_);
+    ar.node(ast->block_);
 }
 
-AstSerializer::VisitResult AstSerializer::traversePtrDerefExpr(PtrDerefExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ReturnStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traversePtrDerefExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.list(ast->exprs_);
+    ar.loc(ast->terminLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseNullLitExpr(NullLitExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, SelectiveStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseNullLitExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->expr_);
+    ar.loc(ast->rDelimLoc_);
+    ar.node(ast->ifStmt_);
+    ar.loc(ast->otherKeyLoc_);
+    ar.node(ast->elseStmt_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseRelExpr(RelExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, SyncedStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseRelExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->expr_);
+    ar.loc(ast->rDelimLoc_);
+    ar.node(ast->stmt_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseShiftExpr(ShiftExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, SwitchStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseShiftExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->preamble_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->expr_);
+    ar.loc(ast->rDelimLoc_);
+    ar.node(ast->stmt_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseStrLitExpr(StrLitExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, ThrowStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseStrLitExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->expr_);
+    ar.loc(ast->terminLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseSubExpr(SubExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, TryStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseSubExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->stmt_);
+    ar.list(ast->catchs_);
+    ar.node(ast->final_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseSuperExpr(SuperExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, TypeSwitchStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseSuperExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->spec_);
+    ar.loc(ast->rDelimLoc_);
+    ar.node(ast->stmt_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseThisExpr(ThisExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, WhileStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseThisExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->whileLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.node(ast->expr_);
+    ar.loc(ast->rDelimLoc_);
+    ar.node(ast->stmt_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseTypeAssertExpr(TypeAssertExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, WithStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseTypeAssertExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.loc(ast->lDelimLoc_);
+    ar.list(ast->exprs_);
+    ar.loc(ast->rDelimLoc_);
+    ar.node(ast->stmt_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseTypeidExpr(TypeidExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, YieldStmtAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseTypeidExpr(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->keyLoc_);
+    ar.node(ast->expr_);
+    ar.loc(ast->terminLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseUnaryExpr(UnaryExprAst* ast)
+    //--- Shapes ---//
+
+template <class ArchiveT, class TemplateParamT>
+void fields(ArchiveT& ar, FuncSpecAst__<TemplateParamT>* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseUnaryExpr(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<FuncSpecAst*>(ast));
+    ar.loc(ast->lDelimLoc_);
+    ar.loc(ast->rDelimLoc_);
+    if (ast->isTemplate())
+        ar.node(ast, ast->templateParam(), &FuncSpecAst::setTemplateParam);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseMixinExpr(MixinExprAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, FuncRecvDeclAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseMixinExpr(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<FuncDeclAst*>(ast));
+    ar.node(ast->recv_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseVoidInitExpr(VoidInitExprAst* ast)
+template <class ArchiveT, class VariadicT, class DefaultArgT>
+void fields(ArchiveT& ar, ParamDeclAst__<VariadicT, DefaultArgT>* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseVoidInitExpr(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<ParamDeclAst*>(ast));
+    if (ast->isVariadic())
+        ar.loc(ast, ast->variadicLoc(), &ParamDeclAst::setVariadicLoc);
+    if (ast->hasDefaultArg()) {
+        ar.loc(ast, ast->assignLoc(), &ParamDeclAst::setAssignLoc);
+        ar.node(ast, ast->defaultArg(), &ParamDeclAst::setDefaultArg);
+    }
 }
 
-AstSerializer::VisitResult AstSerializer::traverseWrappedExpr(WrappedExprAst* ast)
+template <class ArchiveT, class DefaultArgT, class SpecializationT>
+void fields(ArchiveT& ar, TemplateParamDeclAst__<DefaultArgT, SpecializationT>* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseWrappedExpr(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<TemplateParamDeclAst*>(ast));
+    if (ast->hasDefaultArg()) {
+        ar.loc(ast, ast->assignLoc(), &TemplateParamDeclAst::setAssignLoc);
+        ar.node(ast, ast->defaultArg(), &TemplateParamDeclAst::setDefaultArg);
+    }
+    if (ast->hasSpecialization()) {
+        ar.loc(ast, ast->bindLoc(), &TemplateParamDeclAst::setBindLoc);
+        ar.node(ast, ast->specialization(), &TemplateParamDeclAst::setSpecialization);
+    }
 }
 
-AstSerializer::VisitResult AstSerializer::traverseBlockStmt(BlockStmtAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, TemplateParamAliasDeclAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseBlockStmt(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<TemplateParamDeclAst*>(ast));
+    ar.loc(ast->aliasLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseBodyStmt(BodyStmtAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, TemplateParamThisDeclAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseBodyStmt(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<TemplateParamDeclAst*>(ast));
+    ar.loc(ast->thissLoc_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseContractStmt(ContractStmtAst* ast)
+template <class ArchiveT, class InitT>
+void fields(ArchiveT& ar, VarDeclAst__<InitT>* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseContractStmt(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<VarDeclAst*>(ast));
+    if (ast->hasInit()) {
+        ar.loc(ast, ast->assignLoc(), &VarDeclAst::setAssignLoc);
+        ar.node(ast, ast->init(), &VarDeclAst::setInit);
+    }
 }
 
-AstSerializer::VisitResult AstSerializer::traverseExprStmt(ExprStmtAst* ast)
+template <class ArchiveT, class InitsT>
+void fields(ArchiveT& ar, VarGroupDeclAst__<InitsT>* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseExprStmt(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<VarGroupDeclAst*>(ast));
+    if (ast->hasInits()) {
+        ar.loc(ast, ast->assignLoc(), &VarGroupDeclAst::setAssignLoc);
+        ar.list(ast, ast->inits(), &VarGroupDeclAst::setInits);
+    }
 }
 
-AstSerializer::VisitResult AstSerializer::traverseDeclStmt(DeclStmtAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, VarTagDeclAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseDeclStmt(ast);
-    *output__ << ")";
-    return Continue;
+    fields(ar, static_cast<VarGroupDeclAst*>(ast));
+    ar.node(ast->tag_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseInStmt(InStmtAst* ast)
+    //--- Miscellaneous ---//
+
+template <class ArchiveT>
+void fields(ArchiveT& ar, ProgramAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseInStmt(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->module_);
+    ar.node(ast->package_);
+    ar.list(ast->decls_);
+    ar.list(ast->stmts_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseOutStmt(OutStmtAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, GeneratorAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseOutStmt(ast);
-    *output__ << ")";
-    return Continue;
+    ar.loc(ast->oprLoc_);
+    ar.list(ast->patterns_);
+    ar.node(ast->range_);
+    ar.list(ast->filters_);
 }
 
-AstSerializer::VisitResult AstSerializer::traverseEmptyStmt(EmptyStmtAst* ast)
+template <class ArchiveT>
+void fields(ArchiveT& ar, TemplateArgAst* ast)
 {
-    *output__ << "(" << static_cast<size_t>(ast->kind());
-    Base::traverseEmptyStmt(ast);
-    *output__ << ")";
-    return Continue;
+    ar.node(ast->arg_);
 }
+template <class ArchiveT>
+void visitFields(ArchiveT& ar, Ast* ast, unsigned shape)
+{
+#define SHAPE_CASE(AST_KIND, SHAPE, AST_CLASS) \
+    if (ast->kind() == Ast::Kind::AST_KIND && shape == SHAPE) { \
+        fields(ar, static_cast<AST_CLASS*>(ast)); \
+        return; \
+    }
+
+    SHAPED_AST_MIXIN(SHAPE_CASE)
+
+#undef SHAPE_CASE
 
+    switch (ast->kind()) {
+#define MAKE_CASE(AST_NODE, AST_KIND) \
+    case Ast::Kind::AST_NODE##AST_KIND: \
+        fields(ar, static_cast<AST_NODE##AST_KIND##Ast*>(ast)); \
+        return;
+
+    NAME_AST_MIXIN(MAKE_NAME_CASE)
+    SPEC_AST_MIXIN(MAKE_SPEC_CASE)
+    ATTR_AST_MIXIN(MAKE_ATTR_CASE)
+    DECL_AST_MIXIN(MAKE_DECL_CASE)
+    EXPR_AST_MIXIN(MAKE_EXPR_CASE)
+    STMT_AST_MIXIN(MAKE_STMT_CASE)
+
+#undef MAKE_CASE
+
+    case Ast::Kind::Program:
+        fields(ar, static_cast<ProgramAst*>(ast));
+        return;
+    case Ast::Kind::Generator:
+        fields(ar, static_cast<GeneratorAst*>(ast));
+        return;
+    case Ast::Kind::Invalid:
+        fields(ar, static_cast<TemplateArgAst*>(ast));
+        return;
+    default:
+        UAISO_ASSERT(false, return);
+        return;
+    }
+}
+
+} // anonymous
+
+    //--- Writer ---//
+
+class AstSerializer::Writer final
+{
+public:
+    Writer(std::ostream* os)
+        : os_(os)
+    {
+        out_.append(kMagic, sizeof(kMagic));
+        uint(kFormatVersion);
+    }
+
+    std::string finish()
+    {
+        flush();
+        return std::move(out_);
+    }
+
+    void flush()
+    {
+        if (os_) {
+            os_->write(out_.data(), out_.size());
+            out_.clear();
+        }
+    }
+
+    void uint(uint64_t value)
+    {
+        while (value >= 0x80) {
+            out_.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out_.push_back(static_cast<char>(value));
+    }
+
+    void sint(int64_t value)
+    {
+        uint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    void str(const std::string& s)
+    {
+        uint(s.size());
+        out_ += s;
+    }
+
+    /*
+     * Header of a node: its kind plus one (0 is a null node) shifted to make
+     * room for a bit telling whether the node has bits other than the kind.
+     */
+    void node(const Ast* ast)
+    {
+        if (!ast) {
+            uint(0);
+            return;
+        }
+
+        const uint32_t bits = AstSerializer::bits(ast);
+        const uint64_t kind = (bits & 0xffff) + 1;
+        uint(kind << 1 | (bits >> 16 ? 1 : 0));
+        if (bits >> 16)
+            uint(bits >> 16);
+        unsigned shape = 0;
+        if (isShaped(ast->kind())) {
+            shape = shapeOf(ast);
+            uint(shape);
+        }
+        visitFields(*this, const_cast<Ast*>(ast), shape);
+
+        if (out_.size() >= kChunkSize)
+            flush();
+    }
+
+    template <class AstT>
+    void node(const std::unique_ptr<AstT>& ast)
+    {
+        node(ast.get());
+    }
+
+    template <class AstT, class ChildT, class SetT>
+    void node(AstT*, const ChildT* child, SetT)
+    {
+        node(child);
+    }
+
+    template <class ListT>
+    void list(const ListT* list)
+    {
+        if (!list) {
+            uint(0);
+            return;
+        }
+        uint64_t cnt = 0;
+        for (auto it = list->begin(); it != list->end(); ++it)
+            ++cnt;
+        uint(cnt + 1);
+        for (auto ast : *list)
+            node(ast);
+    }
+
+    template <class ListT>
+    void list(const std::unique_ptr<ListT>& list)
+    {
+        this->list(list.get());
+    }
+
+    template <class AstT, class ListT, class SetT>
+    void list(AstT*, const ListT* list, SetT)
+    {
+        this->list(list);
+    }
+
+    /*
+     * A location is tagged with its file: 0 for an empty location, 1 for the
+     * file of the previous location, 2 for an unspecified file, and 3 plus
+     * the index of the file in the file table otherwise (its name follows
+     * when it's a new one). Then come the deltas: line and column against
+     * the previous location, last line and last column against line and
+     * column.
+     */
+    void loc(const SourceLoc& loc)
+    {
+        if (loc.isEmpty() && loc.fileId_.isUnspecified()) {
+            uint(0);
+            return;
+        }
+
+        if (loc.fileId_ == prevFileId_) {
+            uint(1);
+        } else if (loc.fileId_.isUnspecified()) {
+            uint(2);
+        } else {
+            auto it = std::find(files_.begin(), files_.end(), loc.fileId_);
+            uint(3 + (it - files_.begin()));
+            if (it == files_.end()) {
+                files_.push_back(loc.fileId_);
+                str(loc.fileName());
+            }
+        }
+        prevFileId_ = loc.fileId_;
+
+        sint(int64_t(loc.line_) - prevLine_);
+        sint(int64_t(loc.col_) - prevCol_);
+        sint(int64_t(loc.lastLine_) - loc.line_);
+        sint(int64_t(loc.lastCol_) - loc.col_);
+        prevLine_ = loc.line_;
+        prevCol_ = loc.col_;
+    }
+
+    template <class AstT, class SetT>
+    void loc(AstT*, const SourceLoc& loc, SetT)
+    {
+        this->loc(loc);
+    }
+
+    /*
+     * A lexeme is the index of its spelling in the lexeme table, plus one
+     * (0 is a null lexeme). The spelling follows when it's a new one.
+     */
+    template <class LexemeT>
+    void lexeme(const LexemeT* lex, const SourceLoc&)
+    {
+        if (!lex) {
+            uint(0);
+            return;
+        }
+        auto it = lexIdx_.find(lex);
+        if (it != lexIdx_.end()) {
+            uint(it->second);
+            return;
+        }
+        const size_t idx = lexIdx_.size() + 1;
+        lexIdx_.emplace(lex, idx);
+        uint(idx);
+        str(lex->spelling());
+    }
+
+private:
+    std::ostream* os_;
+    std::string out_;
+    std::unordered_map<const Lexeme*, size_t> lexIdx_;
+    std::vector<FileId> files_;
+    FileId prevFileId_;
+    int64_t prevLine_ { 0 };
+    int64_t prevCol_ { 0 };
+};
+
+    //--- Reader ---//
+
+class AstSerializer::Reader final
+{
+public:
+    Reader(const char* data, size_t len, LexemeMap* lexs)
+        : cur_(data)
+        , end_(data + len)
+        , lexs_(lexs)
+    {}
+
+    bool header()
+    {
+        if (size_t(end_ - cur_) < sizeof(kMagic)
+                || memcmp(cur_, kMagic, sizeof(kMagic)))
+            return false;
+        cur_ += sizeof(kMagic);
+        return uint() == kFormatVersion && ok_;
+    }
+
+    bool ok() const { return ok_; }
+
+    bool atEnd() const { return cur_ == end_; }
+
+    uint64_t uint()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (cur_ == end_) {
+                ok_ = false;
+                return 0;
+            }
+            const unsigned char byte = *cur_++;
+            value |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+        ok_ = false;
+        return 0;
+    }
+
+    int64_t sint()
+    {
+        const uint64_t value = uint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    std::string str()
+    {
+        const uint64_t len = uint();
+        if (len > uint64_t(end_ - cur_)) {
+            ok_ = false;
+            return std::string();
+        }
+        std::string s(cur_, len);
+        cur_ += len;
+        return s;
+    }
+
+    void str(std::string& s)
+    {
+        s = str();
+    }
+
+    Ast* node()
+    {
+        const uint64_t header = uint();
+        if (!ok_ || !header)
+            return nullptr;
+
+        const uint64_t kind = (header >> 1) - 1;
+        const uint64_t flags = header & 1 ? uint() : 0;
+        if (kind > 0xffff || flags > 0xffff) {
+            ok_ = false;
+            return nullptr;
+        }
+        const unsigned shape = isShaped(Ast::Kind(kind)) ? uint() : 0;
+        std::unique_ptr<Ast> ast(create(Ast::Kind(kind), shape));
+        if (!ast) {
+            ok_ = false;
+            return nullptr;
+        }
+        AstSerializer::setBits(ast.get(), uint32_t(kind | flags << 16));
+        visitFields(*this, ast.get(), shape);
+
+        return ok_ ? ast.release() : nullptr;
+    }
+
+    template <class AstT>
+    void node(std::unique_ptr<AstT>& ast)
+    {
+        std::unique_ptr<Ast> any(node());
+        if (any && !fits(any.get(), static_cast<const AstT*>(nullptr))) {
+            ok_ = false;
+            any.reset();
+        }
+        ast.reset(static_cast<AstT*>(any.release()));
+    }
+
+    template <class AstT, class ChildT, class SetT>
+    void node(AstT* ast, const ChildT*, SetT set)
+    {
+        std::unique_ptr<ChildT> child;
+        node(child);
+        if (child)
+            (ast->*set)(child.release());
+    }
+
+    template <class ListT>
+    void list(std::unique_ptr<ListT>& list)
+    {
+        list.reset();
+        uint64_t cnt = uint();
+        if (!cnt)
+            return;
+
+        // Build the list circularly, like the parsers do when shifting.
+        ListT* last = nullptr;
+        while (--cnt && ok_) {
+            std::unique_ptr<typename ListT::AstType> ast;
+            node(ast);
+            if (!ast) {
+                ok_ = false;
+                break;
+            }
+            last = last ? last->handleSR(ast.release())
+                        : ListT::createSR(ast.release());
+        }
+        if (last)
+            list.reset(last->finishSR());
+    }
+
+    template <class AstT, class ListT, class SetT>
+    void list(AstT* ast, const ListT*, SetT set)
+    {
+        std::unique_ptr<ListT> list;
+        this->list(list);
+        if (list)
+            (ast->*set)(list.release());
+    }
+
+    void loc(SourceLoc& loc)
+    {
+        const uint64_t tag = uint();
+        if (!tag) {
+            loc = kEmptyLoc;
+            return;
+        }
+
+        if (tag == 2) {
+            prevFileId_ = FileId();
+        } else if (tag > 2) {
+            const uint64_t idx = tag - 3;
+            if (idx == files_.size()) {
+                files_.push_back(FileRegistry::insertOrFind(str()));
+            } else if (idx > files_.size()) {
+                ok_ = false;
+                return;
+            }
+            prevFileId_ = files_[idx];
+        }
+
+        prevLine_ += sint();
+        prevCol_ += sint();
+        const int lastLine = static_cast<int>(prevLine_ + sint());
+        const int lastCol = static_cast<int>(prevCol_ + sint());
+        loc = SourceLoc(static_cast<int>(prevLine_), static_cast<int>(prevCol_),
+                        lastLine, lastCol, prevFileId_);
+    }
+
+    template <class AstT, class SetT>
+    void loc(AstT* ast, const SourceLoc&, SetT set)
+    {
+        SourceLoc loc;
+        this->loc(loc);
+        (ast->*set)(loc);
+    }
+
+    /*
+     * Every occurrence is interned again, so the lexeme map knows about the
+     * lexeme at each location, as it would after lexing.
+     */
+    template <class LexemeT>
+    void lexeme(const LexemeT*& lex, const SourceLoc& loc)
+    {
+        lex = nullptr;
+        const uint64_t idx = uint();
+        if (!idx)
+            return;
+        if (idx == spells_.size() + 1) {
+            spells_.push_back(str());
+        } else if (idx > spells_.size()) {
+            ok_ = false;
+            return;
+        }
+        lex = lexs_->insertOrFind<LexemeT>(spells_[idx - 1], loc.fileId_, loc.lineCol());
+    }
+
+private:
+    const char* cur_;
+    const char* end_;
+    LexemeMap* lexs_;
+    bool ok_ { true };
+    std::vector<std::string> spells_;
+    std::vector<FileId> files_;
+    FileId prevFileId_;
+    int64_t prevLine_ { 0 };
+    int64_t prevCol_ { 0 };
+};
+
+    //--- AstSerializer ---//
+
+uint32_t AstSerializer::bits(const Ast* ast)
+{
+    return ast->bits_;
+}
+
+void AstSerializer::setBits(Ast* ast, uint32_t bits)
+{
+    ast->bits_ = bits;
+}
+
+std::string AstSerializer::serialize(const ProgramAst* ast) const
+{
+    UAISO_ASSERT(ast, return std::string());
+
+    Writer writer(nullptr);
+    writer.node(ast);
+    return writer.finish();
+}
+
+bool AstSerializer::serialize(const ProgramAst* ast, std::ostream& os) const
+{
+    UAISO_ASSERT(ast, return false);
+
+    Writer writer(&os);
+    writer.node(ast);
+    writer.finish();
+    return os.good();
+}
+
+std::unique_ptr<ProgramAst> AstSerializer::deserialize(const char* data,
+                                                       size_t len,
+                                                       LexemeMap* lexs) const
+{
+    UAISO_ASSERT(data, return nullptr);
+    UAISO_ASSERT(lexs, return nullptr);
+
+    Reader reader(data, len, lexs);
+    if (!reader.header())
+        return nullptr;
+    std::unique_ptr<ProgramAst> ast;
+    reader.node(ast);
+    if (!reader.ok() || !reader.atEnd())
+        return nullptr;
+    return ast;
+}
+
+std::unique_ptr<ProgramAst> AstSerializer::deserialize(const std::string& data,
+                                                       LexemeMap* lexs) const
+{
+    return deserialize(data.data(), data.size(), lexs);
+}
+
+namespace uaiso {
+
+std::string serialize(const ProgramAst* ast)
+{
+    return AstSerializer().serialize(ast);
+}
+
+std::unique_ptr<ProgramAst> deserialize(const std::string& data, LexemeMap* lexs)
+{
+    return AstSerializer().deserialize(data, lexs);
+}
+
+} // namespace uaiso
@@ -16,202 +16,100 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
  * USA
  *****************************************************************************/
-/*---------------------------------------------------------------*/
-/*---                    The UaiSo! Project                   ---*/
-/*---                                                         ---*/
-/*---         This file was AUTOMATICALLY GENERATED           ---*/
-/*--- It can be AUTOMATICALLY UPDATED if the formatting/style ---*/
-/*--- of the method declarations is preserved (it's fragile). ---*/
-/*---------------------------------------------------------------*/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
 
 #ifndef UAISO_ASTSERIALIZER_H__
 #define UAISO_ASTSERIALIZER_H__
 
-#include "Ast/Ast.h"
-#include "Ast/AstVisitor.h"
+#include "Ast/AstFwd.h"
+#include "Common/Config.h"
+#include "Common/Test.h"
+#include <cstdint>
+#include <memory>
 #include <ostream>
+#include <string>
 
 namespace uaiso {
 
-class UAISO_API AstSerializer final : public AstVisitor<AstSerializer>
+class LexemeMap;
+
+/*!
+ * \brief The AstSerializer class
+ *
+ * A compact binary encoding of a program's AST, so a program can be
+ * restored without being parsed again. Nodes are written in pre-order: a
+ * varint kind followed by the node's bits (variety and alike) and then its
+ * fields, in declaration order. Source locations are delta-encoded against
+ * the previous one, lexemes are referenced by their index in a table that
+ * is built as they are first seen, and lists are written as runs prefixed
+ * by their length. Semantic annotations (symbols, types, environments) are
+ * not part of the encoding.
+ *
+ * Which fields are written is declared once per node class and shared by
+ * both the writer and the reader, while dispatching on the kind of a node
+ * is driven by the AST mixins, like AstVisitor.
+ */
+class UAISO_API AstSerializer final
 {
 public:
-    void serializeProgram(ProgramAst* ast);
-    void serializeProgram(ProgramAst* ast, std::ostream& os);
+    /*!
+     * \brief serialize
+     *
+     * Return the encoding of program \a ast.
+     */
+    std::string serialize(const ProgramAst* ast) const;
+
+    /*!
+     * \brief serialize
+     *
+     * Write the encoding of program \a ast to \a os, in chunks, as the AST
+     * is traversed. Return whether the stream is still good.
+     */
+    bool serialize(const ProgramAst* ast, std::ostream& os) const;
+
+    /*!
+     * \brief deserialize
+     *
+     * Rebuild the program encoded in the \a len bytes of \a data, with its
+     * lexemes interned in \a lexs. If the data can't be read, return null.
+     */
+    std::unique_ptr<ProgramAst> deserialize(const char* data,
+                                            size_t len,
+                                            LexemeMap* lexs) const;
+
+    /*!
+     * \brief deserialize
+     */
+    std::unique_ptr<ProgramAst> deserialize(const std::string& data,
+                                            LexemeMap* lexs) const;
 
 private:
-    friend class AstVisitor<AstSerializer>;
-    using Base = AstVisitor<AstSerializer>;
-
-    template <class AstT>
-    VisitResult traverse(VisitResult (Base::*function)(AstT*), AstT*);
-
-    VisitResult traverseName(NameAst*);
-    VisitResult traverseSpec(SpecAst*);
-    VisitResult traverseAttr(AttrAst*);
-    VisitResult traverseDecl(DeclAst*);
-    VisitResult traverseExpr(ExprAst*);
-    VisitResult traverseStmt(StmtAst*);
-
-    void enterList();
-    void leaveList();
-
-    //--- Names ---//
-
-    VisitResult traverseSimpleName(SimpleNameAst* ast);
-    VisitResult traverseTemplateInstName(TemplateInstNameAst* ast);
-    VisitResult traverseGenName(GenNameAst* ast);
-    VisitResult traverseNestedName(NestedNameAst* ast);
-
-    //--- Specifiers ---//
-
-    VisitResult traverseRecordSpec(RecordSpecAst* ast);
-    VisitResult traverseArraySpec(ArraySpecAst* ast);
-    VisitResult traverseBuiltinSpec(BuiltinSpecAst* ast);
-    VisitResult traverseChanSpec(ChanSpecAst* ast);
-    VisitResult traverseDecoratedSpec(DecoratedSpecAst* ast);
-    VisitResult traverseOpaqueSpec(OpaqueSpecAst* ast);
-    VisitResult traverseFuncSpec(FuncSpecAst* ast);
-    VisitResult traverseInferredSpec(InferredSpecAst* ast);
-    VisitResult traverseNamedSpec(NamedSpecAst* ast);
-    VisitResult traversePtrSpec(PtrSpecAst* ast);
-    VisitResult traverseTypeofSpec(TypeofSpecAst* ast);
-    VisitResult traverseVoidSpec(VoidSpecAst* ast);
-
-    //--- Attributes ---//
-
-    VisitResult traverseAnnotAttr(AnnotAttrAst* ast);
-    VisitResult traverseDeclAttr(DeclAttrAst* ast);
-    VisitResult traverseAutoAttr(AutoAttrAst* ast);
-    VisitResult traverseCodegenAttr(CodegenAttrAst* ast);
-    VisitResult traverseEvalStrategyAttr(EvalStrategyAttrAst* ast);
-    VisitResult traverseLinkageAttr(LinkageAttrAst* ast);
-    VisitResult traverseParamDirAttr(ParamDirAttrAst* ast);
-    VisitResult traverseStorageClassAttr(StorageClassAttrAst* ast);
-    VisitResult traverseTypeQualAttr(TypeQualAttrAst* ast);
-    VisitResult traverseVisibilityAttr(VisibilityAttrAst* ast);
-
-    VisitResult traverseAliasDecl(AliasDeclAst* ast);
-    VisitResult traverseBaseDecl(BaseDeclAst* ast);
-    VisitResult traverseSelectiveDecl(SelectiveDeclAst* ast);
-    VisitResult traverseConstraintDecl(ConstraintDeclAst* ast);
-    VisitResult traverseVersionDecl(VersionDeclAst* ast);
-    VisitResult traverseEnumDecl(EnumDeclAst* ast);
-    VisitResult traverseEnumMemberDecl(EnumMemberDeclAst* ast);
-    VisitResult traverseBlockDecl(BlockDeclAst* ast);
-    VisitResult traverseErrorDecl(ErrorDeclAst* ast);
-    VisitResult traverseFuncDecl(FuncDeclAst* ast);
-    VisitResult traverseForwardDecl(ForwardDeclAst* ast);
-    VisitResult traverseImportModuleDecl(ImportModuleDeclAst* ast);
-    VisitResult traverseInvariantDecl(InvariantDeclAst* ast);
-    VisitResult traverseModuleDecl(ModuleDeclAst* ast);
-    VisitResult traversePackageDecl(PackageDeclAst* ast);
-    VisitResult traverseParamDecl(ParamDeclAst* ast);
-    VisitResult traverseParamGroupDecl(ParamGroupDeclAst* ast);
-    VisitResult traverseParamClauseDecl(ParamClauseDeclAst* ast);
-    VisitResult traverseSectionDecl(SectionDeclAst* ast);
-    VisitResult traverseStaticAssertDecl(StaticAssertDeclAst* ast);
-    VisitResult traverseTemplateDecl(TemplateDeclAst* ast);
-    VisitResult traverseTemplateParamDecl(TemplateParamDeclAst* ast);
-    VisitResult traverseTemplateParamClauseDecl(TemplateParamClauseDeclAst* ast);
-    VisitResult traverseRecordDecl(RecordDeclAst* ast);
-    VisitResult traverseUnitTestDecl(UnitTestDeclAst* ast);
-    VisitResult traverseVarDecl(VarDeclAst* ast);
-    VisitResult traverseVarGroupDecl(VarGroupDeclAst* ast);
-
-    //--- Expressions ---//
-
-    VisitResult traverseAddExpr(AddExprAst* ast);
-    VisitResult traverseAddrOfExpr(AddrOfExprAst* ast);
-    VisitResult traverseRecordLitExpr(RecordLitExprAst* ast);
-    VisitResult traverseRecordInitExpr(RecordInitExprAst* ast);
-    VisitResult traverseArrayInitExpr(ArrayInitExprAst* ast);
-    VisitResult traverseArrayLengthExpr(ArrayLengthExprAst* ast);
-    VisitResult traverseArraySliceExpr(ArraySliceExprAst* ast);
-    VisitResult traverseArrayIndexExpr(ArrayIndexExprAst* ast);
-    VisitResult traverseAssertExpr(AssertExprAst* ast);
-    VisitResult traverseAssignExpr(AssignExprAst* ast);
-    VisitResult traverseBinaryExpr(BinaryExprAst* ast);
-    VisitResult traverseBitAndExpr(BitAndExprAst* ast);
-    VisitResult traverseBitCompExpr(BitCompExprAst* ast);
-    VisitResult traverseBitOrExpr(BitOrExprAst* ast);
-    VisitResult traverseBitXorExpr(BitXorExprAst* ast);
-    VisitResult traverseBoolLitExpr(BoolLitExprAst* ast);
-    VisitResult traverseCallExpr(CallExprAst* ast);
-    VisitResult traverseCastExpr(CastExprAst* ast);
-    VisitResult traverseChanExpr(ChanExprAst* ast);
-    VisitResult traverseCharLitExpr(CharLitExprAst* ast);
-    VisitResult traverseCommaExpr(CommaExprAst* ast);
-    VisitResult traverseConcatExpr(ConcatExprAst* ast);
-    VisitResult traverseCondExpr(CondExprAst* ast);
-    VisitResult traverseDelExpr(DelExprAst* ast);
-    VisitResult traverseDesignateExpr(DesignateExprAst* ast);
-    VisitResult traverseDivExpr(DivExprAst* ast);
-    VisitResult traverseEqExpr(EqExprAst* ast);
-    VisitResult traverseFuncLitExpr(FuncLitExprAst* ast);
-    VisitResult traverseIdentExpr(IdentExprAst* ast);
-    VisitResult traverseInExpr(InExprAst* ast);
-    VisitResult traverseIncDecExpr(IncDecExprAst* ast);
-    VisitResult traverseTypeQueryExpr(TypeQueryExprAst* ast);
-    VisitResult traverseIsExpr(IsExprAst* ast);
-    VisitResult traverseLogicAndExpr(LogicAndExprAst* ast);
-    VisitResult traverseLogicNotExpr(LogicNotExprAst* ast);
-    VisitResult traverseLogicOrExpr(LogicOrExprAst* ast);
-    VisitResult traverseMakeExpr(MakeExprAst* ast);
-    VisitResult traverseMemberAccessExpr(MemberAccessExprAst* ast);
-    VisitResult traverseMinusExpr(MinusExprAst* ast);
-    VisitResult traverseModExpr(ModExprAst* ast);
-    VisitResult traverseMulExpr(MulExprAst* ast);
-    VisitResult traverseNestedNewExpr(NestedNewExprAst* ast);
-    VisitResult traverseNewExpr(NewExprAst* ast);
-    VisitResult traverseNumLitExpr(NumLitExprAst* ast);
-    VisitResult traversePlusExpr(PlusExprAst* ast);
-    VisitResult traversePrimaryExpr(PrimaryExprAst* ast);
-    VisitResult traversePowerExpr(PowerExprAst* ast);
-    VisitResult traversePtrDerefExpr(PtrDerefExprAst* ast);
-    VisitResult traverseNullLitExpr(NullLitExprAst* ast);
-    VisitResult traverseRelExpr(RelExprAst* ast);
-    VisitResult traverseShiftExpr(ShiftExprAst* ast);
-    VisitResult traverseStrLitExpr(StrLitExprAst* ast);
-    VisitResult traverseSubExpr(SubExprAst* ast);
-    VisitResult traverseSuperExpr(SuperExprAst* ast);
-    VisitResult traverseThisExpr(ThisExprAst* ast);
-    VisitResult traverseTypeAssertExpr(TypeAssertExprAst* ast);
-    VisitResult traverseTypeidExpr(TypeidExprAst* ast);
-    VisitResult traverseUnaryExpr(UnaryExprAst* ast);
-    VisitResult traverseMixinExpr(MixinExprAst* ast);
-    VisitResult traverseVoidInitExpr(VoidInitExprAst* ast);
-    VisitResult traverseWrappedExpr(WrappedExprAst* ast);
-
-    //--- Statements ---//
-
-    VisitResult traverseBlockStmt(BlockStmtAst* ast);
-    VisitResult traverseBodyStmt(BodyStmtAst* ast);
-    VisitResult traverseContractStmt(ContractStmtAst* ast);
-    VisitResult traverseDeclStmt(DeclStmtAst* ast);
-    VisitResult traverseExprStmt(ExprStmtAst* ast);
-    VisitResult traverseInStmt(InStmtAst* ast);
-    VisitResult traverseOutStmt(OutStmtAst* ast);
-    VisitResult traverseEmptyStmt(EmptyStmtAst* ast);
+    DECL_CLASS_TEST(AstSerializer)
+
+    class Writer;
+    class Reader;
+
+    static uint32_t bits(const Ast* ast);
+    static void setBits(Ast* ast, uint32_t bits);
 };
 
 /*!
  * \brief serialize
- * \param ast
- * \return
  *
- * Serialize a ProgramAst.
+ * Convenience for AstSerializer::serialize.
  */
-std::string serialize(ProgramAst* ast);
+UAISO_API std::string serialize(const ProgramAst* ast);
 
 /*!
  * \brief deserialize
- * \param s
- * \return
  *
- * Deserialize a ProgramAst.
+ * Convenience for AstSerializer::deserialize.
  */
-std::unique_ptr<ProgramAst> deserialize(const std::string& s);
+UAISO_API std::unique_ptr<ProgramAst> deserialize(const std::string& data,
+                                                  LexemeMap* lexs);
 
 } // namespace uaiso
 
@@ -0,0 +1,219 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#include "Ast/AstSerializer.h"
+#include "Ast/Ast.h"
+#include "Ast/AstDumper.h"
+#include "Parsing/Factory.h"
+#include "Parsing/Lexeme.h"
+#include "Parsing/LexemeMap.h"
+#include "Parsing/TokenMap.h"
+#include "Parsing/Unit.h"
+#include <sstream>
+
+using namespace uaiso;
+
+class AstSerializer::AstSerializerTest final : public Test
+{
+public:
+    TEST_RUN(AstSerializerTest
+             , &AstSerializerTest::testCase1
+             , &AstSerializerTest::testCase2
+             , &AstSerializerTest::testCase3
+             , &AstSerializerTest::testCase4
+             )
+
+    const std::string fileName_ = "/serial.py";
+
+    const std::string source_ =
+        "import os.path as p\n"
+        "from pkg import a, b as c\n"
+        "\n"
+        "@decor\n"
+        "class C(Base):\n"
+        "    \"\"\"Doc.\"\"\"\n"
+        "    def m(self, x, y=1, *args, **kw):\n"
+        "        return [i * 2.5 for i in x if i > y]\n"
+        "\n"
+        "def f(p, q='q'):\n"
+        "    try:\n"
+        "        while p:\n"
+        "            p, q = q[1:], lambda z: z\n"
+        "    except Exception as e:\n"
+        "        raise\n"
+        "    finally:\n"
+        "        del q\n"
+        "    return {'k': p, 'v': (q, not p)}\n"
+        "\n"
+        "v = C().m(0x10, y=-1) if f else None\n";
+
+    static std::string dump(ProgramAst* ast)
+    {
+        std::ostringstream oss;
+        AstDumper().dumpProgram(ast, oss);
+        return oss.str();
+    }
+
+    void testCase1()
+    {
+        auto factory = FactoryCreator::create(LangId::Py);
+        std::unique_ptr<Unit> unit = factory->makeUnit();
+        unit->setFileName(fileName_);
+        unit->assignInput(source_);
+        TokenMap tokens;
+        LexemeMap lexs;
+        unit->parse(&tokens, &lexs);
+        UAISO_EXPECT_TRUE(unit->ast());
+        ProgramAst* progAst = Program_Cast(unit->ast());
+
+        const std::string data = AstSerializer().serialize(progAst);
+        LexemeMap otherLexs;
+        std::unique_ptr<ProgramAst> restored =
+                AstSerializer().deserialize(data, &otherLexs);
+        UAISO_EXPECT_TRUE(restored);
+        UAISO_EXPECT_STR_EQ(dump(progAst), dump(restored.get()));
+
+        // Locations and lexemes survive as well, so a second round
+        // produces the very same bytes.
+        UAISO_EXPECT_STR_EQ(data, AstSerializer().serialize(restored.get()));
+
+        // Lexemes are interned into the given map at their locations.
+        const FileId fileId = FileRegistry::insertOrFind(fileName_);
+        const Ident* ident = otherLexs.findAt<Ident>(fileId, LineCol(9, 4));
+        UAISO_EXPECT_TRUE(ident);
+        UAISO_EXPECT_STR_EQ("f", ident->str());
+        const StrLit* lit = otherLexs.findAt<StrLit>(fileId, LineCol(9, 11));
+        UAISO_EXPECT_TRUE(lit);
+        UAISO_EXPECT_STR_EQ(lexs.findAt<StrLit>(fileId, LineCol(9, 11))->spelling(),
+                            lit->spelling());
+    }
+
+    void testCase2()
+    {
+        // Nodes whose class isn't told by the kind alone.
+        std::unique_ptr<ProgramAst> progAst(new ProgramAst);
+
+        auto var = newAst<VarDeclAst__<VarInit__>>();
+        var->setName(newAst<SimpleNameAst>()->setNameLoc(loc(1, 4)));
+        var->setAssignLoc(loc(1, 6));
+        var->setInit(newAst<NumLitExprAst>()->setLitLoc(loc(1, 8))
+                     ->setVariety(NumLitVariety::FloatFormat));
+        progAst->addDecl(var);
+
+        auto param = newAst<ParamDeclAst__<ParamVariadic__, ParamDefaultArg__>>();
+        param->setVariadicLoc(loc(2, 10));
+        param->setAssignLoc(loc(2, 12));
+        param->setDefaultArg(newAst<NullLitExprAst>()->setLitLoc(loc(2, 14)));
+        auto tmplParam = newAst<TemplateParamDeclAst__<TemplateParamDefaultArg__,
+                                                       TemplateParamSpecialization__>>();
+        tmplParam->setAssignLoc(loc(2, 3));
+        tmplParam->setDefaultArg(newAst<VoidSpecAst>()->setKeyLoc(loc(2, 5)));
+        tmplParam->setBindLoc(loc(2, 6));
+        tmplParam->setSpecialization(newAst<InferredSpecAst>()->setKeyLoc(loc(2, 7)));
+        auto spec = newAst<FuncSpecAst__<FuncTemplateParam__>>();
+        spec->setLDelimLoc(loc(2, 1));
+        spec->setTemplateParam(newAst<TemplateParamClauseDeclAst>()->addDecl(tmplParam));
+        spec->setParam(newAst<ParamClauseDeclAst>()->addDecl(param));
+        auto func = newAst<FuncRecvDeclAst>();
+        func->setRecv(newAst<ParamClauseDeclAst>()->setLDelimLoc(loc(2, 0)));
+        func->setSpec(spec);
+        progAst->addDecl(func);
+
+        auto tag = newAst<VarTagDeclAst>();
+        tag->setTag(newAst<StrLitExprAst>()->setLitLoc(loc(3, 2)));
+        tag->addDecl(newAst<VarDeclAst>());
+        tag->setAllocScheme(AllocScheme::Dynamic);
+        progAst->addDecl(tag);
+        progAst->addDecl(newAst<TemplateParamAliasDeclAst>()->setAliasLoc(loc(4, 0)));
+
+        const std::string data = AstSerializer().serialize(progAst.get());
+        LexemeMap lexs;
+        std::unique_ptr<ProgramAst> restored = AstSerializer().deserialize(data, &lexs);
+        UAISO_EXPECT_TRUE(restored);
+        UAISO_EXPECT_STR_EQ(data, AstSerializer().serialize(restored.get()));
+
+        auto decl = restored->decls_->begin();
+        auto var2 = VarDecl_Cast(*decl);
+        UAISO_EXPECT_TRUE(var2->hasInit());
+        UAISO_EXPECT_TRUE(var2->assignLoc() == loc(1, 6));
+        UAISO_EXPECT_TRUE(NumLitExpr_Cast(var2->init())->variety() == NumLitVariety::FloatFormat);
+
+        auto func2 = FuncDecl_Cast(*(++decl));
+        UAISO_EXPECT_TRUE(static_cast<FuncRecvDeclAst*>(func2)->recv_);
+        auto spec2 = FuncSpec_Cast(func2->spec_.get());
+        UAISO_EXPECT_TRUE(spec2->isTemplate());
+        auto tmplParam2 = TemplateParamDecl_Cast(
+                    *TemplateParamClauseDecl_Cast(spec2->templateParam())->decls_->begin());
+        UAISO_EXPECT_TRUE(tmplParam2->hasDefaultArg());
+        UAISO_EXPECT_TRUE(tmplParam2->hasSpecialization());
+        UAISO_EXPECT_TRUE(tmplParam2->bindLoc() == loc(2, 6));
+        auto param2 = ParamDecl_Cast(*ParamClauseDecl_Cast(spec2->param_.get())->decls_->begin());
+        UAISO_EXPECT_TRUE(param2->isVariadic());
+        UAISO_EXPECT_TRUE(param2->variadicLoc() == loc(2, 10));
+        UAISO_EXPECT_TRUE(param2->hasDefaultArg());
+
+        auto tag2 = VarGroupDecl_Cast(*(++decl));
+        UAISO_EXPECT_TRUE(tag2->allocScheme() == AllocScheme::Dynamic);
+        UAISO_EXPECT_TRUE(static_cast<VarTagDeclAst*>(tag2)->tag_);
+        auto alias2 = TemplateParamDecl_Cast(*(++decl));
+        UAISO_EXPECT_TRUE(static_cast<TemplateParamAliasDeclAst*>(alias2)->aliasLoc_ == loc(4, 0));
+    }
+
+    void testCase3()
+    {
+        std::unique_ptr<ProgramAst> progAst(new ProgramAst);
+        progAst->addStmt(newAst<ExprStmtAst>()->addExpr(
+                             newAst<IdentExprAst>()->setName(
+                                 newAst<SimpleNameAst>()->setNameLoc(loc(0, 0)))));
+        const std::string data = AstSerializer().serialize(progAst.get());
+
+        LexemeMap lexs;
+        UAISO_EXPECT_TRUE(AstSerializer().deserialize(data, &lexs));
+        for (size_t len = 0; len < data.size(); ++len)
+            UAISO_EXPECT_FALSE(AstSerializer().deserialize(data.data(), len, &lexs));
+        std::string corrupt = data;
+        corrupt[0] = '?';
+        UAISO_EXPECT_FALSE(AstSerializer().deserialize(corrupt, &lexs));
+        UAISO_EXPECT_FALSE(AstSerializer().deserialize(data + '\0', &lexs));
+    }
+
+    void testCase4()
+    {
+        // Streaming gives the same bytes.
+        std::unique_ptr<ProgramAst> progAst(new ProgramAst);
+        for (int i = 0; i < 10000; ++i) {
+            progAst->addStmt(newAst<ExprStmtAst>()->addExpr(
+                                 newAst<NumLitExprAst>()->setLitLoc(loc(i, 0))));
+        }
+        std::ostringstream oss;
+        UAISO_EXPECT_TRUE(AstSerializer().serialize(progAst.get(), oss));
+        UAISO_EXPECT_STR_EQ(AstSerializer().serialize(progAst.get()), oss.str());
+    }
+
+    SourceLoc loc(int line, int col)
+    {
+        return SourceLoc(line, col, line, col + 1, fileName_);
+    }
+};
+
+MAKE_CLASS_TEST(AstSerializer)
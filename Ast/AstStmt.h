@@ -88,7 +88,9 @@ public:
 
     BlockStmtAst()
         : StmtAst(Kind::BlockStmt)
-    {}
+    {
+        RELEASE_WITH_POOL(env);
+    }
 
     NAMED_LOC_PARAM(LDelim, lDelim)
     NAMED_AST_LIST_PARAM(Stmt, stmts, StmtAst)
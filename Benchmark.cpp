@@ -0,0 +1,1717 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#include "Ast/Ast.h"
+#include "Ast/AstMisc.h"
+#include "Ast/AstPool.h"
+#include "Ast/AstSerializer.h"
+#include "Ast/AstVisitor.h"
+#include "Common/Assert.h"
+#include "Haskell/HsKeywords.h"
+#include "Parsing/Factory.h"
+#include "Parsing/Lexeme.h"
+#include "Parsing/LexemeMap.h"
+#include "Parsing/Lexer.h"
+#include "Parsing/Parser.h"
+#include "Parsing/ParsingContext.h"
+#include "Parsing/SourceBuffer.h"
+#include "Parsing/TokenMap.h"
+#include "Parsing/Unit.h"
+#include "Python/PyKeywords.h"
+#include "Semantic/Binder.h"
+#include "Semantic/CompletionProposer.h"
+#include "Semantic/CompletionRanker.h"
+#include "Semantic/Environment.h"
+#include "Semantic/Import.h"
+#include "Semantic/ImportResolver.h"
+#include "Semantic/Manager.h"
+#include "Semantic/Program.h"
+#include "Semantic/ProgramCache.h"
+#include "Semantic/Snapshot.h"
+#include "Semantic/Symbol.h"
+#include "Semantic/TypeChecker.h"
+#include "Semantic/TypeInterner.h"
+#include "Semantic/TypeResolutionCache.h"
+#include "Semantic/TypeResolver.h"
+#include "StringUtils/predicate.hpp"
+#include "Tinydir/Tinydir.h"
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+using namespace uaiso;
+
+/*!
+ * Benchmarks for the engine. Run from the project's root directory (the
+ * corpus is taken from TestData). With no arguments, all benchmarks are run,
+ * otherwise only the ones named in the command line.
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+std::vector<std::string> listFiles(const std::string& dirPath,
+                                   const std::string& suffix)
+{
+    std::vector<std::string> files;
+    tinydir_dir dir;
+    if (tinydir_open_sorted(&dir, dirPath.c_str()) == -1)
+        return files;
+    for (size_t i = 0; i < dir.n_files; ++i) {
+        tinydir_file file;
+        tinydir_readfile_n(&dir, &file, i);
+        if (!file.is_dir && str::ends_with(file.name, suffix))
+            files.push_back(file.path);
+    }
+    tinydir_close(&dir);
+    return files;
+}
+
+std::string readFile(const std::string& fileName)
+{
+    std::ifstream ifs(fileName);
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    return ss.str();
+}
+
+/*!
+ * Bytes currently allocated from the free store (including mmap'ed blocks),
+ * if we know how to get it.
+ */
+size_t heapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    auto info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+struct Corpus
+{
+    LangId langId_;
+    std::vector<std::string> files_;
+};
+
+std::vector<Corpus> corpora()
+{
+    std::vector<Corpus> all;
+    all.push_back({ LangId::Py, listFiles("TestData/Python", ".py") });
+    Corpus go { LangId::Go, {} };
+    for (auto dir : { "TestData/Go/Stdlib/fmt", "TestData/Go/Stdlib/math",
+                      "TestData/Go/Stdlib/math/big", "TestData/Go/Stdlib/math/cmplx" }) {
+        auto files = listFiles(dir, ".go");
+        go.files_.insert(go.files_.end(), files.begin(), files.end());
+    }
+    all.push_back(go);
+    all.push_back({ LangId::D, listFiles("TestData/D", ".d") });
+    return all;
+}
+
+const int kRounds = 10;
+
+/*!
+ * Print figures of a single round: \a nodes allocated in \a secs, taking
+ * \a bytes of memory.
+ */
+void printRow(const std::string& label, size_t nodes, double secs, size_t bytes)
+{
+    std::cout << "  " << std::left << std::setw(24) << label << std::right
+              << std::setw(12) << std::fixed << std::setprecision(0)
+              << (secs > 0 ? nodes / secs : 0) << " nodes/s"
+              << std::setw(10) << std::setprecision(1)
+              << (nodes ? double(bytes) / nodes : 0) << " bytes/node"
+              << std::endl;
+}
+
+} // anonymous
+
+/*!
+ * AST allocation: parse (and then destroy) the corpus with nodes coming from
+ * the free store and from an AstPool. Hand-written parsers are driven
+ * directly, so the very same code path is measured both ways; Bison-based
+ * ones only run through their Unit (always pooled).
+ */
+void benchAstPool()
+{
+    std::cout << "[uaiso] Benchmark: AST allocation" << std::endl;
+
+    for (const auto& corpus : corpora()) {
+        std::unique_ptr<Factory> factory = FactoryCreator::create(corpus.langId_);
+        std::vector<std::string> sources;
+        for (const auto& fileName : corpus.files_)
+            sources.push_back(readFile(fileName));
+
+        // Through the unit, which owns the pool.
+        size_t nodes = 0, bytes = 0;
+        double secs = 0;
+        for (int round = 0; round < kRounds; ++round) {
+            for (size_t i = 0; i < sources.size(); ++i) {
+                auto start = Clock::now();
+                std::unique_ptr<Unit> unit = factory->makeUnit();
+                unit->setFileName(corpus.files_[i]);
+                unit->assignInput(sources[i]);
+                size_t heap = heapInUse();
+                unit->parse(nullptr, nullptr);
+                if (round == 0) {
+                    nodes += unit->astPool()->nodeCount();
+                    bytes += heapInUse() - heap;
+                }
+                unit.reset();
+                secs += secondsSince(start);
+            }
+        }
+        std::cout << langName(corpus.langId_) << " (" << corpus.files_.size()
+                  << " files)" << std::endl;
+        if (!nodes)
+            continue;
+        printRow("unit (pool)", nodes, secs / kRounds, bytes);
+
+        if (!factory->makeParser())
+            continue;
+
+        for (bool pooled : { false, true }) {
+            size_t bytes = 0;
+            double secs = 0;
+            for (int round = 0; round < kRounds; ++round) {
+                for (size_t i = 0; i < sources.size(); ++i) {
+                    auto start = Clock::now();
+                    AstPool pool;
+                    std::unique_ptr<AstPool::Scope> scope;
+                    if (pooled)
+                        scope.reset(new AstPool::Scope(&pool));
+                    std::unique_ptr<Lexer> lexer = factory->makeLexer();
+                    std::unique_ptr<Parser> parser = factory->makeParser();
+                    ParsingContext context;
+                    context.setFileName(corpus.files_[i].c_str());
+                    lexer->setContext(&context);
+                    lexer->setBuffer(sources[i].c_str(), sources[i].size());
+                    size_t heap = heapInUse();
+                    parser->parse(lexer.get(), &context);
+                    if (round == 0)
+                        bytes += heapInUse() - heap;
+                    delete context.releaseAst();
+                    scope.reset();
+                    secs += secondsSince(start);
+                }
+            }
+            printRow(pooled ? "parser (pool)" : "parser (free store)",
+                     nodes, secs / kRounds, bytes);
+        }
+    }
+}
+
+/*!
+ * Lexeme interning: the words of the whole corpus are interned into a
+ * shared LexemeMap by a varying number of threads, each one as if it were
+ * parsing a file of its own.
+ */
+void benchInterner()
+{
+    std::cout << "[uaiso] Benchmark: lexeme interning" << std::endl;
+
+    std::vector<std::string> words;
+    for (const auto& corpus : corpora()) {
+        for (const auto& fileName : corpus.files_) {
+            std::string source = readFile(fileName);
+            std::string word;
+            for (char ch : source) {
+                if (std::isalnum(static_cast<unsigned char>(ch)) || ch == '_') {
+                    word += ch;
+                } else if (!word.empty()) {
+                    words.push_back(word);
+                    word.clear();
+                }
+            }
+        }
+    }
+    std::cout << "  " << words.size() << " words" << std::endl;
+
+    for (int threadCnt : { 1, 2, 4, 8 }) {
+        double secs = 0;
+        for (int round = 0; round < kRounds; ++round) {
+            LexemeMap lexs;
+            std::vector<std::thread> threads;
+            auto start = Clock::now();
+            for (int t = 0; t < threadCnt; ++t) {
+                threads.emplace_back([&lexs, &words, t] () {
+                    auto fileId = FileRegistry::insertOrFind(
+                                "<bench_interner_" + std::to_string(t) + ">");
+                    for (size_t i = 0; i < words.size(); ++i) {
+                        lexs.insertOrFind<Ident>(words[i].c_str(), words[i].size(),
+                                                 fileId, LineCol(i, 0));
+                    }
+                });
+            }
+            for (auto& thread : threads)
+                thread.join();
+            secs += secondsSince(start);
+        }
+        secs /= kRounds;
+        std::cout << "  " << std::left << std::setw(24)
+                  << (std::to_string(threadCnt) + " thread(s)") << std::right
+                  << std::setw(12) << std::fixed << std::setprecision(0)
+                  << (secs > 0 ? words.size() * threadCnt / secs : 0)
+                  << " lexemes/s" << std::endl;
+    }
+}
+
+namespace {
+
+// The hash LineColIndex had, when it was an unordered_map.
+struct XorLineColHash
+{
+    size_t operator()(const LineCol& lineCol) const
+    {
+        return std::hash<int>()(lineCol.line_) ^ std::hash<int>()(lineCol.col_);
+    }
+};
+
+void benchPositions(const std::string& label,
+                    const std::vector<std::vector<LineCol>>& files)
+{
+    size_t total = 0;
+    for (const auto& lineCols : files)
+        total += lineCols.size();
+    std::cout << label << " (" << files.size() << " files, "
+              << total << " positions)" << std::endl;
+    if (!total)
+        return;
+
+    // Lookups in source order (as the binder does) and shuffled.
+    std::vector<std::pair<size_t, LineCol>> inOrder;
+    for (size_t i = 0; i < files.size(); ++i) {
+        for (const auto& lineCol : files[i])
+            inOrder.emplace_back(i, lineCol);
+    }
+    auto shuffled = inOrder;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(42));
+
+    auto print = [total] (const char* what, size_t bytes,
+                          double inOrderSecs, double shuffledSecs) {
+        std::cout << "  " << std::left << std::setw(24) << what << std::right
+                  << std::setw(10) << std::fixed << std::setprecision(1)
+                  << double(bytes) / total << " bytes/pos"
+                  << std::setw(10) << std::setprecision(1)
+                  << inOrderSecs * 1e9 / total << " ns/lookup (in order)"
+                  << std::setw(10) << std::setprecision(1)
+                  << shuffledSecs * 1e9 / total << " ns/lookup (shuffled)"
+                  << std::endl;
+    };
+
+    // Before: a hash map per file.
+    {
+        using Index = std::unordered_map<LineCol, int, XorLineColHash>;
+        size_t heap = heapInUse();
+        std::vector<Index> indexes(files.size());
+        for (size_t i = 0; i < files.size(); ++i) {
+            for (const auto& lineCol : files[i])
+                indexes[i].emplace(lineCol, TK_IDENT);
+        }
+        size_t bytes = heapInUse() - heap;
+        double secs[2];
+        for (int i = 0; i < 2; ++i) {
+            const auto& queries = i ? shuffled : inOrder;
+            size_t found = 0;
+            auto start = Clock::now();
+            for (int round = 0; round < kRounds; ++round) {
+                for (const auto& query : queries)
+                    found += indexes[query.first].count(query.second);
+            }
+            secs[i] = secondsSince(start) / kRounds;
+            UAISO_ASSERT(found == total * kRounds, {});
+        }
+        print("hash map (xor hash)", bytes, secs[0], secs[1]);
+    }
+
+    // After: the sorted arrays of TokenMap.
+    {
+        std::vector<FileId> fileIds;
+        for (size_t i = 0; i < files.size(); ++i) {
+            fileIds.push_back(FileRegistry::insertOrFind(
+                                  "<bench_positions_" + std::to_string(i) + ">"));
+        }
+        size_t heap = heapInUse();
+        TokenMap tokens;
+        for (size_t i = 0; i < files.size(); ++i) {
+            for (const auto& lineCol : files[i])
+                tokens.insertOrFind(TK_IDENT, fileIds[i], lineCol);
+        }
+        size_t bytes = heapInUse() - heap;
+        double secs[2];
+        for (int i = 0; i < 2; ++i) {
+            const auto& queries = i ? shuffled : inOrder;
+            size_t found = 0;
+            auto start = Clock::now();
+            for (int round = 0; round < kRounds; ++round) {
+                for (const auto& query : queries)
+                    found += tokens.findAt(fileIds[query.first], query.second) == TK_IDENT;
+            }
+            secs[i] = secondsSince(start) / kRounds;
+            UAISO_ASSERT(found == total * kRounds, {});
+        }
+        print("sorted arrays", bytes, secs[0], secs[1]);
+    }
+}
+
+} // anonymous
+
+/*!
+ * Position indexes: memory and lookup latency of the per-file line/col
+ * indexes, with the positions of the lexemes of the corpus and with those of
+ * a synthetic file of 100k tokens.
+ */
+void benchPosIndex()
+{
+    std::cout << "[uaiso] Benchmark: position indexes" << std::endl;
+
+    for (const auto& corpus : corpora()) {
+        std::unique_ptr<Factory> factory = FactoryCreator::create(corpus.langId_);
+        std::vector<std::vector<LineCol>> files;
+        for (const auto& fileName : corpus.files_) {
+            std::string source = readFile(fileName);
+            LexemeMap lexs;
+            std::unique_ptr<Unit> unit = factory->makeUnit();
+            unit->setFileName(fileName);
+            unit->assignInput(source);
+            unit->parse(nullptr, &lexs);
+            std::vector<LineCol> lineCols;
+            for (auto info : lexs.list<Ident>(unit->fileId()))
+                lineCols.push_back(std::get<1>(info));
+            for (auto info : lexs.list<StrLit>(unit->fileId()))
+                lineCols.push_back(std::get<1>(info));
+            for (auto info : lexs.list<NumLit>(unit->fileId()))
+                lineCols.push_back(std::get<1>(info));
+            std::sort(lineCols.begin(), lineCols.end());
+            files.push_back(lineCols);
+        }
+        benchPositions(langName(corpus.langId_), files);
+    }
+
+    // Lines of 10 tokens, 4 columns apart.
+    std::vector<LineCol> lineCols;
+    for (int i = 0; i < 100000; ++i)
+        lineCols.emplace_back(i / 10 + 1, (i % 10) * 4);
+    benchPositions("Synthetic", { lineCols });
+}
+
+namespace {
+
+class NameGatherer final : public AstVisitor<NameGatherer>
+{
+public:
+    std::vector<const SimpleNameAst*> names_;
+
+private:
+    friend class AstVisitor<NameGatherer>;
+
+    VisitResult visitSimpleName(SimpleNameAst* ast)
+    {
+        names_.push_back(ast);
+        return Continue;
+    }
+};
+
+std::string fullPath(const std::string& fileName)
+{
+    char* path = realpath(fileName.c_str(), nullptr);
+    if (!path)
+        return fileName;
+    std::string full(path);
+    free(path);
+    return full;
+}
+
+} // anonymous
+
+/*!
+ * Binding: time taken by the Binder on each file of the corpus (builtins
+ * and automatic modules aside), and the cost of getting to the identifier of
+ * a simple name through the lexeme map's position index, as opposed to
+ * reading it off the AST.
+ */
+void benchBinding()
+{
+    std::cout << "[uaiso] Benchmark: binding" << std::endl;
+
+    for (const auto& corpus : corpora()) {
+        std::unique_ptr<Factory> factory = FactoryCreator::create(corpus.langId_);
+        std::unique_ptr<const Lang> lang = factory->makeLang();
+        std::vector<std::pair<std::string, std::string>> sources;
+        for (const auto& fileName : corpus.files_)
+            sources.emplace_back(fullPath(fileName), readFile(fileName));
+
+        double bindSecs = 0;
+        size_t bound = 0;
+        double indexSecs = 0, directSecs = 0;
+        size_t names = 0, found = 0;
+        for (int round = 0; round < kRounds; ++round) {
+            TokenMap tokens;
+            LexemeMap lexs;
+            for (const auto& source : sources) {
+                std::unique_ptr<Unit> unit = factory->makeUnit();
+                unit->setFileName(source.first);
+                unit->assignInput(source.second);
+                unit->parse(&tokens, &lexs);
+                if (!unit->ast() || unit->ast()->kind() != Ast::Kind::Program)
+                    continue;
+                auto progAst = Program_Cast(unit->ast());
+
+                NameGatherer gatherer;
+                traverseProgram(progAst, &gatherer, lang.get());
+                names += gatherer.names_.size();
+
+                auto start = Clock::now();
+                for (auto name : gatherer.names_) {
+                    found += lexs.findAt<Ident>(name->nameLoc_.fileId_,
+                                                name->nameLoc_.lineCol()) != nullptr;
+                }
+                indexSecs += secondsSince(start);
+
+                start = Clock::now();
+                for (auto name : gatherer.names_)
+                    found += name->ident() != nullptr;
+                directSecs += secondsSince(start);
+
+                Binder binder(factory.get());
+                binder.setLexemes(&lexs);
+                binder.setTokens(&tokens);
+                binder.ignoreBuiltins();
+                binder.ignoreAutomaticModules();
+                start = Clock::now();
+                std::unique_ptr<Program> prog = binder.bind(progAst, source.first);
+                bindSecs += secondsSince(start);
+                bound += prog != nullptr;
+            }
+        }
+
+        std::cout << "  " << std::left << std::setw(24) << langName(corpus.langId_)
+                  << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << (bound ? bindSecs * 1e6 / bound : 0) << " us/file"
+                  << std::setw(8) << (names ? indexSecs * 1e9 / names : 0) << " ns/name (index)"
+                  << std::setw(8) << (names ? directSecs * 1e9 / names : 0) << " ns/name (ast)"
+                  << "  [" << found << " hits]" << std::endl;
+    }
+}
+
+/*!
+ * Source input: load the corpus through stdio into a string (as units used
+ * to do with a FILE*) and into a SourceBuffer.
+ */
+void benchInput()
+{
+    std::cout << "[uaiso] Benchmark: source input" << std::endl;
+
+    for (const auto& corpus : corpora()) {
+        size_t bytes = 0;
+        double stdioSecs = 0, bufferSecs = 0;
+        for (int round = 0; round < kRounds * 10; ++round) {
+            for (const auto& fileName : corpus.files_) {
+                auto start = Clock::now();
+                FILE* file = fopen(fileName.c_str(), "r");
+                fseek(file, 0, SEEK_END);
+                std::string source;
+                source.resize(ftell(file));
+                rewind(file);
+                source.resize(fread(&source[0], 1, source.size(), file));
+                fclose(file);
+                stdioSecs += secondsSince(start);
+
+                start = Clock::now();
+                auto buffer = SourceBuffer::load(fileName);
+                bufferSecs += secondsSince(start);
+                UAISO_ASSERT(buffer->size() == source.size(), return);
+                bytes += buffer->size();
+            }
+        }
+
+        for (const auto& row : { std::make_pair("stdio", stdioSecs),
+                                 std::make_pair("SourceBuffer", bufferSecs) }) {
+            std::cout << "  " << std::left << std::setw(12) << langName(corpus.langId_)
+                      << std::setw(14) << row.first << std::right
+                      << std::setw(10) << std::fixed << std::setprecision(1)
+                      << (row.second > 0 ? bytes / row.second / 1e6 : 0) << " MB/s"
+                      << std::endl;
+        }
+    }
+}
+
+/*!
+ * Lexing throughput: tokenize the corpus with the hand-written lexers (the
+ * ones available through a factory), without any lexeme tracking.
+ */
+void benchLexer()
+{
+    std::cout << "[uaiso] Benchmark: lexing" << std::endl;
+
+    for (const auto& corpus : corpora()) {
+        std::unique_ptr<Factory> factory = FactoryCreator::create(corpus.langId_);
+        if (!factory->makeLexer())
+            continue;
+
+        std::vector<std::string> sources;
+        for (const auto& fileName : corpus.files_)
+            sources.push_back(readFile(fileName));
+
+        size_t bytes = 0, tokens = 0;
+        double secs = 0;
+        for (int round = 0; round < kRounds * 10; ++round) {
+            for (size_t i = 0; i < sources.size(); ++i) {
+                std::unique_ptr<Lexer> lexer = factory->makeLexer();
+                ParsingContext context;
+                context.setFileName(corpus.files_[i].c_str());
+                lexer->setContext(&context);
+                lexer->setBuffer(sources[i].c_str(), sources[i].size());
+                auto start = Clock::now();
+                while (lexer->lex() != TK_EOP)
+                    ++tokens;
+                secs += secondsSince(start);
+                bytes += sources[i].size();
+            }
+        }
+
+        std::cout << "  " << std::left << std::setw(12) << langName(corpus.langId_)
+                  << std::right << std::setw(10) << std::fixed << std::setprecision(1)
+                  << (secs > 0 ? bytes / secs / 1e6 : 0) << " MB/s"
+                  << std::setw(12) << std::setprecision(0)
+                  << (secs > 0 ? tokens / secs : 0) << " tokens/s" << std::endl;
+    }
+}
+
+/*!
+ * Keyword filtering: look up every identifier-like word of the Python corpus
+ * as a keyword. There's no Haskell corpus, so Haskell's filter runs over the
+ * very same words (a realistic mix for it too: mostly non-keywords).
+ */
+void benchKeywords()
+{
+    std::cout << "[uaiso] Benchmark: keyword filtering" << std::endl;
+
+    std::vector<std::string> words;
+    for (const auto& fileName : listFiles("TestData/Python", ".py")) {
+        std::string source = readFile(fileName);
+        std::string word;
+        for (char ch : source) {
+            if (std::isalnum(static_cast<unsigned char>(ch)) || ch == '_') {
+                word += ch;
+            } else if (!word.empty()) {
+                if (!std::isdigit(static_cast<unsigned char>(word[0])))
+                    words.push_back(word);
+                word.clear();
+            }
+        }
+    }
+    std::cout << "  " << words.size() << " words" << std::endl;
+
+    using Filter = Token (*)(const char*, size_t);
+    for (const auto& filter : { std::make_pair("Python", Filter(&PyKeywords::filter)),
+                                std::make_pair("Haskell", Filter(&HsKeywords::filter)) }) {
+        size_t hits = 0;
+        auto start = Clock::now();
+        for (int round = 0; round < kRounds * 10; ++round) {
+            for (const auto& word : words)
+                hits += filter.second(word.c_str(), word.size()) != TK_INVALID;
+        }
+        double secs = secondsSince(start);
+        std::cout << "  " << std::left << std::setw(12) << filter.first
+                  << std::right << std::setw(10) << std::fixed << std::setprecision(2)
+                  << (!words.empty() ? secs * 1e9 / (words.size() * kRounds * 10) : 0) << " ns/word"
+                  << "  [" << hits / (kRounds * 10) << " keywords]" << std::endl;
+    }
+}
+
+/*!
+ * Dependency processing: a synthetic Python project of 2000 modules, each
+ * importing four others (so the import graph is a tree with a few levels),
+ * processed from its root by a Manager with increasing worker counts.
+ */
+void benchDeps()
+{
+    std::cout << "[uaiso] Benchmark: dependency processing" << std::endl;
+
+    const int kModules = 2000;
+    char dirTemplate[] = "/tmp/uaiso_bench_deps_XXXXXX";
+    if (!mkdtemp(dirTemplate))
+        return;
+    const std::string dirPath(dirTemplate);
+
+    std::vector<std::string> fileNames;
+    for (int i = 0; i < kModules; ++i) {
+        std::ostringstream code;
+        for (int j = 4 * i + 1; j <= 4 * i + 4 && j < kModules; ++j)
+            code << "import m" << j << "\n";
+        code << "\n";
+        for (int j = 0; j < 8; ++j) {
+            code << "class C" << j << ":\n"
+                 << "    def __init__(self, a, b):\n"
+                 << "        self.a = a\n"
+                 << "        self.b = b\n"
+                 << "    def sum(self, x):\n"
+                 << "        if x > 0:\n"
+                 << "            return self.a + self.b * x\n"
+                 << "        return [self.a, self.b, x]\n\n"
+                 << "def f" << j << "(p, q=" << j << "):\n"
+                 << "    c = C" << j << "(p, q)\n"
+                 << "    return c.sum(p - q)\n\n";
+        }
+        fileNames.push_back(dirPath + "/m" + std::to_string(i) + ".py");
+        std::ofstream(fileNames.back()) << code.str();
+    }
+
+    std::unique_ptr<Factory> factory = FactoryCreator::create(LangId::Py);
+    const std::string root = readFile(fileNames[0]);
+    std::vector<unsigned> counts { 1 };
+    for (unsigned count = 2; count <= std::thread::hardware_concurrency(); count *= 2)
+        counts.push_back(count);
+    std::cout << "  " << kModules << " modules, "
+              << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+
+    double baseSecs = 0;
+    for (auto count : counts) {
+        double secs = 0;
+        for (int round = 0; round < kRounds / 2; ++round) {
+            TokenMap tokens;
+            LexemeMap lexs;
+            Snapshot snapshot;
+            Manager manager;
+            manager.config(factory.get(), &tokens, &lexs, snapshot);
+            manager.setWorkerCount(count);
+            auto start = Clock::now();
+            manager.process(root, fileNames[0]);
+            secs += secondsSince(start);
+        }
+        secs /= kRounds / 2;
+        if (count == 1)
+            baseSecs = secs;
+        std::cout << "  " << std::left << std::setw(12)
+                  << (std::to_string(count) + " workers") << std::right
+                  << std::setw(10) << std::fixed << std::setprecision(1)
+                  << secs * 1e3 << " ms"
+                  << std::setw(8) << std::setprecision(2)
+                  << (secs > 0 ? baseSecs / secs : 0) << "x" << std::endl;
+    }
+
+    for (const auto& fileName : fileNames)
+        std::remove(fileName.c_str());
+    rmdir(dirPath.c_str());
+}
+
+/*!
+ * Import resolution: the imports of a synthetic Python project of 500 files,
+ * each importing the same ten modules (found in the last of 30 search paths)
+ * and a module which doesn't exist, are resolved by a fresh ImportResolver
+ * per file, by a shared one, and by a shared one after revalidation.
+ */
+void benchImports()
+{
+    std::cout << "[uaiso] Benchmark: import resolution" << std::endl;
+
+    const int kFiles = 500, kPaths = 30, kShared = 10;
+    char dirTemplate[] = "/tmp/uaiso_bench_imports_XXXXXX";
+    if (!mkdtemp(dirTemplate))
+        return;
+    const std::string dirPath(dirTemplate);
+    std::vector<std::string> written, searchPaths;
+    for (int i = 0; i < kPaths; ++i) {
+        searchPaths.push_back(dirPath + "/lib" + std::to_string(i) + "/");
+        mkdir(searchPaths.back().c_str(), 0700);
+        for (int j = 0; j < 20; ++j) {
+            written.push_back(searchPaths.back() + "other" + std::to_string(j) + ".py");
+            std::ofstream(written.back()) << "x = 1\n";
+        }
+    }
+    for (int i = 0; i < kShared; ++i) {
+        written.push_back(searchPaths.back() + "s" + std::to_string(i) + ".py");
+        std::ofstream(written.back()) << "x = 1\n";
+    }
+
+    std::vector<std::unique_ptr<Import>> imports;
+    for (int i = 0; i < kFiles; ++i) {
+        for (int j = 0; j <= kShared; ++j) {
+            const std::string target = j < kShared ? "s" + std::to_string(j) : "missing";
+            imports.emplace_back(new Import(dirPath + "/", target, nullptr, false));
+        }
+    }
+
+    std::unique_ptr<Factory> factory = FactoryCreator::create(LangId::Py);
+    auto report = [&imports] (const char* label, double secs,
+                              const ImportResolver::Stats& stats) {
+        std::cout << "  " << std::left << std::setw(24) << label << std::right
+                  << std::setw(10) << std::fixed << std::setprecision(1)
+                  << secs * 1e3 << " ms"
+                  << std::setw(8) << std::setprecision(1)
+                  << 100. * stats.resolveHits_ / imports.size() << "% hits"
+                  << std::setw(8) << stats.dirMisses_ << " listings" << std::endl;
+    };
+
+    ImportResolver::Stats total;
+    auto start = Clock::now();
+    for (int i = 0; i < kFiles; ++i) {
+        ImportResolver resolver(factory.get());
+        for (int j = 0; j <= kShared; ++j)
+            resolver.resolve(imports[i * (kShared + 1) + j].get(), searchPaths);
+        total.resolveHits_ += resolver.stats().resolveHits_;
+        total.dirMisses_ += resolver.stats().dirMisses_;
+    }
+    report("resolver per file", secondsSince(start), total);
+
+    ImportResolver resolver(factory.get());
+    start = Clock::now();
+    for (const auto& import : imports)
+        resolver.resolve(import.get(), searchPaths);
+    report("shared resolver", secondsSince(start), resolver.stats());
+
+    resolver.revalidate();
+    const auto before = resolver.stats();
+    start = Clock::now();
+    for (const auto& import : imports)
+        resolver.resolve(import.get(), searchPaths);
+    double secs = secondsSince(start);
+    total = resolver.stats();
+    total.resolveHits_ -= before.resolveHits_;
+    total.dirMisses_ -= before.dirMisses_;
+    report("shared (revalidated)", secs, total);
+
+    for (const auto& fileName : written)
+        std::remove(fileName.c_str());
+    for (const auto& searchPath : searchPaths)
+        rmdir(searchPath.c_str());
+    rmdir(dirPath.c_str());
+}
+
+/*!
+ * Editing session: a synthetic Python project of 200 modules, all importing
+ * the same one, which is then edited as by typing. Most edits are confined
+ * to function bodies, every tenth one adds a function. The time to process
+ * each edit is reported apart for edits which cut off the reloading of the
+ * importing modules and those which didn't.
+ */
+void benchEditing()
+{
+    std::cout << "[uaiso] Benchmark: editing session" << std::endl;
+
+    const int kModules = 200, kEdits = 100;
+    char dirTemplate[] = "/tmp/uaiso_bench_editing_XXXXXX";
+    if (!mkdtemp(dirTemplate))
+        return;
+    const std::string dirPath(dirTemplate);
+
+    std::vector<std::string> fileNames;
+    for (int i = 0; i < kModules; ++i) {
+        std::ostringstream code;
+        code << "import hub\n\n";
+        for (int j = 0; j < 8; ++j) {
+            code << "def f" << j << "(p, q):\n"
+                 << "    return hub.g0(p) + q * " << j << "\n\n";
+        }
+        fileNames.push_back(dirPath + "/m" + std::to_string(i) + ".py");
+        std::ofstream(fileNames.back()) << code.str();
+    }
+    const std::string hubName = dirPath + "/hub.py";
+    auto hubCode = [] (int funcs, int edit) {
+        std::ostringstream code;
+        for (int j = 0; j < funcs; ++j) {
+            code << "def g" << j << "(x):\n"
+                 << "    y = x + " << j << "\n";
+            if (j == 0) {
+                for (int k = 0; k < edit % 10; ++k)
+                    code << "    y = y * " << k << "\n";
+            }
+            code << "    return y\n\n";
+        }
+        return code.str();
+    };
+    std::ofstream(hubName) << hubCode(10, 0);
+
+    std::unique_ptr<Factory> factory = FactoryCreator::create(LangId::Py);
+    TokenMap tokens;
+    LexemeMap lexs;
+    Snapshot snapshot;
+    Manager manager;
+    manager.config(factory.get(), &tokens, &lexs, snapshot);
+    for (const auto& fileName : fileNames)
+        manager.process(readFile(fileName), fileName);
+
+    double cutoffSecs = 0, reloadSecs = 0;
+    int funcs = 10;
+    for (int edit = 1; edit <= kEdits; ++edit) {
+        if (edit % 10 == 0)
+            ++funcs;
+        const std::string code = hubCode(funcs, edit);
+        const size_t cutoffs = manager.replacementStats().cutoffs_;
+        auto start = Clock::now();
+        manager.process(code, hubName);
+        double secs = secondsSince(start);
+        if (manager.replacementStats().cutoffs_ > cutoffs)
+            cutoffSecs += secs;
+        else
+            reloadSecs += secs;
+    }
+
+    auto stats = manager.replacementStats();
+    const size_t reloads = stats.replaced_ - stats.cutoffs_;
+    std::cout << "  " << kEdits << " edits, " << stats.cutoffs_ << " cut off ("
+              << std::fixed << std::setprecision(1)
+              << (stats.replaced_ ? 100. * stats.cutoffs_ / stats.replaced_ : 0)
+              << "%), " << stats.reloaded_ << " modules reloaded" << std::endl;
+    std::cout << "  " << std::left << std::setw(24) << "cut off" << std::right
+              << std::setw(10) << std::setprecision(2)
+              << (stats.cutoffs_ ? cutoffSecs * 1e3 / stats.cutoffs_ : 0)
+              << " ms/edit" << std::endl;
+    std::cout << "  " << std::left << std::setw(24) << "dependents reloaded" << std::right
+              << std::setw(10) << std::setprecision(2)
+              << (reloads ? reloadSecs * 1e3 / reloads : 0)
+              << " ms/edit" << std::endl;
+
+    for (const auto& fileName : fileNames)
+        std::remove(fileName.c_str());
+    std::remove(hubName.c_str());
+    rmdir(dirPath.c_str());
+}
+
+namespace {
+
+std::vector<std::string> listFilesRecursively(const std::string& dirPath,
+                                              const std::string& suffix)
+{
+    std::vector<std::string> files = listFiles(dirPath, suffix);
+    tinydir_dir dir;
+    if (tinydir_open_sorted(&dir, dirPath.c_str()) == -1)
+        return files;
+    for (size_t i = 0; i < dir.n_files; ++i) {
+        tinydir_file file;
+        tinydir_readfile_n(&dir, &file, i);
+        if (file.is_dir && file.name[0] != '.') {
+            auto sub = listFilesRecursively(file.path, suffix);
+            files.insert(files.end(), sub.begin(), sub.end());
+        }
+    }
+    tinydir_close(&dir);
+    return files;
+}
+
+} // anonymous
+
+/*!
+ * Program cache: index a corpus as dependencies are (parse and bind each
+ * file) without a cache, with a cold cache (so entries are also stored), and
+ * with a warm one (entries are loaded instead).
+ */
+void benchCache()
+{
+    std::cout << "[uaiso] Benchmark: program cache" << std::endl;
+
+    std::vector<std::pair<const char*, Corpus>> corpora {
+        { "Go (Stdlib)", { LangId::Go, listFilesRecursively("TestData/Go/Stdlib", ".go") } },
+        { "Python", { LangId::Py, listFiles("TestData/Python", ".py") } }
+    };
+    for (const auto& corpus : corpora) {
+        char dirTemplate[] = "/tmp/uaiso_bench_cache_XXXXXX";
+        if (!mkdtemp(dirTemplate))
+            return;
+        const std::string dirPath(dirTemplate);
+        ProgramCache cache(dirPath);
+        std::unique_ptr<Factory> factory = FactoryCreator::create(corpus.second.langId_);
+        std::vector<std::string> fileNames;
+        for (const auto& fileName : corpus.second.files_)
+            fileNames.push_back(fullPath(fileName));
+
+        enum Mode { NoCache, Cold, Warm };
+        std::vector<std::string> keys;
+        for (auto mode : { NoCache, Cold, Warm }) {
+            TokenMap tokens;
+            LexemeMap lexs;
+            size_t progs = 0;
+            auto start = Clock::now();
+            for (const auto& fileName : fileNames) {
+                auto buffer = SourceBuffer::load(fileName);
+                if (!buffer)
+                    continue;
+                std::string key;
+                if (mode != NoCache)
+                    key = ProgramCache::key(buffer->data(), buffer->size(), corpus.second.langId_);
+                if (mode == Warm) {
+                    progs += cache.load(key, fileName, &lexs) != nullptr;
+                    continue;
+                }
+                std::unique_ptr<Unit> unit = factory->makeUnit();
+                unit->setFileName(fileName);
+                unit->assignInput(buffer.get());
+                unit->parse(&tokens, &lexs);
+                if (!unit->ast() || unit->ast()->kind() != Ast::Kind::Program)
+                    continue;
+                Binder binder(factory.get());
+                binder.setLexemes(&lexs);
+                binder.setTokens(&tokens);
+                binder.ignoreBuiltins();
+                binder.ignoreAutomaticModules();
+                std::unique_ptr<Program> prog = binder.bind(Program_Cast(unit->ast()), fileName);
+                if (!prog)
+                    continue;
+                ++progs;
+                if (mode == Cold && cache.store(key, prog.get(), &lexs))
+                    keys.push_back(key);
+            }
+            double secs = secondsSince(start);
+            static const char* const labels[] = { "no cache", "cold", "warm" };
+            std::cout << "  " << std::left << std::setw(14) << corpus.first
+                      << std::setw(10) << labels[mode] << std::right
+                      << std::setw(10) << std::fixed << std::setprecision(1)
+                      << secs * 1e3 << " ms  [" << progs << "/"
+                      << fileNames.size() << " files]" << std::endl;
+        }
+
+        for (const auto& key : keys)
+            std::remove((dirPath + "/" + key + ".uaisopc").c_str());
+        rmdir(dirPath.c_str());
+    }
+}
+
+/*!
+ * AST serialization: the corpus is parsed once, then the programs are written
+ * to the binary format and read back. Reading should beat parsing by a wide
+ * margin; the size of the serialized data is reported per node.
+ */
+void benchSerialize()
+{
+    std::cout << "[uaiso] Benchmark: AST serialization" << std::endl;
+
+    for (const auto& corpus : corpora()) {
+        std::unique_ptr<Factory> factory = FactoryCreator::create(corpus.langId_);
+        std::vector<std::string> sources;
+        for (const auto& fileName : corpus.files_)
+            sources.push_back(readFile(fileName));
+
+        size_t nodes = 0, bytes = 0;
+        double parseSecs = 0, writeSecs = 0, readSecs = 0;
+        for (int round = 0; round < kRounds; ++round) {
+            for (size_t i = 0; i < sources.size(); ++i) {
+                LexemeMap lexs;
+                auto start = Clock::now();
+                std::unique_ptr<Unit> unit = factory->makeUnit();
+                unit->setFileName(corpus.files_[i]);
+                unit->assignInput(sources[i]);
+                unit->parse(nullptr, &lexs);
+                parseSecs += secondsSince(start);
+                if (!unit->ast() || unit->ast()->kind() != Ast::Kind::Program)
+                    continue;
+
+                start = Clock::now();
+                const std::string data = AstSerializer().serialize(Program_Cast(unit->ast()));
+                writeSecs += secondsSince(start);
+
+                LexemeMap otherLexs;
+                start = Clock::now();
+                std::unique_ptr<ProgramAst> ast = AstSerializer().deserialize(data, &otherLexs);
+                readSecs += secondsSince(start);
+                UAISO_ASSERT(ast, return);
+                if (round == 0) {
+                    nodes += unit->astPool()->nodeCount();
+                    bytes += data.size();
+                }
+            }
+        }
+        std::cout << langName(corpus.langId_) << " (" << corpus.files_.size()
+                  << " files)" << std::endl;
+        if (!nodes)
+            continue;
+        printRow("parse", nodes, parseSecs / kRounds, 0);
+        printRow("serialize", nodes, writeSecs / kRounds, bytes);
+        printRow("deserialize", nodes, readSecs / kRounds, bytes);
+    }
+}
+
+/*!
+ * Signature-only parsing: the corpus is parsed as a dependency would be, with
+ * function bodies skipped, and compared to a full parse in nodes, memory held
+ * by the AST and time.
+ */
+void benchSignatures()
+{
+    std::cout << "[uaiso] Benchmark: signature-only parsing" << std::endl;
+
+    for (const auto& corpus : corpora()) {
+        std::unique_ptr<Factory> factory = FactoryCreator::create(corpus.langId_);
+        std::vector<std::string> sources;
+        for (const auto& fileName : corpus.files_)
+            sources.push_back(readFile(fileName));
+
+        std::cout << langName(corpus.langId_) << " (" << corpus.files_.size()
+                  << " files)" << std::endl;
+        const bool canSkipBodies = factory->makeUnit()->canSkipBodies();
+        for (bool skipBodies : { false, true }) {
+            if (skipBodies && !canSkipBodies)
+                continue;
+            size_t nodes = 0, bytes = 0;
+            double secs = 0;
+            for (int round = 0; round < kRounds; ++round) {
+                for (size_t i = 0; i < sources.size(); ++i) {
+                    LexemeMap lexs;
+                    auto start = Clock::now();
+                    std::unique_ptr<Unit> unit = factory->makeUnit();
+                    unit->setFileName(corpus.files_[i]);
+                    unit->assignInput(sources[i]);
+                    unit->setSkipBodies(skipBodies);
+                    size_t heap = heapInUse();
+                    unit->parse(nullptr, &lexs);
+                    if (round == 0) {
+                        nodes += unit->astPool()->nodeCount();
+                        bytes += heapInUse() - heap;
+                    }
+                    unit.reset();
+                    secs += secondsSince(start);
+                }
+            }
+            std::cout << "  " << std::left << std::setw(24)
+                      << (skipBodies ? "signatures only" : "full") << std::right
+                      << std::setw(10) << nodes << " nodes"
+                      << std::setw(10) << bytes / 1024 << " KiB"
+                      << std::setw(10) << std::fixed << std::setprecision(2)
+                      << secs / kRounds * 1000 << " ms" << std::endl;
+        }
+    }
+}
+
+/*!
+ * Time to first completion: a large file is processed up to a completion
+ * point within its last function and the completions proposed, with every
+ * function body bound upfront and with bodies bound lazily.
+ */
+void benchLazyBodies()
+{
+    std::cout << "[uaiso] Benchmark: lazy binding of bodies" << std::endl;
+
+    const int kClasses = 200, kMethods = 10;
+    std::ostringstream oss;
+    for (int i = 0; i < kClasses; ++i) {
+        oss << "class C" << i << ":\n"
+            << "    def __init__(self, a):\n"
+            << "        self.a = a\n";
+        for (int j = 0; j < kMethods; ++j) {
+            oss << "    def m" << j << "(self, p, q):\n";
+            for (int k = 0; k < 8; ++k)
+                oss << "        v" << k << " = p + q * " << k << "\n";
+            oss << "        if p:\n"
+                << "            w = [x for x in q]\n"
+                << "        return self.a\n";
+        }
+        oss << "\n";
+    }
+    oss << "def last(n):\n"
+        << "    r = n\n"
+        << "    s =";
+    const std::string code = oss.str();
+    const LineCol lineCol(kClasses * (3 + kMethods * 12) + kClasses + 2, 7);
+    const std::string fileName = "/bench_lazy.py";
+
+    std::unique_ptr<Factory> factory = FactoryCreator::create(LangId::Py);
+    for (bool lazy : { false, true }) {
+        double secs = 0;
+        size_t proposed = 0;
+        for (int round = 0; round < kRounds; ++round) {
+            TokenMap tokens;
+            LexemeMap lexs;
+            Snapshot snapshot;
+            Manager manager;
+            manager.config(factory.get(), &tokens, &lexs, snapshot);
+            Manager::BehaviourFlags flags = Manager::BehaviourFlag::IgnoreBuiltins;
+            if (lazy)
+                flags |= Manager::BehaviourFlag::BindBodiesLazily;
+            manager.setBehaviour(flags);
+
+            auto start = Clock::now();
+            std::unique_ptr<Unit> unit = manager.process(code, fileName, lineCol);
+            if (!unit->ast())
+                return;
+            Snapshot::Version version = snapshot.pin();
+            CompletionProposer proposer(factory.get());
+            manager.setUp(&proposer, version);
+            auto result = proposer.propose(Program_Cast(unit->ast()), &lexs);
+            secs += secondsSince(start);
+            proposed = std::get<0>(result).size();
+        }
+        std::cout << "  " << std::left << std::setw(24)
+                  << (lazy ? "lazy bodies" : "eager bodies") << std::right
+                  << std::setw(10) << std::fixed << std::setprecision(2)
+                  << secs / kRounds * 1e3 << " ms to first completion"
+                  << "  [" << proposed << " proposed]" << std::endl;
+    }
+}
+
+/*!
+ * Builtins: bind the corpus with and without builtins, in time per file and
+ * in memory held by each program (builtins are shared, not copied).
+ */
+void benchBuiltins()
+{
+    std::cout << "[uaiso] Benchmark: builtins" << std::endl;
+
+    for (const auto& corpus : corpora()) {
+        std::unique_ptr<Factory> factory = FactoryCreator::create(corpus.langId_);
+        std::vector<std::pair<std::string, std::string>> sources;
+        for (const auto& fileName : corpus.files_)
+            sources.emplace_back(fullPath(fileName), readFile(fileName));
+
+        std::cout << langName(corpus.langId_) << " (" << corpus.files_.size()
+                  << " files)" << std::endl;
+        for (bool builtins : { false, true }) {
+            size_t bound = 0, bytes = 0;
+            double secs = 0;
+            for (int round = 0; round < kRounds; ++round) {
+                TokenMap tokens;
+                LexemeMap lexs;
+                std::vector<std::unique_ptr<Program>> progs;
+                for (const auto& source : sources) {
+                    std::unique_ptr<Unit> unit = factory->makeUnit();
+                    unit->setFileName(source.first);
+                    unit->assignInput(source.second);
+                    unit->parse(&tokens, &lexs);
+                    if (!unit->ast() || unit->ast()->kind() != Ast::Kind::Program)
+                        continue;
+
+                    Binder binder(factory.get());
+                    binder.setLexemes(&lexs);
+                    binder.setTokens(&tokens);
+                    if (!builtins)
+                        binder.ignoreBuiltins();
+                    binder.ignoreAutomaticModules();
+                    size_t heap = heapInUse();
+                    auto start = Clock::now();
+                    progs.push_back(binder.bind(Program_Cast(unit->ast()),
+                                                source.first));
+                    secs += secondsSince(start);
+                    bytes += heapInUse() - heap;
+                    bound += progs.back() != nullptr;
+                }
+            }
+            std::cout << "  " << std::left << std::setw(24)
+                      << (builtins ? "with builtins" : "without builtins")
+                      << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(10) << (bound ? secs * 1e6 / bound : 0) << " us/file"
+                      << std::setw(10) << (bound ? bytes / bound : 0) << " bytes/program"
+                      << std::endl;
+        }
+    }
+}
+
+/*!
+ * Type checking: check the (already bound) corpus, with the types of
+ * expressions interned in a snapshot's interner.
+ */
+void benchTypeCheck()
+{
+    std::cout << "[uaiso] Benchmark: type checking" << std::endl;
+
+    for (const auto& corpus : corpora()) {
+        std::unique_ptr<Factory> factory = FactoryCreator::create(corpus.langId_);
+        TokenMap tokens;
+        LexemeMap lexs;
+        std::vector<std::unique_ptr<Unit>> units;
+        std::vector<std::unique_ptr<Program>> progs;
+        for (const auto& fileName : corpus.files_) {
+            std::unique_ptr<Unit> unit = factory->makeUnit();
+            unit->setFileName(fullPath(fileName));
+            unit->assignInput(readFile(fileName));
+            unit->parse(&tokens, &lexs);
+            if (!unit->ast() || unit->ast()->kind() != Ast::Kind::Program)
+                continue;
+            Binder binder(factory.get());
+            binder.setLexemes(&lexs);
+            binder.setTokens(&tokens);
+            binder.ignoreAutomaticModules();
+            progs.push_back(binder.bind(Program_Cast(unit->ast()), unit->fileName()));
+            units.push_back(std::move(unit));
+        }
+
+        Snapshot snapshot;
+        Snapshot::Version version = snapshot.pin();
+        double secs = 0;
+        for (int round = 0; round < kRounds; ++round) {
+            for (const auto& unit : units) {
+                auto start = Clock::now();
+                TypeChecker checker(factory.get());
+                checker.setTokens(&tokens);
+                checker.setTypeInterner(version.types());
+                checker.setResolutionCache(version.resolutions());
+                checker.check(Program_Cast(unit->ast()));
+                secs += secondsSince(start);
+            }
+        }
+        std::cout << "  " << std::left << std::setw(24) << langName(corpus.langId_)
+                  << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << (units.empty() ? 0 : secs * 1e6 / kRounds / units.size())
+                  << " us/file" << std::setw(8) << version.types()->size()
+                  << " types interned" << std::endl;
+    }
+}
+
+void collectEnvs(Environment env, std::vector<Environment>& envs)
+{
+    envs.push_back(env);
+    for (auto nested : env.nestedEnvs())
+        collectEnvs(nested, envs);
+}
+
+/*!
+ * Symbol lookup: after binding the corpus, replay from every scope the
+ * binder created the search of every name declared (or merged, as the
+ * builtins) in the program's scopes, the way the binder and the type
+ * checker resolve names.
+ */
+void benchLookup()
+{
+    std::cout << "[uaiso] Benchmark: symbol lookup" << std::endl;
+
+    for (const auto& corpus : corpora()) {
+        std::unique_ptr<Factory> factory = FactoryCreator::create(corpus.langId_);
+        TokenMap tokens;
+        LexemeMap lexs;
+        std::vector<std::unique_ptr<Unit>> units;
+        std::vector<std::unique_ptr<Program>> progs;
+        size_t bytes = 0;
+        for (const auto& fileName : corpus.files_) {
+            std::unique_ptr<Unit> unit = factory->makeUnit();
+            unit->setFileName(fullPath(fileName));
+            unit->assignInput(readFile(fileName));
+            unit->parse(&tokens, &lexs);
+            if (!unit->ast() || unit->ast()->kind() != Ast::Kind::Program)
+                continue;
+            Binder binder(factory.get());
+            binder.setLexemes(&lexs);
+            binder.setTokens(&tokens);
+            binder.ignoreAutomaticModules();
+            size_t heap = heapInUse();
+            auto prog = binder.bind(Program_Cast(unit->ast()), unit->fileName());
+            bytes += heapInUse() - heap;
+            if (prog)
+                progs.push_back(std::move(prog));
+            units.push_back(std::move(unit));
+        }
+
+        std::vector<std::pair<Environment, const Ident*>> trace;
+        for (const auto& prog : progs) {
+            std::vector<Environment> envs;
+            collectEnvs(prog->env(), envs);
+            std::vector<const Ident*> names;
+            for (auto env : envs) {
+                for (auto decl : env.listDecls())
+                    names.push_back(decl->name());
+            }
+            std::sort(names.begin(), names.end());
+            names.erase(std::unique(names.begin(), names.end()), names.end());
+            for (auto env : envs) {
+                for (auto name : names)
+                    trace.emplace_back(env, name);
+            }
+        }
+
+        size_t hits = 0;
+        auto start = Clock::now();
+        for (int round = 0; round < kRounds; ++round) {
+            for (const auto& lookup : trace) {
+                hits += lookup.first.searchValueDecl(lookup.second) != nullptr;
+                hits += lookup.first.searchTypeDecl(lookup.second) != nullptr;
+                hits += lookup.first.searchDecl(lookup.second) != nullptr;
+            }
+        }
+        double secs = secondsSince(start);
+        size_t lookups = 3 * trace.size() * kRounds;
+        std::cout << "  " << std::left << std::setw(24) << langName(corpus.langId_)
+                  << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << (lookups ? secs * 1e9 / lookups : 0) << " ns/lookup"
+                  << std::setw(10) << (lookups ? 100.0 * hits / lookups : 0) << " % hits"
+                  << std::setw(10) << (progs.empty() ? 0 : bytes / progs.size())
+                  << " bytes/program" << std::endl;
+    }
+}
+
+/*!
+ * Star imports: search names from a scope nested in a module which merges
+ * (through `from m import *`) many other modules.
+ */
+void benchStarImports()
+{
+    std::cout << "[uaiso] Benchmark: star imports" << std::endl;
+
+    const int kSymsPerModule = 50;
+    const int kLookups = 200000;
+    std::vector<std::unique_ptr<Ident>> idents;
+    auto makeIdent = [&idents] (const std::string& name) {
+        idents.emplace_back(new Ident(name));
+        return idents.back().get();
+    };
+
+    for (int modules : { 1, 4, 10, 40 }) {
+        Environment modEnv;
+        for (int m = 0; m < modules; ++m) {
+            Environment other;
+            for (int i = 0; i < kSymsPerModule; ++i) {
+                auto name = makeIdent("m" + std::to_string(m) + "_" + std::to_string(i));
+                other.insertValueDecl(std::unique_ptr<const ValueDecl>(new Var(name)));
+            }
+            std::unique_ptr<Namespace> space(new Namespace);
+            space->setEnv(other);
+            modEnv.injectNamespace(std::move(space), true);
+        }
+        Environment funcEnv = modEnv.createSubEnv().createSubEnv();
+
+        std::vector<const Ident*> hits, misses;
+        for (int i = 0; i < kSymsPerModule; ++i) {
+            hits.push_back(idents[idents.size() - 1 - i].get());
+            misses.push_back(makeIdent("unresolved" + std::to_string(i)));
+        }
+
+        for (auto names : { &hits, &misses }) {
+            size_t found = 0;
+            auto start = Clock::now();
+            for (int i = 0; i < kLookups; ++i)
+                found += funcEnv.searchValueDecl((*names)[i % names->size()]) != nullptr;
+            double secs = secondsSince(start);
+            std::cout << "  " << std::left << std::setw(24)
+                      << (std::to_string(modules) + " modules, "
+                          + (names == &hits ? "hits" : "misses"))
+                      << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(10) << secs * 1e9 / kLookups << " ns/lookup"
+                      << std::setw(10) << found << " found" << std::endl;
+        }
+
+        auto start = Clock::now();
+        size_t listed = 0;
+        for (int round = 0; round < kRounds; ++round)
+            listed += funcEnv.outerEnv().outerEnv().listValueDecls().size();
+        std::cout << "  " << std::left << std::setw(24)
+                  << (std::to_string(modules) + " modules, listing")
+                  << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << secondsSince(start) * 1e6 / kRounds << " us/list"
+                  << std::setw(10) << listed / kRounds << " listed" << std::endl;
+    }
+}
+
+/*!
+ * Completion: propose names, narrowed by the prefix typed so far, in a
+ * function of a module with many top-level declarations.
+ */
+void benchCompletion()
+{
+    std::cout << "[uaiso] Benchmark: completion by prefix" << std::endl;
+
+    const int kFuncs = 5000, kProposals = 200;
+    std::ostringstream oss;
+    for (int i = 0; i < kFuncs; ++i) {
+        oss << "def fun" << i << "(a):\n"
+            << "    return a\n";
+    }
+    oss << "def last(n):\n"
+        << "    r = n\n"
+        << "    s =";
+    const std::string code = oss.str();
+    const LineCol lineCol(kFuncs * 2 + 2, 7);
+
+    std::unique_ptr<Factory> factory = FactoryCreator::create(LangId::Py);
+    TokenMap tokens;
+    LexemeMap lexs;
+    Snapshot snapshot;
+    Manager manager;
+    manager.config(factory.get(), &tokens, &lexs, snapshot);
+    manager.setBehaviour(Manager::BehaviourFlag::IgnoreBuiltins);
+    std::unique_ptr<Unit> unit = manager.process(code, "/bench_completion.py", lineCol);
+    if (!unit->ast())
+        return;
+
+    Environment env = Program_Cast(unit->ast())->program_->env();
+    Snapshot::Version version = snapshot.pin();
+    for (const char* prefix : { "", "f", "fun1", "fun12", "fun123" }) {
+        CompletionProposer proposer(factory.get());
+        manager.setUp(&proposer, version);
+        size_t proposed = 0;
+        auto start = Clock::now();
+        for (int i = 0; i < kProposals; ++i) {
+            auto result = proposer.propose(Program_Cast(unit->ast()), &lexs, prefix);
+            proposed = std::get<0>(result).size();
+        }
+        double proposeSecs = secondsSince(start);
+
+        // The module's symbols alone: listed, then filtered by the editor,
+        // versus visited by prefix.
+        const size_t len = std::strlen(prefix);
+        size_t filtered = 0;
+        start = Clock::now();
+        for (int i = 0; i < kProposals; ++i) {
+            std::vector<const Symbol*> syms;
+            for (auto decl : env.listDecls()) {
+                if (decl->name()->spelling().compare(0, len, prefix) == 0)
+                    syms.push_back(decl);
+            }
+            filtered += syms.size();
+        }
+        double listSecs = secondsSince(start);
+        size_t visited = 0;
+        start = Clock::now();
+        for (int i = 0; i < kProposals; ++i) {
+            env.visitSymbols(prefix,
+                             Environment::SymbolGroups(Environment::SymbolGroup::ValueDecls)
+                                 | Environment::SymbolGroup::TypeDecls,
+                             [&visited] (const Symbol*) { ++visited; });
+        }
+        double visitSecs = secondsSince(start);
+        UAISO_ASSERT(filtered == visited, {});
+
+        std::cout << "  " << std::left << std::setw(24)
+                  << (std::string("prefix \"") + prefix + "\"") << std::right
+                  << std::setw(10) << std::fixed << std::setprecision(1)
+                  << proposeSecs / kProposals * 1e6 << " us/proposal"
+                  << std::setw(10) << listSecs / kProposals * 1e6 << " us list+filter"
+                  << std::setw(10) << visitSecs / kProposals * 1e6 << " us visit"
+                  << "  [" << proposed << " proposed]" << std::endl;
+    }
+}
+
+/*!
+ * Ranking: fuzzy match the names visible in a module that imports all the
+ * ones of a corpus (and in a large generated module), keeping the best 50,
+ * versus listing them, scoring and sorting all matches as an editor would.
+ */
+void benchRanking()
+{
+    std::cout << "[uaiso] Benchmark: ranking of completions" << std::endl;
+
+    const size_t kTop = 50;
+    const int kQueries = 20;
+    const char* patterns[] = { "s", "pr", "new", "rdfl" };
+
+    std::ostringstream oss;
+    const char* verbs[] = { "get", "set", "make", "parse", "read", "write", "print", "load" };
+    const char* nouns[] = { "Name", "Value", "File", "Stream", "Buffer", "Line", "Field", "Node" };
+    for (int i = 0; i < 10000; ++i) {
+        oss << "def " << verbs[i % 8] << nouns[(i / 8) % 8] << i << "(a):\n"
+            << "    return a\n";
+    }
+    const std::string bigModule = oss.str();
+
+    auto corpusList = corpora();
+    corpusList.push_back({ LangId::Py, { "" } }); // The generated module.
+    for (const auto& corpus : corpusList) {
+        const bool isGenerated = corpus.files_.size() == 1 && corpus.files_[0].empty();
+        std::unique_ptr<Factory> factory = FactoryCreator::create(corpus.langId_);
+        TokenMap tokens;
+        LexemeMap lexs;
+        std::vector<std::string> sources;
+        std::vector<std::unique_ptr<Unit>> units;
+        std::vector<std::unique_ptr<Program>> progs;
+        Environment env;
+        for (const auto& fileName : corpus.files_)
+            sources.push_back(isGenerated ? bigModule : readFile(fileName));
+        for (size_t i = 0; i < sources.size(); ++i) {
+            std::unique_ptr<Unit> unit = factory->makeUnit();
+            unit->setFileName(isGenerated ? "/bench_ranking.py"
+                                          : fullPath(corpus.files_[i]));
+            unit->assignInput(sources[i]);
+            unit->parse(&tokens, &lexs);
+            if (!unit->ast() || unit->ast()->kind() != Ast::Kind::Program)
+                continue;
+            Binder binder(factory.get());
+            binder.setLexemes(&lexs);
+            binder.setTokens(&tokens);
+            binder.ignoreBuiltins();
+            binder.ignoreAutomaticModules();
+            auto prog = binder.bind(Program_Cast(unit->ast()), unit->fileName());
+            if (!prog)
+                continue;
+            env.mergeEnv(prog->env());
+            progs.push_back(std::move(prog));
+            units.push_back(std::move(unit));
+        }
+        const auto groups = Environment::SymbolGroups(Environment::SymbolGroup::ValueDecls)
+                | Environment::SymbolGroup::TypeDecls;
+        size_t candidates = 0;
+        env.visitSymbols("", groups, [&candidates] (const Symbol*) { ++candidates; });
+
+        std::cout << (isGenerated ? std::string("Python, generated module")
+                                  : langName(corpus.langId_))
+                  << " (" << candidates << " names)" << std::endl;
+        for (const char* pattern : patterns) {
+            CompletionRanker ranker;
+            size_t ranked = 0;
+            auto start = Clock::now();
+            for (int i = 0; i < kQueries; ++i) {
+                ranker.start(pattern, kTop);
+                env.visitSymbols("", groups, [&ranker] (const Symbol* sym) {
+                    ranker.consider(sym, 0);
+                });
+                ranked = ranker.finish().size();
+            }
+            double rankSecs = secondsSince(start);
+
+            size_t matched = 0;
+            start = Clock::now();
+            for (int i = 0; i < kQueries; ++i) {
+                std::vector<std::pair<int, const std::string*>> all;
+                env.visitSymbols("", groups, [&all, pattern] (const Symbol* sym) {
+                    if (!isDecl(sym))
+                        return;
+                    const std::string& name = ConstDeclSymbol_Cast(sym)->name()->spelling();
+                    int score = CompletionRanker::matchScore(pattern, name);
+                    if (score >= 0)
+                        all.emplace_back(score, &name);
+                });
+                std::sort(all.begin(), all.end(), [] (const auto& a, const auto& b) {
+                    if (a.first != b.first)
+                        return a.first > b.first;
+                    return *a.second < *b.second;
+                });
+                matched = all.size();
+                all.resize(std::min(all.size(), kTop));
+            }
+            double sortSecs = secondsSince(start);
+
+            std::cout << "  " << std::left << std::setw(24)
+                      << (std::string("pattern \"") + pattern + "\"") << std::right
+                      << std::setw(10) << std::fixed << std::setprecision(1)
+                      << rankSecs / kQueries * 1e6 << " us top-" << kTop
+                      << std::setw(10) << sortSecs / kQueries * 1e6 << " us visit+sort"
+                      << "  [" << ranked << " of " << matched << " matches]" << std::endl;
+        }
+    }
+}
+
+/*!
+ * Resolution: resolve the elaborate types of a program re-bound over and
+ * over (fresh elaborate types every time), from a scope nested deep into a
+ * module with many record declarations, with and without a shared cache.
+ */
+void benchResolution()
+{
+    std::cout << "[uaiso] Benchmark: elaborate type resolution" << std::endl;
+
+    const int kRecords = 500;
+    const int kDepth = 16;
+    const int kUses = 20000;
+
+    std::unique_ptr<Factory> factory = FactoryCreator::create(LangId::Py);
+    LexemeMap lexs;
+    std::vector<const Ident*> names;
+    Environment root;
+    for (int i = 0; i < kRecords; ++i) {
+        const std::string spelling = "Record" + std::to_string(i);
+        auto name = lexs.intern<Ident>(spelling);
+        std::unique_ptr<RecordType> recTy(new RecordType);
+        for (int j = 0; j < 8; ++j) {
+            auto field = lexs.intern<Ident>(spelling + "_f" + std::to_string(j));
+            recTy->env().insertValueDecl(std::unique_ptr<const ValueDecl>(new Var(field)));
+        }
+        std::unique_ptr<Record> rec(new Record(name));
+        rec->setType(std::move(recTy));
+        root.insertTypeDecl(std::unique_ptr<const TypeDecl>(rec.release()));
+        names.push_back(name);
+    }
+    Environment inner = root;
+    for (int d = 0; d < kDepth; ++d)
+        inner = inner.createSubEnv();
+
+    Snapshot snapshot;
+    for (bool cached : { false, true }) {
+        TypeResolver resolver(factory.get());
+        Snapshot::Version version = snapshot.pin();
+        if (cached)
+            resolver.setResolutionCache(version.resolutions());
+        size_t resolved = 0;
+        auto start = Clock::now();
+        for (int round = 0; round < kRounds; ++round) {
+            std::vector<std::unique_ptr<ElaborateType>> uses;
+            uses.reserve(kUses);
+            for (int i = 0; i < kUses; ++i)
+                uses.emplace_back(new ElaborateType(names[(i * 7) % kRecords]));
+            for (const auto& elabTy : uses)
+                resolved += std::get<0>(resolver.resolve(elabTy.get(), inner)) != nullptr;
+        }
+        double secs = secondsSince(start);
+        std::cout << "  " << std::left << std::setw(24) << (cached ? "cached" : "uncached")
+                  << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << secs * 1e9 / (kRounds * kUses) << " ns/resolution"
+                  << "  [" << resolved << " resolved]" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::pair<const char*, std::function<void ()>>> benchs {
+        { "AstPool", benchAstPool },
+        { "Interner", benchInterner },
+        { "PosIndex", benchPosIndex },
+        { "Binding", benchBinding },
+        { "Input", benchInput },
+        { "Lexer", benchLexer },
+        { "Keywords", benchKeywords },
+        { "Deps", benchDeps },
+        { "Imports", benchImports },
+        { "Editing", benchEditing },
+        { "Cache", benchCache },
+        { "Serialize", benchSerialize },
+        { "Signatures", benchSignatures },
+        { "LazyBodies", benchLazyBodies },
+        { "Builtins", benchBuiltins },
+        { "TypeCheck", benchTypeCheck },
+        { "Lookup", benchLookup },
+        { "StarImports", benchStarImports },
+        { "Completion", benchCompletion },
+        { "Ranking", benchRanking },
+        { "Resolution", benchResolution },
+    };
+
+    for (const auto& bench : benchs) {
+        bool run = argc == 1;
+        for (int i = 1; i < argc && !run; ++i)
+            run = !strcmp(argv[i], bench.first);
+        if (run)
+            bench.second();
+    }
+
+    return 0;
+}
@@ -25,6 +25,7 @@
 #define UAISO_LINECOL_H__
 
 #include "Common/Config.h"
+#include <cstdint>
 #include <functional>
 #include <ostream>
 
@@ -55,10 +56,10 @@ public:
     int col_;
 };
 
-bool operator==(const LineCol& a, const LineCol& b);
-bool operator!=(const LineCol& a, const LineCol& b);
-bool operator<(const LineCol& a, const LineCol& b);
-LineCol operator+(const LineCol& a, const LineCol& b);
+UAISO_API bool operator==(const LineCol& a, const LineCol& b);
+UAISO_API bool operator!=(const LineCol& a, const LineCol& b);
+UAISO_API bool operator<(const LineCol& a, const LineCol& b);
+UAISO_API LineCol operator+(const LineCol& a, const LineCol& b);
 
 UAISO_API inline std::ostream& operator<<(std::ostream& os, const LineCol& lineCol)
 {
@@ -75,9 +76,11 @@ struct hash<uaiso::LineCol>
 {
     size_t operator()(const uaiso::LineCol& lineCol) const
     {
-        const int a = std::hash<int>()(lineCol.line_);
-        const int b = std::hash<int>()(lineCol.col_);
-        return a ^ b;
+        // Pack both into a single key, so (a, b), (b, a) and (a, a) don't
+        // collide.
+        const uint64_t key = (uint64_t(uint32_t(lineCol.line_)) << 32)
+                | uint32_t(lineCol.col_);
+        return std::hash<uint64_t>()(key);
     }
 };
 
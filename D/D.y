@@ -63,14 +63,15 @@ namespace uaiso { namespace detail { struct PartialParse; } }
 /* Forward declare the context, it's a yyparse parameter. */
 namespace uaiso { class DParsingContext; }
 
-/* Location enhanced with filename. */
+/* Location enhanced with the file id and the lexeme (if any). */
 typedef struct D_YYLTYPE
 {
   int first_line;
   int first_column;
   int last_line;
   int last_column;
-  const char* filename;
+  unsigned file_id;
+  const uaiso::Lexeme* lexeme;
 } D_YYLTYPE;
 # define D_YYLTYPE_IS_DECLARED 1
 # define D_YYLTYPE_IS_TRIVIAL 1
@@ -83,7 +84,8 @@ typedef struct D_YYLTYPE
          (Current).first_column = YYRHSLOC (Rhs, 1).first_column;       \
          (Current).last_line    = YYRHSLOC (Rhs, N).last_line;          \
          (Current).last_column  = YYRHSLOC (Rhs, N).last_column;        \
-         (Current).filename     = YYRHSLOC (Rhs, N).filename;           \
+         (Current).file_id      = YYRHSLOC (Rhs, N).file_id;            \
+         (Current).lexeme       = (N) == 1 ? YYRHSLOC (Rhs, 1).lexeme : 0; \
       }                                                                 \
       else                                                              \
       {                                                                 \
@@ -91,7 +93,8 @@ typedef struct D_YYLTYPE
            YYRHSLOC (Rhs, 0).last_line;                                 \
          (Current).first_column = (Current).last_column =               \
            YYRHSLOC (Rhs, 0).last_column;                               \
-         (Current).filename     = 0;                                    \
+         (Current).file_id      = 0;                                    \
+         (Current).lexeme       = 0;                                    \
       }                                                                 \
     while (YYID (0))
 }
@@ -973,8 +976,8 @@ PrimaryExpr:
 |   '.' IdentOrTemplateInst
     {
         DECL_1_LOC(@1);
-        context->trackLexeme<Ident>(".", locA.lineCol());
-        auto dot = newAst<GenNameAst>()->setGenLoc(locA);
+        auto dot = newAst<GenNameAst>()->setGenLoc(locA)
+            ->setIdent(context->trackLexeme<Ident>(".", locA.lineCol()));
         auto name = newAst<NestedNameAst>()->setNamesSR(NameAstList::createSR(dot)->handleSR($2));
         $$ = newAst<IdentExprAst>()->setName(name);
     }
@@ -1714,7 +1717,7 @@ CtorDecl:
         auto spec = newAst<FuncSpecAst>();
         spec->setParam(fullParam->param_.release())
             ->setResult(newAst<VoidSpecAst>()->setKeyLoc(locA));
-        auto name = newAst<SimpleNameAst>()->setNameLoc(locA);
+        auto name = newAst<SimpleNameAst>()->setNameLoc(locA)->setIdent(ConstIdent_Cast(@1.lexeme));
         auto func = newAst<FuncDeclAst>()->setSpec(spec)->setName(name)->setStmt($3);
         func->setVariety(FuncVariety::Constructor);
         $$ = func;
@@ -1727,7 +1730,7 @@ CtorDecl:
         auto spec = newAst<FuncSpecAst>();
         spec->setParam(fullParam->param_.release())
             ->setResult(newAst<VoidSpecAst>()->setKeyLoc(locA));
-        auto name = newAst<SimpleNameAst>()->setNameLoc(locA);
+        auto name = newAst<SimpleNameAst>()->setNameLoc(locA)->setIdent(ConstIdent_Cast(@1.lexeme));
         auto attrSpec = newAst<DecoratedSpecAst>()->setSpec(spec)->setAttrsSR($3);
         auto func = newAst<FuncDeclAst>()->setSpec(attrSpec)->setName(name)->setStmt($4);
         func->setVariety(FuncVariety::Constructor);
@@ -1743,7 +1746,7 @@ CtorDecl:
         auto spec = newAst<FuncSpecAst>();
         spec->setParam(fullParam->param_.release())
             ->setResult(newAst<VoidSpecAst>()->setKeyLoc(locA));
-        auto name = newAst<SimpleNameAst>()->setNameLoc(locA);
+        auto name = newAst<SimpleNameAst>()->setNameLoc(locA)->setIdent(ConstIdent_Cast(@1.lexeme));
         auto attrSpec = newAst<DecoratedSpecAst>()->setSpec(spec)->setAttrsSR($3);
         auto func = newAst<FuncDeclAst>()->setSpec(attrSpec)->setName(name)->setStmt($5);
         func->setVariety(FuncVariety::Constructor);
@@ -1757,7 +1760,7 @@ CtorDecl:
         auto spec = newAst<FuncSpecAst>();
         spec->setParam(fullParam->param_.release())
             ->setResult(newAst<VoidSpecAst>()->setKeyLoc(locA));
-        auto name = newAst<SimpleNameAst>()->setNameLoc(locA);
+        auto name = newAst<SimpleNameAst>()->setNameLoc(locA)->setIdent(ConstIdent_Cast(@2.lexeme));
         auto attrSpec = newAst<DecoratedSpecAst>()->setSpec(spec)->setAttrsSR($1);
         auto func = newAst<FuncDeclAst>()->setSpec(attrSpec)->setName(name)->setStmt($4);
         func->setVariety(FuncVariety::Constructor);
@@ -1771,7 +1774,7 @@ CtorDecl:
         auto spec = newAst<FuncSpecAst>();
         spec->setParam(fullParam->param_.release())
             ->setResult(newAst<VoidSpecAst>()->setKeyLoc(locA));
-        auto name = newAst<SimpleNameAst>()->setNameLoc(locA);
+        auto name = newAst<SimpleNameAst>()->setNameLoc(locA)->setIdent(ConstIdent_Cast(@2.lexeme));
         auto attrs = $1->mergeSR($4);
         auto attrSpec = newAst<DecoratedSpecAst>()->setSpec(spec)->setAttrsSR(attrs);
         auto func = newAst<FuncDeclAst>()->setSpec(attrSpec)->setName(name)->setStmt($5);
@@ -1788,7 +1791,7 @@ CtorDecl:
         auto spec = newAst<FuncSpecAst>();
         spec->setParam(fullParam->param_.release())
             ->setResult(newAst<VoidSpecAst>()->setKeyLoc(locA));
-        auto name = newAst<SimpleNameAst>()->setNameLoc(locA);
+        auto name = newAst<SimpleNameAst>()->setNameLoc(locA)->setIdent(ConstIdent_Cast(@2.lexeme));
         auto attrs = $1->mergeSR($4);
         auto attrSpec = newAst<DecoratedSpecAst>()->setSpec(spec)->setAttrsSR(attrs);
         auto func = newAst<FuncDeclAst>()->setSpec(attrSpec)->setName(name)->setStmt($6);
@@ -1805,7 +1808,7 @@ DtorDecl:
         auto param = newAst<ParamClauseDeclAst>()->setLDelimLoc(locC)->setRDelimLoc(locD);
         auto spec = newAst<FuncSpecAst>()->setParam(param)
             ->setResult(newAst<VoidSpecAst>()->setKeyLoc(locA));
-        auto name = newAst<SimpleNameAst>()->setNameLoc(locB);
+        auto name = newAst<SimpleNameAst>()->setNameLoc(locB)->setIdent(ConstIdent_Cast(@2.lexeme));
         auto func = newAst<FuncDeclAst>()->setSpec(spec)->setName(name)->setStmt($5);
         func->setVariety(FuncVariety::Destructor);
         $$ = func;
@@ -1818,7 +1821,7 @@ DtorDecl:
         auto baseSpec = newAst<FuncSpecAst>()->setParam(param)
             ->setResult(newAst<VoidSpecAst>()->setKeyLoc(locA));
         auto spec = newAst<DecoratedSpecAst>()->setSpec(baseSpec)->setAttrsSR($5);
-        auto name = newAst<SimpleNameAst>()->setNameLoc(locB);
+        auto name = newAst<SimpleNameAst>()->setNameLoc(locB)->setIdent(ConstIdent_Cast(@2.lexeme));
         auto func = newAst<FuncDeclAst>()->setSpec(spec)->setName(name)->setStmt($6);
         func->setVariety(FuncVariety::Destructor);
         $$ = func;
@@ -1831,7 +1834,7 @@ DtorDecl:
         auto baseSpec = newAst<FuncSpecAst>()->setParam(param)
             ->setResult(newAst<VoidSpecAst>()->setKeyLoc(locA));
         auto spec = newAst<DecoratedSpecAst>()->setSpec(baseSpec)->setAttrsSR($1);
-        auto name = newAst<SimpleNameAst>()->setNameLoc(locB);
+        auto name = newAst<SimpleNameAst>()->setNameLoc(locB)->setIdent(ConstIdent_Cast(@3.lexeme));
         auto func = newAst<FuncDeclAst>()->setSpec(spec)->setName(name)->setStmt($6);
         func->setVariety(FuncVariety::Destructor);
         $$ = func;
@@ -1839,13 +1842,13 @@ DtorDecl:
 |   Attrs '~' THIS '(' ')' FuncAttrs FuncEnd
     {
         /* TODO: Join ~ and this */
-        DECL_4_LOC(@1, @2, @3, @4);
+        DECL_4_LOC(@2, @3, @4, @5);
         auto attrs = $1->mergeSR($6);
         auto param = newAst<ParamClauseDeclAst>()->setLDelimLoc(locC)->setRDelimLoc(locD);
         auto baseSpec = newAst<FuncSpecAst>()->setParam(param)
             ->setResult(newAst<VoidSpecAst>()->setKeyLoc(locA));
         auto spec = newAst<DecoratedSpecAst>()->setSpec(baseSpec)->setAttrsSR(attrs);
-        auto name = newAst<SimpleNameAst>()->setNameLoc(locB);
+        auto name = newAst<SimpleNameAst>()->setNameLoc(locB)->setIdent(ConstIdent_Cast(@3.lexeme));
         auto func = newAst<FuncDeclAst>()->setSpec(spec)->setName(name)->setStmt($7);
         func->setVariety(FuncVariety::Destructor);
         $$ = func;
@@ -1860,7 +1863,7 @@ Postblit:
         auto param = newAst<ParamClauseDeclAst>()->setLDelimLoc(locB)->setRDelimLoc(locC);
         auto spec = newAst<FuncSpecAst>()->setParam(param)
             ->setResult(newAst<VoidSpecAst>()->setKeyLoc(locA));
-        auto name = newAst<SimpleNameAst>()->setNameLoc(locA);
+        auto name = newAst<SimpleNameAst>()->setNameLoc(locA)->setIdent(ConstIdent_Cast(@1.lexeme));
         auto func = newAst<FuncDeclAst>()->setSpec(spec)->setName(name)->setStmt($5);
         func->setVariety(FuncVariety::Constructor);
         $$ = func;
@@ -1873,7 +1876,7 @@ Postblit:
         auto baseSpec = newAst<FuncSpecAst>()->setParam(param)
             ->setResult(newAst<VoidSpecAst>()->setKeyLoc(locA));
         auto spec = newAst<DecoratedSpecAst>()->setSpec(baseSpec)->setAttrsSR($5);
-        auto name = newAst<SimpleNameAst>()->setNameLoc(locA);
+        auto name = newAst<SimpleNameAst>()->setNameLoc(locA)->setIdent(ConstIdent_Cast(@1.lexeme));
         auto func = newAst<FuncDeclAst>()->setSpec(spec)->setName(name)->setStmt($6);
         func->setVariety(FuncVariety::Constructor);
         $$ = func;
@@ -3811,7 +3814,7 @@ Ident:
     IDENT
     {
         DECL_1_LOC(@1);
-        $$ = newAst<SimpleNameAst>()->setNameLoc(locA);
+        $$ = newAst<SimpleNameAst>()->setNameLoc(locA)->setIdent(ConstIdent_Cast(@1.lexeme));
     }
 |   COMPLETION
     {
@@ -3906,7 +3909,7 @@ StringLit:
     STR_LIT
     {
         DECL_1_LOC(@1);
-        $$ = newAst<StrLitExprAst>()->setLitLoc(locA);
+        $$ = newAst<StrLitExprAst>()->setLitLoc(locA)->setLit(ConstStrLit_Cast(@1.lexeme));
     }
 ;
 
@@ -3914,12 +3917,14 @@ NumLit:
     INT_LIT
     {
         DECL_1_LOC(@1);
-        $$ = newAst<NumLitExprAst>()->setLitLoc(locA);
+        $$ = newAst<NumLitExprAst>()->setLitLoc(locA)->setLit(ConstNumLit_Cast(@1.lexeme))
+            ->setVariety(NumLitVariety::IntFormat);
     }
 |   FLOAT_LIT
     {
         DECL_1_LOC(@1);
-        $$ = newAst<NumLitExprAst>()->setLitLoc(locA);
+        $$ = newAst<NumLitExprAst>()->setLitLoc(locA)->setLit(ConstNumLit_Cast(@1.lexeme))
+            ->setVariety(NumLitVariety::FloatFormat);
     }
 ;
 
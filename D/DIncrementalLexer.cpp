@@ -32,6 +32,9 @@
 // See Flex bug (1) in 3rdPartyBugs.txt
 void D_yyset_column(int column, yyscan_t yyscanner);
 
+// Defined in D.l, where the start conditions are known.
+void D_yybegin_nested_comment(yyscan_t yyscanner);
+
 using namespace uaiso;
 
 DIncrementalLexer::DIncrementalLexer()
@@ -42,16 +45,20 @@ DIncrementalLexer::DIncrementalLexer()
 }
 
 DIncrementalLexer::~DIncrementalLexer()
-{}
+{
+    finish();
+}
 
 void DIncrementalLexer::lex(const std::string& source)
 {
     P->phrasing_.reset(new Phrasing);
-    P->context_->collectPhrasing(P->phrasing_.get());
+    auto dContext = static_cast<DParsingContext*>(P->context_.get());
+    dContext->collectPhrasing(P->phrasing_.get());
+    dContext->setNestedCommentLevel(0);
+    dContext->leaveTokenState();
 
     yyscan_t scanner = 0;
-    if (D_yylex_init_extra(static_cast<DParsingContext*>(P->context_.get()),
-                           &scanner)) {
+    if (D_yylex_init_extra(dContext, &scanner)) {
         Error::log("Failed to initializer scanner.\n");
         return;
     }
@@ -70,3 +77,62 @@ void DIncrementalLexer::lex(const std::string& source)
 
     decideState();
 }
+
+void DIncrementalLexer::resume(const char* buff, size_t len,
+                               const LineCol& lineCol, const LexerState& state)
+{
+    finish();
+    auto dContext = static_cast<DParsingContext*>(P->context_.get());
+
+    // The state is the nesting level of `/+ +/` comments at the resume
+    // point, which is within one if it's not zero.
+    dContext->setNestedCommentLevel(state.bits_);
+    dContext->leaveTokenState();
+
+    if (D_yylex_init_extra(dContext, &scanner_)) {
+        Error::log("Failed to initializer scanner.\n");
+        scanner_ = nullptr;
+        return;
+    }
+
+    bufferState_ = D_yy_scan_bytes(buff, len, scanner_);
+    D_yyset_lineno(lineCol.line_, scanner_);
+    D_yyset_column(lineCol.col_, scanner_);
+
+    // Within a comment, the location isn't assigned to every piece of it,
+    // so the comment is taken to start where lexing resumes.
+    YYLTYPE* loc = new YYLTYPE();
+    loc->first_line = loc->last_line = lineCol.line_;
+    loc->first_column = loc->last_column = lineCol.col_;
+    loc_ = loc;
+    if (state.bits_) {
+        D_yybegin_nested_comment(scanner_);
+        dContext->enterTokenState();
+    }
+}
+
+bool DIncrementalLexer::lexNext(LexerState& state)
+{
+    if (!scanner_)
+        return false;
+
+    auto dContext = static_cast<DParsingContext*>(P->context_.get());
+    state.bits_ = dContext->nestedCommentLevel();
+    state.stack_.clear();
+
+    YYSTYPE sdummy;
+    return D_yylex(&sdummy, static_cast<YYLTYPE*>(loc_), scanner_);
+}
+
+void DIncrementalLexer::finish()
+{
+    if (!scanner_)
+        return;
+
+    D_yy_delete_buffer(static_cast<YY_BUFFER_STATE>(bufferState_), scanner_);
+    D_yylex_destroy(scanner_);
+    delete static_cast<YYLTYPE*>(loc_);
+    scanner_ = nullptr;
+    bufferState_ = nullptr;
+    loc_ = nullptr;
+}
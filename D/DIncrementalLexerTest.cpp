@@ -25,6 +25,7 @@
 #include "Parsing/IncrementalLexer__.h"
 #include "Parsing/Phrasing.h"
 #include "Parsing/Token.h"
+#include <sstream>
 
 using namespace uaiso;
 
@@ -43,6 +44,9 @@ public:
              , &DIncrementalLexerTest::testCase9
              , &DIncrementalLexerTest::testCase10
              , &DIncrementalLexerTest::testCase11
+             , &DIncrementalLexerTest::testCase12
+             , &DIncrementalLexerTest::testCase13
+             , &DIncrementalLexerTest::testCase14
              )
 
     DIncrementalLexer lexer_;
@@ -53,6 +57,30 @@ public:
         return std::unique_ptr<Phrasing>(lexer_.releasePhrasing());
     }
 
+    std::string dump(const Phrasing& phrasing)
+    {
+        std::ostringstream oss;
+        for (size_t i = 0; i < phrasing.size(); ++i) {
+            oss << phrasing.token(i) << "@" << phrasing.lineCol(i).line_ << ":"
+                << phrasing.lineCol(i).col_ << "/" << phrasing.length(i) << " ";
+        }
+        return oss.str();
+    }
+
+    std::string lexFromScratch(const std::string& source)
+    {
+        DIncrementalLexer lexer;
+        IncrementalLexer::LineRange lines = lexer.lexDocument(source);
+        return dump(*lexer.phrasing(lines));
+    }
+
+    std::string all(const DIncrementalLexer& lexer)
+    {
+        IncrementalLexer::LineRange lines;
+        lines.last_ = lexer.lineCount();
+        return dump(*lexer.phrasing(lines));
+    }
+
     void testCase1()
     {
         auto phrase = core("struct ticks {");
@@ -199,6 +227,90 @@ public:
         UAISO_EXPECT_CONTAINER_EQ(expected, (*phrase));
         UAISO_EXPECT_TRUE(lexer_.state() == IncrementalLexer::InCode);
     }
+
+    void testCase12()
+    {
+        // A nested comment left unterminated doesn't leak into later lexing.
+        auto phrase = core("/+ open\n");
+        UAISO_EXPECT_TRUE(lexer_.state() == IncrementalLexer::InMultilineComment);
+
+        DIncrementalLexer lexer;
+        IncrementalLexer::LineRange lines = lexer.lexDocument("x /+ c +/ y");
+        std::unique_ptr<Phrasing> phrasing = lexer.phrasing(lines);
+        std::vector<Token> expected {
+            TK_IDENT, TK_MULTILINE_COMMENT, TK_IDENT
+        };
+        UAISO_EXPECT_INT_EQ(expected.size(), phrasing->size());
+        UAISO_EXPECT_CONTAINER_EQ(expected, (*phrasing));
+    }
+
+    void testCase13()
+    {
+        // Lexing a document incrementally is just like lexing it all over.
+        const std::string source =
+R"raw(module m;
+
+int f(int a) {
+    int x = a + 1; /+ one
+    /+ more +/ +/
+    return x;
+}
+
+string s = "two
+lines";
+)raw";
+        DIncrementalLexer lexer;
+        lexer.lexDocument(source);
+        DIncrementalLexer pieceLexer;
+        pieceLexer.lex(source);
+        std::unique_ptr<Phrasing> piece(pieceLexer.releasePhrasing());
+        UAISO_EXPECT_STR_EQ(dump(*piece), all(lexer));
+
+        std::string edited = source;
+        edited.replace(edited.find("return x"), 8, "return x + 2");
+        lexer.edit(5, 1, 1);
+        IncrementalLexer::LineRange lines = lexer.lexDocument(edited);
+        UAISO_EXPECT_TRUE(lines.first_ <= 5);
+        UAISO_EXPECT_TRUE(lines.last_ < 9);
+        UAISO_EXPECT_STR_EQ(lexFromScratch(edited), all(lexer));
+
+        // Open a comment that swallows the rest, and close it back.
+        edited.replace(edited.find("int f"), 5, "/* int f");
+        lexer.edit(2, 1, 1);
+        lexer.lexDocument(edited);
+        UAISO_EXPECT_STR_EQ(lexFromScratch(edited), all(lexer));
+        edited.replace(edited.find("/* int f"), 8, "int f");
+        lexer.edit(2, 1, 1);
+        lexer.lexDocument(edited);
+        UAISO_EXPECT_STR_EQ(lexFromScratch(edited), all(lexer));
+    }
+
+    void testCase14()
+    {
+        // Lexing resumed within a nested comment picks up its nesting level.
+        const std::string rest = "two +/ three +/ x";
+        DIncrementalLexer lexer;
+        Phrasing phrasing;
+        lexer.P->context_->collectPhrasing(&phrasing);
+        LexerState state;
+        state.bits_ = 2;
+        lexer.resume(rest.c_str(), rest.size(), LineCol(1, 4), state);
+        UAISO_EXPECT_TRUE(lexer.lexNext(state));
+        UAISO_EXPECT_INT_EQ(2, state.bits_);
+        while (lexer.lexNext(state)) {}
+        lexer.finish();
+
+        std::vector<Token> expected {
+            TK_MULTILINE_COMMENT, TK_IDENT
+        };
+        UAISO_EXPECT_INT_EQ(expected.size(), phrasing.size());
+        UAISO_EXPECT_CONTAINER_EQ(expected, phrasing);
+        UAISO_EXPECT_INT_EQ(1, phrasing.lineCol(0).line_);
+        UAISO_EXPECT_INT_EQ(4, phrasing.lineCol(0).col_);
+        UAISO_EXPECT_INT_EQ(15, phrasing.length(0));
+        UAISO_EXPECT_INT_EQ(20, phrasing.lineCol(1).col_);
+        UAISO_EXPECT_INT_EQ(0, state.bits_);
+    }
 };
 
 MAKE_CLASS_TEST(DIncrementalLexer)
@@ -22,3 +22,134 @@
 /*--------------------------*/
 
 #include "D/DParsingContext.h"
+#include "Parsing/Token.h"
+
+using namespace uaiso;
+
+int DParsingContext::interceptRawToken(int token)
+{
+    if (skipBodies())
+        trackSignature(token);
+
+    return token;
+}
+
+bool DParsingContext::startsFuncBody() const
+{
+    if (!skipBodies() || parenDepth_)
+        return false;
+
+    switch (prevToken_) {
+    case TK_BODY:
+    case TK_DO:
+    case TK_OUT:
+    case TK_UNITTEST:
+    case TK_INVARIANT:
+        return true;
+
+    default:
+        return afterParams_;
+    }
+}
+
+bool DParsingContext::opensParams() const
+{
+    switch (prevToken_) {
+    case TK_THIS:
+    case TK_INVARIANT:
+    // Contracts, which precede the body like attributes do.
+    case TK_IN:
+    case TK_OUT:
+        return true;
+
+    case TK_RPAREN:
+        // Template parameters followed by the function's ones.
+        return afterParams_;
+
+    case TK_IDENT:
+        switch (prevPrevToken_) {
+        case TK_AT:
+        case TK_CLASS:
+        case TK_STRUCT:
+        case TK_UNION:
+        case TK_INTERFACE:
+        case TK_TEMPLATE:
+        case TK_ENUM:
+            return false;
+
+        default:
+            return true;
+        }
+
+    default:
+        return false;
+    }
+}
+
+bool DParsingContext::keepsParams(int token) const
+{
+    switch (token) {
+    case TK_CONST:
+    case TK_IMMUTABLE:
+    case TK_INOUT:
+    case TK_SHARED:
+    case TK_NOTHROW:
+    case TK_PURE:
+    case TK_REF:
+    case TK_RETURN:
+    case TK_SCOPE:
+    case TK_AT:
+    case TK_SAFE:
+    case TK_TRUSTED:
+    case TK_SYSTEM:
+    case TK_NOGC:
+    case TK_DISABLE:
+    case TK_PROPERTY:
+    case TK_IF:
+    case TK_IN:
+    case TK_OUT:
+        return true;
+
+    case TK_IDENT:
+        return prevToken_ == TK_AT;
+
+    default:
+        return false;
+    }
+}
+
+void DParsingContext::trackSignature(int token)
+{
+    switch (token) {
+    case TK_LPAREN:
+        if (parenDepth_++)
+            break;
+        if (opensParams()) {
+            group_ = Group::Params;
+        } else if (afterParams_
+                   && (prevToken_ == TK_IF
+                       || (prevToken_ == TK_IDENT && prevPrevToken_ == TK_AT))) {
+            // A constraint or an attribute's arguments.
+            group_ = Group::Attr;
+        } else {
+            group_ = Group::Other;
+            afterParams_ = false;
+        }
+        break;
+
+    case TK_RPAREN:
+        if (!parenDepth_ || --parenDepth_)
+            break;
+        if (group_ == Group::Params)
+            afterParams_ = true;
+        break;
+
+    default:
+        if (!parenDepth_ && !keepsParams(token))
+            afterParams_ = false;
+        break;
+    }
+
+    prevPrevToken_ = prevToken_;
+    prevToken_ = token;
+}
@@ -32,6 +32,62 @@ class DParsingContext : public ParsingContext
 {
 public:
     using ParsingContext::ParsingContext;
+
+    /*!
+     * \brief nestedCommentLevel
+     * \return
+     *
+     * Return how deeply nested, in `/+ +/` comments, the scanner is. Like
+     * the start condition below, it's kept here, not in the scanner's
+     * globals, so files can be lexed concurrently.
+     */
+    int nestedCommentLevel() const { return nestedCommentLevel_; }
+    void setNestedCommentLevel(int level) { nestedCommentLevel_ = level; }
+    void enterNestedComment() { ++nestedCommentLevel_; }
+    int leaveNestedComment() { return --nestedCommentLevel_; }
+
+    /*!
+     * \brief prevStartCond
+     * \return
+     *
+     * Return the scanner's start condition to go back to once an escape
+     * sequence is lexed.
+     */
+    int prevStartCond() const { return prevStartCond_; }
+    void setPrevStartCond(int cond) { prevStartCond_ = cond; }
+
+    virtual int interceptRawToken(int token) override;
+
+    /*!
+     * \brief startsFuncBody
+     * \return
+     *
+     * A function's body is the brace following its parameters, possibly
+     * with attributes, a constraint, or contracts in between, or the brace
+     * following `body`, `do`, `out`, `unittest`, and `invariant`.
+     */
+    virtual bool startsFuncBody() const override;
+
+private:
+    void trackSignature(int token);
+    bool opensParams() const;
+    bool keepsParams(int token) const;
+
+    //! Kind of the outermost parenthesized group being lexed.
+    enum class Group : char
+    {
+        Other,
+        Params,
+        Attr
+    };
+
+    int nestedCommentLevel_ { 0 };
+    int prevStartCond_ { 0 };
+    int parenDepth_ { 0 };
+    int prevToken_ { 0 };
+    int prevPrevToken_ { 0 };
+    Group group_ { Group::Other };
+    bool afterParams_ { false };
 };
 
 } // namespace uaiso
@@ -55,22 +55,26 @@ void D_yyerror(D_YYLTYPE* yylocp,
     UAISO_UNUSED(scanner);
 
     DEBUG_TRACE("error at %d:%d %s (%s)\n",
-                yylocp->last_line, yylocp->last_column, s, yylocp->filename);
+                yylocp->last_line, yylocp->last_column, s,
+                FileRegistry::name(FileId(yylocp->file_id)).c_str());
 
     context->trackReport(Diagnostic::UnexpectedToken,
                          SourceLoc(yylocp->first_line, yylocp->first_column,
                                    yylocp->last_line, yylocp->last_column,
-                                   yylocp->filename));
+                                   FileId(yylocp->file_id)));
 }
 
 void DUnit::parseCore(TokenMap* tokens,
                       LexemeMap* lexs,
                       DParsingContext* context)
 {
-    P->ast_.reset(nullptr);
+    P->discardAst();
+    AstPool::Scope scope(&P->tree_->pool_);
+
     context->collectLexemes(lexs);
     context->collectTokens(tokens);
     context->collectReports(P->reports_.get());
+    context->setSkipBodies(P->bit_.skipBodies_);
     context->setFileName(P->fullFileName_.c_str()); // Filename for Flex actions.
 
     yyscan_t scanner = 0;
@@ -80,7 +84,14 @@ void DUnit::parseCore(TokenMap* tokens,
     }
 
     YY_BUFFER_STATE buffState = nullptr;
-    if (P->bit_.readFromFile_) {
+    if (P->bit_.readFromBuffer_) {
+        // Scan in place, the buffer comes with the padding Flex requires.
+        buffState = D_yy_scan_buffer(P->buffer_->scanBuffer(),
+                                     P->buffer_->size() + SourceBuffer::kPadding,
+                                     scanner);
+        D_yyset_lineno(0, scanner); // See Flex bug (2) in 3rdPartyBugs.txt
+        D_yyset_column(0, scanner);
+    } else if (P->bit_.readFromFile_) {
         D_yyset_in(P->file_, scanner);
     } else {
         buffState = D_yy_scan_bytes(P->source_->c_str(), P->source_->size(), scanner);
@@ -90,8 +101,9 @@ void DUnit::parseCore(TokenMap* tokens,
 
     //D_yydebug = 1;
     int success = !D_yyparse(scanner, context);
+    std::unique_ptr<Ast> ast(context->releaseAst()); // Dispose within the pool.
     if (success)
-        P->ast_.reset(context->releaseAst());
+        P->tree_->ast_ = std::move(ast);
 
     D_yy_delete_buffer(buffState, scanner);
     D_yylex_destroy(scanner);
@@ -111,3 +123,8 @@ void DUnit::parse(TokenMap* tokens,
     context.setStopMark(lineCol);
     parseCore(tokens, lexs, &context);
 }
+
+bool DUnit::canSkipBodies() const
+{
+    return true;
+}
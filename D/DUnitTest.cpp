@@ -22,6 +22,7 @@
 /*--------------------------*/
 
 #include "D/DUnit.h"
+#include "Common/Util__.h"
 #include "Parsing/UnitTest.h"
 
 using namespace uaiso;
@@ -47,6 +48,7 @@ public:
              , &DUnitTest::testCase15
              , &DUnitTest::testCase16
              , &DUnitTest::testCase17
+             , &DUnitTest::testCase18
              )
 
     const std::string baseCode() const
@@ -268,6 +270,37 @@ public:
 
         runCore(FactoryCreator::create(LangId::D), code);
     }
+
+    void testCase18()
+    {
+        std::string code = R"raw(
+            module test;
+            int foo(int a) pure nothrow {
+                string s = "}";
+                /+ { /+ } +/ +/
+                if (a) { return 1; }
+                return 0;
+            }
+            T bar(T)(T t) if (is(T : int)) {
+                return t + '}';
+            }
+            struct Point {
+                int x;
+                int line() const { return x; }
+            }
+            int i;
+        )raw";
+
+        skipBodies_ = true;
+        auto unit = runCore(FactoryCreator::create(LangId::D), code);
+        UAISO_EXPECT_INT_EQ(2, countSkippedBodies(unit.get()));
+        int decls = 0;
+        for (auto decl : *Program_Cast(unit->ast())->decls()) {
+            UAISO_UNUSED(decl);
+            ++decls;
+        }
+        UAISO_EXPECT_INT_EQ(4, decls);
+    }
 };
 
 MAKE_CLASS_TEST(DUnit)
@@ -63,7 +63,7 @@ typedef void* yyscan_t;
 /* Forward declare the context, it's a yyparse parameter. */
 namespace uaiso { class GoParsingContext; }
 
-/* Location enhanced with filename. */
+/* Location enhanced with the file id and the lexeme (if any). */
 typedef struct GO_YYLTYPE
 {
   int first_line;
@@ -71,7 +71,8 @@ typedef struct GO_YYLTYPE
   int last_line;
   int last_column;
   int prev_last_column;
-  const char* filename;
+  unsigned file_id;
+  const uaiso::Lexeme* lexeme;
 } GO_YYLTYPE;
 # define GO_YYLTYPE_IS_DECLARED 1
 # define GO_YYLTYPE_IS_TRIVIAL 1
@@ -84,7 +85,8 @@ typedef struct GO_YYLTYPE
          (Current).first_column = YYRHSLOC (Rhs, 1).first_column;       \
          (Current).last_line    = YYRHSLOC (Rhs, N).last_line;          \
          (Current).last_column  = YYRHSLOC (Rhs, N).last_column;        \
-         (Current).filename     = YYRHSLOC (Rhs, N).filename;           \
+         (Current).file_id      = YYRHSLOC (Rhs, N).file_id;            \
+         (Current).lexeme       = (N) == 1 ? YYRHSLOC (Rhs, 1).lexeme : 0; \
       }                                                                 \
       else                                                              \
       {                                                                 \
@@ -92,7 +94,8 @@ typedef struct GO_YYLTYPE
            YYRHSLOC (Rhs, 0).last_line;                                 \
          (Current).first_column = (Current).last_column =               \
            YYRHSLOC (Rhs, 0).last_column;                               \
-         (Current).filename     = 0;                                    \
+         (Current).file_id      = 0;                                    \
+         (Current).lexeme       = 0;                                    \
       }                                                                 \
     while (YYID (0))
 }
@@ -1513,8 +1516,8 @@ ImportModuleDecl:
 |   '.' StringLit
     {
         DECL_1_LOC(@1);
-        auto dot = newAst<GenNameAst>()->setGenLoc(locA);
-        context->trackLexeme<Ident>(".", locA.lineCol());
+        auto dot = newAst<GenNameAst>()->setGenLoc(locA)
+            ->setIdent(context->trackLexeme<Ident>(".", locA.lineCol()));
         $$ = newAst<ImportModuleDeclAst>()->setLocalName(dot)->setExpr($2);
     }
 ;
@@ -2480,7 +2483,7 @@ Ident:
     IDENT
     {
         DECL_1_LOC(@1);
-        $$ = newAst<SimpleNameAst>()->setNameLoc(locA);
+        $$ = newAst<SimpleNameAst>()->setNameLoc(locA)->setIdent(ConstIdent_Cast(@1.lexeme));
     }
 |   COMPLETION
     {
@@ -2523,7 +2526,7 @@ StringLit:
     STR_LIT
     {
         DECL_1_LOC(@1);
-        $$ = newAst<StrLitExprAst>()->setLitLoc(locA);
+        $$ = newAst<StrLitExprAst>()->setLitLoc(locA)->setLit(ConstStrLit_Cast(@1.lexeme));
     }
 ;
 
@@ -2531,12 +2534,14 @@ NumLit:
     INT_LIT
     {
         DECL_1_LOC(@1);
-        $$ = newAst<NumLitExprAst>()->setLitLoc(locA);
+        $$ = newAst<NumLitExprAst>()->setLitLoc(locA)->setLit(ConstNumLit_Cast(@1.lexeme))
+            ->setVariety(NumLitVariety::IntFormat);
     }
 |   FLOAT_LIT
     {
         DECL_1_LOC(@1);
-        $$ = newAst<NumLitExprAst>()->setLitLoc(locA);
+        $$ = newAst<NumLitExprAst>()->setLitLoc(locA)->setLit(ConstNumLit_Cast(@1.lexeme))
+            ->setVariety(NumLitVariety::FloatFormat);
     }
 ;
 
@@ -36,6 +36,13 @@ void GO_yyset_column(int column, yyscan_t yyscanner);
 
 using namespace uaiso;
 
+namespace {
+
+// Bits of the lexer state.
+const uint32_t kMayAddSemicolon = 1;
+
+} // anonymous
+
 GoIncrementalLexer::GoIncrementalLexer()
 {
     P->context_.reset(new GoParsingContext);
@@ -44,7 +51,9 @@ GoIncrementalLexer::GoIncrementalLexer()
 }
 
 GoIncrementalLexer::~GoIncrementalLexer()
-{}
+{
+    finish();
+}
 
 void GoIncrementalLexer::lex(const std::string& source)
 {
@@ -73,3 +82,57 @@ void GoIncrementalLexer::lex(const std::string& source)
 
     decideState();
 }
+
+void GoIncrementalLexer::resume(const char* buff, size_t len,
+                                const LineCol& lineCol, const LexerState& state)
+{
+    finish();
+    auto goContext = static_cast<GoParsingContext*>(P->context_.get());
+
+    // Whether the token preceding the resume point ends a statement, so
+    // that a semicolon is inserted at the newline following it.
+    goContext->setMayAddSemicolon(state.bits_ & kMayAddSemicolon);
+
+    if (GO_yylex_init_extra(goContext, &scanner_)) {
+        Error::log("Failed to initializer scanner.\n");
+        scanner_ = nullptr;
+        return;
+    }
+
+    bufferState_ = GO_yy_scan_bytes(buff, len, scanner_);
+    GO_yyset_lineno(lineCol.line_, scanner_);
+    GO_yyset_column(lineCol.col_, scanner_);
+
+    // An inserted semicolon is placed at the end of the preceding token,
+    // which is where lexing resumes.
+    YYLTYPE* loc = new YYLTYPE();
+    loc->first_line = loc->last_line = lineCol.line_;
+    loc->first_column = loc->last_column = lineCol.col_;
+    loc_ = loc;
+}
+
+bool GoIncrementalLexer::lexNext(LexerState& state)
+{
+    if (!scanner_)
+        return false;
+
+    auto goContext = static_cast<GoParsingContext*>(P->context_.get());
+    state.bits_ = goContext->mayAddSemicolon() ? kMayAddSemicolon : 0;
+    state.stack_.clear();
+
+    YYSTYPE sdummy;
+    return GO_yylex(&sdummy, static_cast<YYLTYPE*>(loc_), scanner_);
+}
+
+void GoIncrementalLexer::finish()
+{
+    if (!scanner_)
+        return;
+
+    GO_yy_delete_buffer(static_cast<YY_BUFFER_STATE>(bufferState_), scanner_);
+    GO_yylex_destroy(scanner_);
+    delete static_cast<YYLTYPE*>(loc_);
+    scanner_ = nullptr;
+    bufferState_ = nullptr;
+    loc_ = nullptr;
+}
@@ -40,6 +40,15 @@ public:
 
 private:
     DECL_CLASS_TEST(GoIncrementalLexer)
+
+    void resume(const char* buff, size_t len, const LineCol& lineCol,
+                const LexerState& state) override;
+    bool lexNext(LexerState& state) override;
+    void finish() override;
+
+    void* scanner_ { nullptr };      //!< Flex's yyscan_t.
+    void* bufferState_ { nullptr };  //!< Flex's YY_BUFFER_STATE.
+    void* loc_ { nullptr };          //!< Bison's YYLTYPE, kept across tokens.
 };
 
 } // namespace uaiso
@@ -23,8 +23,10 @@
 
 #include "Go/GoIncrementalLexer.h"
 #include "Parsing/IncrementalLexer__.h"
+#include "Parsing/Lexer.h"
 #include "Parsing/Phrasing.h"
 #include "Parsing/Token.h"
+#include <sstream>
 
 using namespace uaiso;
 
@@ -42,6 +44,8 @@ public:
              , &GoIncrementalLexerTest::testCase8
              , &GoIncrementalLexerTest::testCase9
              , &GoIncrementalLexerTest::testCase10
+             , &GoIncrementalLexerTest::testCase11
+             , &GoIncrementalLexerTest::testCase12
              )
 
     GoIncrementalLexer lexer_;
@@ -52,6 +56,30 @@ public:
         return std::unique_ptr<Phrasing>(lexer_.releasePhrasing());
     }
 
+    std::string dump(const Phrasing& phrasing)
+    {
+        std::ostringstream oss;
+        for (size_t i = 0; i < phrasing.size(); ++i) {
+            oss << phrasing.token(i) << "@" << phrasing.lineCol(i).line_ << ":"
+                << phrasing.lineCol(i).col_ << "/" << phrasing.length(i) << " ";
+        }
+        return oss.str();
+    }
+
+    std::string lexFromScratch(const std::string& source)
+    {
+        GoIncrementalLexer lexer;
+        IncrementalLexer::LineRange lines = lexer.lexDocument(source);
+        return dump(*lexer.phrasing(lines));
+    }
+
+    std::string all(const GoIncrementalLexer& lexer)
+    {
+        IncrementalLexer::LineRange lines;
+        lines.last_ = lexer.lineCount();
+        return dump(*lexer.phrasing(lines));
+    }
+
     void testCase1()
     {
         auto phrase = core("var ticks struct {");
@@ -178,6 +206,78 @@ public:
         UAISO_EXPECT_CONTAINER_EQ(expected, (*phrase));
         UAISO_EXPECT_TRUE(lexer_.state() == IncrementalLexer::InCode);
     }
+
+    void testCase11()
+    {
+        // Resuming after a token which ends a statement still inserts the
+        // semicolon at the newline.
+        GoIncrementalLexer lexer;
+        Phrasing scratch;
+        lexer.P->context_->collectPhrasing(&scratch);
+        const std::string code = "var a";
+        LexerState state;
+        lexer.resume(code.c_str(), code.size(), LineCol(0, 0), state);
+        while (lexer.lexNext(state)) {
+            if (!scratch.isEmpty() && scratch.token(scratch.size() - 1) == TK_IDENT)
+                break;
+        }
+        lexer.lexNext(state); // The state is saved ahead of the token.
+        lexer.finish();
+
+        scratch.clear();
+        const std::string rest = "\nb";
+        lexer.resume(rest.c_str(), rest.size(), LineCol(0, 5), state);
+        while (lexer.lexNext(state)) {}
+        lexer.finish();
+        std::vector<Token> expected { TK_SEMICOLON, TK_IDENT };
+        UAISO_EXPECT_INT_EQ(expected.size(), scratch.size());
+        UAISO_EXPECT_CONTAINER_EQ(expected, scratch);
+        UAISO_EXPECT_INT_EQ(0, scratch.lineCol(0).line_);
+        UAISO_EXPECT_INT_EQ(5, scratch.lineCol(0).col_);
+    }
+
+    void testCase12()
+    {
+        // Lexing a document incrementally is just like lexing it all over.
+        const std::string source =
+R"raw(package main
+
+func f(a int) int {
+    x := a + 1 /* one
+    more */
+    return x
+}
+
+var s = `raw
+string`
+)raw";
+        GoIncrementalLexer lexer;
+        lexer.lexDocument(source);
+        GoIncrementalLexer pieceLexer;
+        pieceLexer.lex(source);
+        std::unique_ptr<Phrasing> piece(pieceLexer.releasePhrasing());
+        UAISO_EXPECT_STR_EQ(dump(*piece), all(lexer));
+
+        std::string edited = source;
+        edited.replace(edited.find("return x"), 8, "return x + 2");
+        lexer.edit(5, 1, 1);
+        IncrementalLexer::LineRange lines = lexer.lexDocument(edited);
+        UAISO_EXPECT_TRUE(lines.first_ <= 5);
+        UAISO_EXPECT_TRUE(lines.last_ < 9);
+        UAISO_EXPECT_STR_EQ(lexFromScratch(edited), all(lexer));
+
+        // Remove the statement's end, so the semicolon moves one line down.
+        edited.replace(edited.find("a + 1"), 5, "a +\n1");
+        lexer.edit(3, 1, 2);
+        lexer.lexDocument(edited);
+        UAISO_EXPECT_STR_EQ(lexFromScratch(edited), all(lexer));
+
+        // And open a raw string that swallows the rest.
+        edited.replace(edited.find("func f"), 6, "func `f");
+        lexer.edit(2, 1, 1);
+        lexer.lexDocument(edited);
+        UAISO_EXPECT_STR_EQ(lexFromScratch(edited), all(lexer));
+    }
 };
 
 MAKE_CLASS_TEST(GoIncrementalLexer)
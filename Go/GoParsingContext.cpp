@@ -30,10 +30,68 @@ using namespace uaiso;
 
 GoParsingContext::GoParsingContext()
     : mayAddSemicolon_(false)
+    , inSignature_(false)
+    , prevStartCond_(0)
+    , parenDepth_(0)
+    , braceDepth_(0)
+    , prevToken_(0)
 {}
 
+bool GoParsingContext::startsFuncBody() const
+{
+    return skipBodies()
+            && inSignature_
+            && !parenDepth_
+            && !braceDepth_
+            && prevToken_ != TK_STRUCT
+            && prevToken_ != TK_INTERFACE;
+}
+
+void GoParsingContext::trackSignature(int token)
+{
+    switch (token) {
+    case TK_FUNC:
+        if (!parenDepth_ && !braceDepth_)
+            inSignature_ = true;
+        break;
+
+    case TK_LPAREN:
+        ++parenDepth_;
+        break;
+
+    case TK_RPAREN:
+        if (parenDepth_)
+            --parenDepth_;
+        break;
+
+    case TK_LBRACE:
+        if (startsFuncBody())
+            inSignature_ = false;
+        ++braceDepth_;
+        break;
+
+    case TK_RBRACE:
+        if (braceDepth_)
+            --braceDepth_;
+        break;
+
+    case TK_SEMICOLON:
+        if (!parenDepth_ && !braceDepth_)
+            inSignature_ = false;
+        break;
+
+    default:
+        break;
+    }
+
+    prevToken_ = token;
+}
+
 int GoParsingContext::interceptRawToken(int token)
 {
+    if (skipBodies())
+        trackSignature(token);
+
     switch (token) {
     case TK_COMPLETION:
     case TK_IDENT:
@@ -35,11 +35,40 @@ public:
 
     bool mayAddSemicolon() const { return mayAddSemicolon_; }
     void clearSemicolonInfo() { mayAddSemicolon_ = false; }
+    void setMayAddSemicolon(bool may) { mayAddSemicolon_ = may; }
+
+    /*!
+     * \brief prevStartCond
+     * \return
+     *
+     * Return the scanner's start condition to go back to once an escape
+     * sequence is lexed. It's kept here, not in the scanner's globals, so
+     * files can be lexed concurrently.
+     */
+    int prevStartCond() const { return prevStartCond_; }
+    void setPrevStartCond(int cond) { prevStartCond_ = cond; }
 
     virtual int interceptRawToken(int token) override;
 
+    /*!
+     * \brief startsFuncBody
+     * \return
+     *
+     * A function's body is the first brace, outside parentheses and braces,
+     * after the `func` keyword, except for the one of a struct or interface
+     * type in the function's result.
+     */
+    virtual bool startsFuncBody() const override;
+
 private:
+    void trackSignature(int token);
+
     bool mayAddSemicolon_;
+    bool inSignature_;
+    int prevStartCond_;
+    int parenDepth_;
+    int braceDepth_;
+    int prevToken_;
 };
 
 } // namespace uaiso
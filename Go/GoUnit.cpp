@@ -51,22 +51,26 @@ void GO_yyerror(const GO_YYLTYPE* yylocp,
                 const char *s)
 {
     DEBUG_TRACE("error at %d:%d %s (%s)\n",
-                yylocp->last_line, yylocp->last_column, s, yylocp->filename);
+                yylocp->last_line, yylocp->last_column, s,
+                FileRegistry::name(FileId(yylocp->file_id)).c_str());
 
     context->trackReport(Diagnostic::UnexpectedToken,
                          SourceLoc(yylocp->first_line, yylocp->first_column,
                                    yylocp->last_line, yylocp->last_column,
-                                   yylocp->filename));
+                                   FileId(yylocp->file_id)));
 }
 
 void GoUnit::parseCore(TokenMap* tokens,
                        LexemeMap* lexs,
                        GoParsingContext* context)
 {
-    P->ast_.reset(nullptr);
+    P->discardAst();
+    AstPool::Scope scope(&P->tree_->pool_);
+
     context->collectLexemes(lexs);
     context->collectTokens(tokens);
     context->collectReports(P->reports_.get());
+    context->setSkipBodies(P->bit_.skipBodies_);
     context->setFileName(P->fullFileName_.c_str()); // Filename for Flex actions.
 
     yyscan_t scanner = 0;
@@ -76,7 +80,14 @@ void GoUnit::parseCore(TokenMap* tokens,
     }
 
     YY_BUFFER_STATE buffState = nullptr;
-    if (P->bit_.readFromFile_) {
+    if (P->bit_.readFromBuffer_) {
+        // Scan in place, the buffer comes with the padding Flex requires.
+        buffState = GO_yy_scan_buffer(P->buffer_->scanBuffer(),
+                                      P->buffer_->size() + SourceBuffer::kPadding,
+                                      scanner);
+        GO_yyset_lineno(0, scanner); // See Flex bug (2) in 3rdPartyBugs.txt
+        GO_yyset_column(0, scanner);
+    } else if (P->bit_.readFromFile_) {
         GO_yyset_in(P->file_, scanner);
     } else {
         buffState = GO_yy_scan_bytes(P->source_->c_str(), P->source_->size(), scanner);
@@ -86,8 +97,9 @@ void GoUnit::parseCore(TokenMap* tokens,
 
     //GO_yydebug = 1;
     int success = !GO_yyparse(scanner, context);
+    std::unique_ptr<Ast> ast(context->releaseAst()); // Dispose within the pool.
     if (success)
-        P->ast_.reset(context->releaseAst());
+        P->tree_->ast_ = std::move(ast);
 
     GO_yy_delete_buffer(buffState, scanner);
     GO_yylex_destroy(scanner);
@@ -107,3 +119,8 @@ void GoUnit::parse(TokenMap* tokens,
     context.setStopMark(lineCol);
     parseCore(tokens, lexs, &context);
 }
+
+bool GoUnit::canSkipBodies() const
+{
+    return true;
+}
@@ -22,6 +22,7 @@
 /*--------------------------*/
 
 #include "Go/GoUnit.h"
+#include "Common/Util__.h"
 #include "Parsing/UnitTest.h"
 
 using namespace uaiso;
@@ -61,6 +62,7 @@ public:
              , &GoUnitTest::testCase29
              , &GoUnitTest::testCase30
              , &GoUnitTest::testCase31
+             , &GoUnitTest::testCase32
              )
 
     const std::string baseCode() const
@@ -438,6 +440,39 @@ public:
 
         runCore(FactoryCreator::create(LangId::Go), code);
     }
+
+    void testCase32()
+    {
+        std::string code = R"raw(
+            package main
+            type Point struct {
+                line int
+            }
+            func (p Point) Line() struct{ n int } {
+                s := "}"
+                if p.line > 0 {
+                    return struct{ n int }{p.line}
+                }
+                return struct{ n int }{len(`{` + s)}
+            }
+            func calc(total int) (int, error) {
+                f := func() { /* } */ }
+                f() // }
+                return total, nil
+            }
+            var i = calc
+        )raw";
+
+        skipBodies_ = true;
+        auto unit = runCore(FactoryCreator::create(LangId::Go), code);
+        UAISO_EXPECT_INT_EQ(2, countSkippedBodies(unit.get()));
+        int decls = 0;
+        for (auto decl : *Program_Cast(unit->ast())->decls()) {
+            UAISO_UNUSED(decl);
+            ++decls;
+        }
+        UAISO_EXPECT_INT_EQ(4, decls);
+    }
 };
 
 MAKE_CLASS_TEST(GoUnit)
@@ -25,7 +25,22 @@
 
 using namespace uaiso;
 
+namespace {
+
+constexpr CharClassTable hsCharClasses()
+{
+    auto table = CharClassTable::standard();
+    table.remove('b', CharClassTable::BinPrefix);
+    table.remove('B', CharClassTable::BinPrefix);
+    return table;
+}
+
+constexpr CharClassTable charClassTable = hsCharClasses();
+
+} // anonymous
+
 HsLang::HsLang()
+    : Lang(&charClassTable)
 {}
 
 Lang::Structure HsLang::structure() const
@@ -39,8 +39,6 @@ public:
 
     std::string sourceFileSuffix() const override;
 
-    bool isBinPrefix(char ch) const override { return false; }
-
     bool hasStrictDecimalPoint() const override { return true; }
 
     bool hasStrLitJoinEscape() const override { return true; }
@@ -176,7 +176,7 @@ LexNextToken:
     case '"':
     case '\'':
         tk = lexStrLit(ch, false, &hsLang);
-        context_->trackLexeme<StrLit>(mark_, curr_ - mark_, LineCol(line_, col_));
+        lexeme_ = context_->trackLexeme<StrLit>(mark_, curr_ - mark_, LineCol(line_, col_));
         break;
 
     default:
@@ -187,7 +187,7 @@ LexNextToken:
 
         if (std::isdigit(ch)) {
             tk = lexNumLit(ch, &hsLang);
-            context_->trackLexeme<NumLit>(mark_, curr_ - mark_, LineCol(line_, col_));
+            lexeme_ = context_->trackLexeme<NumLit>(mark_, curr_ - mark_, LineCol(line_, col_));
             break;
         }
 
@@ -372,7 +372,7 @@ void HsLexer::inspectKeyword(Token tk)
 Token HsLexer::classifyIdent(char& ch)
 {
     if (mark_[0] >= 97) {
-        context_->trackLexeme<Ident>(mark_, curr_ - mark_, LineCol(line_, col_));
+        lexeme_ = context_->trackLexeme<Ident>(mark_, curr_ - mark_, LineCol(line_, col_));
         return TK_IDENT;
     }
 
@@ -383,7 +383,7 @@ Token HsLexer::classifyIdent(char& ch)
 
     std::function<void ()> classifyRecursively = [&]() {
         if (ch != '.') {
-            context_->trackLexeme<Ident>(mark_, curr_ - mark_, LineCol(line_, col_));
+            lexeme_ = context_->trackLexeme<Ident>(mark_, curr_ - mark_, LineCol(line_, col_));
             return;
         }
 
@@ -392,9 +392,8 @@ Token HsLexer::classifyIdent(char& ch)
         char next = peekChar(1);
 
         if (hsLang.isIdentChar(next)) {
-            ch = consumeCharPeekNext(1);
-            while (hsLang.isIdentChar(ch))
-                ch = consumeCharPeekNext();
+            consumeChar(1);
+            ch = consumeWhile(hsLang.charClasses(), CharClassTable::Ident);
             tk = TK_CAPITAL_IDENT_LIST;
             classifyRecursively();
         }
@@ -403,7 +402,7 @@ Token HsLexer::classifyIdent(char& ch)
             ch = consumeCharPeekNext(1);
             while (isAscSymbol(ch))
                 ch = consumeCharPeekNext();
-            context_->trackLexeme<Ident>(mark_, curr_ - mark_, LineCol(line_, col_));
+            lexeme_ = context_->trackLexeme<Ident>(mark_, curr_ - mark_, LineCol(line_, col_));
             tk = TK_QUALIFIED_OPRTR;
         }
     };
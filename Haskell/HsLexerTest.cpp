@@ -663,4 +663,17 @@ void HsLexer::HsLexerTest::testCase39()
 {}
 
 void HsLexer::HsLexerTest::testCase40()
-{}
+{
+    // Fixity declarations, all three are reserved (but not their prefixes
+    // or extensions).
+    auto tks = core("infixl 6 + infixr 5 + infix 4 + infi infixlr");
+
+    std::vector<Token> expected {
+        TK_INFIXL, TK_INT_LIT, TK_PLUS,
+        TK_INFIXR, TK_INT_LIT, TK_PLUS,
+        TK_INFIX, TK_INT_LIT, TK_PLUS,
+        TK_IDENT, TK_IDENT, TK_EOP
+    };
+    UAISO_EXPECT_INT_EQ(expected.size(), tks.size());
+    UAISO_EXPECT_CONTAINER_EQ(expected, tks);
+}
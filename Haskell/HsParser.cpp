@@ -64,11 +64,13 @@ Parser::Expr HsParser::parseAExpr()
     case TK_INT_LIT:
         consumeToken();
         return Expr(newAst<NumLitExprAst>()->setLitLoc(lastLoc_)
+                    ->setLit(ConstNumLit_Cast(lastLexeme_))
                     ->setVariety(NumLitVariety::IntFormat));
 
     case TK_FLOAT_LIT:
         consumeToken();
         return Expr(newAst<NumLitExprAst>()->setLitLoc(lastLoc_)
+                    ->setLit(ConstNumLit_Cast(lastLexeme_))
                     ->setVariety(NumLitVariety::FloatFormat));
 
     case TK_TRUE_VALUE:
@@ -24,6 +24,8 @@
 #include "Ast/Ast.h"
 #include "Ast/AstVisitor.h"
 #include "Ast/AstDumper.h"
+#include "Ast/AstPool.h"
+#include "Ast/AstSerializer.h"
 #include "Common/Assert.h"
 #include "Common/FileInfo.h"
 #include "Common/Test.h"
@@ -36,22 +38,28 @@
 #include "Haskell/HsLexer.h"
 #include "Haskell/HsParser.h"
 #include "Parsing/Factory.h"
+#include "Parsing/FileRegistry.h"
 #include "Parsing/LexemeMap.h"
+#include "Parsing/SourceBuffer.h"
 #include "Parsing/TokenMap.h"
 #include "Parsing/Unit.h"
+#include "Python/PyIncrementalLexer.h"
 #include "Python/PyLexer.h"
 #include "Python/PyParser.h"
 #include "Semantic/Binder.h"
 #include "Semantic/CompletionProposer.h"
+#include "Semantic/CompletionRanker.h"
 #include "Semantic/CompletionTest.h"
 #include "Semantic/Environment.h"
 #include "Semantic/ImportResolver.h"
 #include "Semantic/Program.h"
+#include "Semantic/ProgramCache.h"
 #include "Semantic/Sanitizer.h"
 #include "Semantic/Snapshot.h"
 #include "Semantic/Symbol.h"
 #include "Semantic/Type.h"
 #include "Semantic/TypeChecker.h"
+#include "Semantic/TypeInterner.h"
 #include "StringUtils/string.hpp"
 #include <cstring>
 #include <fstream>
@@ -84,19 +92,30 @@ std::vector<std::string> readSearchPaths()
     return paths;
 }
 
+CALL_CLASS_TEST(AstPool)
+CALL_CLASS_TEST(AstSerializer)
 CALL_CLASS_TEST(Binder)
 CALL_CLASS_TEST(DIncrementalLexer)
 CALL_CLASS_TEST(DUnit)
 CALL_CLASS_TEST(CompletionProposer)
+CALL_CLASS_TEST(CompletionRanker)
 CALL_CLASS_TEST(Environment)
 CALL_CLASS_TEST(FileInfo)
+CALL_CLASS_TEST(FileRegistry)
 CALL_CLASS_TEST(GoIncrementalLexer)
 CALL_CLASS_TEST(GoUnit)
 CALL_CLASS_TEST(HsLexer)
 CALL_CLASS_TEST(HsParser)
+CALL_CLASS_TEST(ImportResolver)
+CALL_CLASS_TEST(LexemeMap)
+CALL_CLASS_TEST(ProgramCache)
+CALL_CLASS_TEST(PyIncrementalLexer)
 CALL_CLASS_TEST(PyLexer)
 CALL_CLASS_TEST(PyParser)
+CALL_CLASS_TEST(Snapshot)
+CALL_CLASS_TEST(SourceBuffer)
 CALL_CLASS_TEST(TypeChecker)
+CALL_CLASS_TEST(TypeInterner)
 
 class WorkflowTest : public Test
 {
@@ -106,7 +125,6 @@ public:
     WorkflowTest()
         : debug_(false)
         , singlePass_(false)
-        , file_(nullptr)
     {}
 
     void testAll()
@@ -125,8 +143,8 @@ public:
     {
         std::cout << fileName_ << std::endl;
 
-        file_ = fopen(fileName_.c_str(), "r");
-        if (!file_) {
+        auto buffer = SourceBuffer::load(fileName_);
+        if (!buffer) {
             UAISO_FAIL_TEST("cannot open file");
             return;
         }
@@ -145,9 +163,8 @@ public:
 
         std::unique_ptr<Unit> unit(factory->makeUnit());
         unit->setFileName(fileName_);
-        unit->assignInput(file_);
+        unit->assignInput(buffer.get());
         unit->parse(&tokens_, &lexs_);
-        fclose(file_);
         std::unique_ptr<DiagnosticReports> reports(unit->releaseReports());
         UAISO_EXPECT_INT_EQ(0, reports->size());
         UAISO_EXPECT_TRUE(unit->ast());
@@ -163,7 +180,6 @@ public:
         UAISO_EXPECT_FALSE(prog->env().isEmpty());
 
         TypeChecker typeChecker(factory.get());
-        typeChecker.setLexemes(&lexs_);
         typeChecker.setTokens(&tokens_);
         typeChecker.collectDiagnostics(reports.get());
         UAISO_EXPECT_INT_EQ(0, reports->size());
@@ -172,7 +188,6 @@ public:
 
     bool debug_;
     bool singlePass_;
-    FILE* file_;
     std::string fileName_;
     LexemeMap lexs_;
     TokenMap tokens_;
@@ -392,15 +407,26 @@ int main(int argc, char* argv[])
     workflowTest.run();
 
     if (!workflowTest.singlePass_) {
+        test_AstPool();
+        test_AstSerializer();
         test_FileInfo();
+        test_FileRegistry();
+        test_LexemeMap();
+        test_SourceBuffer();
         test_Environment();
+        test_Snapshot();
+        test_ProgramCache();
+        test_ImportResolver();
         test_Binder();
         test_TypeChecker();
+        test_TypeInterner();
+        test_CompletionRanker();
         test_CompletionProposer();
         test_DIncrementalLexer();
         test_DUnit();
         test_GoIncrementalLexer();
         test_GoUnit();
+        test_PyIncrementalLexer();
         test_PyLexer();
         test_PyParser();
         test_HsLexer();
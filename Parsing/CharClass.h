@@ -0,0 +1,139 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#ifndef UAISO_CHARCLASS_H__
+#define UAISO_CHARCLASS_H__
+
+#include <cstdint>
+
+namespace uaiso {
+
+/*!
+ * \brief The CharClassTable class
+ *
+ * A 256-entry table mapping every character into the set of lexical classes
+ * it belongs to. A Lang is built with one such table (typically a constexpr
+ * one), so the lexers classify a character with a single load instead of a
+ * virtual call or a locale-aware ctype function.
+ */
+class CharClassTable final
+{
+public:
+    /*!
+     * \brief The Class enum
+     *
+     * Each value is a distinct bit, so a character may be in many classes.
+     */
+    enum Class : uint16_t
+    {
+        IdentFirst  = 1 << 0,
+        Ident       = 1 << 1,
+        Digit       = 1 << 2,
+        HexDigit    = 1 << 3,
+        Space       = 1 << 4,   //!< Blank within a line (not a newline).
+        Quote       = 1 << 5,   //!< Delimiter of a string literal.
+        Escape      = 1 << 6,   //!< Valid after a backslash in a string literal.
+        OctalPrefix = 1 << 7,
+        HexPrefix   = 1 << 8,
+        BinPrefix   = 1 << 9,
+        LongSuffix  = 1 << 10,
+        Exponent    = 1 << 11,
+    };
+
+    constexpr CharClassTable() : classes_() {}
+
+    /*!
+     * \brief is
+     * \param ch
+     * \param cls
+     * \return
+     *
+     * Return whether \a ch is in any of the classes in \a cls.
+     */
+    constexpr bool is(char ch, uint16_t cls) const
+    {
+        return classes_[static_cast<unsigned char>(ch)] & cls;
+    }
+
+    //! Put \a ch into the classes \a cls.
+    constexpr void add(char ch, uint16_t cls)
+    {
+        classes_[static_cast<unsigned char>(ch)] |= cls;
+    }
+
+    //! Put every character in range [\a first, \a last] into the classes \a cls.
+    constexpr void add(char first, char last, uint16_t cls)
+    {
+        for (int ch = static_cast<unsigned char>(first);
+                ch <= static_cast<unsigned char>(last); ++ch) {
+            classes_[ch] |= cls;
+        }
+    }
+
+    //! Take \a ch out of the classes \a cls.
+    constexpr void remove(char ch, uint16_t cls)
+    {
+        classes_[static_cast<unsigned char>(ch)] &= ~cls;
+    }
+
+    /*!
+     * \brief standard
+     * \return
+     *
+     * Return the classification shared by most languages: C-like identifiers
+     * and numbers, double-quoted strings with any printable escape.
+     */
+    static constexpr CharClassTable standard()
+    {
+        CharClassTable table;
+        table.add('a', 'z', IdentFirst | Ident);
+        table.add('A', 'Z', IdentFirst | Ident);
+        table.add('_', IdentFirst | Ident);
+        table.add('0', '9', Ident | Digit | HexDigit);
+        table.add('a', 'f', HexDigit);
+        table.add('A', 'F', HexDigit);
+        table.add(' ', Space);
+        table.add('\t', Space);
+        table.add('\f', Space);
+        table.add('"', Quote);
+        table.add(' ', '~', Escape);
+        table.add('o', OctalPrefix);
+        table.add('O', OctalPrefix);
+        table.add('x', HexPrefix);
+        table.add('X', HexPrefix);
+        table.add('b', BinPrefix);
+        table.add('B', BinPrefix);
+        table.add('l', LongSuffix);
+        table.add('L', LongSuffix);
+        table.add('e', Exponent);
+        table.add('E', Exponent);
+        return table;
+    }
+
+private:
+    uint16_t classes_[256];
+};
+
+} // namespace uaiso
+
+#endif
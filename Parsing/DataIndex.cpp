@@ -20,65 +20,302 @@
 /*--------------------------*/
 /*--- The UaiSo! Project ---*/
 /*--------------------------*/
-
 #include "Parsing/Lexeme.h"
 #include "Parsing/LexemeMap.h"
 #include "Parsing/SourceLoc.h"
 #include "Parsing/TokenMap.h"
 #include "Common/LineCol.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
-#include <unordered_set>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 using namespace uaiso;
 
 namespace {
 
-template <class DataT>
-struct DataIndex
+// A line/col as a single integer with the same ordering.
+inline uint64_t posKey(const LineCol& lineCol)
 {
-    using Data = std::unordered_set<DataT>;
-    using LineColIndex = std::unordered_map<LineCol, typename Data::const_iterator>;
-    using FileIndex = std::unordered_map<std::string, std::unique_ptr<LineColIndex>>;
+    return (uint64_t(uint32_t(lineCol.line_) ^ 0x80000000u) << 32)
+            | (uint32_t(lineCol.col_) ^ 0x80000000u);
+}
 
-    Data data_;
-    FileIndex fileIndex_;
-};
+/*
+ * The values at each line/col of a file, sorted by position, in separate
+ * arrays. Since values arrive in source order while lexing, an insertion
+ * is typically an append.
+ */
+template <class ValueT>
+struct LineColIndex
+{
+    size_t lowerBound(const LineCol& lineCol) const
+    {
+        const uint64_t key = posKey(lineCol);
+        size_t size = lineCols_.size();
+        if (!size || posKey(lineCols_.back()) < key)
+            return size;
+
+        // Branchless binary search.
+        const LineCol* base = lineCols_.data();
+        while (size > 1) {
+            size_t half = size / 2;
+            base = posKey(base[half - 1]) < key ? base + half : base;
+            size -= half;
+        }
+        return (base - lineCols_.data()) + (posKey(*base) < key);
+    }
 
-} // anonymous
+    const ValueT* find(const LineCol& lineCol) const
+    {
+        size_t idx = lowerBound(lineCol);
+        if (idx == lineCols_.size() || posKey(lineCols_[idx]) != posKey(lineCol))
+            return nullptr;
+        return &values_[idx];
+    }
+
+    /*
+     * Insert \a value at \a lineCol unless there's a value there already.
+     * Return the value at the position.
+     */
+    template <class MakeValueT>
+    ValueT insertOrFind(const LineCol& lineCol, MakeValueT makeValue)
+    {
+        size_t idx = lowerBound(lineCol);
+        if (idx != lineCols_.size() && posKey(lineCols_[idx]) == posKey(lineCol))
+            return values_[idx];
+
+        ValueT value = makeValue();
+        if (idx == lineCols_.size()) {
+            lineCols_.push_back(lineCol);
+            values_.push_back(value);
+        } else {
+            lineCols_.insert(lineCols_.begin() + idx, lineCol);
+            values_.insert(values_.begin() + idx, value);
+        }
+        return value;
+    }
+
+    void clear()
+    {
+        lineCols_.clear();
+        values_.clear();
+    }
 
-namespace std {
+    std::vector<LineCol> lineCols_;
+    std::vector<ValueT> values_;
+};
 
-// As for the equal value, this is an specialization that computes that hash
-// value of a lexeme based on the underlying string (not on the pointer).
-template <> struct hash<std::unique_ptr<Lexeme>>
+/*
+ * Index of the values at each line/col of each file. A file's index is only
+ * filled by the thread that is parsing that file, but different files may
+ * be parsed concurrently, so the map of files is guarded. Clearing a file
+ * drops its index rather than emptying it, so one that's been retained
+ * stays as it was.
+ */
+template <class ValueT>
+struct PosIndex
 {
-    size_t operator()(const std::unique_ptr<Lexeme>& value) const
+    using ByFile = LineColIndex<ValueT>;
+
+    ByFile* fetch(FileId fileId)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& byFile = files_[fileId];
+        if (!byFile)
+            byFile = std::make_shared<ByFile>();
+        return byFile.get();
+    }
+
+    const ByFile* find(FileId fileId) const
     {
-        return std::hash<std::string>()(value->s_);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto byFileIt = files_.find(fileId);
+        if (byFileIt == files_.end())
+            return nullptr;
+        return byFileIt->second.get();
     }
+
+    std::shared_ptr<ByFile> share(FileId fileId) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto byFileIt = files_.find(fileId);
+        if (byFileIt == files_.end())
+            return std::shared_ptr<ByFile>();
+        return byFileIt->second;
+    }
+
+    void clear(FileId fileId)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        files_.erase(fileId);
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        files_.clear();
+    }
+
+    mutable std::mutex mutex_;
+    std::unordered_map<FileId, std::shared_ptr<ByFile>> files_;
 };
 
-// As for the hash value, this is an specialization that computes whether two
-// lexemes are equal based on the underlying string (not on the pointer).
-template <> struct equal_to<std::unique_ptr<Lexeme>>
+// FNV-1a over the spelling, seeded by the lexeme kind.
+size_t hashSpell(Lexeme::Kind kind, const char* spell, size_t len)
 {
-    bool operator()(const std::unique_ptr<Lexeme>& a,
-                    const std::unique_ptr<Lexeme>& b) const
+    uint64_t h = 14695981039346656037ULL ^ static_cast<uint64_t>(kind);
+    for (size_t i = 0; i < len; ++i) {
+        h ^= static_cast<unsigned char>(spell[i]);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+const size_t kShardBits = 5;
+const size_t kShardCount = size_t(1) << kShardBits;
+const size_t kMinSlots = 64;
+
+// Source of lexeme map stamps.
+std::atomic<uint64_t> nextStamp { 0 };
+
+} // anonymous
+
+namespace uaiso {
+
+/*
+ * Interner of lexemes, safe to be used from multiple threads. Lexemes are
+ * spread across shards by the hash of their spelling (and kind), each shard
+ * has its own lock and an open addressing table. Lookups take the raw
+ * spelling, no temporary lexeme is needed. Once interned, a lexeme never
+ * moves, so pointers to it remain valid until the interner is cleared.
+ */
+class LexemeInterner final
+{
+public:
+    template <class ValueT>
+    const ValueT* insertOrFind(const char* spell, size_t len)
+    {
+        const auto kind = ValueT::kKind;
+        const size_t hash = hashSpell(kind, spell, len);
+        Shard& shard = shards_[shardOf(hash)];
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        size_t slot = shard.probe(hash, kind, spell, len);
+        if (!shard.slots_[slot].lex_) {
+            shard.lexs_.emplace_back(new ValueT(std::string(spell, len)));
+            shard.slots_[slot] = Slot { hash, shard.lexs_.back().get() };
+            if (shard.lexs_.size() * 2 > shard.slots_.size())
+                shard.grow();
+            return static_cast<const ValueT*>(shard.lexs_.back().get());
+        }
+        return static_cast<const ValueT*>(shard.slots_[slot].lex_);
+    }
+
+    template <class ValueT>
+    const ValueT* find(const char* spell, size_t len) const
+    {
+        const auto kind = ValueT::kKind;
+        const size_t hash = hashSpell(kind, spell, len);
+        const Shard& shard = shards_[shardOf(hash)];
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        size_t slot = shard.probe(hash, kind, spell, len);
+        return static_cast<const ValueT*>(shard.slots_[slot].lex_);
+    }
+
+    void clear()
     {
-        return a->s_ == b->s_;
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            shard.reset();
+        }
     }
+
+private:
+    // The low bits of the hash pick the slot, the high bits the shard.
+    static size_t shardOf(size_t hash)
+    {
+        return hash >> (sizeof(size_t) * 8 - kShardBits);
+    }
+
+    struct Slot
+    {
+        size_t hash_;
+        Lexeme* lex_;
+    };
+
+    struct Shard
+    {
+        Shard() { reset(); }
+
+        /*
+         * Return the slot where the lexeme is, or the empty slot where it
+         * should be inserted.
+         */
+        size_t probe(size_t hash,
+                     Lexeme::Kind kind,
+                     const char* spell,
+                     size_t len) const
+        {
+            const size_t mask = slots_.size() - 1;
+            size_t slot = hash & mask;
+            while (slots_[slot].lex_) {
+                const Slot& cur = slots_[slot];
+                if (cur.hash_ == hash
+                        && cur.lex_->kind_ == kind
+                        && cur.lex_->s_.size() == len
+                        && !std::memcmp(cur.lex_->s_.data(), spell, len)) {
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+            return slot;
+        }
+
+        void grow()
+        {
+            std::vector<Slot> slots(slots_.size() * 2, Slot { 0, nullptr });
+            const size_t mask = slots.size() - 1;
+            for (const auto& cur : slots_) {
+                if (!cur.lex_)
+                    continue;
+                size_t slot = cur.hash_ & mask;
+                while (slots[slot].lex_)
+                    slot = (slot + 1) & mask;
+                slots[slot] = cur;
+            }
+            slots_.swap(slots);
+        }
+
+        void reset()
+        {
+            slots_.assign(kMinSlots, Slot { 0, nullptr });
+            lexs_.clear();
+        }
+
+        mutable std::mutex mutex_;
+        std::vector<Slot> slots_;
+        std::vector<std::unique_ptr<Lexeme>> lexs_;
+    };
+
+    std::array<Shard, kShardCount> shards_;
 };
 
-} // namespace std
+} // namespace uaiso
 
 
     /*--- LexemeMap ---*/
 
 struct uaiso::LexemeMap::LexemeMapImpl
-        : public DataIndex<std::unique_ptr<Lexeme>>
 {
+    LexemeInterner interner_;
+    PosIndex<const Lexeme*> posIndex_;
     const Ident* self_ { nullptr };
+    uint64_t stamp_ { ++nextStamp };
 };
 
 LexemeMap::LexemeMap()
@@ -90,6 +327,11 @@ LexemeMap::LexemeMap()
 LexemeMap::~LexemeMap()
 {}
 
+uint64_t LexemeMap::stamp() const
+{
+    return P->stamp_;
+}
+
 const Ident* LexemeMap::self() const
 {
     return P->self_;
@@ -97,130 +339,124 @@ const Ident* LexemeMap::self() const
 
 void LexemeMap::insertPredefined()
 {
-    P->self_ = insertOrFind<Ident>("self", "<__predefined__>", LineCol(-1, -1));
+    P->self_ = insertOrFind<Ident>("self",
+                                   FileRegistry::insertOrFind("<__predefined__>"),
+                                   LineCol(-1, -1));
 }
 
-namespace {
-
 template <class ValueT>
-DataIndex<std::unique_ptr<Lexeme>>::Data::const_iterator
-findDataIt(const std::string& spell,
-           const DataIndex<std::unique_ptr<Lexeme>>::Data& data)
+const ValueT* LexemeMap::insertOrFind(const std::string& spell,
+                                      FileId fileId,
+                                      const LineCol& lineCol)
 {
-    // A hack to allow looking it up without actually allocating a new value.
-    static char local[sizeof(ValueT)];
-    std::unique_ptr<Lexeme> helper(new (local) ValueT(spell));
-    auto it = data.find(helper);
-    helper.release();
-
-    return it;
+    return insertOrFind<ValueT>(spell.c_str(), spell.length(), fileId, lineCol);
 }
 
-} // namespace anonymous
-
 template <class ValueT>
-const ValueT* LexemeMap::insertOrFind(const std::string& spell,
-                                      const std::string& fullFileName,
+const ValueT* LexemeMap::insertOrFind(const char* spell,
+                                      size_t len,
+                                      FileId fileId,
                                       const LineCol& lineCol)
 {
-    auto &byFile = P->fileIndex_[fullFileName];
-    if (!byFile) {
-        byFile.reset(new DataIndex<std::unique_ptr<Lexeme>>::LineColIndex);
-    } else {
-        auto posIt = byFile->find(lineCol);
-        if (posIt != byFile->end())
-            return static_cast<const ValueT*>(posIt->second->get());
-    }
-
-    // A mapping for this line/col doesn't exist, but this value might be in
-    // global index (from another occurrence). If not, we must create it.
-    auto valIt = findDataIt<ValueT>(spell, P->data_);
-    if (valIt == P->data_.end())
-        valIt = P->data_.emplace(new ValueT(spell)).first;
-
-    // Now, add a mapping from the line/col to the value.
-    byFile->emplace(lineCol, valIt);
+    // If there's no lexeme at this line/col, the value might be interned
+    // already (from another occurrence). If not, it's created.
+    auto byFile = P->posIndex_.fetch(fileId);
+    auto value = byFile->insertOrFind(lineCol, [this, spell, len] () {
+        return static_cast<const Lexeme*>(
+                    P->interner_.insertOrFind<ValueT>(spell, len));
+    });
+
+    return static_cast<const ValueT*>(value);
+}
 
-    return static_cast<const ValueT*>(valIt->get());
+template <class ValueT>
+const ValueT* LexemeMap::intern(const std::string& spell)
+{
+    return P->interner_.insertOrFind<ValueT>(spell.c_str(), spell.length());
 }
 
 template <class ValueT>
-const ValueT* LexemeMap::findAt(const std::string& fullFileName,
+const ValueT* LexemeMap::findAt(FileId fileId,
                                 const LineCol& lineCol) const
 {
-    auto byFileIt = P->fileIndex_.find(fullFileName);
-    if (byFileIt == P->fileIndex_.end()
-            || !byFileIt->second) {
+    auto byFile = P->posIndex_.find(fileId);
+    if (!byFile)
         return nullptr;
-    }
 
-    auto it = byFileIt->second->find(lineCol);
-    if (it == byFileIt->second->end())
+    auto value = byFile->find(lineCol);
+    if (!value)
         return nullptr;
 
-    return static_cast<const ValueT*>(it->second->get());
+    return static_cast<const ValueT*>(*value);
 }
 
 template <class ValueT>
 const ValueT* LexemeMap::findAnyOf(const std::string& spell) const
 {
-    auto valIt = findDataIt<ValueT>(spell, P->data_);
-    if (valIt == P->data_.end())
-        return nullptr;
-    return static_cast<const ValueT*>(valIt->get());
+    return P->interner_.find<ValueT>(spell.c_str(), spell.length());
 }
 
 template <class ValueT>
-std::vector<std::tuple<const ValueT*, LineCol>>
-LexemeMap::list(const std::string& fullFileName) const
+LexemeMap::Range<ValueT> LexemeMap::list(FileId fileId) const
 {
-    std::vector<std::tuple<const ValueT*, LineCol>> v;
-
-    auto byFileIt = P->fileIndex_.find(fullFileName);
-    if (byFileIt == P->fileIndex_.end() || !byFileIt->second)
-        return v;
+    auto byFile = P->posIndex_.find(fileId);
+    if (!byFile)
+        return Range<ValueT>();
 
-    for (auto pos : *byFileIt->second) {
-        const LineCol& lineCol = pos.first;
-        const ValueT* value = static_cast<const ValueT*>(pos.second->get());
-        v.push_back(std::make_tuple(value, lineCol));
-    }
-
-    return v;
+    return Range<ValueT>(byFile->values_.data(),
+                         byFile->lineCols_.data(),
+                         byFile->values_.size());
 }
 
 void LexemeMap::clear()
 {
-    P->data_.clear();
-    P->fileIndex_.clear();
+    P->interner_.clear();
+    P->posIndex_.clear();
+    P->stamp_ = ++nextStamp;
     insertPredefined();
 }
 
-void LexemeMap::clear(const std::string& fullFileName)
+void LexemeMap::clear(FileId fileId)
 {
-    auto byFileIt = P->fileIndex_.find(fullFileName);
-    if (byFileIt != P->fileIndex_.end())
-        byFileIt->second->clear();
+    P->posIndex_.clear(fileId);
 }
 
 template const Ident*
 LexemeMap::insertOrFind<Ident>(const std::string&,
-                               const std::string&,
+                               FileId,
                                const LineCol& lineCol);
 template const StrLit*
 LexemeMap::insertOrFind<StrLit>(const std::string&,
-                                const std::string&,
+                                FileId,
                                 const LineCol& lineCol);
 template const NumLit*
 LexemeMap::insertOrFind<NumLit>(const std::string&,
-                                const std::string&,
+                                FileId,
+                                const LineCol& lineCol);
+template const Ident*
+LexemeMap::insertOrFind<Ident>(const char*, size_t,
+                               FileId,
+                               const LineCol& lineCol);
+template const StrLit*
+LexemeMap::insertOrFind<StrLit>(const char*, size_t,
+                                FileId,
+                                const LineCol& lineCol);
+template const NumLit*
+LexemeMap::insertOrFind<NumLit>(const char*, size_t,
+                                FileId,
                                 const LineCol& lineCol);
 template const Ident*
-LexemeMap::findAt<Ident>(const std::string&, const LineCol& lineCol) const;
+LexemeMap::intern<Ident>(const std::string&);
 template const StrLit*
-LexemeMap::findAt<StrLit>(const std::string&, const LineCol& lineCol) const;
+LexemeMap::intern<StrLit>(const std::string&);
 template const NumLit*
-LexemeMap::findAt<NumLit>(const std::string&, const LineCol& lineCol) const;
+LexemeMap::intern<NumLit>(const std::string&);
+template const Ident*
+LexemeMap::findAt<Ident>(FileId, const LineCol& lineCol) const;
+template const StrLit*
+LexemeMap::findAt<StrLit>(FileId, const LineCol& lineCol) const;
+template const NumLit*
+LexemeMap::findAt<NumLit>(FileId, const LineCol& lineCol) const;
 
 template const Ident*
 LexemeMap::findAnyOf<Ident>(const std::string&) const;
@@ -229,18 +465,20 @@ LexemeMap::findAnyOf<StrLit>(const std::string&) const;
 template const NumLit*
 LexemeMap::findAnyOf<NumLit>(const std::string&) const;
 
-template std::vector<std::tuple<const Ident*, LineCol>>
-LexemeMap::list<Ident>(const std::string&) const;
-template std::vector<std::tuple<const StrLit*, LineCol>>
-LexemeMap::list<StrLit>(const std::string&) const;
-template std::vector<std::tuple<const NumLit*, LineCol>>
-LexemeMap::list<NumLit>(const std::string&) const;
+template LexemeMap::Range<Ident>
+LexemeMap::list<Ident>(FileId) const;
+template LexemeMap::Range<StrLit>
+LexemeMap::list<StrLit>(FileId) const;
+template LexemeMap::Range<NumLit>
+LexemeMap::list<NumLit>(FileId) const;
 
 
     /*--- TokenMap ---*/
 
-struct uaiso::TokenMap::TokenMapImpl : public DataIndex<int>
-{};
+struct uaiso::TokenMap::TokenMapImpl
+{
+    PosIndex<Token> posIndex_;
+};
 
 TokenMap::TokenMap()
     : impl_(new TokenMapImpl)
@@ -250,52 +488,41 @@ TokenMap::~TokenMap()
 {}
 
 Token TokenMap::insertOrFind(int tk,
-                             const std::string& file,
+                             FileId fileId,
                              const LineCol& lineCol)
 {
-    auto &byFile = P->fileIndex_[file];
-    if (!byFile) {
-        byFile.reset(new DataIndex<int>::LineColIndex);
-    } else {
-        auto posIt = byFile->find(lineCol);
-        if (posIt != byFile->end())
-            return Token(*posIt->second);
-    }
-
-    // A mapping for this line/col doesn't exist, but this value might
-    // be in the global index (from another occurrence). Insert will
-    // either create it or return an iterator to the existing one.
-    auto valPair = P->data_.insert(tk);
-
-    // Now, add a mapping from the line/col to the value.
-    byFile->emplace(lineCol, valPair.first);
-
-    return Token(*valPair.first);
+    auto byFile = P->posIndex_.fetch(fileId);
+    return byFile->insertOrFind(lineCol, [tk] () { return Token(tk); });
 }
 
-Token TokenMap::findAt(const std::string& fullFileName,
+Token TokenMap::findAt(FileId fileId,
                        const LineCol& lineCol) const
 {
-    auto byFileIt = P->fileIndex_.find(fullFileName);
-    if (byFileIt == P->fileIndex_.end() || !byFileIt->second)
+    auto byFile = P->posIndex_.find(fileId);
+    if (!byFile)
         return Token::TK_INVALID;
 
-    auto it = byFileIt->second->find(lineCol);
-    if (it == byFileIt->second->end())
+    auto tk = byFile->find(lineCol);
+    if (!tk)
         return Token::TK_INVALID;
 
-    return Token(*it->second);
+    return *tk;
+}
+
+std::unique_ptr<TokenMap> TokenMap::retain(FileId fileId) const
+{
+    std::unique_ptr<TokenMap> retained(new TokenMap);
+    if (auto byFile = P->posIndex_.share(fileId))
+        retained->P->posIndex_.files_.emplace(fileId, std::move(byFile));
+    return retained;
 }
 
 void TokenMap::clear()
 {
-    P->data_.clear();
-    P->fileIndex_.clear();
+    P->posIndex_.clear();
 }
 
-void TokenMap::clear(const std::string& fullFileName)
+void TokenMap::clear(FileId fileId)
 {
-    auto infoIt = P->fileIndex_.find(fullFileName);
-    if (infoIt != P->fileIndex_.end())
-        infoIt->second->clear();
+    P->posIndex_.clear(fileId);
 }
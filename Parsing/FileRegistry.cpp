@@ -0,0 +1,117 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+#include "Parsing/FileRegistry.h"
+#include "Common/Assert.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+using namespace uaiso;
+
+namespace {
+
+/*
+ * Names are appended (under the lock) to segments which never move, and
+ * published by the size, so they're read without locking: a name whose id
+ * is below the size was stored before the size was.
+ */
+const uint32_t kSegmentBits = 10;
+const uint32_t kSegmentSize = 1u << kSegmentBits;
+const uint32_t kSegmentCnt = 1u << 12;
+
+struct Registry
+{
+    Registry()
+    {
+        // Id 0 is reserved for the unspecified file.
+        append(std::string());
+    }
+
+    const std::string& name(uint32_t id) const
+    {
+        return segments_[id >> kSegmentBits][id & (kSegmentSize - 1)];
+    }
+
+    // The lock must be held.
+    uint32_t append(const std::string& fullFileName)
+    {
+        const uint32_t id = size_.load(std::memory_order_relaxed);
+        auto& segment = segments_[id >> kSegmentBits];
+        if (!segment)
+            segment.reset(new std::string[kSegmentSize]);
+        segment[id & (kSegmentSize - 1)] = fullFileName;
+        ids_.emplace(fullFileName, id);
+        size_.store(id + 1, std::memory_order_release);
+        return id;
+    }
+
+    std::mutex mutex_;
+    std::unique_ptr<std::string[]> segments_[kSegmentCnt];
+    std::atomic<uint32_t> size_ { 0 };
+    std::unordered_map<std::string, uint32_t> ids_;
+};
+
+Registry& registry()
+{
+    static Registry registry;
+    return registry;
+}
+
+} // anonymous
+
+FileId FileRegistry::insertOrFind(const std::string& fullFileName)
+{
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex_);
+    auto it = reg.ids_.find(fullFileName);
+    if (it != reg.ids_.end())
+        return FileId(it->second);
+
+    UAISO_ASSERT(reg.size_.load(std::memory_order_relaxed) < kSegmentSize * kSegmentCnt,
+                 return FileId());
+    return FileId(reg.append(fullFileName));
+}
+
+FileId FileRegistry::find(const std::string& fullFileName)
+{
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex_);
+    auto it = reg.ids_.find(fullFileName);
+    if (it != reg.ids_.end())
+        return FileId(it->second);
+    return FileId();
+}
+
+const std::string& FileRegistry::name(FileId fileId)
+{
+    const Registry& reg = registry();
+    UAISO_ASSERT(fileId.value() < reg.size_.load(std::memory_order_acquire),
+                 return reg.name(0));
+    return reg.name(fileId.value());
+}
+
+size_t FileRegistry::size()
+{
+    return registry().size_.load(std::memory_order_acquire);
+}
@@ -0,0 +1,142 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+#ifndef UAISO_FILEREGISTRY_H__
+#define UAISO_FILEREGISTRY_H__
+
+#include "Common/Config.h"
+#include "Common/Test.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace uaiso {
+
+/*!
+ * \brief The FileId class
+ *
+ * A compact handle to a file name interned in the FileRegistry. The
+ * default constructed id stands for an unspecified file (an empty name).
+ */
+class UAISO_API FileId final
+{
+public:
+    FileId()
+        : id_(0)
+    {}
+
+    explicit FileId(uint32_t id)
+        : id_(id)
+    {}
+
+    uint32_t value() const
+    {
+        return id_;
+    }
+
+    bool isUnspecified() const
+    {
+        return id_ == 0;
+    }
+
+private:
+    uint32_t id_;
+};
+
+inline bool operator==(FileId a, FileId b)
+{
+    return a.value() == b.value();
+}
+
+inline bool operator!=(FileId a, FileId b)
+{
+    return !(a == b);
+}
+
+inline bool operator<(FileId a, FileId b)
+{
+    return a.value() < b.value();
+}
+
+/*!
+ * \brief The FileRegistry class
+ *
+ * A process-wide registry which interns full file names into FileIds. Ids
+ * are never recycled and the name of an id remains valid for the lifetime
+ * of the process. All functions are thread-safe, looking up a name doesn't
+ * lock.
+ */
+class UAISO_API FileRegistry final
+{
+public:
+    FileRegistry() = delete;
+
+    /*!
+     * \brief insertOrFind
+     *
+     * Return the id of the file \a fullFileName, registering it if that's
+     * the first time it's seen.
+     */
+    static FileId insertOrFind(const std::string& fullFileName);
+
+    /*!
+     * \brief find
+     *
+     * Return the id of the file \a fullFileName if it has been registered,
+     * otherwise return an unspecified id.
+     */
+    static FileId find(const std::string& fullFileName);
+
+    /*!
+     * \brief name
+     *
+     * Return the full file name of \a fileId.
+     */
+    static const std::string& name(FileId fileId);
+
+    /*!
+     * \brief size
+     *
+     * Return the number of registered files, including the unspecified one.
+     */
+    static size_t size();
+
+private:
+    DECL_CLASS_TEST(FileRegistry)
+};
+
+} // namespace uaiso
+
+namespace std {
+
+template <>
+struct hash<uaiso::FileId>
+{
+    size_t operator()(uaiso::FileId fileId) const
+    {
+        return std::hash<uint32_t>()(fileId.value());
+    }
+};
+
+} // namespace std
+
+#endif
@@ -0,0 +1,159 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+#include "Parsing/FileRegistry.h"
+#include "Parsing/LexemeMap.h"
+#include "Parsing/Lexeme.h"
+#include "Parsing/SourceLoc.h"
+#include "Parsing/TokenMap.h"
+#include "Semantic/Program.h"
+#include "Semantic/Snapshot.h"
+#include <atomic>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace uaiso;
+
+class FileRegistry::FileRegistryTest final : public Test
+{
+public:
+    TEST_RUN(FileRegistryTest
+             , &FileRegistryTest::testCase1
+             , &FileRegistryTest::testCase2
+             , &FileRegistryTest::testCase3
+             , &FileRegistryTest::testCase4
+             , &FileRegistryTest::testCase5
+             , &FileRegistryTest::testCase6
+             , &FileRegistryTest::testCase7
+             )
+
+    void testCase1()
+    {
+        // The unspecified file is always there.
+        UAISO_EXPECT_TRUE(FileId().isUnspecified());
+        UAISO_EXPECT_TRUE(FileRegistry::find("").isUnspecified());
+        UAISO_EXPECT_TRUE(FileRegistry::name(FileId()).empty());
+    }
+
+    void testCase2()
+    {
+        auto size = FileRegistry::size();
+        auto id = FileRegistry::insertOrFind("/file_registry_test/a.py");
+        UAISO_EXPECT_FALSE(id.isUnspecified());
+        UAISO_EXPECT_INT_EQ(size + 1, FileRegistry::size());
+        UAISO_EXPECT_STR_EQ("/file_registry_test/a.py", FileRegistry::name(id));
+
+        // Interning the same name again gives back the same id.
+        UAISO_EXPECT_TRUE(id == FileRegistry::insertOrFind("/file_registry_test/a.py"));
+        UAISO_EXPECT_TRUE(id == FileRegistry::find("/file_registry_test/a.py"));
+        UAISO_EXPECT_INT_EQ(size + 1, FileRegistry::size());
+
+        auto other = FileRegistry::insertOrFind("/file_registry_test/b.py");
+        UAISO_EXPECT_TRUE(id != other);
+        UAISO_EXPECT_TRUE(FileRegistry::find("/file_registry_test/c.py").isUnspecified());
+    }
+
+    void testCase3()
+    {
+        SourceLoc loc(1, 2, 3, 4, "/file_registry_test/a.py");
+        UAISO_EXPECT_TRUE(loc.fileId_ == FileRegistry::find("/file_registry_test/a.py"));
+        UAISO_EXPECT_STR_EQ("/file_registry_test/a.py", loc.fileName());
+        UAISO_EXPECT_TRUE(loc == SourceLoc(1, 2, 3, 4, loc.fileId_));
+        UAISO_EXPECT_FALSE(loc == SourceLoc(1, 2, 3, 4, "/file_registry_test/b.py"));
+        UAISO_EXPECT_TRUE(kEmptyLoc.fileId_.isUnspecified());
+    }
+
+    void testCase4()
+    {
+        // Lexemes and tokens are indexed per file id.
+        auto a = FileRegistry::insertOrFind("/file_registry_test/a.py");
+        auto b = FileRegistry::insertOrFind("/file_registry_test/b.py");
+        LexemeMap lexs;
+        auto ident = lexs.insertOrFind<Ident>("foo", a, LineCol(1, 1));
+        UAISO_EXPECT_PTR_EQ(ident, lexs.findAt<Ident>(a, LineCol(1, 1)));
+        UAISO_EXPECT_FALSE(lexs.findAt<Ident>(b, LineCol(1, 1)));
+        UAISO_EXPECT_PTR_EQ(ident, lexs.insertOrFind<Ident>("foo", b, LineCol(5, 5)));
+        lexs.clear(a);
+        UAISO_EXPECT_FALSE(lexs.findAt<Ident>(a, LineCol(1, 1)));
+        UAISO_EXPECT_PTR_EQ(ident, lexs.findAt<Ident>(b, LineCol(5, 5)));
+
+        TokenMap tokens;
+        tokens.insertOrFind(TK_IDENT, a, LineCol(1, 1));
+        UAISO_EXPECT_INT_EQ(TK_IDENT, tokens.findAt(a, LineCol(1, 1)));
+        UAISO_EXPECT_INT_EQ(TK_INVALID, tokens.findAt(b, LineCol(1, 1)));
+    }
+
+    void testCase5()
+    {
+        // Both the id and the name can be used on a snapshot.
+        auto a = FileRegistry::insertOrFind("/file_registry_test/a.py");
+        Snapshot snapshot;
+        std::unique_ptr<Program> prog(new Program("/file_registry_test/a.py"));
+        auto raw = prog.get();
+        snapshot.insertOrReplace(a, std::move(prog));
+        UAISO_EXPECT_PTR_EQ(raw, snapshot.find(a));
+        UAISO_EXPECT_PTR_EQ(raw, snapshot.find("/file_registry_test/a.py"));
+        UAISO_EXPECT_FALSE(snapshot.find("/file_registry_test/c.py"));
+    }
+
+    void testCase6()
+    {
+        // Names are read, without locking, while others are registered
+        // (enough of them for the storage to grow).
+        const int kFiles = 3000;
+        std::vector<FileId> ids(kFiles);
+        std::atomic<int> registered { 0 };
+        std::thread writer([&ids, &registered] () {
+            for (int i = 0; i < kFiles; ++i) {
+                ids[i] = FileRegistry::insertOrFind("/file_registry_test/many/"
+                                                    + std::to_string(i) + ".py");
+                registered.store(i + 1, std::memory_order_release);
+            }
+        });
+        bool match = true;
+        for (int seen = 0; seen < kFiles;) {
+            const int cnt = registered.load(std::memory_order_acquire);
+            for (; seen < cnt; ++seen) {
+                match &= FileRegistry::name(ids[seen])
+                        == "/file_registry_test/many/" + std::to_string(seen) + ".py";
+            }
+        }
+        writer.join();
+        UAISO_EXPECT_TRUE(match);
+        UAISO_EXPECT_TRUE(FileRegistry::size() > size_t(kFiles));
+    }
+
+    void testCase7()
+    {
+        // A location fits in 16 bytes, columns too large are clamped.
+        SourceLoc loc(100000, 70000, 100001, -70000, FileId());
+        UAISO_EXPECT_INT_EQ(100000, loc.line_);
+        UAISO_EXPECT_INT_EQ(100001, loc.lastLine_);
+        UAISO_EXPECT_INT_EQ(std::numeric_limits<int16_t>::max(), loc.col_);
+        UAISO_EXPECT_INT_EQ(std::numeric_limits<int16_t>::min(), loc.lastCol_);
+        UAISO_EXPECT_INT_EQ(-1, SourceLoc(1, -1, 1, -1, FileId()).col_);
+    }
+};
+
+MAKE_CLASS_TEST(FileRegistry)
@@ -56,7 +56,7 @@ struct PartialParse {};
 #define DECL_LOC(X, L) \
     SourceLoc loc##X(L.first_line, L.first_column, \
                      L.last_line, L.last_column, \
-                     L.filename)
+                     FileId(L.file_id))
 #define DECL_1_LOC(L1) DECL_LOC(A, L1)
 #define DECL_2_LOC(L1, L2) DECL_1_LOC(L1); DECL_LOC(B, L2)
 #define DECL_3_LOC(L1, L2, L3) DECL_2_LOC(L1, L2); DECL_LOC(C, L3)
@@ -71,7 +71,8 @@ struct PartialParse {};
 #define ASSIGN_LOC \
     /* Would use yy_top_state, but it chrashes. See (3) in 3rdPartyBugs.txt. */ \
     if (!yyextra->hasTokenState()) { \
-        yylloc->filename = yyextra->fileName(); \
+        yylloc->file_id = yyextra->fileId().value(); \
+        yylloc->lexeme = nullptr; \
         yylloc->first_line = yylloc->last_line = yylineno; \
         yylloc->first_column = yycolumn; \
         yylloc->last_column = yycolumn + yyleng; \
@@ -109,8 +110,9 @@ struct PartialParse {};
 
 #define PROCESS_LEXEME(LEXEME, TOKEN) \
     do { \
-        yyextra->trackLexeme<LEXEME>(yytext, \
-                                     LineCol(yylloc->first_line, yylloc->first_column)); \
+        yylloc->lexeme = \
+            yyextra->trackLexeme<LEXEME>(yytext, \
+                                         LineCol(yylloc->first_line, yylloc->first_column)); \
         PROCESS_TOKEN(TOKEN); \
     } while (0)
 
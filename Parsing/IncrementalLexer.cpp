@@ -22,6 +22,8 @@
 /*--------------------------*/
 
 #include "Parsing/IncrementalLexer__.h"
+#include <algorithm>
+#include <cstring>
 
 using namespace uaiso;
 
@@ -64,3 +66,211 @@ void IncrementalLexer::decideState()
 
     P->state_ = IncrementalLexer::InCode;
 }
+
+void IncrementalLexer::edit(int line, int removedLines, int addedLines)
+{
+    UAISO_ASSERT(line >= 0 && removedLines >= 0 && addedLines >= 0, return);
+
+    if (line + removedLines > static_cast<int>(P->lines_.size())) {
+        // Out of sync with the document, start all over.
+        P->lines_.clear();
+        P->staleFrom_ = P->dirtyEnd_ = P->validEnd_ = 0;
+        return;
+    }
+
+    // The line following removed ones may no longer start where it used to,
+    // so it's taken as edited too.
+    if (!addedLines && line + removedLines < static_cast<int>(P->lines_.size())) {
+        ++removedLines;
+        ++addedLines;
+    }
+
+    // The checkpoint of the first line is preserved, since it depends only on
+    // what precedes it.
+    IncrementalLexerImpl::Line head;
+    if (line < static_cast<int>(P->lines_.size())) {
+        head.checkpoint_ = P->lines_[line].checkpoint_;
+        head.resumeLinesBack_ = P->lines_[line].resumeLinesBack_;
+        head.resumeCol_ = P->lines_[line].resumeCol_;
+        head.state_ = P->lines_[line].state_;
+    }
+
+    auto it = P->lines_.begin() + line;
+    it = P->lines_.erase(it, it + removedLines);
+    P->lines_.insert(it, addedLines, IncrementalLexerImpl::Line());
+    if (addedLines)
+        P->lines_[line] = std::move(head);
+
+    const int editEnd = line + removedLines;
+    const int delta = addedLines - removedLines;
+    const bool dirty = P->staleFrom_ < P->dirtyEnd_;
+    P->dirtyEnd_ = dirty && P->dirtyEnd_ >= editEnd ? P->dirtyEnd_ + delta
+                                                    : line + addedLines;
+    P->validEnd_ = P->validEnd_ >= editEnd ? P->validEnd_ + delta
+                                           : std::min(P->validEnd_, line);
+    P->staleFrom_ = std::min(P->staleFrom_, line);
+}
+
+IncrementalLexer::LineRange IncrementalLexer::lexDocument(const std::string& source,
+                                                          int lastLine)
+{
+    const char* buff = source.c_str();
+    const char* end = buff + source.size();
+    std::vector<size_t> lineStarts(1, 0);
+    for (const char* it = buff;
+            (it = static_cast<const char*>(std::memchr(it, '\n', end - it))); ) {
+        lineStarts.push_back(++it - buff);
+    }
+    const int lineCnt = lineStarts.size();
+    auto lineOf = [&lineStarts] (size_t offset) -> int {
+        return std::upper_bound(lineStarts.begin(), lineStarts.end(), offset)
+                - lineStarts.begin() - 1;
+    };
+
+    if (static_cast<int>(P->lines_.size()) != lineCnt) {
+        P->lines_.clear();
+        P->lines_.resize(lineCnt);
+        P->staleFrom_ = P->dirtyEnd_ = P->validEnd_ = 0;
+    }
+
+    LineRange range;
+    if (P->staleFrom_ >= lineCnt || (lastLine >= 0 && P->staleFrom_ > lastLine))
+        return range;
+
+    // Resume from the checkpoint preceding the first stale line.
+    int line = P->staleFrom_;
+    while (line > 0 && !P->lines_[line].checkpoint_)
+        --line;
+    range.first_ = line;
+    LineCol resumeLineCol(0, 0);
+    LexerState state;
+    if (line) {
+        const IncrementalLexerImpl::Line& from = P->lines_[line];
+        resumeLineCol = LineCol(line - from.resumeLinesBack_, from.resumeCol_);
+        state = from.state_;
+    }
+    size_t prevEnd = lineStarts[resumeLineCol.line_] + resumeLineCol.col_;
+    int prevLast = line - 1;
+
+    if (!P->scratch_)
+        P->scratch_.reset(new Phrasing);
+    P->scratch_->clear();
+    P->context_->collectPhrasing(P->scratch_.get());
+    resume(buff + prevEnd, source.size() - prevEnd, resumeLineCol, state);
+
+    // Lines up to the given one are reached from a token boundary, at the
+    // end of the previous token. Stop if the state at the start of a line
+    // past the edits converges, or if the line is past the last requested.
+    int stop = lineCnt;
+    bool converged = false;
+    auto reach = [&] (int upTo) -> bool {
+        const int endLine = lineOf(prevEnd);
+        const int endCol = prevEnd - lineStarts[endLine];
+        for (int l = prevLast + 1; l <= upTo; ++l) {
+            IncrementalLexerImpl::Line& ln = P->lines_[l];
+            if (l > range.first_
+                    && l >= P->dirtyEnd_ && l < P->validEnd_
+                    && ln.checkpoint_
+                    && ln.resumeLinesBack_ == l - endLine
+                    && ln.resumeCol_ == endCol
+                    && ln.state_ == state) {
+                converged = true;
+                stop = l;
+                return false;
+            }
+            ln.checkpoint_ = true;
+            ln.resumeLinesBack_ = l - endLine;
+            ln.resumeCol_ = endCol;
+            ln.state_ = state;
+            if (lastLine >= 0 && l > lastLine) {
+                stop = l;
+                return false;
+            }
+            ln.phrases_.clear();
+        }
+        return true;
+    };
+
+    bool more = true;
+    while (more) {
+        more = lexNext(state);
+
+        const Phrasing& scratch = *P->scratch_;
+        for (size_t i = 0; i < scratch.size(); ++i) {
+            const LineCol lineCol = scratch.lineCol(i);
+            const int first = lineCol.line_;
+            UAISO_ASSERT(first < lineCnt, continue);
+            const int len = scratch.length(i);
+            const size_t tkEnd = std::min(lineStarts[first] + lineCol.col_ + len,
+                                          source.size());
+            const int last = len > 0 ? lineOf(tkEnd - 1) : first;
+
+            if (first > prevLast && !reach(first)) {
+                more = false;
+                break;
+            }
+
+            if (first >= range.first_) {
+                IncrementalLexerImpl::Phrase phrase {
+                    scratch.token(i), lineCol.col_, len, scratch.flags(i)
+                };
+                auto& phrases = P->lines_[first].phrases_;
+                // Multiline tokens may be reported line by line (as Flex-based
+                // lexers do with comments), each report extending the previous.
+                if (!phrases.empty()
+                        && phrases.back().tk_ == phrase.tk_
+                        && phrases.back().col_ == phrase.col_) {
+                    phrases.back() = phrase;
+                } else {
+                    phrases.push_back(phrase);
+                }
+                for (int l = std::max(first, prevLast) + 1; l <= last; ++l) {
+                    P->lines_[l].checkpoint_ = false;
+                    P->lines_[l].phrases_.clear();
+                }
+            }
+
+            prevLast = std::max(prevLast, last);
+            prevEnd = std::max(prevEnd, tkEnd);
+        }
+        P->scratch_->clear();
+
+        if (!more && stop == lineCnt)
+            reach(lineCnt - 1);
+    }
+    finish();
+
+    if (converged) {
+        P->staleFrom_ = P->dirtyEnd_ = P->validEnd_;
+    } else if (stop < lineCnt) {
+        P->staleFrom_ = stop;
+        if (stop >= P->validEnd_)
+            P->dirtyEnd_ = P->validEnd_ = stop;
+    } else {
+        P->staleFrom_ = P->dirtyEnd_ = P->validEnd_ = lineCnt;
+    }
+    range.last_ = stop;
+
+    return range;
+}
+
+int IncrementalLexer::lineCount() const
+{
+    return P->lines_.size();
+}
+
+std::unique_ptr<Phrasing> IncrementalLexer::phrasing(const LineRange& lines) const
+{
+    std::unique_ptr<Phrasing> phrasing(new Phrasing);
+    const int last = std::min(lines.last_, static_cast<int>(P->lines_.size()));
+    for (int line = std::max(lines.first_, 0); line < last; ++line) {
+        for (const auto& phrase : P->lines_[line].phrases_) {
+            phrasing->append(phrase.tk_, LineCol(line, phrase.col_),
+                             phrase.len_, phrase.flags_);
+        }
+    }
+    return phrasing;
+}
+
+void IncrementalLexer::finish()
+{}
@@ -32,10 +32,20 @@
 
 namespace uaiso {
 
+struct LexerState;
+class LineCol;
 class Phrasing;
 
 /*!
  * \brief The IncrementalLexer class
+ *
+ * A lexer for syntax highlighting, in one of two ways. Either a client lexes
+ * pieces of a document (typically its lines), passing along the state from
+ * one piece into the next. Or the lexer keeps a table of the document's
+ * lines, with a checkpoint at the start of every line that starts at a token
+ * boundary (lines within a multiline comment or string don't), and after an
+ * edit re-lexes from the checkpoint preceding it until the state at the start
+ * of a line converges to the one it had before the edit.
  */
 class UAISO_API IncrementalLexer
 {
@@ -57,11 +67,101 @@ public:
 
     State state() const;
 
+    /*!
+     * \brief The LineRange struct
+     *
+     * Lines [first_, last_) of a document.
+     */
+    struct LineRange
+    {
+        int first_ { 0 };
+        int last_ { 0 };
+
+        bool isEmpty() const { return first_ >= last_; }
+    };
+
+    /*!
+     * \brief edit
+     * \param line
+     * \param removedLines
+     * \param addedLines
+     *
+     * Notify that lines [line, line + removedLines) of the document have been
+     * replaced by \a addedLines lines (a change within a single line removes
+     * one and adds one). The phrasing of lines from \a line onwards is stale
+     * until the document is lexed again.
+     */
+    void edit(int line, int removedLines, int addedLines);
+
+    /*!
+     * \brief lexDocument
+     * \param source
+     * \param lastLine
+     * \return
+     *
+     * Lex the stale lines of the document \a source, which must have as many
+     * lines as the table (otherwise the whole of it is lexed). If \a lastLine
+     * isn't negative, lexing stops past that line (say, the end of the
+     * viewport), and stale lines following it are left for a later call.
+     *
+     * Return the lines whose phrasing may have changed.
+     */
+    LineRange lexDocument(const std::string& source, int lastLine = -1);
+
+    /*!
+     * \brief lineCount
+     * \return
+     *
+     * Return the number of lines of the document lastly lexed.
+     */
+    int lineCount() const;
+
+    /*!
+     * \brief phrasing
+     * \param lines
+     * \return
+     *
+     * Return the phrasing of the tokens that start within the given lines of
+     * the document.
+     */
+    std::unique_ptr<Phrasing> phrasing(const LineRange& lines) const;
+
 protected:
     IncrementalLexer();
 
     void decideState();
 
+    /*!
+     * \brief resume
+     * \param buff
+     * \param len
+     * \param lineCol
+     * \param state
+     *
+     * Prepare to lex the document from \a buff (its last \a len characters),
+     * a token boundary at \a lineCol, with the lexer in \a state. Tokens must
+     * be tracked as phrases by the context.
+     */
+    virtual void resume(const char* buff, size_t len, const LineCol& lineCol,
+                        const LexerState& state) = 0;
+
+    /*!
+     * \brief lexNext
+     * \param state
+     * \return
+     *
+     * Save the lexer state into \a state and lex the next token. Return false
+     * at the end of the input.
+     */
+    virtual bool lexNext(LexerState& state) = 0;
+
+    /*!
+     * \brief finish
+     *
+     * Release what's been acquired by resume.
+     */
+    virtual void finish();
+
     DECL_PIMPL(IncrementalLexer)
 };
 
@@ -34,9 +34,11 @@
 #define UAISO_INCREMENTALLEXER_INTERNAL_H__
 
 #include "Parsing/IncrementalLexer.h"
+#include "Parsing/Lexer.h"
 #include "Parsing/ParsingContext.h"
 #include "Parsing/Phrasing.h"
 #include "Common/Assert.h"
+#include <vector>
 
 namespace uaiso {
 
@@ -50,6 +52,43 @@ struct IncrementalLexer::IncrementalLexerImpl
     IncrementalLexer::State state_;
     std::unique_ptr<Phrasing> phrasing_;
     std::unique_ptr<ParsingContext> context_;
+
+    /*!
+     * A token of the document, which belongs to the line where it starts.
+     */
+    struct Phrase
+    {
+        Token tk_;
+        int col_;
+        int len_;
+        Phrasing::TokenFlags flags_;
+    };
+
+    /*!
+     * A line of the document. Its checkpoint is the lexer state at the end of
+     * the token preceding the line, together with that position, given as a
+     * number of lines back and a column.
+     */
+    struct Line
+    {
+        bool checkpoint_ { false };
+        int resumeLinesBack_ { 0 };
+        int resumeCol_ { 0 };
+        LexerState state_;
+        std::vector<Phrase> phrases_;
+    };
+
+    std::vector<Line> lines_;
+
+    // Lines before staleFrom_ are up to date; those in [staleFrom_, dirtyEnd_)
+    // are to be lexed; those in [dirtyEnd_, validEnd_) were up to date before
+    // the edits, so they may be reused if lexing converges; the remaining ones
+    // have never been lexed.
+    int staleFrom_ { 0 };
+    int dirtyEnd_ { 0 };
+    int validEnd_ { 0 };
+
+    std::unique_ptr<Phrasing> scratch_;
 };
 
 } // namespace uaiso
@@ -0,0 +1,158 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#ifndef UAISO_KEYWORDTABLE_H__
+#define UAISO_KEYWORDTABLE_H__
+
+#include "Parsing/Token.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace uaiso {
+
+/*!
+ * \brief The Keyword struct
+ *
+ * The spelling of a keyword and its token.
+ */
+struct Keyword
+{
+    const char* spell_;
+    Token tk_;
+};
+
+/*!
+ * \brief The KeywordTable class
+ *
+ * A perfect hash table of keywords, built at compile time: the constructor
+ * searches for a seed under which the hashes of all keywords fall
+ * into distinct slots, so filtering a word takes one hash and at most one
+ * comparison.
+ *
+ * The hash only looks at the length and at the first, middle, and last
+ * characters of a word; keywords which agree on all of them can't be put
+ * in the same table (the constructor would not terminate in a constant
+ * expression, which is a compilation error).
+ *
+ * \code
+ * constexpr Keyword keywords[] = { { "if", TK_IF }, { "else", TK_ELSE } };
+ * constexpr KeywordTable<2> table(keywords);
+ * \endcode
+ */
+template <size_t N, unsigned Bits = 7>
+class KeywordTable final
+{
+public:
+    static_assert(N < (size_t(1) << Bits), "table too small for keywords");
+
+    constexpr explicit KeywordTable(const Keyword (&keywords)[N])
+        : slots_()
+        , seed_(0)
+        , maxLen_(0)
+    {
+        for (uint32_t seed = 0; ; ++seed) {
+            bool taken[kSlots] {};
+            size_t i = 0;
+            for (; i < N; ++i) {
+                const size_t len = length(keywords[i].spell_);
+                const uint32_t slot = hash(keywords[i].spell_, len, seed);
+                if (taken[slot])
+                    break;
+                taken[slot] = true;
+            }
+            if (i == N) {
+                seed_ = seed;
+                break;
+            }
+        }
+
+        for (size_t i = 0; i < N; ++i) {
+            const size_t len = length(keywords[i].spell_);
+            Slot& slot = slots_[hash(keywords[i].spell_, len, seed_)];
+            slot.spell_ = keywords[i].spell_;
+            slot.len_ = len;
+            slot.tk_ = keywords[i].tk_;
+            if (len > maxLen_)
+                maxLen_ = len;
+        }
+    }
+
+    /*!
+     * \brief filter
+     * \param spell
+     * \param len
+     * \return
+     *
+     * Return the token of the given word if it's a keyword. Otherwise, return
+     * an invalid token.
+     */
+    Token filter(const char* spell, size_t len) const
+    {
+        if (!len || len > maxLen_)
+            return TK_INVALID;
+
+        const Slot& slot = slots_[hash(spell, len, seed_)];
+        if (slot.len_ == len && !std::memcmp(slot.spell_, spell, len))
+            return slot.tk_;
+        return TK_INVALID;
+    }
+
+private:
+    static constexpr size_t kSlots = size_t(1) << Bits;
+
+    struct Slot
+    {
+        const char* spell_ { nullptr };
+        size_t len_ { 0 };
+        Token tk_ { TK_INVALID };
+    };
+
+    static constexpr size_t length(const char* spell)
+    {
+        size_t len = 0;
+        while (spell[len])
+            ++len;
+        return len;
+    }
+
+    static constexpr uint32_t hash(const char* spell, size_t len, uint32_t seed)
+    {
+        uint32_t h = (uint32_t(static_cast<unsigned char>(spell[0]))
+                      | uint32_t(static_cast<unsigned char>(spell[len >> 1])) << 8
+                      | uint32_t(static_cast<unsigned char>(spell[len - 1])) << 16
+                      | uint32_t(len) << 24) ^ seed;
+        h *= 0x9e3779b1;
+        h ^= h >> 15;
+        h *= 0x85ebca77;
+        return h >> (32 - Bits);
+    }
+
+    Slot slots_[kSlots];
+    uint32_t seed_;
+    size_t maxLen_;
+};
+
+} // namespace uaiso
+
+#endif
@@ -22,10 +22,23 @@
 /*--------------------------*/
 
 #include "Parsing/Lang.h"
-#include <cctype>
 
 using namespace uaiso;
 
+namespace {
+
+constexpr CharClassTable standardCharClasses = CharClassTable::standard();
+
+} // anonymous
+
+Lang::Lang()
+    : charClasses_(&standardCharClasses)
+{}
+
+Lang::Lang(const CharClassTable* charClasses)
+    : charClasses_(charClasses)
+{}
+
 Lang::~Lang()
 {}
 
@@ -56,26 +69,6 @@ std::string Lang::funcCallDelim() const
     return "(";
 }
 
-bool Lang::isIdentFirstChar(char ch) const
-{
-    return std::isalpha(ch) || ch == '_';
-}
-
-bool Lang::isIdentChar(char ch) const
-{
-    return std::isalnum(ch) || ch == '_';
-}
-
-bool Lang::isStrLitEscape(char ch) const
-{
-    return std::isprint(ch);
-}
-
-bool Lang::isStrLitQuote(char ch) const
-{
-    return ch == '"';
-}
-
 bool Lang::hasStrLitJoinEscape() const
 {
     return false;
@@ -86,31 +79,6 @@ std::pair<bool, char> Lang::strLitJoinEscapeMatcher() const
     return std::make_pair(false, 0);
 }
 
-bool Lang::isOctalPrefix(char ch) const
-{
-    return ch == 'o' || ch == 'O';
-}
-
-bool Lang::isHexPrefix(char ch) const
-{
-    return ch == 'x' || ch == 'X';
-}
-
-bool Lang::isBinPrefix(char ch) const
-{
-    return ch == 'b' || ch == 'B';
-}
-
-bool Lang::isLongSuffix(char ch) const
-{
-    return ch == 'L' || ch == 'l';
-}
-
-bool Lang::isExponent(char ch) const
-{
-    return ch == 'e' || ch == 'E';
-}
-
 bool Lang::hasStrictDecimalPoint() const
 {
     return false;
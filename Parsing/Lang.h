@@ -25,6 +25,7 @@
 #define UAISO_LANG_H__
 
 #include "Common/Config.h"
+#include "Parsing/CharClass.h"
 #include "Parsing/Token.h"
 #include <string>
 
@@ -34,6 +35,9 @@ namespace uaiso {
  * \brief The Lang class
  *
  * Characteristics of a programming language.
+ *
+ * Lexical predicates on characters are not virtual, they're answered by
+ * the CharClassTable the language is built with.
  */
 class UAISO_API Lang
 {
@@ -147,27 +151,27 @@ public:
 
     virtual std::string funcCallDelim() const;
 
-    virtual bool isIdentFirstChar(char ch) const;
+    bool isIdentFirstChar(char ch) const { return charClasses_->is(ch, CharClassTable::IdentFirst); }
 
-    virtual bool isIdentChar(char ch) const;
+    bool isIdentChar(char ch) const { return charClasses_->is(ch, CharClassTable::Ident); }
 
-    virtual bool isStrLitQuote(char ch) const;
+    bool isStrLitQuote(char ch) const { return charClasses_->is(ch, CharClassTable::Quote); }
 
-    virtual bool isStrLitEscape(char ch) const;
+    bool isStrLitEscape(char ch) const { return charClasses_->is(ch, CharClassTable::Escape); }
 
     virtual bool hasStrLitJoinEscape() const;
 
     virtual std::pair<bool, char> strLitJoinEscapeMatcher() const;
 
-    virtual bool isOctalPrefix(char ch) const;
+    bool isOctalPrefix(char ch) const { return charClasses_->is(ch, CharClassTable::OctalPrefix); }
 
-    virtual bool isHexPrefix(char ch) const;
+    bool isHexPrefix(char ch) const { return charClasses_->is(ch, CharClassTable::HexPrefix); }
 
-    virtual bool isBinPrefix(char ch) const;
+    bool isBinPrefix(char ch) const { return charClasses_->is(ch, CharClassTable::BinPrefix); }
 
-    virtual bool isLongSuffix(char ch) const;
+    bool isLongSuffix(char ch) const { return charClasses_->is(ch, CharClassTable::LongSuffix); }
 
-    virtual bool isExponent(char ch) const;
+    bool isExponent(char ch) const { return charClasses_->is(ch, CharClassTable::Exponent); }
 
     /*!
      * \brief hasStrictDecimalPoint
@@ -177,6 +181,29 @@ public:
      * after the decimal point, such as in Haskell.
      */
     virtual bool hasStrictDecimalPoint() const;
+
+    /*!
+     * \brief charClasses
+     * \return
+     *
+     * Return the table by which characters are classified.
+     */
+    const CharClassTable& charClasses() const { return *charClasses_; }
+
+protected:
+    Lang();
+
+    /*!
+     * \brief Lang
+     * \param charClasses
+     *
+     * Construct a language whose characters are classified by the given
+     * table, which must outlive it.
+     */
+    explicit Lang(const CharClassTable* charClasses);
+
+private:
+    const CharClassTable* charClasses_;
 };
 
 } // namespace uaiso
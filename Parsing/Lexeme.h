@@ -33,6 +33,7 @@
 namespace uaiso {
 
 class Ident;
+class LexemeInterner;
 class StrLit;
 class NumLit;
 
@@ -57,9 +58,23 @@ public:
      */
     virtual std::string str() const { return s_; }
 
+    /*!
+     * \brief spelling
+     * \return
+     *
+     * Return the lexeme as it appears in the source, e.g., with the
+     * delimiters of a string literal.
+     */
+    const std::string& spelling() const { return s_; }
+
+    /*!
+     * \brief kind
+     * \return
+     */
+    Kind kind() const { return kind_; }
+
 protected:
-    friend struct std::hash<std::unique_ptr<Lexeme>>;
-    friend struct std::equal_to<std::unique_ptr<Lexeme>>;
+    friend class LexemeInterner;
 
     Lexeme(const std::string& s, Kind kind);
 
@@ -80,6 +95,8 @@ protected:
 class UAISO_API Ident final : public Lexeme
 {
 public:
+    static constexpr Kind kKind = Kind::Ident;
+
     Ident(const std::string& s)
         : Lexeme(s, Kind::Ident)
     {}
@@ -95,6 +112,8 @@ const Ident kCompletionIdent("<completion>");
 class UAISO_API StrLit final : public Lexeme
 {
 public:
+    static constexpr Kind kKind = Kind::StrLit;
+
     StrLit(const std::string& s)
         : Lexeme(s, Kind::StrLit)
     {
@@ -112,6 +131,8 @@ class UAISO_API NumLit : public Lexeme
 public:
     using Lexeme::Lexeme;
 
+    static constexpr Kind kKind = Kind::NumLit;
+
     NumLit(const std::string& s)
         : Lexeme(s, Kind::NumLit)
     {}
@@ -27,6 +27,10 @@
 #include "Common/Config.h"
 #include "Common/LineCol.h"
 #include "Common/Pimpl.h"
+#include "Common/Test.h"
+#include "Parsing/FileRegistry.h"
+#include "Parsing/Lexeme.h"
+#include <cstdint>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -41,6 +45,11 @@ class StrLit;
 
 /*!
  * \brief The LexemeMap class
+ *
+ * Lexemes are interned, there's a single instance of each one, so they can
+ * be compared by pointer. Insertions and lookups may happen concurrently
+ * from several threads, provided each file is handled by a single thread at
+ * a time. Clearing the whole map is not thread-safe.
  */
 class UAISO_API LexemeMap final
 {
@@ -57,25 +66,140 @@ public:
     template <class ValueT>
     using LexemeInfo = std::tuple<const ValueT*, LineCol>;
 
+    /*!
+     * \brief The Range class
+     *
+     * A view, in source order, over the lexemes of type \a ValueT of a file.
+     * Nothing is copied, the view refers to the map's storage directly, and
+     * it's invalidated once lexemes are inserted in that file (or cleared).
+     */
+    template <class ValueT>
+    class Range final
+    {
+    public:
+        class const_iterator final
+        {
+        public:
+            LexemeInfo<ValueT> operator*() const
+            {
+                return LexemeInfo<ValueT>(static_cast<const ValueT*>(*value_),
+                                          *lineCol_);
+            }
+
+            const_iterator& operator++()
+            {
+                ++value_;
+                ++lineCol_;
+                skip();
+                return *this;
+            }
+
+            bool operator==(const const_iterator& other) const
+            {
+                return value_ == other.value_;
+            }
+
+            bool operator!=(const const_iterator& other) const
+            {
+                return value_ != other.value_;
+            }
+
+        private:
+            friend class Range;
+
+            const_iterator(const Lexeme* const* value,
+                           const Lexeme* const* end,
+                           const LineCol* lineCol)
+                : value_(value), end_(end), lineCol_(lineCol)
+            {
+                skip();
+            }
+
+            // Lexemes of other kinds are in the storage as well.
+            void skip()
+            {
+                while (value_ != end_ && (*value_)->kind() != ValueT::kKind) {
+                    ++value_;
+                    ++lineCol_;
+                }
+            }
+
+            const Lexeme* const* value_;
+            const Lexeme* const* end_;
+            const LineCol* lineCol_;
+        };
+
+        Range()
+            : values_(nullptr), lineCols_(nullptr), size_(0)
+        {}
+
+        Range(const Lexeme* const* values, const LineCol* lineCols, size_t size)
+            : values_(values), lineCols_(lineCols), size_(size)
+        {}
+
+        const_iterator begin() const
+        {
+            return const_iterator(values_, values_ + size_, lineCols_);
+        }
+
+        const_iterator end() const
+        {
+            return const_iterator(values_ + size_, values_ + size_,
+                                  lineCols_ + size_);
+        }
+
+        bool empty() const
+        {
+            return begin() == end();
+        }
+
+    private:
+        const Lexeme* const* values_;
+        const LineCol* lineCols_;
+        size_t size_;
+    };
+
     /*!
      * \brief insertOrFind
      *
      * Insert the lexeme with the spelling \a spell at line/column
-     * \a lineCol of the file \a fullFileName.
+     * \a lineCol of the file \a fileId.
      */
     template <class ValueT>
     const ValueT* insertOrFind(const std::string& spell,
-                               const std::string& fullFileName,
+                               FileId fileId,
                                const LineCol& lineCol);
 
+    /*!
+     * \brief insertOrFind
+     *
+     * Insert the lexeme with the spelling given by the first \a len chars
+     * of \a spell.
+     */
+    template <class ValueT>
+    const ValueT* insertOrFind(const char* spell,
+                               size_t len,
+                               FileId fileId,
+                               const LineCol& lineCol);
+
+    /*!
+     * \brief intern
+     *
+     * Insert the lexeme with the spelling \a spell without placing it at
+     * any line/column, as for the ones which don't come from a source file
+     * (e.g., builtins).
+     */
+    template <class ValueT>
+    const ValueT* intern(const std::string& spell);
+
     /*!
      * \brief findAt
      *
      * Return the lexeme at the line/column \a lineCol of the file
-     * \a fullFileName. If no lexeme can be found, return null.
+     * \a fileId. If no lexeme can be found, return null.
      */
     template <class ValueT>
-    const ValueT* findAt(const std::string& fullFileName,
+    const ValueT* findAt(FileId fileId,
                          const LineCol& lineCol) const;
 
     /*!
@@ -89,10 +213,12 @@ public:
 
     /*!
      * \brief list
-     * \warning This method creates copies of the map's underlying storage.
+     *
+     * Return a view over the lexemes of type \a ValueT in the file \a fileId,
+     * in source order.
      */
     template <class ValueT>
-    std::vector<LexemeInfo<ValueT>> list(const std::string& fullFileName) const;
+    Range<ValueT> list(FileId fileId) const;
 
     /*!
      * \brief clear
@@ -101,9 +227,18 @@ public:
 
     /*!
      * \brief clear
-     * \param fullFileName
+     * \param fileId
+     */
+    void clear(FileId fileId);
+
+    /*!
+     * \brief stamp
+     *
+     * Return a number which identifies the lexemes this map holds: it's
+     * unique across maps and it changes when the map is cleared. Data that
+     * refers to lexemes and outlives a parse can be keyed by it.
      */
-    void clear(const std::string& fullFileName);
+    uint64_t stamp() const;
 
     /*!
      * \brief selfIdent
@@ -115,6 +250,7 @@ public:
 
 private:
     DECL_PIMPL(LexemeMap)
+    DECL_CLASS_TEST(LexemeMap)
 
     void insertPredefined();
 };
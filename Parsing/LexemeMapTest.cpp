@@ -0,0 +1,222 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+#include "Parsing/LexemeMap.h"
+#include "Parsing/Lexeme.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace uaiso;
+
+class LexemeMap::LexemeMapTest final : public Test
+{
+public:
+    TEST_RUN(LexemeMapTest
+             , &LexemeMapTest::testCase1
+             , &LexemeMapTest::testCase2
+             , &LexemeMapTest::testCase3
+             , &LexemeMapTest::testCase4
+             , &LexemeMapTest::testCase5
+             , &LexemeMapTest::testCase6
+             , &LexemeMapTest::testCase7
+             , &LexemeMapTest::testCase8
+             )
+
+    void testCase1()
+    {
+        auto file = FileRegistry::insertOrFind("/lexeme_map_test/a.py");
+        LexemeMap lexs;
+        auto foo = lexs.insertOrFind<Ident>("foo", file, LineCol(1, 0));
+        UAISO_EXPECT_STR_EQ("foo", foo->str());
+        UAISO_EXPECT_PTR_EQ(foo, lexs.insertOrFind<Ident>("foo", file, LineCol(2, 0)));
+        UAISO_EXPECT_PTR_EQ(foo, lexs.insertOrFind<Ident>("foobar", 3, file, LineCol(3, 0)));
+        UAISO_EXPECT_PTR_EQ(foo, lexs.findAnyOf<Ident>("foo"));
+        UAISO_EXPECT_PTR_EQ(foo, lexs.findAt<Ident>(file, LineCol(3, 0)));
+        UAISO_EXPECT_FALSE(lexs.findAnyOf<Ident>("fo"));
+        UAISO_EXPECT_FALSE(lexs.findAnyOf<Ident>("fooo"));
+    }
+
+    void testCase2()
+    {
+        // Same spelling, different kinds, are different lexemes.
+        auto file = FileRegistry::insertOrFind("/lexeme_map_test/a.py");
+        LexemeMap lexs;
+        auto ident = lexs.insertOrFind<Ident>("123", file, LineCol(1, 0));
+        auto num = lexs.insertOrFind<NumLit>("123", file, LineCol(1, 4));
+        UAISO_EXPECT_TRUE(static_cast<const Lexeme*>(ident)
+                          != static_cast<const Lexeme*>(num));
+        UAISO_EXPECT_PTR_EQ(ident, lexs.findAnyOf<Ident>("123"));
+        UAISO_EXPECT_PTR_EQ(num, lexs.findAnyOf<NumLit>("123"));
+        UAISO_EXPECT_FALSE(lexs.findAnyOf<StrLit>("123"));
+    }
+
+    void testCase3()
+    {
+        // Pointers remain stable while the interner grows.
+        auto file = FileRegistry::insertOrFind("/lexeme_map_test/a.py");
+        LexemeMap lexs;
+        std::vector<const Ident*> idents;
+        for (int i = 0; i < 20000; ++i) {
+            idents.push_back(lexs.insertOrFind<Ident>("id" + std::to_string(i),
+                                                      file, LineCol(i, 0)));
+        }
+        for (int i = 0; i < 20000; ++i) {
+            auto ident = lexs.findAnyOf<Ident>("id" + std::to_string(i));
+            UAISO_EXPECT_PTR_EQ(idents[i], ident);
+            UAISO_EXPECT_STR_EQ("id" + std::to_string(i), ident->str());
+        }
+    }
+
+    void testCase4()
+    {
+        auto file = FileRegistry::insertOrFind("/lexeme_map_test/a.py");
+        LexemeMap lexs;
+        lexs.insertOrFind<Ident>("foo", file, LineCol(1, 0));
+        lexs.clear();
+        UAISO_EXPECT_FALSE(lexs.findAnyOf<Ident>("foo"));
+        UAISO_EXPECT_FALSE(lexs.findAt<Ident>(file, LineCol(1, 0)));
+        UAISO_EXPECT_PTR_EQ(lexs.self(), lexs.findAnyOf<Ident>("self"));
+    }
+
+    void testCase5()
+    {
+        // Several threads, each one on its own file, interning an
+        // overlapping set of identifiers. They must all agree on the
+        // interned instances.
+        const int kThreads = 8;
+        const int kIdents = 4096; // Power of 2, so any odd stride is a permutation.
+        LexemeMap lexs;
+        std::vector<std::vector<const Ident*>> seen(kThreads);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&lexs, &seen, t, kIdents] () {
+                auto file = FileRegistry::insertOrFind(
+                            "/lexeme_map_test/t" + std::to_string(t) + ".py");
+                for (int i = 0; i < kIdents; ++i) {
+                    // Walk in a different order on each thread.
+                    int k = (i * (2 * t + 1)) % kIdents;
+                    seen[t].push_back(lexs.insertOrFind<Ident>(
+                        "id" + std::to_string(k), file, LineCol(k, 0)));
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        for (int t = 0; t < kThreads; ++t) {
+            auto file = FileRegistry::find("/lexeme_map_test/t"
+                                           + std::to_string(t) + ".py");
+            for (int k = 0; k < kIdents; ++k) {
+                auto ident = lexs.findAnyOf<Ident>("id" + std::to_string(k));
+                UAISO_EXPECT_TRUE(ident);
+                UAISO_EXPECT_PTR_EQ(ident, lexs.findAt<Ident>(file, LineCol(k, 0)));
+            }
+            for (int i = 0; i < kIdents; ++i) {
+                int k = (i * (2 * t + 1)) % kIdents;
+                UAISO_EXPECT_PTR_EQ(lexs.findAnyOf<Ident>("id" + std::to_string(k)),
+                                    seen[t][i]);
+            }
+        }
+    }
+
+    void testCase6()
+    {
+        // Listing is in source order, even when a position is inserted
+        // behind the last one, and only yields lexemes of the given type.
+        auto file = FileRegistry::insertOrFind("/lexeme_map_test/a.py");
+        LexemeMap lexs;
+        auto a = lexs.insertOrFind<Ident>("a", file, LineCol(1, 0));
+        auto b = lexs.insertOrFind<Ident>("b", file, LineCol(2, 4));
+        lexs.insertOrFind<NumLit>("1", file, LineCol(2, 8));
+        auto c = lexs.insertOrFind<Ident>("c", file, LineCol(2, 0));
+        auto d = lexs.insertOrFind<Ident>("d", file, LineCol(0, 9));
+        UAISO_EXPECT_PTR_EQ(c, lexs.findAt<Ident>(file, LineCol(2, 0)));
+        UAISO_EXPECT_PTR_EQ(b, lexs.insertOrFind<Ident>("b", file, LineCol(2, 4)));
+
+        std::vector<const Ident*> idents;
+        std::vector<LineCol> lineCols;
+        for (auto info : lexs.list<Ident>(file)) {
+            idents.push_back(std::get<0>(info));
+            lineCols.push_back(std::get<1>(info));
+        }
+        UAISO_EXPECT_INT_EQ(4, idents.size());
+        UAISO_EXPECT_PTR_EQ(d, idents[0]);
+        UAISO_EXPECT_PTR_EQ(a, idents[1]);
+        UAISO_EXPECT_PTR_EQ(c, idents[2]);
+        UAISO_EXPECT_PTR_EQ(b, idents[3]);
+        UAISO_EXPECT_TRUE(lineCols[0] == LineCol(0, 9));
+        UAISO_EXPECT_TRUE(lineCols[3] == LineCol(2, 4));
+
+        auto nums = lexs.list<NumLit>(file);
+        UAISO_EXPECT_FALSE(nums.empty());
+        UAISO_EXPECT_TRUE(LineCol(2, 8) == std::get<1>(*nums.begin()));
+        UAISO_EXPECT_TRUE(lexs.list<StrLit>(file).empty());
+        UAISO_EXPECT_TRUE(lexs.list<Ident>(FileId()).empty());
+    }
+
+    void testCase7()
+    {
+        // Positions whose line and column are swapped or equal are told
+        // apart.
+        auto file = FileRegistry::insertOrFind("/lexeme_map_test/a.py");
+        LexemeMap lexs;
+        for (int i = 0; i < 100; ++i) {
+            for (int j = 0; j < 100; ++j) {
+                lexs.insertOrFind<Ident>(std::to_string(i * 100 + j),
+                                         file, LineCol(i, j));
+            }
+        }
+        for (int i = 0; i < 100; ++i) {
+            for (int j = 0; j < 100; ++j) {
+                UAISO_EXPECT_STR_EQ(std::to_string(i * 100 + j),
+                                    lexs.findAt<Ident>(file, LineCol(i, j))->str());
+            }
+        }
+        UAISO_EXPECT_FALSE(lexs.findAt<Ident>(file, LineCol(100, 0)));
+        UAISO_EXPECT_FALSE(lexs.findAt<Ident>(file, LineCol(-1, 0)));
+    }
+
+    void testCase8()
+    {
+        // Interning places nothing in a file and clearing changes the stamp.
+        auto file = FileRegistry::insertOrFind("/lexeme_map_test/a.py");
+        LexemeMap lexs;
+        LexemeMap other;
+        UAISO_EXPECT_TRUE(lexs.stamp() != other.stamp());
+        auto foo = lexs.intern<Ident>("foo");
+        UAISO_EXPECT_PTR_EQ(foo, lexs.intern<Ident>("foo"));
+        UAISO_EXPECT_PTR_EQ(foo, lexs.findAnyOf<Ident>("foo"));
+        UAISO_EXPECT_PTR_EQ(foo, lexs.insertOrFind<Ident>("foo", file, LineCol(1, 0)));
+        UAISO_EXPECT_FALSE(other.findAnyOf<Ident>("foo"));
+
+        auto stamp = lexs.stamp();
+        lexs.clear(file);
+        UAISO_EXPECT_INT_EQ(stamp, lexs.stamp());
+        UAISO_EXPECT_PTR_EQ(foo, lexs.findAnyOf<Ident>("foo"));
+        lexs.clear();
+        UAISO_EXPECT_TRUE(stamp != lexs.stamp());
+        UAISO_EXPECT_FALSE(lexs.findAnyOf<Ident>("foo"));
+    }
+};
+
+MAKE_CLASS_TEST(LexemeMap)
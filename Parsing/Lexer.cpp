@@ -27,6 +27,9 @@
 #include "Common/Assert.h"
 #include <cctype>
 #include <iostream>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 using namespace uaiso;
 
@@ -44,6 +47,22 @@ void Lexer::setBuffer(const char* buff, size_t len)
     eof_ = buff + len;
 }
 
+void Lexer::setBuffer(const char* buff, size_t len, const LineCol& lineCol)
+{
+    setBuffer(buff, len);
+    line_ = lineCol.line_;
+    col_ = lineCol.col_;
+}
+
+void Lexer::saveState(LexerState& state) const
+{
+    state.bits_ = 0;
+    state.stack_.clear();
+}
+
+void Lexer::restoreState(const LexerState&)
+{}
+
 void Lexer::setContext(ParsingContext *context)
 {
     context_ = context;
@@ -51,14 +70,14 @@ void Lexer::setContext(ParsingContext *context)
 
 SourceLoc Lexer::tokenLoc() const
 {
-    SourceLoc loc(line_, col_, line_ + breaks_, col_ + (curr_ - mark_), "");
-    if (breaks_)
-        loc.lastCol_ = rearLeng_ - 1; // Not a past-the-end value.
-    return loc;
+    // Not a past-the-end value on a line of its own.
+    const int lastCol = breaks_ ? rearLeng_ - 1 : col_ + int(curr_ - mark_);
+    return SourceLoc(line_, col_, line_ + breaks_, lastCol, FileId());
 }
 
 void Lexer::updatePos()
 {
+    lexeme_ = nullptr;
     if (breaks_) {
         line_ += breaks_;
         breaks_ = 0;
@@ -84,11 +103,13 @@ void Lexer::skipSpaces(char& ch)
 {
     UAISO_ASSERT(ch == '\f' || ch == '\t' || ch == ' ', return);
 
-    do {
-        ch = consumeCharPeekNext();
-        ++col_;
-        ++mark_;
-    } while (ch == '\f' || ch == '\t' || ch == ' ');
+    const char* pos = curr_ + 1;
+    while (pos != eof_ && (*pos == ' ' || *pos == '\t' || *pos == '\f'))
+        ++pos;
+    col_ += pos - curr_;
+    mark_ += pos - curr_;
+    advanceTo(pos);
+    ch = peekChar();
 }
 
 void Lexer::maybeSkipSpaces(char& ch)
@@ -118,6 +139,45 @@ char Lexer::consumeCharPeekNext(size_t dist)
     return peekChar();
 }
 
+char Lexer::consumeWhile(const CharClassTable& chars, uint16_t cls)
+{
+    const char* pos = curr_;
+    while (pos != eof_ && chars.is(*pos, cls))
+        ++pos;
+    advanceTo(pos);
+    return peekChar();
+}
+
+const char* Lexer::findFirstOf(char a, char b, char c) const
+{
+    const char* pos = curr_;
+#ifdef __SSE2__
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    const __m128i vc = _mm_set1_epi8(c);
+    const __m128i vnull = _mm_setzero_si128();
+    for (; eof_ - pos >= 16; pos += 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+        const __m128i hits = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(block, va), _mm_cmpeq_epi8(block, vb)),
+                    _mm_or_si128(_mm_cmpeq_epi8(block, vc), _mm_cmpeq_epi8(block, vnull)));
+        if (const int mask = _mm_movemask_epi8(hits))
+            return pos + __builtin_ctz(mask);
+    }
+#endif
+    while (pos != eof_ && *pos != a && *pos != b && *pos != c && *pos)
+        ++pos;
+    return pos;
+}
+
+void Lexer::advanceTo(const char* pos)
+{
+    UAISO_ASSERT(pos >= curr_ && pos <= eof_, return);
+
+    rearLeng_ += pos - curr_;
+    curr_ = pos;
+}
+
 Token Lexer::lexStrLit(char& ch, const bool mayBreak, const Lang* lang)
 {
     UAISO_ASSERT(ch == '"' || ch == '\'', return TK_INVALID);
@@ -132,7 +192,14 @@ Token Lexer::lexStrLitEnd(char& ch, const char quote, const bool mayBreak, const
 {
     UAISO_ASSERT(ch != '"' || ch != '\'', return TK_INVALID);
 
-    while (ch && ch != quote) {
+    // Ordinary characters are skipped in bulk, stopping only at those that
+    // require attention.
+    while (true) {
+        advanceTo(findFirstOf(quote, '\\', '\n'));
+        ch = peekChar();
+        if (!ch || ch == quote)
+            break;
+
         if (ch == '\\') {
             ch = consumeCharPeekNext();
             // Current character must be a valid escape. This includes a line
@@ -170,9 +237,8 @@ Token Lexer::lexIdentOrKeyword(char& ch, const Lang* lang)
 {
     UAISO_ASSERT(lang->isIdentFirstChar(ch), return TK_INVALID);
 
-    ch = consumeCharPeekNext();
-    while (lang->isIdentChar(ch))
-        ch = consumeCharPeekNext();
+    consumeChar();
+    ch = consumeWhile(lang->charClasses(), CharClassTable::Ident);
 
     const Token tk = filterKeyword(mark_, curr_ - mark_);
     if (tk != TK_INVALID) {
@@ -197,6 +263,7 @@ Token Lexer::lexNumLit(char& ch, const Lang* lang)
                      || (ch == '.' && !lang->hasStrictDecimalPoint()),
                  return TK_INVALID);
 
+    const CharClassTable& chars = lang->charClasses();
     if (ch == '0') {
         ch = consumeCharPeekNext();
 
@@ -211,10 +278,9 @@ Token Lexer::lexNumLit(char& ch, const Lang* lang)
         }
 
         // Hex format
-        if (lang->isHexPrefix(ch) && std::isxdigit(peekChar(1))) {
-            ch = consumeCharPeekNext(1);
-            while (ch && std::isxdigit(ch))
-                ch = consumeCharPeekNext();
+        if (lang->isHexPrefix(ch) && chars.is(peekChar(1), CharClassTable::HexDigit)) {
+            consumeChar(1);
+            ch = consumeWhile(chars, CharClassTable::HexDigit);
         }
 
         // Bin format
@@ -228,8 +294,7 @@ Token Lexer::lexNumLit(char& ch, const Lang* lang)
         }
     }
 
-    while (ch && std::isdigit(ch))
-        ch = consumeCharPeekNext();
+    ch = consumeWhile(chars, CharClassTable::Digit);
 
     // Long integer
     if (ch && lang->isLongSuffix(ch)) {
@@ -239,7 +304,7 @@ Token Lexer::lexNumLit(char& ch, const Lang* lang)
 
     if (ch && (lang->isExponent(ch)
                || (ch == '.' && (!lang->hasStrictDecimalPoint()
-                                 || std::isdigit(peekChar(1)))))) {
+                                 || chars.is(peekChar(1), CharClassTable::Digit))))) {
         return lexFloatLit(ch, lang);
     }
 
@@ -253,18 +318,17 @@ Token Lexer::lexFloatLit(char& ch, const Lang* lang)
                                       || std::isdigit(peekChar(1)))),
                   return TK_INVALID);
 
+    const CharClassTable& chars = lang->charClasses();
     if (ch == '.')
         ch = consumeCharPeekNext();
 
-    while (ch && std::isdigit(ch))
-        ch = consumeCharPeekNext();
+    ch = consumeWhile(chars, CharClassTable::Digit);
 
     if (lang->isExponent(ch)) {
         ch = consumeCharPeekNext();
         if (ch == '+' || ch == '-')
             ch = consumeCharPeekNext();
-        while (ch && std::isdigit(ch))
-            ch = consumeCharPeekNext();
+        ch = consumeWhile(chars, CharClassTable::Digit);
     }
 
     return TK_FLOAT_LIT;
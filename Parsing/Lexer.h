@@ -25,15 +25,44 @@
 #define UAISO_LEXER_H__
 
 #include "Common/Config.h"
+#include "Common/LineCol.h"
 #include "Parsing/SourceLoc.h"
 #include "Parsing/Token.h"
 #include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace uaiso {
 
+class CharClassTable;
 class ParsingContext;
 class Lang;
+class Lexeme;
+
+/*!
+ * \brief The LexerState struct
+ *
+ * What a lexer carries from one token into the next, other than its position
+ * in the buffer, such as Python's indentation stack. Together with a position
+ * at a token boundary, it allows lexing to be resumed from there. An empty
+ * state is a lexer's initial one.
+ */
+struct UAISO_API LexerState
+{
+    uint32_t bits_ { 0 };
+    std::vector<size_t> stack_;
+};
+
+inline bool operator==(const LexerState& a, const LexerState& b)
+{
+    return a.bits_ == b.bits_ && a.stack_ == b.stack_;
+}
+
+inline bool operator!=(const LexerState& a, const LexerState& b)
+{
+    return !(a == b);
+}
 
 /*!
  * \brief The Lexer class
@@ -50,6 +79,17 @@ public:
      */
     void setBuffer(const char* buff, size_t len);
 
+    /*!
+     * \brief setBuffer
+     * \param buff
+     * \param len
+     * \param lineCol
+     *
+     * Set a buffer whose first character is at the given line and column of
+     * the source, as when lexing is resumed from the middle of it.
+     */
+    void setBuffer(const char* buff, size_t len, const LineCol& lineCol);
+
     /*!
      * \brief setContext
      * \param context
@@ -74,6 +114,32 @@ public:
      */
     SourceLoc tokenLoc() const;
 
+    /*!
+     * \brief lexeme
+     * \return
+     *
+     * Return the lexeme of the lastly lexed token, if it has one and lexemes
+     * are being tracked. Otherwise, return null.
+     */
+    const Lexeme* lexeme() const { return lexeme_; }
+
+    /*!
+     * \brief saveState
+     * \param state
+     *
+     * Save the lexer's state, as of the end of the lastly lexed token.
+     */
+    virtual void saveState(LexerState& state) const;
+
+    /*!
+     * \brief restoreState
+     * \param state
+     *
+     * Restore a previously saved state, typically right after a buffer is set
+     * at the position where the state was saved.
+     */
+    virtual void restoreState(const LexerState& state);
+
 protected:
     Lexer();
 
@@ -85,6 +151,41 @@ protected:
     void consumeChar(size_t dist = 0);
     char consumeCharPeekNext(size_t dist = 0);
 
+    /*!
+     * \brief consumeWhile
+     * \param chars
+     * \param cls
+     * \return
+     *
+     * Consume the run of characters, starting at the current one, that are
+     * in any of the classes \a cls of table \a chars. Return the character
+     * that follows the run.
+     */
+    char consumeWhile(const CharClassTable& chars, uint16_t cls);
+
+    /*!
+     * \brief findFirstOf
+     * \param a
+     * \param b
+     * \param c
+     * \return
+     *
+     * Return the position of the first character, starting at the current
+     * one, that is either \a a, \a b, \a c, or null. Return the end of the
+     * buffer if there's none. Long runs are scanned in SIMD blocks, where
+     * available.
+     */
+    const char* findFirstOf(char a, char b = 0, char c = 0) const;
+
+    /*!
+     * \brief advanceTo
+     * \param pos
+     *
+     * Consume all characters up to \a pos, which must be within the line
+     * of the current one.
+     */
+    void advanceTo(const char* pos);
+
     void skipSpaces(char& ch);
     void maybeSkipSpaces(char& ch);
 
@@ -138,6 +239,8 @@ protected:
     int breaks_ { 0 };      //!< Number of line breaks within a token.
     int rearLeng_ { 0 };    //!< Length of a token's last line.
 
+    const Lexeme* lexeme_ { nullptr }; //!< Lexeme of the current token.
+
     ParsingContext* context_ { nullptr };
 };
 
@@ -37,7 +37,8 @@ void Parser::consumeToken()
 
     // Track previous token location.
     lastLoc_ = lexer_->tokenLoc();
-    lastLoc_.fileName_ = context_->fileName();
+    lastLoc_.fileId_ = context_->fileId();
+    lastLexeme_ = lexer_->lexeme();
     ahead_ = lexer_->lex();
 }
 
@@ -74,6 +75,6 @@ void Parser::failMatch(bool consume)
         consumeToken();
 
     DEBUG_TRACE("error at %d:%d unexpected token (%s)\n",
-                lastLoc_.lastLine_, lastLoc_.lastCol_, lastLoc_.fileName_.c_str());
+                lastLoc_.lastLine_, lastLoc_.lastCol_, lastLoc_.fileName().c_str());
     context_->trackReport(Diagnostic::UnexpectedToken, lastLoc_);
 }
@@ -32,6 +32,7 @@
 
 namespace uaiso {
 
+class Lexeme;
 class Lexer;
 class ParsingContext;
 
@@ -89,6 +90,7 @@ protected:
     ParsingContext* context_ { nullptr };
     Token ahead_ { TK_INVALID };
     SourceLoc lastLoc_;
+    const Lexeme* lastLexeme_ { nullptr };
 };
 
 } // namespace uaiso
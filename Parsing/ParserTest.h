@@ -22,7 +22,6 @@
 /*--------------------------*/
 
 #include "Ast/AstDumper.h"
-#include "Ast/AstSerializer.h"
 #include "Common/Test.h"
 #include "Parsing/Factory.h"
 #include "Parsing/Lexer.h"
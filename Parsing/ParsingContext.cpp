@@ -28,6 +28,7 @@
 #include "Parsing/TokenMap.h"
 #include "Ast/Ast.h"
 #include "Common/Util__.h"
+#include <cstring>
 #include <iostream>
 
 using namespace uaiso;
@@ -42,6 +43,7 @@ ParsingContext::~ParsingContext()
 void ParsingContext::setFileName(const char* fullFileName)
 {
     fileName_ = fullFileName;
+    fileId_ = FileRegistry::insertOrFind(fullFileName);
 }
 
 const char *ParsingContext::fileName() const
@@ -49,6 +51,11 @@ const char *ParsingContext::fileName() const
     return fileName_;
 }
 
+FileId ParsingContext::fileId() const
+{
+    return fileId_;
+}
+
 void ParsingContext::setAllowComments(bool enable)
 {
     bit_.comments_ = enable;
@@ -59,6 +66,21 @@ bool ParsingContext::allowComments() const
     return bit_.comments_;
 }
 
+void ParsingContext::setSkipBodies(bool enable)
+{
+    bit_.skipBodies_ = enable;
+}
+
+bool ParsingContext::skipBodies() const
+{
+    return bit_.skipBodies_;
+}
+
+bool ParsingContext::startsFuncBody() const
+{
+    return false;
+}
+
 void ParsingContext::setStopMark(const LineCol& lineCol)
 {
     stopMark_ = lineCol;
@@ -132,39 +154,39 @@ void ParsingContext::trackPhrase(Token tk,
 void ParsingContext::trackToken(Token tk, const LineCol& lineCol)
 {
     if (tokens_)
-        tokens_->insertOrFind(tk, fileName_, lineCol);
+        tokens_->insertOrFind(tk, fileId_, lineCol);
 }
 
 template <class LexemeT>
-void ParsingContext::trackLexeme(const char* lex, const LineCol& lineCol)
+const LexemeT* ParsingContext::trackLexeme(const char* lex, const LineCol& lineCol)
 {
-    if (lexs_)
-        lexs_->insertOrFind<LexemeT>(lex, fileName_, lineCol);
+    if (!lexs_)
+        return nullptr;
+    return lexs_->insertOrFind<LexemeT>(lex, std::strlen(lex), fileId_, lineCol);
 }
 
 template <class LexemeT>
-void ParsingContext::trackLexeme(const char* lex,
-                                 int count,
-                                 const LineCol& lineCol)
+const LexemeT* ParsingContext::trackLexeme(const char* lex,
+                                           int count,
+                                           const LineCol& lineCol)
 {
-    if (lexs_)
-        lexs_->insertOrFind<LexemeT>(std::string(lex, count),
-                                        fileName_,
-                                        lineCol);
+    if (!lexs_)
+        return nullptr;
+    return lexs_->insertOrFind<LexemeT>(lex, count, fileId_, lineCol);
 }
 
 // Explicit instantiations for the known lexemes.
-template void
+template const Ident*
 ParsingContext::trackLexeme<Ident>(const char* lex, const LineCol& lineCol);
-template void
+template const Ident*
 ParsingContext::trackLexeme<Ident>(const char* lex, int count, const LineCol& lineCol);
-template void
+template const StrLit*
 ParsingContext::trackLexeme<StrLit>(const char* lex, const LineCol& lineCol);
-template void
+template const StrLit*
 ParsingContext::trackLexeme<StrLit>(const char* lex, int count, const LineCol& lineCol);
-template void
+template const NumLit*
 ParsingContext::trackLexeme<NumLit>(const char* lex, const LineCol& lineCol);
-template void
+template const NumLit*
 ParsingContext::trackLexeme<NumLit>(const char* lex, int count, const LineCol& lineCol);
 
 void ParsingContext::takeAst(std::unique_ptr<Ast> ast)
@@ -28,6 +28,7 @@
 #include "Common/Config.h"
 #include "Common/LineCol.h"
 #include "Parsing/Diagnostic.h"
+#include "Parsing/FileRegistry.h"
 #include "Parsing/Token.h"
 #include <memory>
 #include <utility>
@@ -68,6 +69,14 @@ public:
      */
     const char* fileName() const;
 
+    /*!
+     * \brief fileId
+     * \return
+     *
+     * Return the id under which the file name is registered.
+     */
+    FileId fileId() const;
+
     /*!
      * \brief setAllowComments
      * \param enable
@@ -80,6 +89,54 @@ public:
      */
     bool allowComments() const;
 
+    /*!
+     * \brief setSkipBodies
+     * \param enable
+     *
+     * Ask the parser to skip over function bodies, building no AST for them.
+     */
+    void setSkipBodies(bool enable);
+
+    /*!
+     * \brief skipBodies
+     * \return
+     */
+    bool skipBodies() const;
+
+    /*!
+     * \brief startsFuncBody
+     * \return
+     *
+     * Return whether the opening brace the lexer is about to hand over starts
+     * the body of a function which is to be skipped. A lexer that skips bodies
+     * by brace matching asks before every opening brace, while the context of
+     * its language decides from the tokens handed over so far.
+     *
+     * \sa enterSkippedBody
+     */
+    virtual bool startsFuncBody() const;
+
+    /*!
+     * \brief enterSkippedBody
+     *
+     * Start matching the braces of a skipped body, whose opening brace has
+     * just been lexed.
+     */
+    void enterSkippedBody() { skippedDepth_ = 1; }
+
+    /*!
+     * \brief enterSkippedBrace
+     */
+    void enterSkippedBrace() { ++skippedDepth_; }
+
+    /*!
+     * \brief leaveSkippedBrace
+     * \return
+     *
+     * Return whether the closing brace ends the skipped body.
+     */
+    bool leaveSkippedBrace() { return --skippedDepth_ == 0; }
+
     /*!
      * \brief collectLexemes
      * \param lexs
@@ -120,18 +177,20 @@ public:
      * \brief trackLexeme
      * \param lex     - must be null terminated
      * \param lineCol    - line and column
+     * \return the interned lexeme, or null if lexemes aren't being collected
      */
     template <class LexemeT>
-    void trackLexeme(const char* lex, const LineCol& lineCol);
+    const LexemeT* trackLexeme(const char* lex, const LineCol& lineCol);
 
     /*!
      * \brief trackLexeme
      * \param lex     - doesn't need to be null terminated
      * \param count      - number of lex characters
      * \param lineCol    - line and column
+     * \return the interned lexeme, or null if lexemes aren't being collected
      */
     template <class LexemeT>
-    void trackLexeme(const char* lex, int count, const LineCol& lineCol);
+    const LexemeT* trackLexeme(const char* lex, int count, const LineCol& lineCol);
 
     /*!
      * \brief trackToken
@@ -234,6 +293,7 @@ public:
 
 protected:
     const char* fileName_ { nullptr };
+    FileId fileId_;
     LexemeMap* lexs_ { nullptr };
     TokenMap* tokens_ { nullptr };
     Phrasing* phrasing_ { nullptr };
@@ -247,12 +307,16 @@ protected:
     //! until it eventually sends an EOF.
     size_t toleranceCounter_ { 20 };
 
+    //! Depth of braces within a body being skipped.
+    int skippedDepth_ { 0 };
+
     struct BitFields
     {
         uint8_t comments_                 : 1;
         uint8_t prevTkTerminated_         : 1;
         uint8_t acceptEOF_                : 1;
         uint8_t hasState_                 : 1;
+        uint8_t skipBodies_               : 1;
     };
     union
     {
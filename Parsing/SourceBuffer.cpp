@@ -0,0 +1,218 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#include "Parsing/SourceBuffer.h"
+#include "Common/Assert.h"
+#include "Common/Trace__.h"
+#include <cerrno>
+#include <cstring>
+#if !defined _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define UAISO_HAS_MMAP
+#endif
+
+#define TRACE_NAME "SourceBuffer"
+
+using namespace uaiso;
+
+namespace {
+
+// Below this size, a read is cheaper than the mapping and the page faults.
+const size_t kMapThreshold = 1 << 20;
+
+} // anonymous
+
+struct uaiso::SourceBuffer::SourceBufferImpl
+{
+    ~SourceBufferImpl()
+    {
+#ifdef UAISO_HAS_MMAP
+        if (mapLen_)
+            munmap(data_, mapLen_);
+#endif
+    }
+
+    /*!
+     * \brief allocate
+     *
+     * Allocate room for \a capacity characters plus padding.
+     */
+    void allocate(size_t capacity)
+    {
+        heap_.reset(new char[capacity + kPadding]);
+        data_ = heap_.get();
+        resize(capacity);
+    }
+
+    /*!
+     * \brief resize
+     *
+     * Set the size of the contents, which is never beyond the allocated
+     * capacity, and pad them.
+     */
+    void resize(size_t size)
+    {
+        size_ = size;
+        std::memset(data_ + size, 0, kPadding);
+    }
+
+#ifdef UAISO_HAS_MMAP
+    bool map(int fd, size_t size)
+    {
+        // Reserve room for the contents plus padding with an anonymous
+        // (zero-filled) mapping and place the file over it. Whatever comes
+        // after the file, either the rest of its last page or the anonymous
+        // page, is zeroed and serves as padding.
+        const size_t pageSize = sysconf(_SC_PAGESIZE);
+        const size_t mapLen = (size + kPadding + pageSize - 1) / pageSize * pageSize;
+        void* base = mmap(nullptr, mapLen, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED)
+            return false;
+        if (mmap(base, size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+            munmap(base, mapLen);
+            return false;
+        }
+        madvise(base, mapLen, MADV_SEQUENTIAL);
+        data_ = static_cast<char*>(base);
+        size_ = size;
+        mapLen_ = mapLen;
+        return true;
+    }
+
+    bool read(int fd, size_t size)
+    {
+        allocate(size);
+        size_t count = 0;
+        while (count < size) {
+            ssize_t got = ::read(fd, data_ + count, size - count);
+            if (got == -1) {
+                if (errno == EINTR)
+                    continue; // Interrupted by a signal, nothing was read.
+                return false;
+            }
+            if (got == 0)
+                break; // The file shrank.
+            count += got;
+        }
+        resize(count);
+        return true;
+    }
+#endif
+
+    char* data_ { nullptr };
+    size_t size_ { 0 };
+    size_t mapLen_ { 0 }; //!< Length of the mapping, zero if not mapped.
+    std::unique_ptr<char[]> heap_;
+};
+
+SourceBuffer::SourceBuffer()
+    : P(new SourceBufferImpl)
+{}
+
+SourceBuffer::~SourceBuffer()
+{}
+
+std::unique_ptr<SourceBuffer> SourceBuffer::load(const std::string& fullFileName)
+{
+#ifdef UAISO_HAS_MMAP
+    int fd = open(fullFileName.c_str(), O_RDONLY);
+    if (fd == -1)
+        return std::unique_ptr<SourceBuffer>();
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        const size_t size = st.st_size;
+        std::unique_ptr<SourceBuffer> buffer(new SourceBuffer);
+        bool ok = (size >= kMapThreshold && buffer->P->map(fd, size))
+                || buffer->P->read(fd, size);
+        close(fd);
+        if (ok)
+            return buffer;
+        DEBUG_TRACE("cannot load %s\n", fullFileName.c_str());
+        return std::unique_ptr<SourceBuffer>();
+    }
+    close(fd);
+#endif
+
+    // Not a regular file (or no POSIX), go through stdio.
+    FILE* file = fopen(fullFileName.c_str(), "rb");
+    if (!file)
+        return std::unique_ptr<SourceBuffer>();
+    auto buffer = read(file);
+    fclose(file);
+    return buffer;
+}
+
+std::unique_ptr<SourceBuffer> SourceBuffer::read(FILE* file)
+{
+    UAISO_ASSERT(file, return std::unique_ptr<SourceBuffer>());
+
+    std::unique_ptr<SourceBuffer> buffer(new SourceBuffer);
+    size_t capacity = BUFSIZ;
+    size_t count = 0;
+    buffer->P->allocate(capacity);
+    while (true) {
+        count += fread(buffer->P->data_ + count, 1, capacity - count, file);
+        if (count < capacity)
+            break;
+        std::unique_ptr<char[]> old(buffer->P->heap_.release());
+        buffer->P->allocate(capacity * 2);
+        std::memcpy(buffer->P->data_, old.get(), count);
+        capacity *= 2;
+    }
+    buffer->P->resize(count);
+    return buffer;
+}
+
+std::unique_ptr<SourceBuffer> SourceBuffer::copy(const std::string& source)
+{
+    std::unique_ptr<SourceBuffer> buffer(new SourceBuffer);
+    buffer->P->allocate(source.size());
+    std::memcpy(buffer->P->data_, source.data(), source.size());
+    return buffer;
+}
+
+const char* SourceBuffer::data() const
+{
+    return P->data_;
+}
+
+size_t SourceBuffer::size() const
+{
+    return P->size_;
+}
+
+bool SourceBuffer::isMapped() const
+{
+    return P->mapLen_ != 0;
+}
+
+char* SourceBuffer::scanBuffer()
+{
+    return P->data_;
+}
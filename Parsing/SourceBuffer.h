@@ -0,0 +1,129 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#ifndef UAISO_SOURCEBUFFER_H__
+#define UAISO_SOURCEBUFFER_H__
+
+#include "Common/Config.h"
+#include "Common/Pimpl.h"
+#include "Common/Test.h"
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+namespace uaiso {
+
+/*!
+ * \brief The SourceBuffer class
+ *
+ * The contents of a source file, ready to be lexed in place. The contents
+ * are followed by kPadding null characters, as required by Flex's
+ * yy_scan_buffer, so neither the hand-written lexers nor the Flex scanners
+ * need a copy of their own.
+ */
+class UAISO_API SourceBuffer final
+{
+public:
+    ~SourceBuffer();
+
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+    //! Number of null characters after the contents.
+    static const size_t kPadding = 2;
+
+    /*!
+     * \brief load
+     * \param fullFileName
+     * \return
+     *
+     * Load the given file, bypassing stdio. Large files are memory-mapped
+     * (privately, so writes never reach the disk), others are read with a
+     * single system call, which is cheaper than setting up a mapping. Return
+     * null if the file can't be opened.
+     *
+     * \note A mapped file must not shrink while the buffer is alive: pages
+     * past its new end can't be backed and touching them raises SIGBUS. Source
+     * files are normally replaced (written to a new file and renamed) by
+     * editors, which leaves the mapping intact; a file truncated in place is
+     * the caller's responsibility.
+     */
+    static std::unique_ptr<SourceBuffer> load(const std::string& fullFileName);
+
+    /*!
+     * \brief read
+     * \param file
+     * \return
+     *
+     * Read the remaining contents of an already opened file.
+     */
+    static std::unique_ptr<SourceBuffer> read(FILE* file);
+
+    /*!
+     * \brief copy
+     * \param source
+     * \return
+     */
+    static std::unique_ptr<SourceBuffer> copy(const std::string& source);
+
+    /*!
+     * \brief data
+     * \return
+     */
+    const char* data() const;
+
+    /*!
+     * \brief size
+     * \return
+     *
+     * Return the size of the contents, not accounting for the padding.
+     */
+    size_t size() const;
+
+    /*!
+     * \brief isMapped
+     * \return
+     */
+    bool isMapped() const;
+
+    /*!
+     * \brief scanBuffer
+     * \return
+     *
+     * Return the buffer for a scanner that works in place, with size()
+     * + kPadding characters. The scanner may write to it, as long as it
+     * restores what it changes (which is what Flex does).
+     */
+    char* scanBuffer();
+
+private:
+    SourceBuffer();
+
+    DECL_CLASS_TEST(SourceBuffer)
+    DECL_PIMPL(SourceBuffer)
+};
+
+} // namespace uaiso
+
+#endif
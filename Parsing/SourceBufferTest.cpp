@@ -0,0 +1,133 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+#include "Parsing/SourceBuffer.h"
+#include "Parsing/Factory.h"
+#include "Parsing/LexemeMap.h"
+#include "Parsing/TokenMap.h"
+#include "Parsing/Unit.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+using namespace uaiso;
+
+class SourceBuffer::SourceBufferTest final : public Test
+{
+public:
+    TEST_RUN(SourceBufferTest
+             , &SourceBufferTest::testCase1
+             , &SourceBufferTest::testCase2
+             , &SourceBufferTest::testCase3
+             , &SourceBufferTest::testCase4
+             , &SourceBufferTest::testCase5
+             , &SourceBufferTest::testCase6
+             )
+
+    void testCase1()
+    {
+        auto buffer = SourceBuffer::copy("x = 1");
+        UAISO_EXPECT_FALSE(buffer->isMapped());
+        UAISO_EXPECT_INT_EQ(5, buffer->size());
+        UAISO_EXPECT_STR_EQ("x = 1", std::string(buffer->data(), buffer->size()));
+        checkPadding(buffer.get());
+    }
+
+    void testCase2()
+    {
+        auto fileName = writeFile("x = 1\n");
+        auto buffer = SourceBuffer::load(fileName);
+        unlink(fileName.c_str());
+        UAISO_EXPECT_TRUE(buffer);
+        UAISO_EXPECT_FALSE(buffer->isMapped()); // Too small to be worth it.
+        UAISO_EXPECT_STR_EQ("x = 1\n", std::string(buffer->data(), buffer->size()));
+        checkPadding(buffer.get());
+    }
+
+    void testCase3()
+    {
+        // A large file, filling whole pages: the padding comes after them.
+        std::string contents(1 << 20, 'x');
+        auto fileName = writeFile(contents);
+        auto buffer = SourceBuffer::load(fileName);
+        unlink(fileName.c_str());
+        UAISO_EXPECT_TRUE(buffer);
+        UAISO_EXPECT_TRUE(buffer->isMapped());
+        UAISO_EXPECT_INT_EQ(contents.size(), buffer->size());
+        UAISO_EXPECT_TRUE(contents == std::string(buffer->data(), buffer->size()));
+        checkPadding(buffer.get());
+    }
+
+    void testCase4()
+    {
+        auto fileName = writeFile("");
+        auto buffer = SourceBuffer::load(fileName);
+        unlink(fileName.c_str());
+        UAISO_EXPECT_TRUE(buffer);
+        UAISO_EXPECT_INT_EQ(0, buffer->size());
+        checkPadding(buffer.get());
+    }
+
+    void testCase5()
+    {
+        UAISO_EXPECT_FALSE(SourceBuffer::load("/source_buffer_test/none.py"));
+    }
+
+    void testCase6()
+    {
+        // Parse straight from a mapped file.
+        auto fileName = writeFile("def f(a):\n    return a\n");
+        auto buffer = SourceBuffer::load(fileName);
+        unlink(fileName.c_str());
+        UAISO_EXPECT_TRUE(buffer);
+
+        TokenMap tokens;
+        LexemeMap lexs;
+        std::unique_ptr<Unit> unit(FactoryCreator::create(LangId::Py)->makeUnit());
+        unit->setFileName(fileName);
+        unit->assignInput(buffer.get());
+        unit->parse(&tokens, &lexs);
+        UAISO_EXPECT_TRUE(unit->ast());
+        UAISO_EXPECT_TRUE(lexs.findAnyOf<Ident>("f"));
+        UAISO_EXPECT_TRUE(lexs.findAnyOf<Ident>("a"));
+    }
+
+    std::string writeFile(const std::string& contents)
+    {
+        char fileName[] = "/tmp/uaiso_source_buffer_XXXXXX";
+        int fd = mkstemp(fileName);
+        UAISO_EXPECT_TRUE(fd != -1);
+        UAISO_EXPECT_INT_EQ(contents.size(),
+                            write(fd, contents.data(), contents.size()));
+        close(fd);
+        return fileName;
+    }
+
+    void checkPadding(SourceBuffer* buffer)
+    {
+        for (size_t i = 0; i < kPadding; ++i)
+            UAISO_EXPECT_INT_EQ(0, buffer->scanBuffer()[buffer->size() + i]);
+    }
+};
+
+MAKE_CLASS_TEST(SourceBuffer)
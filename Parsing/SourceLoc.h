@@ -28,63 +28,57 @@
 #include "Common/Assert.h"
 #include "Common/Config.h"
 #include "Common/LineCol.h"
+#include "Parsing/FileRegistry.h"
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <string>
 #include <utility>
 #include <vector>
 
 namespace uaiso {
 
+/*!
+ * \brief The SourceLoc class
+ *
+ * A source range. The file is kept as a FileId, its name is only looked up
+ * (in the FileRegistry) when needed. Columns are kept in 16 bits, so that a
+ * location (one per AST node, at least) fits in 16 bytes; larger ones are
+ * clamped.
+ */
 class UAISO_API SourceLoc
 {
-    friend void swap(SourceLoc &a, SourceLoc &b);
-
 public:
     SourceLoc()
         : line_(0)
-        , col_(0)
         , lastLine_(0)
+        , col_(0)
         , lastCol_(0)
-        , fileName_("<unspecified file>")
     {}
 
     SourceLoc(int line,
               int col,
               int lastLine,
               int lastCol,
-              const std::string& fileName)
+              FileId fileId)
         : line_(line)
-        , col_(col)
         , lastLine_(lastLine)
-        , lastCol_(lastCol)
-        , fileName_(fileName)
+        , col_(clampCol(col))
+        , lastCol_(clampCol(lastCol))
+        , fileId_(fileId)
     {}
 
-    SourceLoc(const SourceLoc& location)
-        : line_(location.line_)
-        , col_(location.col_)
-        , lastLine_(location.lastLine_)
-        , lastCol_(location.lastCol_)
-        , fileName_(location.fileName_)
+    SourceLoc(int line,
+              int col,
+              int lastLine,
+              int lastCol,
+              const std::string& fileName)
+        : SourceLoc(line, col, lastLine, lastCol,
+                    FileRegistry::insertOrFind(fileName))
     {}
 
-    SourceLoc& operator=(const SourceLoc& location)
-    {
-        SourceLoc other(location);
-        swap(*this, other);
-        return *this;
-    }
-
-    SourceLoc(SourceLoc&& location)
-        : SourceLoc() // Delegating empty construction
-    {
-        swap(*this, location);
-    }
-
-    SourceLoc& operator=(SourceLoc&& location) = default;
-
     LineCol lineCol() const
     {
         return LineCol(line_, col_);
@@ -98,35 +92,39 @@ public:
                 && lastCol_ == 0;
     }
 
+    const std::string& fileName() const
+    {
+        return FileRegistry::name(fileId_);
+    }
+
+    static int16_t clampCol(int col)
+    {
+        return static_cast<int16_t>(
+                    std::max<int>(std::numeric_limits<int16_t>::min(),
+                                  std::min<int>(col, std::numeric_limits<int16_t>::max())));
+    }
+
     int line_;
-    int col_;
     int lastLine_;
-    int lastCol_;
-    std::string fileName_;
+    int16_t col_;
+    int16_t lastCol_;
+    FileId fileId_;
 };
 
-const SourceLoc kEmptyLoc = SourceLoc();
+static_assert(sizeof(SourceLoc) == 16, "SourceLoc is expected to be packed");
 
-inline void swap(SourceLoc& a, SourceLoc& b)
-{
-    using std::swap;
-    swap(a.line_, b.line_);
-    swap(a.col_, b.col_);
-    swap(a.lastLine_, b.lastLine_);
-    swap(a.lastCol_, b.lastCol_);
-    swap(a.fileName_, b.fileName_);
-}
+const SourceLoc kEmptyLoc = SourceLoc();
 
 inline SourceLoc joinedLoc(const SourceLoc& a, const SourceLoc& b)
 {
-    //UAISO_ASSERT(a.fileName_ == b.fileName_, return kEmptyLoc);
+    //UAISO_ASSERT(a.fileId_ == b.fileId_, return kEmptyLoc);
 
-    return SourceLoc(a.line_, a.col_, b.lastLine_, b.lastCol_, b.fileName_);
+    return SourceLoc(a.line_, a.col_, b.lastLine_, b.lastCol_, b.fileId_);
 }
 
 UAISO_API inline bool operator==(const SourceLoc& a, const SourceLoc& b)
 {
-    return a.fileName_ == b.fileName_
+    return a.fileId_ == b.fileId_
             && a.line_ == b.line_
             && a.col_ == b.col_
             && a.lastLine_ == b.lastLine_
@@ -135,7 +133,11 @@ UAISO_API inline bool operator==(const SourceLoc& a, const SourceLoc& b)
 
 UAISO_API inline std::ostream& operator<<(std::ostream& os, const SourceLoc& loc)
 {
-    os << loc.fileName_ << ":" << loc.line_ << ":" << loc.col_
+    if (loc.fileId_.isUnspecified())
+        os << "<unspecified file>";
+    else
+        os << loc.fileName();
+    os << ":" << loc.line_ << ":" << loc.col_
        << "[" << loc.lastLine_ << ":" << loc.lastCol_ << "]";
     return os;
 }
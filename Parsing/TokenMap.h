@@ -26,6 +26,7 @@
 
 #include "Common/LineCol.h"
 #include "Common/Pimpl.h"
+#include "Parsing/FileRegistry.h"
 #include "Parsing/Token.h"
 
 namespace uaiso {
@@ -43,23 +44,34 @@ public:
      * \brief insertOrFind
      *
      * Insert the token \a tk at line/column \a lineCol of the file
-     * \a fullFileName.
+     * \a fileId.
      */
     Token insertOrFind(int tk,
-                       const std::string& fullFileName,
+                       FileId fileId,
                        const LineCol& lineCol);
 
     /*!
      * \brief findAt
      *
      * Return the token at the line/column \a lineCol of the file
-     * \a fullFileName. If no token can be found, return an invalid one.
+     * \a fileId. If no token can be found, return an invalid one.
      */
-    Token findAt(const std::string& fullFileName,
+    Token findAt(FileId fileId,
                  const LineCol& lineCol) const;
 
+    /*!
+     * \brief retain
+     * \param fileId
+     * \return
+     *
+     * Return a map with the tokens of file \a fileId as they are now, which
+     * is unaffected by the file being cleared (and parsed again) in this map.
+     * The returned map must only be read from.
+     */
+    std::unique_ptr<TokenMap> retain(FileId fileId) const;
+
     void clear();
-    void clear(const std::string& fullFileName);
+    void clear(FileId fileId);
 
 private:
     DECL_PIMPL(TokenMap)
@@ -36,17 +36,27 @@ void Unit::assignInput(const std::string& source)
 {
     P->source_ = &source;
     P->bit_.readFromFile_ = false;
+    P->bit_.readFromBuffer_ = false;
 }
 
 void Unit::assignInput(FILE* file)
 {
     P->file_ = file;
     P->bit_.readFromFile_ = true;
+    P->bit_.readFromBuffer_ = false;
+}
+
+void Unit::assignInput(SourceBuffer* buffer)
+{
+    P->buffer_ = buffer;
+    P->bit_.readFromFile_ = false;
+    P->bit_.readFromBuffer_ = true;
 }
 
 void Unit::setFileName(const std::string& fullFileName)
 {
     P->fullFileName_ = fullFileName;
+    P->fileId_ = FileRegistry::insertOrFind(fullFileName);
 }
 
 const std::string& Unit::fileName() const
@@ -54,9 +64,40 @@ const std::string& Unit::fileName() const
     return P->fullFileName_;
 }
 
+FileId Unit::fileId() const
+{
+    return P->fileId_;
+}
+
+void Unit::setSkipBodies(bool enable)
+{
+    P->bit_.skipBodies_ = enable;
+}
+
+bool Unit::skipBodies() const
+{
+    return P->bit_.skipBodies_;
+}
+
+bool Unit::canSkipBodies() const
+{
+    return false;
+}
+
 Ast* Unit::ast() const
 {
-    return P->ast_.get();
+    return P->tree_->ast_.get();
+}
+
+std::shared_ptr<Ast> Unit::sharedAst() const
+{
+    // Point to the AST, but own the whole tree, pool included.
+    return std::shared_ptr<Ast>(P->tree_, P->tree_->ast_.get());
+}
+
+const AstPool* Unit::astPool() const
+{
+    return &P->tree_->pool_;
 }
 
 DiagnosticReports* Unit::releaseReports()
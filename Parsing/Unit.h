@@ -25,6 +25,7 @@
 #define UAISO_UNIT_H__
 
 #include "Parsing/Diagnostic.h"
+#include "Parsing/FileRegistry.h"
 #include "Ast/AstFwd.h"
 #include "Common/LineCol.h"
 #include "Common/Pimpl.h"
@@ -34,8 +35,10 @@
 
 namespace uaiso {
 
+class AstPool;
 class LexemeMap;
 class ParsingContext;
+class SourceBuffer;
 class TokenMap;
 
 /*!
@@ -68,6 +71,15 @@ public:
      */
     virtual void assignInput(FILE* file);
 
+    /*!
+     * \brief assignInput
+     * \param buffer
+     *
+     * Lex directly from the buffer, without copying it. The buffer must
+     * outlive the parse.
+     */
+    virtual void assignInput(SourceBuffer* buffer);
+
     /*!
      * \brief setFileName
      * \param name
@@ -80,6 +92,39 @@ public:
      */
     const std::string& fileName() const;
 
+    /*!
+     * \brief fileId
+     * \return
+     */
+    FileId fileId() const;
+
+    /*!
+     * \brief setSkipBodies
+     * \param enable
+     *
+     * Parse only the signatures of functions, skipping over their bodies
+     * without building AST nodes for them. Meant for dependencies, of which
+     * only the declarations are of interest. A language whose parser can't
+     * skip bodies ignores this setting.
+     *
+     * \sa canSkipBodies
+     */
+    void setSkipBodies(bool enable);
+
+    /*!
+     * \brief skipBodies
+     * \return
+     */
+    bool skipBodies() const;
+
+    /*!
+     * \brief canSkipBodies
+     * \return
+     *
+     * Return whether the language's parser honours setSkipBodies.
+     */
+    virtual bool canSkipBodies() const;
+
     /*!
      * \brief parse
      * \param tokens
@@ -112,6 +157,24 @@ public:
      */
     Ast* ast() const;
 
+    /*!
+     * \brief sharedAst
+     * \return
+     *
+     * Return the parsed AST, sharing its ownership, so it's kept (with its
+     * pool) even once the unit is destroyed or parses again.
+     */
+    std::shared_ptr<Ast> sharedAst() const;
+
+    /*!
+     * \brief astPool
+     * \return
+     *
+     * Return the pool from which the AST is allocated. It's owned by the
+     * unit and released together with the AST.
+     */
+    const AstPool* astPool() const;
+
     /*!
      * \brief releaseReports
      * \return
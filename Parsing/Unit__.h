@@ -34,8 +34,10 @@
 #define UAISO_UNIT_INTERNAL_H__
 
 #include "Parsing/Unit.h"
+#include "Parsing/SourceBuffer.h"
 #include "Parsing/Token.h"
 #include "Ast/Ast.h"
+#include "Ast/AstPool.h"
 
 namespace uaiso {
 
@@ -43,13 +45,53 @@ struct Unit::UnitImpl
 {
     UnitImpl()
         : bits_(0)
+        , tree_(std::make_shared<Tree>())
         , reports_(new DiagnosticReports)
         , source_(nullptr)
     {}
 
+    /*!
+     * \brief The Tree struct
+     *
+     * The AST together with the pool it's allocated from. It's shared with
+     * whoever retains the AST (see Unit::sharedAst), so it may outlive the
+     * unit, or the unit's next parse.
+     */
+    struct Tree
+    {
+        /*!
+         * Give the memory of the AST back in one go. Pooled nodes aren't
+         * destroyed one by one, whatever they hold of their own is released
+         * with the pool (see AstPool::atRelease).
+         */
+        ~Tree()
+        {
+            if (AstPool::ownerOf(ast_.get()) == &pool_)
+                ast_.release();
+            else
+                ast_.reset(nullptr);
+            pool_.clear();
+        }
+
+        AstPool pool_;
+        std::unique_ptr<Ast> ast_;
+    };
+
+    /*!
+     * \brief discardAst
+     *
+     * Let go of the AST, which is destroyed unless it's been retained.
+     */
+    void discardAst()
+    {
+        tree_ = std::make_shared<Tree>();
+    }
+
     struct BitFields
     {
         uint32_t readFromFile_       : 1;
+        uint32_t readFromBuffer_     : 1;
+        uint32_t skipBodies_         : 1;
     };
 
     union
@@ -59,13 +101,15 @@ struct Unit::UnitImpl
     };
 
     std::string fullFileName_;
-    std::unique_ptr<Ast> ast_;
+    FileId fileId_;
+    std::shared_ptr<Tree> tree_;
     std::unique_ptr<DiagnosticReports> reports_;
 
     union
     {
         const std::string* source_;
         FILE* file_;
+        SourceBuffer* buffer_;
     };
 };
 
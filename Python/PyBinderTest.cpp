@@ -31,6 +31,7 @@
 #include "Parsing/TokenMap.h"
 #include "Parsing/Unit.h"
 #include <iostream>
+#include <thread>
 
 using namespace uaiso;
 
@@ -363,3 +364,199 @@ class c2:
     UAISO_EXPECT_TRUE(clazzEnv.searchValueDecl(sm));
     UAISO_EXPECT_TRUE(clazzEnv.searchValueDecl(m));
 }
+
+void Binder::BinderTest::PyTestCase13()
+{
+    std::string code = R"raw(
+class c3:
+    def __init__(self, a):
+        n = a
+        self.m = n
+        def nested(k):
+            self.q = k
+            j = k
+    def get(self):
+        return self.m
+
+def h(p):
+    r = p
+)raw";
+
+    // Bodies are bound lazily, so the AST and the maps must outlive them.
+    std::unique_ptr<Factory> factory = FactoryCreator::create(LangId::Py);
+    TokenMap tokens;
+    std::unique_ptr<Unit> unit(factory->makeUnit());
+    unit->assignInput(code);
+    unit->setFileName("/test.py");
+    unit->parse(&tokens, &lexs_);
+    ProgramAst* ast = Program_Cast(unit->ast());
+    UAISO_EXPECT_TRUE(ast);
+
+    Binder binder(factory.get());
+    binder.setLexemes(&lexs_);
+    binder.setTokens(&tokens);
+    binder.bindBodiesLazily();
+    std::unique_ptr<Program> prog = binder.bind(ast, unit->fileName());
+    UAISO_EXPECT_TRUE(prog);
+
+    const Ident* c3 = lexs_.findAnyOf<Ident>("c3");
+    const Ident* init = lexs_.findAnyOf<Ident>("__init__");
+    const Ident* a = lexs_.findAnyOf<Ident>("a");
+    const Ident* n = lexs_.findAnyOf<Ident>("n");
+    const Ident* m = lexs_.findAnyOf<Ident>("m");
+    const Ident* q = lexs_.findAnyOf<Ident>("q");
+    const Ident* j = lexs_.findAnyOf<Ident>("j");
+    const Ident* nested = lexs_.findAnyOf<Ident>("nested");
+    const Ident* h = lexs_.findAnyOf<Ident>("h");
+    const Ident* p = lexs_.findAnyOf<Ident>("p");
+    const Ident* r = lexs_.findAnyOf<Ident>("r");
+
+    // Members declared in method bodies are bound with the record.
+    Environment env = prog->env();
+    const Record* clazz = ConstRecord_Cast(env.searchTypeDecl(c3));
+    UAISO_EXPECT_TRUE(clazz);
+    Environment clazzEnv = clazz->type()->env();
+    UAISO_EXPECT_TRUE(clazzEnv.searchValueDecl(m));
+    UAISO_EXPECT_TRUE(clazzEnv.searchValueDecl(q));
+
+    const Func* funcInit = ConstFunc_Cast(clazzEnv.searchTypeDecl(init));
+    UAISO_EXPECT_TRUE(funcInit);
+    UAISO_EXPECT_FALSE(funcInit->isBodyBound());
+    UAISO_EXPECT_TRUE(funcInit->env().searchValueDecl(a));
+    UAISO_EXPECT_FALSE(funcInit->env().searchValueDecl(n));
+    UAISO_EXPECT_FALSE(funcInit->env().searchTypeDecl(nested));
+
+    const Func* funcH = ConstFunc_Cast(env.searchTypeDecl(h));
+    UAISO_EXPECT_TRUE(funcH);
+    UAISO_EXPECT_TRUE(funcH->env().searchValueDecl(p));
+    UAISO_EXPECT_FALSE(funcH->env().searchValueDecl(r));
+
+    funcInit->bindBody();
+    UAISO_EXPECT_TRUE(funcInit->isBodyBound());
+    UAISO_EXPECT_TRUE(funcInit->env().searchValueDecl(n));
+    const Func* funcNested = ConstFunc_Cast(funcInit->env().searchTypeDecl(nested));
+    UAISO_EXPECT_TRUE(funcNested);
+    UAISO_EXPECT_FALSE(funcNested->isBodyBound());
+    UAISO_EXPECT_FALSE(funcH->env().searchValueDecl(r));
+
+    funcNested->bindBody();
+    UAISO_EXPECT_TRUE(funcNested->env().searchValueDecl(j));
+
+    // Members aren't bound again along with the bodies.
+    size_t members = 0;
+    for (auto decl : clazzEnv.listDecls()) {
+        if (decl->name() == m || decl->name() == q)
+            ++members;
+    }
+    UAISO_EXPECT_INT_EQ(2, members);
+
+    funcH->bindBody();
+    UAISO_EXPECT_TRUE(funcH->env().searchValueDecl(r));
+}
+
+void Binder::BinderTest::PyTestCase14()
+{
+    std::string code = R"raw(
+def len(x):
+    pass
+)raw";
+
+    std::unique_ptr<Program> prog1(core(FactoryCreator::create(LangId::Py),
+                                        basicCode, "/test1.py"));
+    std::unique_ptr<Program> prog2(core(FactoryCreator::create(LangId::Py),
+                                        code, "/test2.py"));
+
+    const Ident* abs = lexs_.findAnyOf<Ident>("abs");
+    const Ident* len = lexs_.findAnyOf<Ident>("len");
+    const Ident* object = lexs_.findAnyOf<Ident>("object");
+    UAISO_EXPECT_TRUE(abs);
+    UAISO_EXPECT_TRUE(len);
+    UAISO_EXPECT_TRUE(object);
+
+    // Builtins are the same symbols in every program.
+    const TypeDecl* abs1 = prog1->env().searchTypeDecl(abs);
+    UAISO_EXPECT_TRUE(abs1);
+    UAISO_EXPECT_TRUE(abs1->isBuiltin());
+    UAISO_EXPECT_PTR_EQ(abs1, prog2->env().searchTypeDecl(abs));
+    UAISO_EXPECT_PTR_EQ(prog1->env().searchTypeDecl(object),
+                        prog2->env().searchTypeDecl(object));
+
+    // But a program's own declaration comes first.
+    UAISO_EXPECT_TRUE(prog1->env().searchTypeDecl(len)->isBuiltin());
+    UAISO_EXPECT_FALSE(prog2->env().searchTypeDecl(len)->isBuiltin());
+
+    // Once the lexemes are gone, builtins are created again.
+    lexs_.clear();
+    std::unique_ptr<Program> prog3(core(FactoryCreator::create(LangId::Py),
+                                        basicCode, "/test1.py"));
+    abs = lexs_.findAnyOf<Ident>("abs");
+    UAISO_EXPECT_TRUE(abs);
+    UAISO_EXPECT_TRUE(prog3->env().searchTypeDecl(abs));
+    UAISO_EXPECT_TRUE(prog3->env().searchTypeDecl(abs) != abs1);
+}
+
+void Binder::BinderTest::PyTestCase15()
+{
+    std::string code = R"raw(
+def f(p):
+    import os
+    r = p
+)raw";
+
+    std::string other = R"raw(
+x = 1
+
+y = 2
+)raw";
+
+    std::unique_ptr<Factory> factory = FactoryCreator::create(LangId::Py);
+    TokenMap tokens;
+    std::unique_ptr<Program> prog;
+    {
+        std::unique_ptr<Unit> unit(factory->makeUnit());
+        unit->assignInput(code);
+        unit->setFileName("/test.py");
+        unit->parse(&tokens, &lexs_);
+        UAISO_EXPECT_TRUE(unit->ast());
+
+        Binder binder(factory.get());
+        binder.setLexemes(&lexs_);
+        binder.setTokens(&tokens);
+        binder.bindBodiesLazily();
+        prog = binder.bind(std::static_pointer_cast<ProgramAst>(unit->sharedAst()),
+                           unit->fileName());
+        UAISO_EXPECT_TRUE(prog);
+    }
+
+    // The unit is gone and the file is parsed again, but the deferred body
+    // keeps the AST and reads the tokens as they were when it was bound.
+    tokens.clear(FileRegistry::insertOrFind("/test.py"));
+    std::unique_ptr<Unit> unit(factory->makeUnit());
+    unit->assignInput(other);
+    unit->setFileName("/test.py");
+    unit->parse(&tokens, &lexs_);
+
+    const Ident* f = lexs_.findAnyOf<Ident>("f");
+    const Ident* r = lexs_.findAnyOf<Ident>("r");
+    const Func* func = ConstFunc_Cast(prog->env().searchTypeDecl(f));
+    UAISO_EXPECT_TRUE(func);
+    UAISO_EXPECT_FALSE(func->isBodyBound());
+
+    // Concurrent requests bind the body once.
+    std::unique_ptr<Func> clone(func->clone());
+    std::thread other1([func]() { func->bindBody(); });
+    std::thread other2([&clone]() { clone->bindBody(); });
+    func->bindBody();
+    other1.join();
+    other2.join();
+
+    UAISO_EXPECT_TRUE(func->isBodyBound());
+    UAISO_EXPECT_TRUE(clone->isBodyBound());
+    UAISO_EXPECT_TRUE(func->env().searchValueDecl(r));
+    size_t count = 0;
+    for (auto decl : func->env().listDecls()) {
+        if (decl->name() == r)
+            ++count;
+    }
+    UAISO_EXPECT_INT_EQ(1, count);
+}
@@ -32,21 +32,14 @@ using namespace uaiso;
 
 namespace {
 
-const char* const kPyBuiltin = "<__pybuiltin__>";
 const char* const kPyBuiltinBool = "<__pybuiltin_bool__>";
 const char* const kPyBuiltinFloat = "<__pybuiltin_float__>";
 const char* const kPyBuiltinInt = "<__pybuiltin_int__>";
 
-// An incremented-per-use line to make sure there are no location collisions
-// in the identifiers created for the builtins file.
-int line = 0;
-
+// Builtins don't come from a source file, their identifiers have no location.
 const Ident* insertOrFindIdent(LexemeMap* lexs, const char* name)
 {
-    auto ident = lexs->findAnyOf<Ident>(name);
-    if (!ident)
-        ident = lexs->insertOrFind<Ident>(name, kPyBuiltin, LineCol(++line, 0));
-    return ident;
+    return lexs->intern<Ident>(name);
 }
 
 template <class TypeT>
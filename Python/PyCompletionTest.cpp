@@ -1052,16 +1052,140 @@ def foo():
 
 void CompletionProposer::CompletionProposerTest::PyTestCase46()
 {
+    std::string code = R"raw(
+class Point:
+    def __init__(self, x, y):
+        self.x = x
+        self.y = y
+    def show(self, z):
+        w = z
+        v =
+#          ^
+#          |
+#          complete at up-arrow
+)raw";
+
+    lineCol_ = { 7, 11 };
+    lazyBodies_ = true;
+    auto expected = { "self", "z", "w", "v", "x", "y", "__init__", "show", "Point" };
+    runCore(FactoryCreator::create(LangId::Py), code, "/test.py", expected);
 }
 
 void CompletionProposer::CompletionProposerTest::PyTestCase47()
 {
+    std::string code = R"raw(
+class Point:
+    def __init__(self, x, y):
+        self.x = x
+        self.y = y
+def baz(f):
+    g = 1
+def foo(a):
+    b = Point()
+    def bar(c):
+        d = 1
+        e =
+#          ^
+#          |
+#          complete at up-arrow
+)raw";
+
+    lineCol_ = { 11, 11 };
+    lazyBodies_ = true;
+    auto expected = { "a", "b", "bar", "c", "d", "e", "foo", "baz", "Point" };
+    runCore(FactoryCreator::create(LangId::Py), code, "/test.py", expected);
 }
 
 void CompletionProposer::CompletionProposerTest::PyTestCase48()
 {
+    std::string code = R"raw(
+class Point:
+    def __init__(self, x, y):
+        self.x = x
+        self.y = y
+    def show(self, z):
+        w = z
+        v =
+#          ^
+#          |
+#          complete at up-arrow
+)raw";
+
+    lineCol_ = { 7, 11 };
+    prefix_ = "s";
+    auto expected = { "self", "show" };
+    runCore(FactoryCreator::create(LangId::Py), code, "/test.py", expected);
 }
 
 void CompletionProposer::CompletionProposerTest::PyTestCase49()
 {
+    std::string code = R"raw(
+class Config:
+    def __init__(self):
+        self.alpha = 1
+        self.beta = 2
+        self.gamma = 3
+        self.path_a = 4
+        self.path_b = 5
+        self.port = 6
+    def parse(self):
+        pass
+    def pace(self):
+        pass
+    def show(self):
+        pass
+c = Config()
+c.
+# ^
+# |
+# complete at up-arrow
+)raw";
+
+    lineCol_ = { 16, 2 };
+    prefix_ = "pa";
+    auto expected = { "path_a", "path_b", "parse", "pace" };
+    runCore(FactoryCreator::create(LangId::Py), code, "/test.py", expected);
+}
+
+void CompletionProposer::CompletionProposerTest::PyTestCase50()
+{
+    std::string code = R"raw(
+class Point:
+    def __init__(self, x, y):
+        self.x = x
+        self.y = y
+    def show(self, z):
+        w = z
+        v =
+#          ^
+#          |
+#          complete at up-arrow
+)raw";
+
+    lineCol_ = { 7, 11 };
+    maxProposals_ = 3;
+    auto expected = { "v", "w", "z" };
+    runCore(FactoryCreator::create(LangId::Py), code, "/test.py", expected);
+}
+
+void CompletionProposer::CompletionProposerTest::PyTestCase51()
+{
+    std::string code = R"raw(
+class Point:
+    def __init__(self, x, y):
+        self.x = x
+        self.y = y
+    def show(self, z):
+        w = z
+        v =
+#          ^
+#          |
+#          complete at up-arrow
+)raw";
+
+    lineCol_ = { 7, 11 };
+    prefix_ = "sw";
+    maxProposals_ = 10;
+    auto expected = { "show" };
+    runCore(FactoryCreator::create(LangId::Py), code, "/test.py", expected);
 }
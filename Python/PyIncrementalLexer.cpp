@@ -51,3 +51,23 @@ void PyIncrementalLexer::lex(const std::string& source)
         tk = lexer.lex();
     } while (tk != TK_EOP);
 }
+
+void PyIncrementalLexer::resume(const char* buff, size_t len,
+                                const LineCol& lineCol, const LexerState& state)
+{
+    lexer_.reset(new PyLexer);
+    lexer_->setContext(P->context_.get());
+    lexer_->setBuffer(buff, len, lineCol);
+    lexer_->restoreState(state);
+}
+
+bool PyIncrementalLexer::lexNext(LexerState& state)
+{
+    lexer_->saveState(state);
+    return lexer_->lex() != TK_EOP;
+}
+
+void PyIncrementalLexer::finish()
+{
+    lexer_.reset();
+}
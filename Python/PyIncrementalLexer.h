@@ -24,10 +24,14 @@
 #ifndef UAISO_PYINCREMENTALLEXER_H__
 #define UAISO_PYINCREMENTALLEXER_H__
 
+#include "Common/Test.h"
 #include "Parsing/IncrementalLexer.h"
+#include <memory>
 
 namespace uaiso {
 
+class PyLexer;
+
 class UAISO_API PyIncrementalLexer final : public IncrementalLexer
 {
 public:
@@ -35,6 +39,16 @@ public:
     virtual ~PyIncrementalLexer();
 
     void lex(const std::string& source) override;
+
+private:
+    DECL_CLASS_TEST(PyIncrementalLexer)
+
+    void resume(const char* buff, size_t len, const LineCol& lineCol,
+                const LexerState& state) override;
+    bool lexNext(LexerState& state) override;
+    void finish() override;
+
+    std::unique_ptr<PyLexer> lexer_;
 };
 
 } // namespace uaiso
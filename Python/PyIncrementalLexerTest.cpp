@@ -0,0 +1,219 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#include "Python/PyIncrementalLexer.h"
+#include "Parsing/IncrementalLexer__.h"
+#include "Parsing/Phrasing.h"
+#include "Parsing/Token.h"
+#include <sstream>
+
+using namespace uaiso;
+
+class PyIncrementalLexer::PyIncrementalLexerTest final : public Test
+{
+public:
+    TEST_RUN(PyIncrementalLexerTest
+             , &PyIncrementalLexerTest::testCase1
+             , &PyIncrementalLexerTest::testCase2
+             , &PyIncrementalLexerTest::testCase3
+             , &PyIncrementalLexerTest::testCase4
+             , &PyIncrementalLexerTest::testCase5
+             , &PyIncrementalLexerTest::testCase6
+             , &PyIncrementalLexerTest::testCase7
+             )
+
+    std::string dump(const Phrasing& phrasing)
+    {
+        std::ostringstream oss;
+        for (size_t i = 0; i < phrasing.size(); ++i) {
+            oss << phrasing.token(i) << "@" << phrasing.lineCol(i).line_ << ":"
+                << phrasing.lineCol(i).col_ << "/" << phrasing.length(i) << " ";
+        }
+        return oss.str();
+    }
+
+    std::string lexFromScratch(const std::string& source)
+    {
+        PyIncrementalLexer lexer;
+        IncrementalLexer::LineRange lines = lexer.lexDocument(source);
+        return dump(*lexer.phrasing(lines));
+    }
+
+    std::string all(const PyIncrementalLexer& lexer)
+    {
+        IncrementalLexer::LineRange lines;
+        lines.last_ = lexer.lineCount();
+        return dump(*lexer.phrasing(lines));
+    }
+
+    const std::string source_ {
+R"raw(import os
+
+def f(a, b):
+    x = a + b # sum
+    if x:
+        return x
+    return """a
+long string"""
+
+class C:
+    def g(self):
+        pass
+)raw" };
+
+    void testCase1()
+    {
+        // The document as a whole is just like a single piece of it.
+        PyIncrementalLexer lexer;
+        IncrementalLexer::LineRange lines = lexer.lexDocument(source_);
+        UAISO_EXPECT_INT_EQ(0, lines.first_);
+        UAISO_EXPECT_INT_EQ(13, lines.last_);
+        UAISO_EXPECT_INT_EQ(13, lexer.lineCount());
+
+        PyIncrementalLexer pieceLexer;
+        pieceLexer.lex(source_);
+        std::unique_ptr<Phrasing> piece(pieceLexer.releasePhrasing());
+        UAISO_EXPECT_STR_EQ(dump(*piece), all(lexer));
+
+        // Nothing is stale.
+        lines = lexer.lexDocument(source_);
+        UAISO_EXPECT_TRUE(lines.isEmpty());
+    }
+
+    void testCase2()
+    {
+        // A change within a line converges right after it.
+        PyIncrementalLexer lexer;
+        lexer.lexDocument(source_);
+
+        std::string source = source_;
+        source.replace(source.find("a + b"), 5, "a * b");
+        lexer.edit(3, 1, 1);
+        IncrementalLexer::LineRange lines = lexer.lexDocument(source);
+        UAISO_EXPECT_TRUE(lines.first_ <= 3);
+        UAISO_EXPECT_INT_EQ(4, lines.last_);
+        UAISO_EXPECT_STR_EQ(lexFromScratch(source), all(lexer));
+
+        std::unique_ptr<Phrasing> phrasing = lexer.phrasing(lines);
+        UAISO_EXPECT_TRUE(phrasing->size() < 10);
+    }
+
+    void testCase3()
+    {
+        // Opening a string turns the rest of the document into it.
+        PyIncrementalLexer lexer;
+        lexer.lexDocument(source_);
+
+        std::string source = source_;
+        source.replace(source.find("import os"), 9, "import '''os");
+        lexer.edit(0, 1, 1);
+        IncrementalLexer::LineRange lines = lexer.lexDocument(source);
+        UAISO_EXPECT_INT_EQ(0, lines.first_);
+        UAISO_EXPECT_INT_EQ(13, lines.last_);
+        UAISO_EXPECT_STR_EQ(lexFromScratch(source), all(lexer));
+
+        // And closing it back restores the original phrasing.
+        lexer.edit(0, 1, 1);
+        lexer.lexDocument(source_);
+        UAISO_EXPECT_STR_EQ(lexFromScratch(source_), all(lexer));
+    }
+
+    void testCase4()
+    {
+        // An edit within a multiline string resumes from the line where the
+        // string starts. Since the string's end moves, lexing converges only
+        // after the following token's line.
+        PyIncrementalLexer lexer;
+        lexer.lexDocument(source_);
+
+        std::string source = source_;
+        source.replace(source.find("long string"), 4, "short");
+        lexer.edit(7, 1, 1);
+        IncrementalLexer::LineRange lines = lexer.lexDocument(source);
+        UAISO_EXPECT_INT_EQ(6, lines.first_);
+        UAISO_EXPECT_INT_EQ(10, lines.last_);
+        UAISO_EXPECT_STR_EQ(lexFromScratch(source), all(lexer));
+    }
+
+    void testCase5()
+    {
+        // Added and removed lines, across indentation levels.
+        PyIncrementalLexer lexer;
+        lexer.lexDocument(source_);
+
+        std::string source = source_;
+        source.replace(source.find("    if x:"), 0, "    while x:\n        x = x - 1\n");
+        lexer.edit(4, 0, 2);
+        lexer.lexDocument(source);
+        UAISO_EXPECT_INT_EQ(15, lexer.lineCount());
+        UAISO_EXPECT_STR_EQ(lexFromScratch(source), all(lexer));
+
+        lexer.edit(4, 3, 1);
+        lexer.lexDocument(source_);
+        UAISO_EXPECT_INT_EQ(13, lexer.lineCount());
+        UAISO_EXPECT_STR_EQ(lexFromScratch(source_), all(lexer));
+    }
+
+    void testCase6()
+    {
+        // In viewport mode, lines past the last visible one are left stale.
+        PyIncrementalLexer lexer;
+        IncrementalLexer::LineRange lines = lexer.lexDocument(source_, 3);
+        UAISO_EXPECT_INT_EQ(0, lines.first_);
+        UAISO_EXPECT_INT_EQ(4, lines.last_);
+        lines.first_ = 4;
+        lines.last_ = 13;
+        UAISO_EXPECT_INT_EQ(0, lexer.phrasing(lines)->size());
+
+        // Already lexed.
+        lines = lexer.lexDocument(source_, 2);
+        UAISO_EXPECT_TRUE(lines.isEmpty());
+
+        // Scrolling down.
+        lines = lexer.lexDocument(source_, 7);
+        UAISO_EXPECT_TRUE(lines.first_ <= 4);
+        UAISO_EXPECT_INT_EQ(8, lines.last_);
+        lines = lexer.lexDocument(source_);
+        UAISO_EXPECT_INT_EQ(13, lines.last_);
+        UAISO_EXPECT_STR_EQ(lexFromScratch(source_), all(lexer));
+    }
+
+    void testCase7()
+    {
+        // Edits in viewport mode, then the whole document.
+        PyIncrementalLexer lexer;
+        lexer.lexDocument(source_, 5);
+
+        std::string source = source_;
+        source.replace(source.find("class C"), 7, "class D");
+        lexer.edit(9, 1, 1);
+        source.replace(source.find("import os"), 9, "import sys");
+        lexer.edit(0, 1, 1);
+        IncrementalLexer::LineRange lines = lexer.lexDocument(source, 5);
+        UAISO_EXPECT_INT_EQ(0, lines.first_);
+        lexer.lexDocument(source);
+        UAISO_EXPECT_STR_EQ(lexFromScratch(source), all(lexer));
+    }
+};
+
+MAKE_CLASS_TEST(PyIncrementalLexer)
@@ -36,15 +36,6 @@ public:
     PyKeywords() = delete;
 
     static Token filter(const char* spell, size_t len);
-
-private:
-    static Token filter2(const char* spell);
-    static Token filter3(const char* spell);
-    static Token filter4(const char* spell);
-    static Token filter5(const char* spell);
-    static Token filter6(const char* spell);
-    static Token filter7(const char* spell);
-    static Token filter8(const char* spell);
 };
 
 } // namespace uaiso
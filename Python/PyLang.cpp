@@ -25,7 +25,21 @@
 
 using namespace uaiso;
 
+namespace {
+
+constexpr CharClassTable pyCharClasses()
+{
+    auto table = CharClassTable::standard();
+    table.add('\'', CharClassTable::Quote);
+    return table;
+}
+
+constexpr CharClassTable charClassTable = pyCharClasses();
+
+} // anonymous
+
 PyLang::PyLang()
+    : Lang(&charClassTable)
 {}
 
 bool PyLang::hasBlockLevelScope() const { return false; }
@@ -51,11 +65,6 @@ std::string PyLang::sourceFileSuffix() const
     return ".py";
 }
 
-bool PyLang::isStrLitQuote(char ch) const
-{
-    return ch == '"' || ch == '\'';
-}
-
 bool PyLang::hasStrLitJoinEscape() const
 {
     return true;
@@ -49,8 +49,6 @@ public:
 
     std::string sourceFileSuffix() const override;
 
-    bool isStrLitQuote(char ch) const override;
-
     bool hasStrLitJoinEscape() const override;
 };
 
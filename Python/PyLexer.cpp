@@ -45,12 +45,27 @@ PyLexer::PyLexer()
     : bits_(0)
 {
     bit_.atLineStart_ = true;
-    indentStack_.push(0);
+    indentStack_.push_back(0);
 }
 
 PyLexer::~PyLexer()
 {}
 
+void PyLexer::saveState(LexerState& state) const
+{
+    state.bits_ = bits_;
+    state.stack_ = indentStack_;
+}
+
+void PyLexer::restoreState(const LexerState& state)
+{
+    if (state.stack_.empty())
+        return; // The initial state.
+
+    bits_ = state.bits_;
+    indentStack_ = state.stack_;
+}
+
 namespace {
 
 // The ASCII value of the operator/delimiter character is used to index a
@@ -126,7 +141,7 @@ LexNextToken:
         // Blank or comment lines have no effect.
         if (ch && ((ch != '#' && ch != '\n') || completionArea)) {
             bit_.indent_ += count;
-            size_t largest = indentStack_.top();
+            size_t largest = indentStack_.back();
             if (bit_.indent_ > largest) {
                 // Relax completion triggering location. Otherwise,
                 // and indent would be sent causing a parse error.
@@ -136,15 +151,15 @@ LexNextToken:
                 }
 
                 // Indents happen one at a time, always.
-                indentStack_.push(bit_.indent_);
+                indentStack_.push_back(bit_.indent_);
                 return TK_INDENT;
             }
             while (bit_.indent_ < largest) {
                 // Dedents may "accumulate".
-                indentStack_.pop();
+                indentStack_.pop_back();
                 ++bit_.pendingDedent_;
                 UAISO_ASSERT(!indentStack_.empty(), return tk);
-                largest = indentStack_.top();
+                largest = indentStack_.back();
             }
         }
     }
@@ -162,8 +177,8 @@ LexNextToken:
 
     switch (ch) {
     case 0:
-        if (indentStack_.top() > 0) {
-            indentStack_.pop();
+        if (indentStack_.back() > 0) {
+            indentStack_.pop_back();
             return TK_DEDENT;
         }
         return TK_EOP;
@@ -197,7 +212,7 @@ LexNextToken:
     case '"':
     case '\'':
         tk = lexStrLit(ch);
-        context_->trackLexeme<StrLit>(mark_, curr_ - mark_, LineCol(line_, col_));
+        lexeme_ = context_->trackLexeme<StrLit>(mark_, curr_ - mark_, LineCol(line_, col_));
         break;
 
     case 'r':
@@ -210,7 +225,7 @@ LexNextToken:
         if (next == '"' || next == '\'') {
             consumeChar();
             tk = lexStrLit(next);
-            context_->trackLexeme<StrLit>(mark_, curr_ - mark_, LineCol(line_, col_));
+            lexeme_ = context_->trackLexeme<StrLit>(mark_, curr_ - mark_, LineCol(line_, col_));
             break;
         }
         // Either a string literal or an identifier.
@@ -219,7 +234,7 @@ LexNextToken:
             if (next2 == '"' || next2 == '\'') {
                 consumeChar(1);
                 tk = lexStrLit(next2);
-                context_->trackLexeme<StrLit>(mark_, curr_ - mark_, LineCol(line_, col_));
+                lexeme_ = context_->trackLexeme<StrLit>(mark_, curr_ - mark_, LineCol(line_, col_));
                 break;
             }
             tk = lexIdentOrKeyword(ch, &pyLang);
@@ -233,7 +248,7 @@ LexNextToken:
     case '.':
         if (std::isdigit(peekChar(1))) {
             tk = lexNumLit(ch, &pyLang);
-            context_->trackLexeme<NumLit>(mark_, curr_ - mark_, LineCol(line_, col_));
+            lexeme_ = context_->trackLexeme<NumLit>(mark_, curr_ - mark_, LineCol(line_, col_));
             break;
         }
         ch = consumeCharPeekNext();
@@ -247,7 +262,7 @@ LexNextToken:
 
     case '*':
         tk = lexOprtrOrDelim(ch);
-        context_->trackLexeme<Ident>(mark_, curr_ - mark_, LineCol(line_, col_));
+        lexeme_ = context_->trackLexeme<Ident>(mark_, curr_ - mark_, LineCol(line_, col_));
         break;
 
     case '+':
@@ -335,9 +350,8 @@ LexNextToken:
         break;
 
     case '#':
-        ch = consumeCharPeekNext();
-        while (ch && ch != '\n')
-            ch = consumeCharPeekNext();
+        advanceTo(findFirstOf('\n'));
+        ch = peekChar();
         if (context_->allowComments()) {
             tk = TK_COMMENT;
             // Immediately return the comment token. Otherwise, if we simply
@@ -357,7 +371,7 @@ LexNextToken:
 
         if (std::isdigit(ch)) {
             tk = lexNumLit(ch, &pyLang);
-            context_->trackLexeme<NumLit>(mark_, curr_ - mark_, LineCol(line_, col_));
+            lexeme_ = context_->trackLexeme<NumLit>(mark_, curr_ - mark_, LineCol(line_, col_));
             break;
         }
 
@@ -444,7 +458,7 @@ Token PyLexer::filterKeyword(const char* spell, size_t len) const
 
 Token PyLexer::classifyIdent(char&)
 {
-    context_->trackLexeme<Ident>(mark_, curr_ - mark_, LineCol(line_, col_));
+    lexeme_ = context_->trackLexeme<Ident>(mark_, curr_ - mark_, LineCol(line_, col_));
 
     return TK_IDENT;
 }
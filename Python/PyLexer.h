@@ -27,7 +27,7 @@
 #include "Common/Config.h"
 #include "Common/Test.h"
 #include "Parsing/Lexer.h"
-#include <stack>
+#include <vector>
 
 namespace uaiso {
 
@@ -44,6 +44,10 @@ public:
 
     Token lex() override;
 
+    void saveState(LexerState& state) const override;
+
+    void restoreState(const LexerState& state) override;
+
 private:
     DECL_CLASS_TEST(PyLexer)
 
@@ -68,7 +72,7 @@ private:
         uint32_t bits_;
     };
 
-    std::stack<size_t> indentStack_;
+    std::vector<size_t> indentStack_;
 };
 
 } // namespace uaiso
@@ -100,6 +100,8 @@ public:
              , &PyLexerTest::testCase64
              , &PyLexerTest::testCase65
              , &PyLexerTest::testCase66
+             , &PyLexerTest::testCase67
+             , &PyLexerTest::testCase68
              )
 
     // Some test cases were taken from CPython.
@@ -170,6 +172,8 @@ public:
     void testCase64();
     void testCase65();
     void testCase66();
+    void testCase67();
+    void testCase68();
 
     std::vector<Token> core(const std::string& code)
     {
@@ -1293,4 +1297,58 @@ void PyLexer::PyLexerTest::testCase66()
     UAISO_EXPECT_CONTAINER_EQ(expected, tks);
 }
 
+void PyLexer::PyLexerTest::testCase67()
+{
+    // Strings and comments spanning more than a scanning block.
+    keepComments_ = true;
+    auto tks = core(R"raw(
+x = "a string longer than a block, \" with an escape" # a comment longer than a block
+y = """first line of a long string
+and its second, last line"""
+)raw");
+
+    std::vector<Token> expected {
+        TK_IDENT, TK_EQ, TK_STR_LIT, TK_COMMENT, TK_NEWLINE,
+        TK_IDENT, TK_EQ, TK_STR_LIT, TK_NEWLINE, TK_EOP
+    };
+    UAISO_EXPECT_INT_EQ(expected.size(), tks.size());
+    UAISO_EXPECT_CONTAINER_EQ(expected, tks);
+
+    std::vector<SourceLoc> expectedLocs {
+        SourceLoc(1, 0, 1, 1, ""),
+        SourceLoc(1, 2, 1, 3, ""),
+        SourceLoc(1, 4, 1, 53, ""),
+        SourceLoc(1, 54, 1, 85, ""),
+        SourceLoc(2, 0, 2, 1, ""),
+        SourceLoc(2, 2, 2, 3, ""),
+        SourceLoc(2, 4, 3, 28, "")
+    };
+    UAISO_EXPECT_INT_EQ(expectedLocs.size(), locs_.size());
+    UAISO_EXPECT_CONTAINER_EQ(expectedLocs, locs_);
+}
+
+void PyLexer::PyLexerTest::testCase68()
+{
+    auto tks = core(R"raw(
+and as assert break class continue def del elif else except exec finally
+for from global if import in is lambda nonlocal not or pass print raise
+return try while with yield None True False
+an ass asserts brake klass def_ elf exe fro i in_ lambd nonlocals none
+)raw");
+
+    std::vector<Token> expected {
+        TK_AND, TK_AS, TK_ASSERT, TK_BREAK, TK_CLASS, TK_CONTINUE, TK_DEF,
+        TK_DELETE, TK_ELIF, TK_ELSE, TK_EXCEPT, TK_EXEC, TK_FINALLY, TK_NEWLINE,
+        TK_FOR, TK_FROM, TK_GLOBAL, TK_IF, TK_IMPORT, TK_IN, TK_IS, TK_LAMBDA,
+        TK_NONLOCAL, TK_NOT, TK_OR, TK_PASS, TK_PRINT, TK_RAISE, TK_NEWLINE,
+        TK_RETURN, TK_TRY, TK_WHILE, TK_WITH, TK_YIELD, TK_NULL_VALUE,
+        TK_TRUE_VALUE, TK_FALSE_VALUE, TK_NEWLINE,
+        TK_IDENT, TK_IDENT, TK_IDENT, TK_IDENT, TK_IDENT, TK_IDENT, TK_IDENT,
+        TK_IDENT, TK_IDENT, TK_IDENT, TK_IDENT, TK_IDENT, TK_IDENT, TK_IDENT,
+        TK_NEWLINE, TK_EOP
+    };
+    UAISO_EXPECT_INT_EQ(expected.size(), tks.size());
+    UAISO_EXPECT_CONTAINER_EQ(expected, tks);
+}
+
 MAKE_CLASS_TEST(PyLexer)
@@ -27,6 +27,7 @@
 #include "Common/Assert.h"
 #include "Common/Trace__.h"
 #include "Common/Util__.h"
+#include "Parsing/Lexeme.h"
 #include "Parsing/ParsingContext.h"
 #include <tuple>
 
@@ -540,6 +541,7 @@ std::unique_ptr<StmtAst> PyParser::parseImportStmt()
             if (maybeConsume(TK_STAR)) {
                 auto star = SimpleNameAst::create();
                 star->setNameLoc(lastLoc_);
+                star->setIdent(ConstIdent_Cast(lastLexeme_));
                 module->setLocalName(star.release());
             } else {
                 module->setItems(parseSubImports(true).release());
@@ -993,7 +995,10 @@ std::unique_ptr<StmtAst> PyParser::parseFuncDef()
 
     match(TK_COLON);
     spec->setLDelimLoc(lastLoc_);
-    decl->setStmt(parseSuite().release());
+    if (context_->skipBodies())
+        decl->setStmt(skipSuite().release());
+    else
+        decl->setStmt(parseSuite().release());
     decl->setSpec(spec.release());
 
     return Stmt(newAst<DeclStmtAst>()->setDecl(decl.release()));
@@ -1169,6 +1174,71 @@ std::unique_ptr<StmtAst> PyParser::parseSuite()
     return Stmt(block.release());
 }
 
+/*
+ * Skip over a suite, for signature-only parsing. Statements aren't built,
+ * except for assignments to attributes of `self` (without their values),
+ * since those declare members of the enclosing class.
+ */
+std::unique_ptr<StmtAst> PyParser::skipSuite()
+{
+    auto block = BlockStmtAst::create();
+    bool simple = !maybeConsume(TK_NEWLINE);
+    if (!simple && !match(TK_INDENT))
+        return Stmt(block.release());
+
+    size_t depth = 1;
+    bool atStmtStart = true;
+    while (ahead_ != TK_EOP) {
+        if (atStmtStart && ahead_ == TK_IDENT && lexer_->lexeme()
+                && lexer_->lexeme()->spelling() == "self") {
+            atStmtStart = false;
+            auto self = IdentExprAst::create();
+            self->setName(parseName().release());
+            if (!maybeConsume(TK_DOT) || ahead_ != TK_IDENT)
+                continue;
+            auto member = MemberAccessExprAst::create();
+            member->setOprLoc(lastLoc_);
+            member->setExpr(self.release());
+            member->setName(parseName().release());
+            if (!maybeConsume(TK_EQ))
+                continue;
+            auto assign = AssignExprAst::create();
+            assign->setOprLoc(lastLoc_);
+            assign->setExpr1s(ExprAstList::create(member.release()));
+            block->addStmt(newAst<ExprStmtAst>()->setExprs(
+                               ExprAstList::create(assign.release())));
+            continue;
+        }
+
+        switch (ahead_) {
+        case TK_NEWLINE:
+            consumeToken();
+            if (simple)
+                return Stmt(block.release());
+            atStmtStart = true;
+            continue;
+
+        case TK_INDENT:
+            ++depth;
+            break;
+
+        case TK_DEDENT:
+            consumeToken();
+            if (--depth == 0)
+                return Stmt(block.release());
+            atStmtStart = true;
+            continue;
+
+        default:
+            atStmtStart = ahead_ == TK_SEMICOLON;
+            break;
+        }
+        consumeToken();
+    }
+
+    return Stmt(block.release());
+}
+
 /*
  * exprlist: expr (',' expr)* [',']
  */
@@ -1669,9 +1739,16 @@ std::unique_ptr<ExprAst> PyParser::parseAtom()
     }
 
     case TK_INT_LIT:
+        consumeToken();
+        return Expr(newAst<NumLitExprAst>()->setLitLoc(lastLoc_)
+                    ->setLit(ConstNumLit_Cast(lastLexeme_))
+                    ->setVariety(NumLitVariety::IntFormat));
+
     case TK_FLOAT_LIT:
         consumeToken();
-        return Expr(newAst<NumLitExprAst>()->setLitLoc(lastLoc_));
+        return Expr(newAst<NumLitExprAst>()->setLitLoc(lastLoc_)
+                    ->setLit(ConstNumLit_Cast(lastLexeme_))
+                    ->setVariety(NumLitVariety::FloatFormat));
 
     case TK_NULL_VALUE:
         consumeToken();
@@ -2004,6 +2081,7 @@ std::unique_ptr<NameAst> PyParser::parseName()
     if (match(TK_IDENT)) {
         auto name = SimpleNameAst::create();
         name->setNameLoc(lastLoc_);
+        name->setIdent(ConstIdent_Cast(lastLexeme_));
         return Name(name.release());
     }
 
@@ -2017,6 +2095,7 @@ std::unique_ptr<ExprAst> PyParser::parseStrLit()
     match(TK_STR_LIT);
     auto str = StrLitExprAst::create();
     str->setLitLoc(lastLoc_);
+    str->setLit(ConstStrLit_Cast(lastLexeme_));
     if (ahead_ == TK_STR_LIT) {
         auto concat = ConcatExprAst::create();
         concat->setExpr1(str.release());
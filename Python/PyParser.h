@@ -113,6 +113,7 @@ private:
     Stmt parseRaiseStmt();
     Stmt parseReturnStmt();
     Stmt parseSuite();
+    Stmt skipSuite();
     Stmt parseWithStmt();
 
     //--- Expressions ---//
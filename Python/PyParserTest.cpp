@@ -24,8 +24,12 @@
 #include "Python/PyParser.h"
 #include "Python/PyLexer.h"
 #include "Python/PyLang.h"
+#include "Ast/AstVisitor.h"
+#include "Parsing/Lexeme.h"
+#include "Parsing/LexemeMap.h"
 #include "Parsing/LangId.h"
 #include "Parsing/ParserTest.h"
+#include <algorithm>
 
 using namespace uaiso;
 
@@ -1407,12 +1411,119 @@ void PyParser::PyParserTest::testcase155()
     core("[1,]\n");
 }
 
+namespace {
+
+class LexemeGatherer final : public AstVisitor<LexemeGatherer>
+{
+public:
+    std::vector<const Lexeme*> lexs_;
+
+private:
+    friend class AstVisitor<LexemeGatherer>;
+
+    VisitResult visitSimpleName(SimpleNameAst* ast)
+    {
+        lexs_.push_back(ast->ident());
+        return Continue;
+    }
+
+    VisitResult visitStrLitExpr(StrLitExprAst* ast)
+    {
+        lexs_.push_back(ast->lit());
+        return Continue;
+    }
+
+    VisitResult visitNumLitExpr(NumLitExprAst* ast)
+    {
+        lexs_.push_back(ast->lit());
+        return Continue;
+    }
+};
+
+} // anonymous
+
 void PyParser::PyParserTest::testcase156()
 {
+    // Names and literals carry the lexemes interned while lexing.
+    std::string code = "foo = bar('baz', 42)\n";
+
+    LexemeMap lexs;
+    ParsingContext context;
+    context.setFileName("/test.py");
+    context.collectLexemes(&lexs);
+
+    PyLexer lexer;
+    lexer.setContext(&context);
+    lexer.setBuffer(code.c_str(), code.length());
+    PyParser parser;
+    UAISO_EXPECT_TRUE(parser.parse(&lexer, &context));
+
+    std::unique_ptr<Ast> ast(context.releaseAst());
+    UAISO_EXPECT_TRUE(ast);
+    LexemeGatherer gatherer;
+    for (auto stmt : *Program_Cast(ast.get())->stmts())
+        gatherer.traverseStmt(stmt);
+
+    UAISO_EXPECT_INT_EQ(4, gatherer.lexs_.size());
+    UAISO_EXPECT_PTR_EQ(lexs.findAnyOf<Ident>("foo"), gatherer.lexs_[0]);
+    UAISO_EXPECT_PTR_EQ(lexs.findAnyOf<Ident>("bar"), gatherer.lexs_[1]);
+    UAISO_EXPECT_PTR_EQ(lexs.findAnyOf<StrLit>("'baz'"), gatherer.lexs_[2]);
+    UAISO_EXPECT_PTR_EQ(lexs.findAnyOf<NumLit>("42"), gatherer.lexs_[3]);
 }
 
 void PyParser::PyParserTest::testcase157()
 {
+    // When skipping bodies, only assignments to attributes of self remain.
+    std::string code = R"raw(
+class Foo:
+    def __init__(self, a):
+        self.x = a
+        if a:
+            self.y = [a,
+                      7]
+        self.x.z = 7
+    def bar(self): return self.x
+def baz(n):
+    return n + 7
+qux = 42
+)raw";
+
+    LexemeMap lexs;
+    ParsingContext context;
+    context.setFileName("/test.py");
+    context.collectLexemes(&lexs);
+    context.setSkipBodies(true);
+
+    PyLexer lexer;
+    lexer.setContext(&context);
+    lexer.setBuffer(code.c_str(), code.length());
+    PyParser parser;
+    UAISO_EXPECT_TRUE(parser.parse(&lexer, &context));
+
+    std::unique_ptr<Ast> ast(context.releaseAst());
+    UAISO_EXPECT_TRUE(ast);
+    LexemeGatherer gatherer;
+    int stmts = 0;
+    for (auto stmt : *Program_Cast(ast.get())->stmts()) {
+        gatherer.traverseStmt(stmt);
+        ++stmts;
+    }
+    UAISO_EXPECT_INT_EQ(3, stmts);
+
+    auto count = [&gatherer](const std::string& spelling) {
+        return std::count_if(gatherer.lexs_.begin(), gatherer.lexs_.end(),
+                             [&spelling](const Lexeme* lex) {
+            return lex->spelling() == spelling;
+        });
+    };
+    UAISO_EXPECT_INT_EQ(4, count("self"));
+    UAISO_EXPECT_INT_EQ(1, count("x"));
+    UAISO_EXPECT_INT_EQ(1, count("y"));
+    UAISO_EXPECT_INT_EQ(0, count("z"));
+    UAISO_EXPECT_INT_EQ(1, count("a"));
+    UAISO_EXPECT_INT_EQ(1, count("n"));
+    UAISO_EXPECT_INT_EQ(0, count("7"));
+    UAISO_EXPECT_INT_EQ(1, count("42"));
 }
 
 void PyParser::PyParserTest::testcase158()
@@ -38,23 +38,23 @@ void PyUnit::parseCore(TokenMap* tokens,
                        LexemeMap* lexs,
                        ParsingContext* context)
 {
-    P->ast_.reset(nullptr);
+    P->discardAst();
+    AstPool::Scope scope(&P->tree_->pool_);
 
     context->collectLexemes(lexs);
     context->collectTokens(tokens);
     context->collectReports(P->reports_.get());
     context->setFileName(P->fullFileName_.c_str());
+    context->setSkipBodies(P->bit_.skipBodies_);
 
     PyLexer lexer;
     lexer.setContext(context);
-    std::unique_ptr<std::string> buff;
-    if (P->bit_.readFromFile_) {
-        fseek(P->file_, 0, SEEK_END);
-        buff.reset(new std::string);
-        buff->resize(ftell(P->file_));
-        rewind(P->file_);
-        fread(&(*buff)[0], 1, buff->size(), P->file_);
-        lexer.setBuffer(buff->c_str(), buff->size());
+    std::unique_ptr<SourceBuffer> buff;
+    if (P->bit_.readFromBuffer_) {
+        lexer.setBuffer(P->buffer_->data(), P->buffer_->size());
+    } else if (P->bit_.readFromFile_) {
+        buff = SourceBuffer::read(P->file_);
+        lexer.setBuffer(buff->data(), buff->size());
     } else {
         lexer.setBuffer(P->source_->c_str(), P->source_->size());
     }
@@ -62,8 +62,9 @@ void PyUnit::parseCore(TokenMap* tokens,
 
     PyParser parser;
     bool success = parser.parse(&lexer, context);
+    std::unique_ptr<Ast> ast(context->releaseAst()); // Dispose within the pool.
     if (success)
-        P->ast_.reset(context->releaseAst());
+        P->tree_->ast_ = std::move(ast);
 }
 
 void PyUnit::parse(TokenMap* tokens, LexemeMap* lexs)
@@ -80,3 +81,8 @@ void PyUnit::parse(TokenMap* tokens,
     context.setStopMark(lineCol);
     parseCore(tokens, lexs, &context);
 }
+
+bool PyUnit::canSkipBodies() const
+{
+    return true;
+}
@@ -38,6 +38,8 @@ public:
                LexemeMap* lexs,
                const LineCol& lineCol) override;
 
+    bool canSkipBodies() const override;
+
 private:
     DECL_CLASS_TEST(PyUnit)
 
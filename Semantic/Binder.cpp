@@ -51,6 +51,7 @@
 #include <algorithm>
 #include <functional>
 #include <iostream>
+#include <mutex>
 #include <stack>
 #include <utility>
 
@@ -100,10 +101,6 @@ namespace {
 class AstToLexeme final : public AstVisitor<AstToLexeme>
 {
 public:
-    AstToLexeme(const LexemeMap* lexs)
-        : lexs_(lexs)
-    {}
-
     std::vector<const Lexeme*> process(ExprAst* ast)
     {
         prepare();
@@ -121,7 +118,6 @@ public:
 private:
     friend class AstVisitor<AstToLexeme>;
 
-    const LexemeMap* lexs_;
     std::vector<const Lexeme*> ids_;
     bool firstOnly_;
 
@@ -141,26 +137,134 @@ private:
 
     VisitResult visitSimpleName(SimpleNameAst* ast)
     {
-        auto name = lexs_->findAt<Ident>(ast->nameLoc_.fileName_,
-                                         ast->nameLoc_.lineCol());
-        return pushName(name);
+        return pushName(ast->ident_);
     }
 
     VisitResult visitGenName(GenNameAst* ast)
     {
-        auto name = lexs_->findAt<Ident>(ast->genLoc_.fileName_,
-                                         ast->genLoc_.lineCol());
-        return pushName(name);
+        return pushName(ast->ident_);
     }
 
     VisitResult visitStrLitExpr(StrLitExprAst* ast)
     {
-        auto name = lexs_->findAt<StrLit>(ast->litLoc_.fileName_,
-                                          ast->litLoc_.lineCol());
-        return pushName(name);
+        return pushName(ast->lit_);
     }
 };
 
+/*!
+ * \brief selfMemberName
+ *
+ * Return the name of the member when the expression is an access to an
+ * attribute of `self`, otherwise null.
+ */
+NameAst* selfMemberName(ExprAst* expr, const LexemeMap* lexs)
+{
+    if (expr->kind() != Ast::Kind::MemberAccessExpr)
+        return nullptr;
+
+    auto member = MemberAccessExpr_Cast(expr);
+    if (!member->exprOrSpec()
+            || member->exprOrSpec()->kind() != Ast::Kind::IdentExpr) {
+        return nullptr;
+    }
+
+    AstToLexeme pickupName;
+    const auto& baseLexemes =
+            pickupName.process(IdentExpr_Cast(member->exprOrSpec())->name());
+    if (baseLexemes.empty() || baseLexemes[0] != lexs->self())
+        return nullptr;
+
+    return member->name();
+}
+
+/*!
+ * \brief The SelfAssignFinder class
+ *
+ * Collect the assignments to attributes of `self` within a function body,
+ * including the ones of nested functions, but not of nested records.
+ */
+class SelfAssignFinder final : public AstVisitor<SelfAssignFinder>
+{
+public:
+    SelfAssignFinder(const LexemeMap* lexs)
+        : lexs_(lexs)
+    {}
+
+    std::vector<AssignExprAst*> find(StmtAst* ast)
+    {
+        traverseStmt(ast);
+        return std::move(assigns_);
+    }
+
+private:
+    friend class AstVisitor<SelfAssignFinder>;
+
+    const LexemeMap* lexs_;
+    std::vector<AssignExprAst*> assigns_;
+
+    VisitResult traverseRecordDecl(RecordDeclAst*)
+    {
+        return Continue;
+    }
+
+    VisitResult visitAssignExpr(AssignExprAst* ast)
+    {
+        for (auto expr : *ast->exprs1()) {
+            if (selfMemberName(expr, lexs_)) {
+                assigns_.push_back(ast);
+                break;
+            }
+        }
+        return Continue;
+    }
+};
+
+/*!
+ * \brief The BuiltinEnvs class
+ *
+ * The builtins environment of each language, created once per lexeme map
+ * (where the builtins' identifiers are interned) and shared, frozen, by
+ * every program bound with that map.
+ */
+class BuiltinEnvs final
+{
+public:
+    static Environment fetch(LangId langId,
+                             const LexemeMap* lexs,
+                             const std::function<Environment ()>& create)
+    {
+        static BuiltinEnvs envs;
+
+        std::lock_guard<std::mutex> lock(envs.mutex_);
+        for (const auto& entry : envs.entries_) {
+            if (entry.langId_ == langId && entry.stamp_ == lexs->stamp())
+                return entry.env_;
+        }
+
+        Environment env = create();
+        env.freeze();
+        // Maps which are cleared or destroyed never match again, so only
+        // the most recent entries are kept.
+        if (envs.entries_.size() == kMaxEntries)
+            envs.entries_.erase(envs.entries_.begin());
+        envs.entries_.push_back(Entry { langId, lexs->stamp(), env });
+        return env;
+    }
+
+private:
+    static const size_t kMaxEntries = 8;
+
+    struct Entry
+    {
+        LangId langId_;
+        uint64_t stamp_;
+        Environment env_;
+    };
+
+    std::mutex mutex_;
+    std::vector<Entry> entries_;
+};
+
 } // anonymous
 
 /*!
@@ -171,7 +275,8 @@ private:
 struct uaiso::Binder::BinderImpl
 {
     BinderImpl(Factory* factory)
-        : lexs_(nullptr)
+        : factory_(factory)
+        , lexs_(nullptr)
         , tokens_(nullptr)
         , ownedBlocks_(0)
         , sanitizer_(factory->makeSanitizer())
@@ -196,6 +301,35 @@ struct uaiso::Binder::BinderImpl
         return prevEnv;
     }
 
+    Environment createBuiltinEnv()
+    {
+        Environment env;
+        auto insertFunc = [&env](std::vector<Builtin::FuncPtr> funcs) {
+            for (auto& func : funcs) {
+                UAISO_ASSERT(func, return);
+                env.insertTypeDecl(std::move(func));
+            }
+        };
+
+        LexemeMap* lexs = const_cast<LexemeMap*>(lexs_);
+        insertFunc(builtins_->createConstructors(lexs));
+        insertFunc(builtins_->createGlobalFuncs(lexs));
+
+        if (lang_->isPurelyOO()) {
+            auto maybeInsert = [&env](Builtin::TypeDeclPtr decl) {
+                if (decl)
+                    env.insertTypeDecl(std::move(decl));
+            };
+
+            maybeInsert(builtins_->createRootTypeDecl(lexs));
+            maybeInsert(builtins_->createBasicTypeDecl(lexs, Type::Kind::Bool));
+            maybeInsert(builtins_->createBasicTypeDecl(lexs, Type::Kind::Float));
+            maybeInsert(builtins_->createBasicTypeDecl(lexs, Type::Kind::Int));
+        }
+
+        return env;
+    }
+
     template <class TypeT = Type>
     std::unique_ptr<TypeT> popDeclType()
     {
@@ -219,11 +353,14 @@ struct uaiso::Binder::BinderImpl
             reports_->add(std::forward<Args>(args)...);
     }
 
+    Factory* factory_;
+
     const LexemeMap* lexs_; //!< Lexeme map of all AST locations.
     const TokenMap* tokens_;   //!< Token map of all AST locations.
 
     //! File name corresponding the to given AST.
     std::string fileName_;
+    FileId fileId_;
 
     //! Environment we're currently in.
     Environment env_;
@@ -264,10 +401,19 @@ struct uaiso::Binder::BinderImpl
     //! Program being constructed.
     std::unique_ptr<Program> program_;
 
+    //! Owner of the AST, retained by deferred bodies (when given).
+    std::shared_ptr<const Ast> astOwner_;
+
+    //! Tokens of the file as they were parsed, retained by deferred bodies.
+    std::shared_ptr<const TokenMap> bodyTokens_;
+
     struct BitFields
     {
         uint32_t ignoreBuiltins_    : 1;
         uint32_t ignoreAutoModules_ : 1;
+        uint32_t lazyBodies_        : 1;
+        uint32_t selfMembersBound_  : 1; //!< Of the deferred body being bound.
+        uint32_t deferredBody_      : 1; //!< A deferred body is being bound.
     };
     union
     {
@@ -308,6 +454,11 @@ void Binder::ignoreAutomaticModules()
     P->bit_.ignoreAutoModules_ = true;
 }
 
+void Binder::bindBodiesLazily()
+{
+    P->bit_.lazyBodies_ = true;
+}
+
 std::unique_ptr<Program> Binder::bind(ProgramAst* progAst,
                                       const std::string& fullFileName)
 {
@@ -315,7 +466,10 @@ std::unique_ptr<Program> Binder::bind(ProgramAst* progAst,
     UAISO_ASSERT(!fullFileName.empty(), return std::unique_ptr<Program>());
 
     P->fileName_.assign(fullFileName);
+    P->fileId_ = FileRegistry::insertOrFind(fullFileName);
     P->program_.reset(new Program(P->fileName_));
+    if (P->bit_.lazyBodies_ && P->tokens_)
+        P->bodyTokens_ = P->tokens_->retain(P->fileId_);
 
     P->enterSubEnv();
 
@@ -343,30 +497,40 @@ std::unique_ptr<Program> Binder::bind(ProgramAst* progAst,
     return std::move(P->program_);
 }
 
-void Binder::insertBuiltins()
+std::unique_ptr<Program> Binder::bind(std::shared_ptr<ProgramAst> progAst,
+                                      const std::string& fullFileName)
 {
-    auto insertFunc = [this](std::vector<Builtin::FuncPtr> funcs) {
-        for (auto& func : funcs) {
-            UAISO_ASSERT(func, return);
-            P->env_.insertTypeDecl(std::move(func));
-        }
-    };
+    P->astOwner_ = progAst;
+    auto prog = bind(progAst.get(), fullFileName);
+    P->astOwner_.reset();
+    return prog;
+}
 
-    LexemeMap* lexs = const_cast<LexemeMap*>(P->lexs_);
-    insertFunc(P->builtins_->createConstructors(lexs));
-    insertFunc(P->builtins_->createGlobalFuncs(lexs));
+void Binder::bindBody(FuncDeclAst* ast,
+                      Environment env,
+                      const std::string& fullFileName)
+{
+    P->fileName_.assign(fullFileName);
+    P->fileId_ = FileRegistry::insertOrFind(fullFileName);
+    P->env_ = env;
+    P->bit_.deferredBody_ = true;
 
-    if (P->lang_->isPurelyOO()) {
-        auto maybeInsert = [this](Builtin::TypeDeclPtr decl) {
-            if (decl)
-                P->env_.insertTypeDecl(std::move(decl));
-        };
+    traverseFuncBody(ast);
 
-        maybeInsert(P->builtins_->createRootTypeDecl(lexs));
-        maybeInsert(P->builtins_->createBasicTypeDecl(lexs, Type::Kind::Bool));
-        maybeInsert(P->builtins_->createBasicTypeDecl(lexs, Type::Kind::Float));
-        maybeInsert(P->builtins_->createBasicTypeDecl(lexs, Type::Kind::Int));
-    }
+    UAISO_ASSERT(P->declTy_.empty(), {});
+    UAISO_ASSERT(P->sym_.empty(), {});
+}
+
+void Binder::insertBuiltins()
+{
+    if (!P->builtins_)
+        return;
+
+    // Builtins are not copied into the program, they're merged by reference.
+    auto create = [this] () { return P->createBuiltinEnv(); };
+    Environment env = BuiltinEnvs::fetch(P->factory_->langName(), P->lexs_, create);
+    if (!env.isEmpty())
+        P->env_.mergeEnv(env);
 }
 
 void Binder::importAutomaticModules()
@@ -375,6 +539,7 @@ void Binder::importAutomaticModules()
     for (const auto& moduleName : names) {
         std::unique_ptr<Import> import(new Import(FileInfo(P->fileName_).fullDir(),
                                                   moduleName, nullptr, true));
+        import->markAsAutomatic();
         P->env_.includeImport(std::move(import));
     }
 }
@@ -385,10 +550,8 @@ void Binder::importAutomaticModules()
 
 Binder::VisitResult Binder::visitSimpleName(SimpleNameAst* ast)
 {
-    const SourceLoc& loc = ast->nameLoc_;
-    auto ident = P->lexs_->findAt<Ident>(loc.fileName_, loc.lineCol());
-    UAISO_ASSERT(ident, return Abort, "SourceLoc:", loc);
-    P->declId_.push_back(ident);
+    UAISO_ASSERT(ast->ident_, return Abort, "SourceLoc:", ast->nameLoc_);
+    P->declId_.push_back(ast->ident_);
 
     return Continue;
 }
@@ -451,7 +614,7 @@ Binder::VisitResult Binder::visitInferredSpec(InferredSpecAst* ast)
 Binder::VisitResult Binder::visitBuiltinSpec(BuiltinSpecAst* ast)
 {
     const SourceLoc& loc = ast->keyLoc();
-    Token tk = P->tokens_->findAt(loc.fileName_, loc.lineCol());
+    Token tk = P->tokens_->findAt(loc.fileId_, loc.lineCol());
 
     std::unique_ptr<Type> ty;
     switch (tk) {
@@ -673,7 +836,7 @@ Binder::VisitResult Binder::traverseNamedSpec(NamedSpecAst* ast)
 Binder::VisitResult Binder::visitVisibilityAttr(VisibilityAttrAst* ast)
 {
     const SourceLoc& loc = ast->keyLoc();
-    Token tk = P->tokens_->findAt(loc.fileName_, loc.lineCol());
+    Token tk = P->tokens_->findAt(loc.fileId_, loc.lineCol());
 
     ENSURE_TOP_SYMBOL_IS_DECL;
     Decl* sym = DeclSymbol_Cast(P->sym_.top().get());
@@ -718,7 +881,7 @@ Binder::VisitResult Binder::visitAnnotAttr(AnnotAttrAst* ast)
 Binder::VisitResult Binder::visitDeclAttr(DeclAttrAst* ast)
 {
     const SourceLoc& loc = ast->keyLoc();
-    Token tk = P->tokens_->findAt(loc.fileName_, loc.lineCol());
+    Token tk = P->tokens_->findAt(loc.fileId_, loc.lineCol());
 
     ENSURE_TOP_SYMBOL_IS_DECL;
     Decl* sym = TypeDecl_Cast(P->sym_.top().get());
@@ -776,7 +939,7 @@ Binder::VisitResult Binder::visitDeclAttr(DeclAttrAst* ast)
 Binder::VisitResult Binder::visitAutoAttr(AutoAttrAst* ast)
 {
     const SourceLoc& loc = ast->keyLoc();
-    Token tk = P->tokens_->findAt(loc.fileName_, loc.lineCol());
+    Token tk = P->tokens_->findAt(loc.fileId_, loc.lineCol());
 
     ENSURE_TOP_SYMBOL_IS_DECL;
     Decl* sym = DeclSymbol_Cast(P->sym_.top().get());
@@ -805,7 +968,7 @@ Binder::VisitResult Binder::visitCodegenAttr(CodegenAttrAst* ast)
 Binder::VisitResult Binder::visitParamDirAttr(ParamDirAttrAst* ast)
 {
     const SourceLoc& loc = ast->keyLoc();
-    Token tk = P->tokens_->findAt(loc.fileName_, loc.lineCol());
+    Token tk = P->tokens_->findAt(loc.fileId_, loc.lineCol());
 
     ENSURE_TOP_SYMBOL_IS(Param);
     Param* param = Param_Cast(P->sym_.top().get());
@@ -838,7 +1001,7 @@ Binder::VisitResult Binder::visitParamDirAttr(ParamDirAttrAst* ast)
 Binder::VisitResult Binder::visitEvalStrategyAttr(EvalStrategyAttrAst* ast)
 {
     const SourceLoc& loc = ast->keyLoc();
-    Token tk = P->tokens_->findAt(loc.fileName_, loc.lineCol());
+    Token tk = P->tokens_->findAt(loc.fileId_, loc.lineCol());
 
     ENSURE_TOP_SYMBOL_IS(Param);
     Param* param = Param_Cast(P->sym_.top().get());
@@ -868,7 +1031,7 @@ Binder::VisitResult Binder::visitEvalStrategyAttr(EvalStrategyAttrAst* ast)
 Binder::VisitResult Binder::visitStorageClassAttr(StorageClassAttrAst* ast)
 {
     const SourceLoc& loc = ast->keyLoc();
-    Token tk = P->tokens_->findAt(loc.fileName_, loc.lineCol());
+    Token tk = P->tokens_->findAt(loc.fileId_, loc.lineCol());
 
     ENSURE_TOP_SYMBOL_IS_DECL;
     Decl* sym = DeclSymbol_Cast(P->sym_.top().get());
@@ -904,7 +1067,7 @@ Binder::VisitResult Binder::visitStorageClassAttr(StorageClassAttrAst* ast)
 Binder::VisitResult Binder::visitLinkageAttr(LinkageAttrAst* ast)
 {
     const SourceLoc& loc = ast->keyLoc();
-    Token tk = P->tokens_->findAt(loc.fileName_, loc.lineCol());
+    Token tk = P->tokens_->findAt(loc.fileId_, loc.lineCol());
 
     ENSURE_TOP_SYMBOL_IS_VALUEDECL;
     ValueDecl* sym = ValueDecl_Cast(P->sym_.top().get());
@@ -934,7 +1097,7 @@ Binder::VisitResult Binder::visitLinkageAttr(LinkageAttrAst* ast)
 Binder::VisitResult Binder::visitTypeQualAttr(TypeQualAttrAst* ast)
 {
     const SourceLoc& loc = ast->keyLoc();
-    Token tk = P->tokens_->findAt(loc.fileName_, loc.lineCol());
+    Token tk = P->tokens_->findAt(loc.fileId_, loc.lineCol());
 
     ENSURE_NONEMPTY_TYPE_STACK;
     Type* ty = P->declTy_.top().get();
@@ -1055,7 +1218,7 @@ Binder::VisitResult Binder::traverseImportModuleDecl(ImportModuleDeclAst* ast)
     // it's still evaluated so the module and given namespace are collected.
 
     UAISO_ASSERT(ast->expr(), return Abort);
-    AstToLexeme astToLexs(P->lexs_);
+    AstToLexeme astToLexs;
     const auto& lexs = astToLexs.process(ast->expr());
     if (lexs.empty()) {
         P->report(Diagnostic::UnresolvedModule, ast->expr(), P->locator_);
@@ -1079,9 +1242,16 @@ Binder::VisitResult Binder::traverseImportModuleDecl(ImportModuleDeclAst* ast)
 
     // By default, if local name is empty, assign the target to it (at an
     // artificial column after the import's last location).
+    // A deferred body may be bound after the file is parsed again, when
+    // the position doesn't belong to this AST, so the name is only interned.
     if (!localName) {
-        localName = const_cast<LexemeMap*>(P->lexs_)->insertOrFind<Ident>(
-                target, P->fileName_, P->locator_->lastLoc(ast).lineCol() + LineCol(0, 1));
+        auto lexs = const_cast<LexemeMap*>(P->lexs_);
+        if (P->bit_.deferredBody_) {
+            localName = lexs->intern<Ident>(target);
+        } else {
+            localName = lexs->insertOrFind<Ident>(
+                    target, P->fileId_, P->locator_->lastLoc(ast).lineCol() + LineCol(0, 1));
+        }
         DEBUG_TRACE("no explicit local name, assign %s\n", target.c_str());
     }
 
@@ -1347,6 +1517,52 @@ Binder::VisitResult Binder::traverseFuncDecl(FuncDeclAst* ast)
     ENSURE_NONEMPTY_TYPE_STACK;
     func->setType(P->popDeclType<FuncType>());
 
+    if (P->bit_.lazyBodies_ && P->lang_->hasFuncLevelScope() && ast->stmt()) {
+        // The body of a method may declare members of its record, which
+        // are part of the program's declarations and can't wait.
+        bool selfMembersBound = P->bit_.selfMembersBound_ && P->tyEnv_.empty();
+        if (P->typeSystem_->isDynamic() && !P->tyEnv_.empty()) {
+            VIS_CALL(bindSelfMembers(ast));
+            selfMembersBound = true;
+        }
+
+        // The body is bound from the tokens retained when the program was,
+        // and keeps the AST alive (if its owner was given).
+        Environment env = P->leaveEnv();
+        func->setEnv(env);
+        Factory* factory = P->factory_;
+        const LexemeMap* lexs = P->lexs_;
+        std::shared_ptr<const TokenMap> bodyTokens = P->bodyTokens_;
+        std::shared_ptr<const Ast> astOwner = P->astOwner_;
+        std::string fileName = P->fileName_;
+        func->setBodyBinder([=]() {
+            Binder binder(factory);
+            binder.setLexemes(lexs);
+            binder.setTokens(bodyTokens.get());
+            binder.P->bodyTokens_ = bodyTokens;
+            binder.P->astOwner_ = astOwner;
+            binder.P->bit_.lazyBodies_ = true;
+            binder.P->bit_.selfMembersBound_ = selfMembersBound;
+            binder.bindBody(ast, env, fileName);
+        });
+        P->env_.insertTypeDecl(std::move(func));
+        return Continue;
+    }
+
+    VIS_CALL(traverseFuncBody(ast));
+
+    if (P->lang_->hasFuncLevelScope())
+        func->setEnv(P->leaveEnv());
+    else
+        func->setEnv(P->env_);
+
+    P->env_.insertTypeDecl(std::move(func));
+
+    return Continue;
+}
+
+Binder::VisitResult Binder::traverseFuncBody(FuncDeclAst* ast)
+{
     if (ast->stmt_ && ast->stmt_->kind() == Ast::Kind::BlockStmt) {
         // A block stmt of a function must have the same environment of
         // its parent function, and not create its own.
@@ -1357,12 +1573,20 @@ Binder::VisitResult Binder::traverseFuncDecl(FuncDeclAst* ast)
         VIS_CALL(traverseStmt(ast->stmt()));
     }
 
-    if (P->lang_->hasFuncLevelScope())
-        func->setEnv(P->leaveEnv());
-    else
-        func->setEnv(P->env_);
+    return Continue;
+}
 
-    P->env_.insertTypeDecl(std::move(func));
+Binder::VisitResult Binder::bindSelfMembers(FuncDeclAst* ast)
+{
+    ENSURE_NONEMPTY_ENV_STACK;
+
+    SelfAssignFinder finder(P->lexs_);
+    for (auto assign : finder.find(ast->stmt())) {
+        for (auto expr : *assign->exprs1()) {
+            if (auto name = selfMemberName(expr, P->lexs_))
+                VIS_CALL(bindAssignTarget(assign, name, P->tyEnv_.top()));
+        }
+    }
 
     return Continue;
 }
@@ -1491,50 +1715,49 @@ Binder::VisitResult Binder::traverseAssignExpr(AssignExprAst* ast)
         return Continue;
 
     for (auto expr : *ast->exprs1()) {
-        Environment env = P->env_;
-        NameAst* name = nullptr;
         if (expr->kind() == Ast::Kind::IdentExpr) {
-            name = IdentExpr_Cast(expr)->name();
-        } else if (expr->kind() == Ast::Kind::MemberAccessExpr) {
-            auto member = MemberAccessExpr_Cast(expr);
-            if (!member->exprOrSpec()
-                    || member->exprOrSpec()->kind() != Ast::Kind::IdentExpr) {
-                continue;
-            }
-            auto baseName = IdentExpr_Cast(member->exprOrSpec())->name();
-
-            // Retrieve the lex of the base name and check whether
-            // it's a "self". If so, bind the corresponding name.
-            AstToLexeme pickupName(P->lexs_);
-            const auto& baseLexemes = pickupName.process(baseName);
-            if (baseLexemes.empty() ||
-                    baseLexemes[0] != P->lexs_->self()) {
-                continue;
-            }
-
-            name = member->name();
-            if (P->tyEnv_.empty())
-                P->report(Diagnostic::InvalidReferenceToSelf, fullLoc(name, P->locator_));
-            else
-                env = P->tyEnv_.top();
-        } else {
+            VIS_CALL(bindAssignTarget(ast, IdentExpr_Cast(expr)->name(), P->env_));
             continue;
         }
 
-        VIS_CALL(traverseName(name));
-        ENSURE_NAME_AVAILABLE;
-        std::unique_ptr<Var> var(new Var(P->declId_.back()));
-        var->setSourceLoc(fullLoc(name, P->locator_));
-        var->setValueType(std::unique_ptr<Type>(new InferredType));
+        // If it's a "self", bind the corresponding name.
+        NameAst* name = selfMemberName(expr, P->lexs_);
+        if (!name)
+            continue;
 
-        ast->syms_.push_back(var.get()); // Annotate AST with symbol
+        // Unless that happened along with the declaration of the function
+        // whose body is now bound (see traverseFuncDecl).
+        if (P->bit_.selfMembersBound_ && P->tyEnv_.empty())
+            continue;
 
-        env.insertValueDecl(std::unique_ptr<ValueDecl>(var.release()));
+        Environment env = P->env_;
+        if (P->tyEnv_.empty())
+            P->report(Diagnostic::InvalidReferenceToSelf, fullLoc(name, P->locator_));
+        else
+            env = P->tyEnv_.top();
+        VIS_CALL(bindAssignTarget(ast, name, env));
     }
 
     return Continue;
 }
 
+Binder::VisitResult Binder::bindAssignTarget(AssignExprAst* ast,
+                                             NameAst* name,
+                                             Environment env)
+{
+    VIS_CALL(traverseName(name));
+    ENSURE_NAME_AVAILABLE;
+    std::unique_ptr<Var> var(new Var(P->declId_.back()));
+    var->setSourceLoc(fullLoc(name, P->locator_));
+    var->setValueType(std::unique_ptr<Type>(new InferredType));
+
+    ast->syms_.push_back(var.get()); // Annotate AST with symbol
+
+    env.insertValueDecl(std::unique_ptr<ValueDecl>(var.release()));
+
+    return Continue;
+}
+
     //------------------//
     //--- Statements ---//
     //------------------//
@@ -27,10 +27,12 @@
 #include "Common/Test.h"
 #include "Parsing/Diagnostic.h"
 #include "Semantic/SymbolFwd.h"
+#include <memory>
 #include <vector>
 
 namespace uaiso {
 
+class Environment;
 class Factory;
 class LexemeMap;
 class Program;
@@ -81,6 +83,19 @@ public:
      */
     void ignoreAutomaticModules();
 
+    /*!
+     * \brief bindBodiesLazily
+     *
+     * Bind only the declarations of the program eagerly, deferring the body
+     * of each function until Func::bindBody is called on it. Deferred bodies
+     * retain the tokens of the file as they are when the program is bound,
+     * so the file may be parsed again meanwhile. The lexeme map and the
+     * factory must outlive the program, and so must the AST, unless its
+     * ownership is shared with the program (see bind's overload).
+     * Diagnostics of deferred bodies aren't collected.
+     */
+    void bindBodiesLazily();
+
     /*!
      * \brief bindProgram
      * \param decl
@@ -89,6 +104,18 @@ public:
      */
     std::unique_ptr<Program> bind(ProgramAst* decl, const std::string& fullFileName);
 
+    /*!
+     * \brief bindProgram
+     * \param decl
+     * \param fullFileName
+     * \return
+     *
+     * Bind the program sharing ownership of its AST, which the functions
+     * whose bodies are deferred keep until those are bound.
+     */
+    std::unique_ptr<Program> bind(std::shared_ptr<ProgramAst> decl,
+                                  const std::string& fullFileName);
+
 private:
     DECL_PIMPL(Binder)
     DECL_CLASS_TEST(Binder)
@@ -99,6 +126,11 @@ private:
     void insertBuiltins();
     void importAutomaticModules();
 
+    void bindBody(FuncDeclAst* ast, Environment env, const std::string& fullFileName);
+    VisitResult traverseFuncBody(FuncDeclAst* ast);
+    VisitResult bindSelfMembers(FuncDeclAst* ast);
+    VisitResult bindAssignTarget(AssignExprAst* ast, NameAst* name, Environment env);
+
     template <class AstT>
     VisitResult keepTypeOfExprSpec(AstT* ast);
 
@@ -53,6 +53,9 @@ public:
              , &BinderTest::PyTestCase10
              , &BinderTest::PyTestCase11
              , &BinderTest::PyTestCase12
+             , &BinderTest::PyTestCase13
+             , &BinderTest::PyTestCase14
+             , &BinderTest::PyTestCase15
              )
 
     //--- Go ---//
@@ -74,6 +77,9 @@ public:
     void PyTestCase10();
     void PyTestCase11();
     void PyTestCase12();
+    void PyTestCase13();
+    void PyTestCase14();
+    void PyTestCase15();
 
 
     std::unique_ptr<Program> core(std::unique_ptr<Factory> factory,
@@ -23,6 +23,7 @@
 
 #include "Semantic/CompletionProposer.h"
 #include "Semantic/Builtin.h"
+#include "Semantic/CompletionRanker.h"
 #include "Semantic/Environment.h"
 #include "Semantic/Program.h"
 #include "Semantic/Symbol.h"
@@ -51,6 +52,28 @@ using namespace uaiso;
 
 namespace {
 
+/*!
+ * \brief The CompletionFinder class
+ *
+ * Tell whether the completion name is within a given statement.
+ */
+class CompletionFinder final : public AstVisitor<CompletionFinder>
+{
+public:
+    bool find(StmtAst* ast)
+    {
+        return traverseStmt(ast) == Abort;
+    }
+
+private:
+    friend class AstVisitor<CompletionFinder>;
+
+    VisitResult visitCompletionName(CompletionNameAst*)
+    {
+        return Abort;
+    }
+};
+
 class CompletionContext final : public AstVisitor<CompletionContext>
 {
 public:
@@ -60,13 +83,8 @@ public:
         : lang_(lang)
     {}
 
-    bool analyse(const ProgramAst* progAst,
-                 const LexemeMap* lexs,
-                 Environment env)
+    bool analyse(const ProgramAst* progAst, Environment env)
     {
-        UAISO_ASSERT(lexs, return false);
-
-        lexs_ = lexs;
         env_ = env;
 
         auto result = traverseProgram(progAst, this, lang_);
@@ -75,7 +93,6 @@ public:
     }
 
     Environment env_;
-    const LexemeMap* lexs_ { nullptr };
     std::stack<Ast*> asts_;
     size_t collectName_ { 0 }; // Collect names only when it matters.
     std::vector<const Ident*> name_;
@@ -90,9 +107,7 @@ public:
     VisitResult visitSimpleName(SimpleNameAst* ast)
     {
         if (collectName_) {
-            auto name = lexs_->findAt<Ident>(ast->nameLoc_.fileName_,
-                                                ast->nameLoc_.lineCol());
-            name_.push_back(name);
+            name_.push_back(ast->ident_);
         }
         return Continue;
     }
@@ -165,7 +180,15 @@ public:
         if (lang_->hasFuncLevelScope()) {
             ENSURE_ANNOTATED_SYMBOL;
             env_ = ast->sym_->env();
-            VIS_CALL(Base::traverseFuncDecl(ast));
+            // A body whose binding was deferred is bound only if that's
+            // where completion is, otherwise it's not even traversed.
+            if (ast->sym_->isBodyBound() || CompletionFinder().find(ast->stmt())) {
+                ast->sym_->bindBody();
+                VIS_CALL(Base::traverseFuncDecl(ast));
+            } else {
+                VIS_CALL(traverseName(ast->name()));
+                VIS_CALL(traverseSpec(ast->spec()));
+            }
             env_ = env_.outerEnv();
         } else {
             VIS_CALL(Base::traverseFuncDecl(ast));
@@ -199,7 +222,10 @@ struct uaiso::CompletionProposer::CompletionProposerImpl
         , resolver_(factory)
     {}
 
-    Symbols& typeDecls(Environment env, Symbols& syms, const Ident* ident)
+    Symbols& typeDecls(Environment env,
+                       Symbols& syms,
+                       const Ident* ident,
+                       size_t distance)
     {
         auto sym = env.searchTypeDecl(ident);
         if (!sym) {
@@ -209,14 +235,51 @@ struct uaiso::CompletionProposer::CompletionProposerImpl
 
         bool hasEnv;
         std::tie(hasEnv, env) = envForType(sym->type(), env);
-        if (hasEnv) {
-            auto extraSyms = env.listDecls();
-            std::copy(extraSyms.begin(), extraSyms.end(), std::back_inserter(syms));
-        }
+        if (hasEnv)
+            addDecls(env, syms, distance);
 
         return syms;
     }
 
+    /*!
+     * \brief addSymbols
+     *
+     * Add the symbols of \a env, which is \a distance scopes away from the
+     * completion point, to the proposals. When ranking, all of them are
+     * considered, otherwise only those starting with the prefix.
+     */
+    Symbols& addSymbols(Environment env,
+                        Symbols& syms,
+                        Environment::SymbolGroups groups,
+                        size_t distance)
+    {
+        if (maxProposals_) {
+            env.visitSymbols(std::string(), groups, [this, distance] (const Symbol* sym) {
+                ranker_.consider(sym, distance);
+            });
+        } else {
+            env.visitSymbols(prefix_, groups, [&syms] (const Symbol* sym) {
+                syms.push_back(sym);
+            });
+        }
+        return syms;
+    }
+
+    Symbols& addDecls(Environment env, Symbols& syms, size_t distance)
+    {
+        return addSymbols(env, syms,
+                          Environment::SymbolGroups(Environment::SymbolGroup::ValueDecls)
+                              | Environment::SymbolGroup::TypeDecls,
+                          distance);
+    }
+
+    Result succeed(Symbols& syms)
+    {
+        if (maxProposals_)
+            return Result(ranker_.finish(), Success);
+        return Result(syms, Success);
+    }
+
     Symbols& addBasicTypeDecls(const LexemeMap* lexs,
                                Environment env,
                                Symbols& syms,
@@ -225,7 +288,7 @@ struct uaiso::CompletionProposer::CompletionProposerImpl
         auto ident = builtin_->basicTypeDeclName(const_cast<LexemeMap*>(lexs), kind);
         if (!ident)
             return syms;
-        return typeDecls(env, syms, ident);
+        return typeDecls(env, syms, ident, 0);
     }
 
     Symbols& addRootRecordDecls(const LexemeMap* lexs,
@@ -234,7 +297,7 @@ struct uaiso::CompletionProposer::CompletionProposerImpl
     {
         auto ident = builtin_->rootTypeDeclName(const_cast<LexemeMap*>(lexs));
         UAISO_ASSERT(ident, return syms);
-        return typeDecls(env, syms, ident);
+        return typeDecls(env, syms, ident, 1);
     }
 
     //! Language-specific details.
@@ -245,6 +308,15 @@ struct uaiso::CompletionProposer::CompletionProposerImpl
 
     //! Type resolver.
     TypeResolver resolver_;
+
+    //! What's typed of the name being completed.
+    std::string prefix_;
+
+    //! Maximum number of ranked proposals, zero when not ranking.
+    size_t maxProposals_ { 0 };
+
+    //! Ranking of proposals.
+    CompletionRanker ranker_;
 };
 
 CompletionProposer::CompletionProposer(Factory *factory)
@@ -254,14 +326,39 @@ CompletionProposer::CompletionProposer(Factory *factory)
 CompletionProposer::~CompletionProposer()
 {}
 
+void CompletionProposer::setMaxProposals(size_t max)
+{
+    P->maxProposals_ = max;
+}
+
+void CompletionProposer::noteAccepted(const Symbol* sym)
+{
+    UAISO_ASSERT(sym, return);
+
+    const Ident* name = nullptr;
+    if (isDecl(sym))
+        name = ConstDeclSymbol_Cast(sym)->name();
+    else if (sym->kind() == Symbol::Kind::Namespace)
+        name = ConstNamespace_Cast(sym)->name();
+    if (name)
+        P->ranker_.noteUse(name->spelling());
+}
+
+void CompletionProposer::setResolutionCache(TypeResolutionCache* cache)
+{
+    P->resolver_.setResolutionCache(cache);
+}
+
 CompletionProposer::Result
-CompletionProposer::propose(ProgramAst* progAst, const LexemeMap* lexs)
+CompletionProposer::propose(ProgramAst* progAst,
+                            const LexemeMap* lexs,
+                            const std::string& prefix)
 {
     UAISO_ASSERT(progAst->program_,
                  return Result(Symbols(), CompletionAstNotFound));
 
     CompletionContext context(P->lang_.get());
-    auto ok = context.analyse(progAst, lexs, progAst->program_->env());
+    auto ok = context.analyse(progAst, progAst->program_->env());
 
     if (!ok) {
         DEBUG_TRACE("completion AST node not found\n");
@@ -275,24 +372,25 @@ CompletionProposer::propose(ProgramAst* progAst, const LexemeMap* lexs)
 
     auto topAst = context.asts_.top();
     auto env = context.env_;
-
-    auto addExtraSyms = [](const auto& extraSyms,
-                           CompletionProposer::Symbols& syms) {
-        std::copy(extraSyms.begin(), extraSyms.end(), std::back_inserter(syms));
-        return syms;
-    };
+    P->prefix_ = prefix;
+    if (P->maxProposals_)
+        P->ranker_.start(prefix, P->maxProposals_);
 
     // When completing an identifier, simply list the environment.
     if (topAst->kind() == Ast::Kind::IdentExpr) {
         Symbols syms;
+        size_t distance = 0;
         while (true) {
-            addExtraSyms(env.listDecls(), syms);
-            addExtraSyms(env.listNamespaces(), syms);
+            P->addSymbols(env, syms,
+                          Environment::SymbolGroups(Environment::SymbolGroup::ValueDecls)
+                              | Environment::SymbolGroup::TypeDecls
+                              | Environment::SymbolGroup::Namespaces,
+                          distance++);
             if (env.isRootEnv())
                 break;
             env = env.outerEnv();
         }
-        return Result(syms, Success);
+        return P->succeed(syms);
     }
 
     // Completing on a member access requires identifying the type or namespace.
@@ -353,19 +451,19 @@ CompletionProposer::propose(ProgramAst* progAst, const LexemeMap* lexs)
                 Symbols syms;
                 P->addRootRecordDecls(lexs, env, syms);
                 P->addBasicTypeDecls(lexs, env, syms, ty->kind());
-                return Result(syms, Success);
+                return P->succeed(syms);
             }
         }
 
         // If completing a namespace, there will be no type.
         if (!ty) {
             Symbols syms;
-            return Result(addExtraSyms(env.listDecls(), syms), Success);
+            return P->succeed(P->addDecls(env, syms, 0));
         }
 
         // Look into base classes.
         Symbols syms;
-        addExtraSyms(env.listDecls(), syms);
+        P->addDecls(env, syms, 0);
         std::stack<const Type*> allTy;
         allTy.push(ty);
         while (!allTy.empty()) {
@@ -386,7 +484,7 @@ CompletionProposer::propose(ProgramAst* progAst, const LexemeMap* lexs)
                 std::tie(baseHasEnv, baseEnv) = envForType(baseTySym->type(), baseEnv);
                 if (baseHasEnv) {
                     allTy.push(baseTySym->type());
-                    addExtraSyms(baseEnv.listDecls(), syms);
+                    P->addDecls(baseEnv, syms, 1);
                 }
             }
         }
@@ -394,7 +492,7 @@ CompletionProposer::propose(ProgramAst* progAst, const LexemeMap* lexs)
         if (P->lang_->isPurelyOO())
             P->addRootRecordDecls(lexs, env, syms);
 
-        return Result(syms, Success);
+        return P->succeed(syms);
     }
 
     DEBUG_TRACE("completion case not yet implemented\n");
@@ -30,6 +30,8 @@
 #include "Common/Test.h"
 #include "Semantic/Snapshot.h"
 #include "Semantic/SymbolFwd.h"
+#include <cstddef>
+#include <string>
 #include <tuple>
 #include <vector>
 
@@ -37,6 +39,7 @@ namespace uaiso {
 
 class Factory;
 class LexemeMap;
+class TypeResolutionCache;
 
 /*!
  * \brief The CompletionProposer class
@@ -67,7 +70,51 @@ public:
     using Symbols = std::vector<const Symbol*>;
     using Result = std::tuple<Symbols, ResultCode>;
 
-    Result propose(ProgramAst* ast, const LexemeMap* lexs);
+    /*!
+     * \brief propose
+     * \param ast
+     * \param lexs
+     * \param prefix
+     * \return
+     *
+     * Propose the symbols which complete the name at the completion point of
+     * \a ast, restricted to the ones whose name start with \a prefix (what
+     * has already been typed).
+     */
+    Result propose(ProgramAst* ast, const LexemeMap* lexs,
+                   const std::string& prefix = std::string());
+
+    /*!
+     * \brief setMaxProposals
+     * \param max
+     *
+     * Rank proposals and return at most \a max of them, the best first. The
+     * prefix is then matched fuzzily (as a subsequence of a name), instead
+     * of literally. Zero (the default) disables ranking.
+     *
+     * \sa CompletionRanker
+     */
+    void setMaxProposals(size_t max);
+
+    /*!
+     * \brief noteAccepted
+     * \param sym
+     *
+     * Note that proposal \a sym has been accepted, so that it ranks higher
+     * in upcoming completions.
+     */
+    void noteAccepted(const Symbol* sym);
+
+    /*!
+     * \brief setResolutionCache
+     * \param cache
+     *
+     * Memoize the resolution of elaborate types met along member accesses
+     * in \a cache (e.g., the one of a snapshot version).
+     *
+     * \sa TypeResolver::setResolutionCache
+     */
+    void setResolutionCache(TypeResolutionCache* cache);
 
 private:
     DECL_PIMPL(CompletionProposer)
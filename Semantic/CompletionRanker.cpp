@@ -0,0 +1,288 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#include "Semantic/CompletionRanker.h"
+#include "Semantic/Symbol.h"
+#include "Parsing/Lexeme.h"
+#include "Common/Assert.h"
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+using namespace uaiso;
+
+namespace {
+
+// Score adjustments, in the scale of matchScore.
+const int kDistancePenalty = 2;      // Per scope away from completion point.
+const int kRecentBonus = 8;          // For a name just accepted.
+const uint64_t kRecentWindow = 32;   // Uses after which the bonus is gone.
+
+/*!
+ * \brief charMask
+ *
+ * Return a bit mask of the characters (case insensitive) in \a s, so that
+ * names lacking some character of the pattern are rejected at once.
+ */
+uint64_t charMask(const std::string& s)
+{
+    struct MaskTable
+    {
+        MaskTable()
+        {
+            for (int c = 0; c < 256; ++c)
+                bits_[c] = uint64_t(1) << 37;
+            for (int c = 'a'; c <= 'z'; ++c) {
+                bits_[c] = uint64_t(1) << (c - 'a');
+                bits_[c - 'a' + 'A'] = bits_[c];
+            }
+            for (int c = '0'; c <= '9'; ++c)
+                bits_[c] = uint64_t(1) << (26 + c - '0');
+            bits_['_'] = uint64_t(1) << 36;
+        }
+        uint64_t bits_[256];
+    };
+    static const MaskTable table;
+
+    uint64_t mask = 0;
+    for (unsigned char c : s)
+        mask |= table.bits_[c];
+    return mask;
+}
+
+// Identifiers are ASCII, the cctype functions would only cost a call
+// (and a locale lookup) per character.
+inline bool isLower(unsigned char c) { return c >= 'a' && c <= 'z'; }
+inline bool isUpper(unsigned char c) { return c >= 'A' && c <= 'Z'; }
+inline bool isDigit(unsigned char c) { return c >= '0' && c <= '9'; }
+inline unsigned char toLower(unsigned char c) { return isUpper(c) ? c - 'A' + 'a' : c; }
+
+bool isWordStart(const std::string& name, size_t pos)
+{
+    if (pos == 0)
+        return true;
+    const unsigned char prev = name[pos - 1], cur = name[pos];
+    return (prev == '_' && cur != '_')
+            || (isLower(prev) && isUpper(cur))
+            || (!isDigit(prev) && isDigit(cur));
+}
+
+int scoreMatch(const std::string& pattern, const std::string& name,
+               bool preferWordStarts)
+{
+    int score = 0;
+    size_t pos = 0, prevPos = 0, firstPos = 0;
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        const unsigned char c = pattern[i];
+        const unsigned char lower = toLower(c);
+
+        // Prefer the occurrence at the start of a word, if there's one
+        // ahead, otherwise take the first one.
+        size_t found = name.size();
+        for (size_t j = pos; j < name.size(); ++j) {
+            if (toLower(name[j]) != lower)
+                continue;
+            if (found == name.size())
+                found = j;
+            if (!preferWordStarts || j == pos || isWordStart(name, j)) {
+                found = j;
+                break;
+            }
+        }
+        if (found == name.size())
+            return -1;
+
+        score += 1;
+        if (static_cast<unsigned char>(name[found]) == c)
+            score += 1;
+        if (found == 0)
+            score += 4;
+        else if (isWordStart(name, found))
+            score += 3;
+        if (i > 0 && found == prevPos + 1)
+            score += 2;
+        if (i == 0)
+            firstPos = found;
+        prevPos = found;
+        pos = found + 1;
+    }
+    score -= static_cast<int>(std::min<size_t>(firstPos, 3));
+    if (pattern.size() == name.size())
+        score += 5;
+
+    return std::max(score, 0);
+}
+
+int kindBonus(const Symbol* sym)
+{
+    switch (sym->kind()) {
+    case Symbol::Kind::Var:
+    case Symbol::Kind::Param:
+        return 3;
+    case Symbol::Kind::Func:
+        return 2;
+    case Symbol::Kind::Namespace:
+        return 0;
+    default:
+        return 1;
+    }
+}
+
+const std::string& nameOf(const Symbol* sym)
+{
+    static const std::string empty;
+    const Ident* name = nullptr;
+    if (isDecl(sym))
+        name = ConstDeclSymbol_Cast(sym)->name();
+    else if (sym->kind() == Symbol::Kind::Namespace)
+        name = ConstNamespace_Cast(sym)->name();
+    return name ? name->spelling() : empty;
+}
+
+struct Candidate
+{
+    int score_;
+    const std::string* name_;
+    const Symbol* sym_;
+};
+
+// Whether candidate a ranks before b. In a heap, the worst is on top.
+bool ranksBefore(const Candidate& a, const Candidate& b)
+{
+    if (a.score_ != b.score_)
+        return a.score_ > b.score_;
+    if (a.name_->size() != b.name_->size())
+        return a.name_->size() < b.name_->size();
+    return *a.name_ < *b.name_;
+}
+
+} // anonymous
+
+struct uaiso::CompletionRanker::CompletionRankerImpl
+{
+    std::string pattern_;
+    uint64_t patternMask_ { 0 };
+    size_t maxResults_ { 0 };
+    std::vector<Candidate> heap_;
+
+    uint64_t useClock_ { 0 };
+    std::unordered_map<std::string, uint64_t> lastUse_;
+
+    int recentBonus(const std::string& name) const
+    {
+        if (lastUse_.empty())
+            return 0;
+        auto it = lastUse_.find(name);
+        if (it == lastUse_.end())
+            return 0;
+        const uint64_t age = useClock_ - it->second;
+        if (age >= kRecentWindow)
+            return 0;
+        return 1 + static_cast<int>(kRecentBonus * (kRecentWindow - age) / kRecentWindow);
+    }
+};
+
+CompletionRanker::CompletionRanker()
+    : P(new CompletionRankerImpl)
+{}
+
+CompletionRanker::~CompletionRanker()
+{}
+
+void CompletionRanker::start(const std::string& pattern, size_t maxResults)
+{
+    P->pattern_ = pattern;
+    P->patternMask_ = charMask(pattern);
+    P->maxResults_ = maxResults;
+    P->heap_.clear();
+    P->heap_.reserve(maxResults + 1);
+}
+
+void CompletionRanker::consider(const Symbol* sym, size_t scopeDistance)
+{
+    UAISO_ASSERT(sym, return);
+
+    if (!P->maxResults_)
+        return;
+
+    const std::string& name = nameOf(sym);
+    if (P->patternMask_ & ~charMask(name))
+        return;
+    int score = matchScore(P->pattern_, name);
+    if (score < 0)
+        return;
+    score += kindBonus(sym) + P->recentBonus(name)
+            - kDistancePenalty * static_cast<int>(scopeDistance);
+
+    Candidate cand { score, &name, sym };
+    if (P->heap_.size() == P->maxResults_) {
+        if (!ranksBefore(cand, P->heap_.front()))
+            return;
+        std::pop_heap(P->heap_.begin(), P->heap_.end(), ranksBefore);
+        P->heap_.back() = cand;
+    } else {
+        P->heap_.push_back(cand);
+    }
+    std::push_heap(P->heap_.begin(), P->heap_.end(), ranksBefore);
+}
+
+std::vector<const Symbol*> CompletionRanker::finish()
+{
+    std::sort_heap(P->heap_.begin(), P->heap_.end(), ranksBefore);
+    std::vector<const Symbol*> syms;
+    syms.reserve(P->heap_.size());
+    for (const auto& cand : P->heap_)
+        syms.push_back(cand.sym_);
+    P->heap_.clear();
+    return syms;
+}
+
+void CompletionRanker::noteUse(const std::string& name)
+{
+    P->lastUse_[name] = ++P->useClock_;
+
+    // Forget the names whose bonus is gone, so the map doesn't grow.
+    if (P->lastUse_.size() > 4 * kRecentWindow) {
+        for (auto it = P->lastUse_.begin(); it != P->lastUse_.end();) {
+            if (P->useClock_ - it->second >= kRecentWindow)
+                it = P->lastUse_.erase(it);
+            else
+                ++it;
+        }
+    }
+}
+
+int CompletionRanker::matchScore(const std::string& pattern, const std::string& name)
+{
+    if (pattern.empty())
+        return 0;
+    if (pattern.size() > name.size())
+        return -1;
+
+    // Jumping to word starts may skip characters needed further on, plain
+    // subsequence matching is the fallback.
+    int score = scoreMatch(pattern, name, true);
+    if (score < 0)
+        score = scoreMatch(pattern, name, false);
+    return score;
+}
@@ -0,0 +1,111 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#ifndef UAISO_COMPLETIONRANKER_H__
+#define UAISO_COMPLETIONRANKER_H__
+
+#include "Common/Config.h"
+#include "Common/Pimpl.h"
+#include "Common/Test.h"
+#include "Semantic/SymbolFwd.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace uaiso {
+
+/*!
+ * \brief The CompletionRanker class
+ *
+ * Rank completion proposals against what's been typed, and keep only the
+ * best ones. A name matches the typed pattern if the pattern's characters
+ * appear in it, in order and regardless of case. Its score favors matches
+ * at the beginning of words and in runs, and is adjusted by the distance
+ * of the symbol's scope from the completion point, by the kind of symbol,
+ * and by how recently a symbol of that name was accepted.
+ */
+class UAISO_API CompletionRanker final
+{
+public:
+    CompletionRanker();
+    ~CompletionRanker();
+
+    CompletionRanker(const CompletionRanker&) = delete;
+    CompletionRanker& operator=(const CompletionRanker&) = delete;
+
+    /*!
+     * \brief start
+     * \param pattern
+     * \param maxResults
+     *
+     * Start a ranking of at most \a maxResults symbols, matched against
+     * \a pattern. Symbols considered before are discarded.
+     */
+    void start(const std::string& pattern, size_t maxResults);
+
+    /*!
+     * \brief consider
+     * \param sym
+     * \param scopeDistance
+     *
+     * Consider symbol \a sym, found \a scopeDistance scopes away from the
+     * completion point, as a proposal. Only the best ones are kept.
+     */
+    void consider(const Symbol* sym, size_t scopeDistance);
+
+    /*!
+     * \brief finish
+     * \return
+     *
+     * Return the best symbols of the ranking, the best first.
+     */
+    std::vector<const Symbol*> finish();
+
+    /*!
+     * \brief noteUse
+     * \param name
+     *
+     * Note that a symbol named \a name has been accepted as a completion,
+     * so that symbols of that name are preferred for a while.
+     */
+    void noteUse(const std::string& name);
+
+    /*!
+     * \brief matchScore
+     * \param pattern
+     * \param name
+     * \return
+     *
+     * Return how well \a name matches \a pattern, or a negative number if
+     * it doesn't match at all.
+     */
+    static int matchScore(const std::string& pattern, const std::string& name);
+
+private:
+    DECL_PIMPL(CompletionRanker)
+    DECL_CLASS_TEST(CompletionRanker)
+};
+
+} // namespace uaiso
+
+#endif
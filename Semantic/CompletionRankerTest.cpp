@@ -0,0 +1,148 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#include "Semantic/CompletionRanker.h"
+#include "Semantic/Symbol.h"
+#include "Parsing/Lexeme.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace uaiso;
+
+class CompletionRanker::CompletionRankerTest final : public Test
+{
+public:
+    TEST_RUN(CompletionRankerTest
+             , &CompletionRankerTest::testCase1
+             , &CompletionRankerTest::testCase2
+             , &CompletionRankerTest::testCase3
+             , &CompletionRankerTest::testCase4
+             , &CompletionRankerTest::testCase5
+             )
+
+    const Ident* ident(const std::string& s)
+    {
+        idents_.emplace_back(new Ident(s));
+        return idents_.back().get();
+    }
+
+    template <class SymbolT>
+    const Symbol* symbol(const std::string& s)
+    {
+        syms_.emplace_back(new SymbolT(ident(s)));
+        return syms_.back().get();
+    }
+
+    std::string nameAt(const std::vector<const Symbol*>& syms, size_t idx)
+    {
+        return ConstDeclSymbol_Cast(syms[idx])->name()->spelling();
+    }
+
+    void testCase1()
+    {
+        // Matching.
+        UAISO_EXPECT_INT_EQ(0, matchScore("", "foo"));
+        UAISO_EXPECT_TRUE(matchScore("fb", "foo_bar") >= 0);
+        UAISO_EXPECT_TRUE(matchScore("FB", "fooBar") >= 0);
+        UAISO_EXPECT_TRUE(matchScore("ax", "bax_ab") >= 0);
+        UAISO_EXPECT_TRUE(matchScore("bf", "foo_bar") < 0);
+        UAISO_EXPECT_TRUE(matchScore("xyz", "abc") < 0);
+        UAISO_EXPECT_TRUE(matchScore("food", "foo") < 0);
+    }
+
+    void testCase2()
+    {
+        // Scoring: word starts, runs, exact matches.
+        UAISO_EXPECT_TRUE(matchScore("fb", "foo_bar") > matchScore("fb", "fabric"));
+        UAISO_EXPECT_TRUE(matchScore("fb", "fooBar") > matchScore("fb", "fabric"));
+        UAISO_EXPECT_TRUE(matchScore("fo", "foo") > matchScore("fo", "fxo"));
+        UAISO_EXPECT_TRUE(matchScore("show", "show") > matchScore("show", "shows"));
+        UAISO_EXPECT_TRUE(matchScore("bar", "bar") > matchScore("bar", "xbar"));
+    }
+
+    void testCase3()
+    {
+        // Only the best ones are kept, the best first.
+        CompletionRanker ranker;
+        ranker.start("v1", 3);
+        for (int i = 0; i < 30; ++i)
+            ranker.consider(symbol<Var>("v" + std::to_string(i)), 0);
+        ranker.consider(symbol<Var>("other"), 0);
+        auto syms = ranker.finish();
+        UAISO_EXPECT_INT_EQ(3, syms.size());
+        UAISO_EXPECT_STR_EQ("v1", nameAt(syms, 0));
+        UAISO_EXPECT_STR_EQ("v10", nameAt(syms, 1));
+        UAISO_EXPECT_STR_EQ("v11", nameAt(syms, 2));
+
+        ranker.start("v1", 0);
+        ranker.consider(symbol<Var>("v1"), 0);
+        UAISO_EXPECT_TRUE(ranker.finish().empty());
+    }
+
+    void testCase4()
+    {
+        // Scope distance and kind of symbol.
+        CompletionRanker ranker;
+        ranker.start("item", 10);
+        ranker.consider(symbol<Var>("items"), 0);
+        ranker.consider(symbol<Var>("item"), 4);
+        auto syms = ranker.finish();
+        UAISO_EXPECT_INT_EQ(2, syms.size());
+        UAISO_EXPECT_STR_EQ("items", nameAt(syms, 0));
+
+        ranker.start("data", 10);
+        ranker.consider(symbol<Record>("data"), 0);
+        ranker.consider(symbol<Var>("data"), 0);
+        syms = ranker.finish();
+        UAISO_EXPECT_INT_EQ(2, syms.size());
+        UAISO_EXPECT_TRUE(syms[0]->kind() == Symbol::Kind::Var);
+    }
+
+    void testCase5()
+    {
+        // Recently used names rank higher.
+        CompletionRanker ranker;
+        auto apple = symbol<Var>("apple");
+        auto apricot = symbol<Var>("apricot");
+        ranker.start("ap", 10);
+        ranker.consider(apricot, 0);
+        ranker.consider(apple, 0);
+        auto syms = ranker.finish();
+        UAISO_EXPECT_INT_EQ(2, syms.size());
+        UAISO_EXPECT_PTR_EQ(apple, syms[0]);
+
+        ranker.noteUse("apricot");
+        ranker.start("ap", 10);
+        ranker.consider(apple, 0);
+        ranker.consider(apricot, 0);
+        syms = ranker.finish();
+        UAISO_EXPECT_INT_EQ(2, syms.size());
+        UAISO_EXPECT_PTR_EQ(apricot, syms[0]);
+    }
+
+    std::vector<std::unique_ptr<Ident>> idents_;
+    std::vector<std::unique_ptr<const Symbol>> syms_;
+};
+
+MAKE_CLASS_TEST(CompletionRanker)
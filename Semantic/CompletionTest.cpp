@@ -62,7 +62,12 @@ CompletionProposer::CompletionProposerTest::runCore(
         flags |= Manager::BehaviourFlag::IgnoreBuiltins;
     if (disableAutoModules_)
         flags |= Manager::BehaviourFlag::IgnoreAutomaticModules;
+    if (lazyBodies_)
+        flags |= Manager::BehaviourFlag::BindBodiesLazily;
     manager.setBehaviour(flags);
+    // More workers than files in most cases, dependencies are processed
+    // concurrently nonetheless.
+    manager.setWorkerCount(4);
     for (const auto& path : searchPaths)
         manager.addSearchPath(path);
 
@@ -76,17 +81,22 @@ CompletionProposer::CompletionProposerTest::runCore(
         std::cout << oss.str();
     }
 
-    Program* prog = snapshot.find(fullFileName);
+    const Program* prog = snapshot.find(fullFileName);
     UAISO_EXPECT_TRUE(prog);
     UAISO_EXPECT_FALSE(prog->env().isEmpty());
 
-    TypeChecker checker(factory.get());
-    checker.setLexemes(&lexs);
-    checker.setTokens(&tokens);
-    checker.check(progAst);
+    // The checker would bind every body, leaving nothing for the proposer.
+    Snapshot::Version version = snapshot.pin();
+    if (!lazyBodies_) {
+        TypeChecker checker(factory.get());
+        manager.setUp(&checker, version);
+        checker.check(progAst);
+    }
 
     CompletionProposer completer(factory.get());
-    auto syms = std::get<0>(completer.propose(progAst, &lexs));
+    completer.setMaxProposals(maxProposals_);
+    manager.setUp(&completer, version);
+    auto syms = std::get<0>(completer.propose(progAst, &lexs, prefix_));
     if (dumpCompletions_) {
         std::ostringstream oss;
         oss << "Produced completions\n";
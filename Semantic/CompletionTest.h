@@ -26,6 +26,7 @@
 
 #include "Common/LineCol.h"
 #include "Semantic/CompletionProposer.h"
+#include <string>
 
 namespace uaiso {
 
@@ -124,6 +125,8 @@ public:
              , &CompletionProposerTest::PyTestCase47
              , &CompletionProposerTest::PyTestCase48
              , &CompletionProposerTest::PyTestCase49
+             , &CompletionProposerTest::PyTestCase50
+             , &CompletionProposerTest::PyTestCase51
              )
 
     //--- D ---//
@@ -219,6 +222,8 @@ public:
     void PyTestCase47();
     void PyTestCase48();
     void PyTestCase49();
+    void PyTestCase50();
+    void PyTestCase51();
 
     std::unique_ptr<Unit> runCore(std::unique_ptr<Factory> factory,
                                   const std::string& code,
@@ -232,6 +237,9 @@ public:
         disableAutoModules_ = true;
         dumpAst_ = false;
         dumpCompletions_ = false;
+        lazyBodies_ = false;
+        prefix_.clear();
+        maxProposals_ = 0;
     }
 
     LineCol lineCol_;
@@ -239,6 +247,9 @@ public:
     bool disableAutoModules_ { true };
     bool dumpAst_ { false };
     bool dumpCompletions_ { false };
+    bool lazyBodies_ { false };
+    std::string prefix_;
+    size_t maxProposals_ { 0 };
 };
 
 } // namespace uaiso
@@ -28,121 +28,551 @@
 #include "Ast/Ast.h"
 #include "Common/Assert.h"
 #include "Parsing/Lexeme.h"
-#include "Parsing/LexemeMap.h"
 #include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace uaiso;
 
 namespace {
 
-template <class SymbolT>
-struct SymbolTable
+enum class Group : char
 {
-    using HashTable =
-        std::unordered_multimap<const Ident*,
-                                std::unique_ptr<const SymbolT>>;
+    Type,
+    Value,
+    Namespace
+};
+
+template <class SymbolT> struct GroupOf;
+template <> struct GroupOf<TypeDecl> { static const Group value = Group::Type; };
+template <> struct GroupOf<ValueDecl> { static const Group value = Group::Value; };
+template <> struct GroupOf<Namespace> { static const Group value = Group::Namespace; };
+
+const std::string& spellingOf(const Ident* name)
+{
+    static const std::string empty;
+    return name ? name->spelling() : empty;
+}
+
+bool hasPrefix(const Ident* name, const std::string& prefix)
+{
+    return spellingOf(name).compare(0, prefix.size(), prefix) == 0;
+}
+
+const Ident* nameOf(const Symbol* sym, Group group)
+{
+    if (group == Group::Namespace)
+        return static_cast<const Namespace*>(sym)->name();
+    return static_cast<const Decl*>(sym)->name();
+}
+
+} // anonymous
+
+/*!
+ * \brief The Environment::SymbolTable struct
+ *
+ * The types, values, and namespaces of a single scope, in one flat table
+ * keyed by the (interned) identifier. Entries are kept in insertion order,
+ * the first kInlineCap of them inline and the remaining ones in an overflow
+ * vector. Small scopes are searched linearly; once a scope outgrows the
+ * inline storage, an open addressing index (with linear probing) maps each
+ * name to its first entry. Entries with the same name, of any group, are
+ * chained through their next_ index. For enumeration by name prefix, large
+ * scopes also get an index of the entries sorted by name, built on demand.
+ */
+struct uaiso::Environment::SymbolTable
+{
+    static const uint32_t kNone = UINT32_MAX;
+    static const uint32_t kInlineCap = 8;
+
+    struct Entry
+    {
+        const Ident* name_ { nullptr };
+        std::unique_ptr<const Symbol> sym_;
+        uint32_t next_ { kNone };
+        Group group_ { Group::Type };
+    };
+
+    Entry& entry(uint32_t idx)
+    {
+        return idx < kInlineCap ? inline_[idx] : overflow_[idx - kInlineCap];
+    }
+
+    const Entry& entry(uint32_t idx) const
+    {
+        return idx < kInlineCap ? inline_[idx] : overflow_[idx - kInlineCap];
+    }
+
+    static size_t hash(const Ident* name)
+    {
+        return (reinterpret_cast<uintptr_t>(name) >> 3) * 0x9E3779B97F4A7C15ull >> 32;
+    }
+
+    /*!
+     * \brief head
+     *
+     * Return the index of the first entry named \a name, of any group.
+     */
+    uint32_t head(const Ident* name) const
+    {
+        if (slots_.empty()) {
+            for (uint32_t idx = 0; idx < size_; ++idx) {
+                if (entry(idx).name_ == name)
+                    return idx;
+            }
+            return kNone;
+        }
+
+        const size_t mask = slots_.size() - 1;
+        for (size_t slot = hash(name) & mask; slots_[slot] != kNone; slot = (slot + 1) & mask) {
+            if (entry(slots_[slot]).name_ == name)
+                return slots_[slot];
+        }
+        return kNone;
+    }
+
+    uint32_t firstOf(uint32_t idx, Group group) const
+    {
+        while (idx != kNone && entry(idx).group_ != group)
+            idx = entry(idx).next_;
+        return idx;
+    }
+
+    uint32_t first(const Ident* name, Group group) const
+    {
+        return firstOf(head(name), group);
+    }
+
+    uint32_t next(uint32_t idx) const
+    {
+        return firstOf(entry(idx).next_, entry(idx).group_);
+    }
 
-    using TableRange =
-        std::pair<typename HashTable::const_iterator,
-                  typename HashTable::const_iterator>;
+    const Symbol* find(const Ident* name, Group group) const
+    {
+        auto idx = first(name, group);
+        return idx == kNone ? nullptr : entry(idx).sym_.get();
+    }
 
-    const SymbolT* find(const Ident* ident) const
+    void insert(std::unique_ptr<const Symbol> sym, Group group)
     {
-        auto it = table_.find(ident);
-        if (it == table_.end())
-            return nullptr;
-        return it->second.get();
+        const Ident* name = nameOf(sym.get(), group);
+        auto last = head(name);
+        const uint32_t idx = size_++;
+        if (idx >= kInlineCap)
+            overflow_.emplace_back();
+        Entry& e = entry(idx);
+        e.name_ = name;
+        e.sym_ = std::move(sym);
+        e.group_ = group;
+        sortedValid_.store(false, std::memory_order_relaxed);
+
+        if (last != kNone) {
+            while (entry(last).next_ != kNone)
+                last = entry(last).next_;
+            entry(last).next_ = idx;
+        } else {
+            ++names_;
+        }
+
+        if (size_ <= kInlineCap)
+            return;
+        if (slots_.empty() || names_ * 2 > slots_.size())
+            reindex();
+        else if (last == kNone)
+            index(idx);
     }
 
-    void insert(std::unique_ptr<const SymbolT> symbol)
+    void index(uint32_t idx)
     {
-        table_.emplace(symbol->name(), std::move(symbol));
+        const size_t mask = slots_.size() - 1;
+        size_t slot = hash(entry(idx).name_) & mask;
+        while (slots_[slot] != kNone)
+            slot = (slot + 1) & mask;
+        slots_[slot] = idx;
     }
 
-    void takeOver(HashTable& hashTable)
+    void reindex()
     {
-        for (auto& p : hashTable)
-            table_.emplace(p.first, std::move(p.second));
-        hashTable.clear();
+        size_t cap = 2 * kInlineCap;
+        while (cap < names_ * 4)
+            cap *= 2;
+        slots_.assign(cap, kNone);
+        for (uint32_t idx = 0; idx < size_; ++idx) {
+            const Entry& e = entry(idx);
+            if (head(e.name_) == kNone)
+                index(idx);
+        }
+    }
+
+    void takeOver(SymbolTable& other)
+    {
+        for (uint32_t idx = 0; idx < other.size_; ++idx) {
+            Entry& e = other.entry(idx);
+            insert(std::move(e.sym_), e.group_);
+            e = Entry();
+        }
+        other.overflow_.clear();
+        other.slots_.clear();
+        other.size_ = 0;
+        other.names_ = 0;
+        other.sortedValid_.store(false, std::memory_order_relaxed);
+    }
+
+    bool isEmpty() const { return size_ == 0; }
+
+    const std::vector<uint32_t>& sortedNames() const
+    {
+        if (sortedValid_.load(std::memory_order_acquire))
+            return sorted_;
+
+        std::lock_guard<std::mutex> lock(sortedMutex_);
+        if (!sortedValid_.load(std::memory_order_relaxed)) {
+            sorted_.resize(size_);
+            for (uint32_t idx = 0; idx < size_; ++idx)
+                sorted_[idx] = idx;
+            std::stable_sort(sorted_.begin(), sorted_.end(),
+                             [this] (uint32_t a, uint32_t b) {
+                return spellingOf(entry(a).name_) < spellingOf(entry(b).name_);
+            });
+            sortedValid_.store(true, std::memory_order_release);
+        }
+        return sorted_;
     }
 
-    bool isEmpty() const { return table_.empty(); }
+    template <class VisitorT>
+    void visit(const std::string& prefix, uint8_t groups, VisitorT&& visitor) const
+    {
+        auto accept = [groups] (const Entry& e) {
+            return (groups & (1 << static_cast<int>(e.group_))) && !e.sym_->isFake();
+        };
+
+        if (size_ <= kInlineCap) {
+            for (uint32_t idx = 0; idx < size_; ++idx) {
+                const Entry& e = entry(idx);
+                if (accept(e) && hasPrefix(e.name_, prefix))
+                    visitor(e.sym_.get());
+            }
+            return;
+        }
+
+        const auto& sorted = sortedNames();
+        auto it = std::lower_bound(sorted.begin(), sorted.end(), prefix,
+                                   [this] (uint32_t idx, const std::string& prefix) {
+            return spellingOf(entry(idx).name_) < prefix;
+        });
+        for (; it != sorted.end() && hasPrefix(entry(*it).name_, prefix); ++it) {
+            if (accept(entry(*it)))
+                visitor(entry(*it).sym_.get());
+        }
+    }
 
-    HashTable table_;
+    Entry inline_[kInlineCap];
+    std::vector<Entry> overflow_;
+    std::vector<uint32_t> slots_;
+    uint32_t size_ { 0 };
+    uint32_t names_ { 0 };
+    mutable std::vector<uint32_t> sorted_;
+    mutable std::atomic<bool> sortedValid_ { false };
+    mutable std::mutex sortedMutex_; // Serializes (rare) building of sorted_.
 };
 
-} // anonymous
+const uint32_t Environment::SymbolTable::kNone;
+const uint32_t Environment::SymbolTable::kInlineCap;
 
 struct uaiso::Environment::EnvironmentImpl
 {
 public:
+    /*!
+     * \brief The MergedIndex struct
+     *
+     * The symbols reachable through the merged environments, combined into
+     * a single table, so that a name not found in the environment itself is
+     * looked up with one probe, instead of one per merged environment. An
+     * index is built lazily and tagged with the versions of the environments
+     * it was built from (frozen ones aside, they don't change).
+     */
+    struct MergedIndex
+    {
+        struct Hit
+        {
+            const Symbol* syms_[3] { nullptr, nullptr, nullptr };
+            const Symbol* decl_ { nullptr };
+            const SymbolTable* declTable_ { nullptr };
+            Group declGroup_ { Group::Type };
+        };
+
+        bool isStale() const
+        {
+            for (const auto& built : versions_) {
+                if (built.first->version_.load(std::memory_order_acquire) != built.second)
+                    return true;
+            }
+            return false;
+        }
+
+        std::vector<std::pair<const EnvironmentImpl*, uint64_t>> versions_;
+        std::unordered_map<const Ident*, Hit> hits_;
+        std::vector<const Symbol*> listed_[3];
+    };
+
+    using Seen = std::unordered_set<const EnvironmentImpl*>;
+
+    // Fewer merged environments than this are searched one by one.
+    static const size_t kMinIndexedEnvs = 8;
+
     bool isEmpty() const
     {
-        return types_.isEmpty()
-                && values_.isEmpty()
-                && namespaces_.isEmpty()
+        return table_.isEmpty()
                 && mergedEnvs_.empty()
                 && (!outer_ || outer_->isEmpty());
     }
 
-    template <class SymbolT>
-    const SymbolT*
-    recursivelySearch(const Ident* name,
-                      SymbolTable<SymbolT> EnvironmentImpl::* symTable) const
+    const Symbol* recursivelySearch(const Ident* name, Group group) const
     {
-        auto sym = (this->*symTable).find(name);
-        if (!sym) {
-            for (auto env : mergedEnvs_) {
-                sym = env.P->recursivelySearch(name, symTable);
-                if (sym)
-                    break;
+        auto sym = table_.find(name, group);
+        if (!sym && !mergedEnvs_.empty()) {
+            if (mergedEnvs_.size() >= kMinIndexedEnvs) {
+                auto index = mergedIndex();
+                auto it = index->hits_.find(name);
+                if (it != index->hits_.end())
+                    sym = it->second.syms_[static_cast<int>(group)];
+            } else {
+                for (auto env : mergedEnvs_) {
+                    sym = env.P->recursivelySearch(name, group);
+                    if (sym)
+                        break;
+                }
             }
         }
         if (!sym && outer_)
-            return outer_->recursivelySearch(name, symTable);
+            return outer_->recursivelySearch(name, group);
 
         return sym;
     }
 
     template <class SymbolT>
-    typename SymbolTable<SymbolT>::TableRange
-    recursivelySearchMultiple(const Ident* name,
-                              SymbolTable<SymbolT> EnvironmentImpl::* symTable) const
+    const SymbolT* recursivelySearch(const Ident* name) const
+    {
+        return static_cast<const SymbolT*>(
+                    recursivelySearch(name, GroupOf<SymbolT>::value));
+    }
+
+    const Decl* recursivelySearchDecl(const Ident* name) const
+    {
+        auto idx = table_.head(name);
+        auto val = table_.firstOf(idx, Group::Value);
+        if (val != SymbolTable::kNone)
+            return static_cast<const Decl*>(table_.entry(val).sym_.get());
+        auto ty = table_.firstOf(idx, Group::Type);
+        if (ty != SymbolTable::kNone)
+            return static_cast<const Decl*>(table_.entry(ty).sym_.get());
+
+        if (mergedEnvs_.size() >= kMinIndexedEnvs) {
+            auto index = mergedIndex();
+            auto it = index->hits_.find(name);
+            if (it != index->hits_.end() && it->second.decl_)
+                return static_cast<const Decl*>(it->second.decl_);
+        } else {
+            for (auto env : mergedEnvs_) {
+                if (auto sym = env.P->recursivelySearchDecl(name))
+                    return sym;
+            }
+        }
+        if (outer_)
+            return outer_->recursivelySearchDecl(name);
+
+        return nullptr;
+    }
+
+    template <class SymbolT>
+    Range<SymbolT> recursivelySearchMultiple(const Ident* name) const
     {
-        auto range = (this->*symTable).table_.equal_range(name);
-        if (range.first == range.second && outer_)
-            return outer_->recursivelySearchMultiple(name, symTable);
-        return range;
+        auto idx = table_.first(name, GroupOf<SymbolT>::value);
+        if (idx == SymbolTable::kNone && outer_)
+            return outer_->recursivelySearchMultiple<SymbolT>(name);
+        return std::make_pair(Iterator<SymbolT>(&table_, idx),
+                              Iterator<SymbolT>(&table_, SymbolTable::kNone));
     }
 
     template <class SymbolT>
-    std::vector<const SymbolT*>
-    list(SymbolTable<SymbolT> EnvironmentImpl::* symTable) const
+    std::vector<const SymbolT*> list(bool withMerged = true) const
     {
+        const Group group = GroupOf<SymbolT>::value;
         std::vector<const SymbolT*> syms;
-        for (auto& sym : (this->*symTable).table_) {
-            if (!sym.second->isFake())
-                syms.push_back(sym.second.get());
+        for (uint32_t idx = 0; idx < table_.size_; ++idx) {
+            const auto& e = table_.entry(idx);
+            if (e.group_ == group && !e.sym_->isFake())
+                syms.push_back(static_cast<const SymbolT*>(e.sym_.get()));
         }
 
-        for (auto env : mergedEnvs_) {
-            auto other = env.P->list(symTable);
-            std::copy(other.begin(), other.end(), std::back_inserter(syms));
+        if (!withMerged)
+            return syms;
+
+        if (mergedEnvs_.size() >= kMinIndexedEnvs) {
+            auto index = mergedIndex();
+            for (auto sym : index->listed_[static_cast<int>(group)])
+                syms.push_back(static_cast<const SymbolT*>(sym));
+        } else {
+            for (auto env : mergedEnvs_) {
+                auto other = env.P->list<SymbolT>();
+                std::copy(other.begin(), other.end(), std::back_inserter(syms));
+            }
         }
 
         return syms;
     }
 
+    /*!
+     * \brief visit
+     *
+     * Visit the symbols this environment lists, once per environment (the
+     * same one may be merged along several paths, or in a cycle).
+     */
+    template <class VisitorT>
+    void visit(const std::string& prefix, uint8_t groups, VisitorT&& visitor,
+               Seen& seen) const
+    {
+        if (!seen.insert(this).second)
+            return;
+
+        table_.visit(prefix, groups, visitor);
+        for (auto env : mergedEnvs_)
+            env.P->visit(prefix, groups, visitor, seen);
+    }
+
+    /*!
+     * \brief mergedIndex
+     *
+     * Return the index of the merged environments, (re)building it if there
+     * is none or if it's stale.
+     */
+    std::shared_ptr<const MergedIndex> mergedIndex() const
+    {
+        auto index = std::atomic_load(&index_);
+        if (index && !index->isStale())
+            return index;
+
+        std::lock_guard<std::mutex> lock(indexMutex_);
+        index = std::atomic_load(&index_);
+        if (index && !index->isStale())
+            return index;
+
+        auto built = std::make_shared<MergedIndex>();
+        Seen seen;
+        for (auto env : mergedEnvs_)
+            env.P->collectReachable(*built, seen);
+        seen.clear();
+        for (auto env : mergedEnvs_)
+            env.P->collectListed(*built, seen);
+        std::atomic_store(&index_, std::shared_ptr<const MergedIndex>(built));
+        return built;
+    }
+
+    /*!
+     * \brief collectReachable
+     *
+     * Add to \a index the symbols reachable from this environment, in the
+     * order they'd be found by a search, keeping the first one of each name.
+     */
+    void collectReachable(MergedIndex& index, Seen& seen) const
+    {
+        if (!seen.insert(this).second)
+            return;
+
+        if (!frozen_)
+            index.versions_.emplace_back(this, version_.load(std::memory_order_acquire));
+
+        for (uint32_t idx = 0; idx < table_.size_; ++idx) {
+            const auto& e = table_.entry(idx);
+            auto& hit = index.hits_[e.name_];
+            if (!hit.syms_[static_cast<int>(e.group_)])
+                hit.syms_[static_cast<int>(e.group_)] = e.sym_.get();
+            if (e.group_ == Group::Namespace)
+                continue;
+            // Within a single environment, a value takes precedence.
+            if (!hit.decl_
+                    || (hit.declTable_ == &table_
+                        && hit.declGroup_ == Group::Type
+                        && e.group_ == Group::Value)) {
+                hit.decl_ = e.sym_.get();
+                hit.declTable_ = &table_;
+                hit.declGroup_ = e.group_;
+            }
+        }
+
+        for (auto env : mergedEnvs_)
+            env.P->collectReachable(index, seen);
+        if (outer_)
+            outer_->collectReachable(index, seen);
+    }
+
+    /*!
+     * \brief collectListed
+     *
+     * Add to \a index the symbols this environment lists.
+     */
+    void collectListed(MergedIndex& index, Seen& seen) const
+    {
+        if (!seen.insert(this).second)
+            return;
+
+        for (uint32_t idx = 0; idx < table_.size_; ++idx) {
+            const auto& e = table_.entry(idx);
+            if (!e.sym_->isFake())
+                index.listed_[static_cast<int>(e.group_)].push_back(e.sym_.get());
+        }
+
+        for (auto env : mergedEnvs_)
+            env.P->collectListed(index, seen);
+    }
+
+    /*!
+     * \brief changed
+     *
+     * Account for a change in the environment's symbols (or in the ones
+     * reachable from it). Only the thread owning an environment which isn't
+     * frozen changes it, so there's no need for an atomic increment.
+     */
+    void changed()
+    {
+        version_.store(version_.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_release);
+    }
+
+    void addMergedEnv(Environment env)
+    {
+        mergedEnvs_.push_back(env);
+        std::atomic_store(&index_, std::shared_ptr<const MergedIndex>());
+        changed();
+    }
+
     std::shared_ptr<EnvironmentImpl> outer_;
     std::vector<Environment> nested_;
-    SymbolTable<TypeDecl> types_;
-    SymbolTable<ValueDecl> values_;
-    SymbolTable<Namespace> namespaces_;
+    SymbolTable table_;
     std::vector<Environment> mergedEnvs_;
+    mutable std::shared_ptr<const MergedIndex> index_;
+    mutable std::mutex indexMutex_; // Serializes (rare) building of index_.
+    std::atomic<uint64_t> version_ { 0 };
     std::vector<std::unique_ptr<const Import>> imports_;
+    bool frozen_ { false };
 };
 
+const size_t Environment::EnvironmentImpl::kMinIndexedEnvs;
+
+uint32_t Environment::nextSameName(const SymbolTable* table, uint32_t idx)
+{
+    return table->next(idx);
+}
+
+const Symbol* Environment::symbolAt(const SymbolTable* table, uint32_t idx)
+{
+    return table->entry(idx).sym_.get();
+}
+
 Environment::Environment()
     : P(new EnvironmentImpl)
 {}
@@ -177,45 +607,49 @@ const Decl* Environment::searchDecl(const Ident* name) const
 {
     UAISO_ASSERT(name, return nullptr);
 
-    const Decl* sym = P->recursivelySearch<ValueDecl>(name, &EnvironmentImpl::values_);
-    if (!sym)
-        sym = P->recursivelySearch<TypeDecl>(name, &EnvironmentImpl::types_);
-    return sym;
+    return P->recursivelySearchDecl(name);
 }
 
 const TypeDecl* Environment::searchTypeDecl(const Ident* name) const
 {
     UAISO_ASSERT(name, return nullptr);
 
-    return P->recursivelySearch<TypeDecl>(name, &EnvironmentImpl::types_);
+    return P->recursivelySearch<TypeDecl>(name);
 }
 
 const ValueDecl* Environment::searchValueDecl(const Ident* name) const
 {
     UAISO_ASSERT(name, return nullptr);
 
-    return P->recursivelySearch<ValueDecl>(name, &EnvironmentImpl::values_);
+    return P->recursivelySearch<ValueDecl>(name);
 }
 
 void Environment::insertTypeDecl(std::unique_ptr<const TypeDecl> symbol)
 {
     UAISO_ASSERT(symbol, return);
+    UAISO_ASSERT(!P->frozen_, return);
 
-    P->types_.insert(std::move(symbol));
+    P->table_.insert(std::move(symbol), Group::Type);
+    P->changed();
 }
 
 void Environment::insertValueDecl(std::unique_ptr<const ValueDecl> symbol)
 {
     UAISO_ASSERT(symbol, return);
+    UAISO_ASSERT(!P->frozen_, return);
 
-    P->values_.insert(std::move(symbol));
+    P->table_.insert(std::move(symbol), Group::Value);
+    P->changed();
 }
 
 void Environment::takeOver(Environment env)
 {
-    P->values_.takeOver(env.P->values_.table_);
-    P->types_.takeOver(env.P->types_.table_);
-    P->namespaces_.takeOver(env.P->namespaces_.table_);
+    UAISO_ASSERT(!P->frozen_, return);
+    UAISO_ASSERT(!env.P->frozen_, return);
+
+    P->table_.takeOver(env.P->table_);
+    P->changed();
+    env.P->changed();
 }
 
 void Environment::nestIntoOuterEnv()
@@ -233,6 +667,7 @@ const std::vector<Environment>& Environment::nestedEnvs() const
 void Environment::detachOuterEnv()
 {
     P->outer_.reset();
+    P->changed();
 }
 
 void Environment::includeImport(std::unique_ptr<const Import> import)
@@ -251,67 +686,110 @@ std::vector<const Import*> Environment::imports() const
 Environment::Range<TypeDecl> Environment::searchTypeDecls(const Ident* name) const
 {
     UAISO_ASSERT(name,
-                 return std::make_pair(Iterator<TypeDecl>(P->types_.table_.end()),
-                                       Iterator<TypeDecl>(P->types_.table_.end())));
-
-    auto mapRange =
-            P->recursivelySearchMultiple<TypeDecl>(name, &EnvironmentImpl::types_);
+                 return std::make_pair(Iterator<TypeDecl>(&P->table_, SymbolTable::kNone),
+                                       Iterator<TypeDecl>(&P->table_, SymbolTable::kNone)));
 
-    return std::make_pair(Iterator<TypeDecl>(mapRange.first),
-                          Iterator<TypeDecl>(mapRange.second));
+    return P->recursivelySearchMultiple<TypeDecl>(name);
 }
 
 Environment::Range<ValueDecl> Environment::searchValueDecls(const Ident* name) const
 {
     UAISO_ASSERT(name,
-                 return std::make_pair(Iterator<ValueDecl>(P->values_.table_.end()),
-                                       Iterator<ValueDecl>(P->values_.table_.end())));
-
-    auto mapRange =
-            P->recursivelySearchMultiple<ValueDecl>(name, &EnvironmentImpl::values_);
+                 return std::make_pair(Iterator<ValueDecl>(&P->table_, SymbolTable::kNone),
+                                       Iterator<ValueDecl>(&P->table_, SymbolTable::kNone)));
 
-    return std::make_pair(Iterator<ValueDecl>(mapRange.first),
-                          Iterator<ValueDecl>(mapRange.second));
+    return P->recursivelySearchMultiple<ValueDecl>(name);
 }
 
 std::vector<const ValueDecl*> Environment::listValueDecls() const
 {
-    return P->list<ValueDecl>(&EnvironmentImpl::values_);
+    return P->list<ValueDecl>();
 }
 
 std::vector<const TypeDecl*> Environment::listTypeDecls() const
 {
-    return P->list<TypeDecl>(&EnvironmentImpl::types_);
+    return P->list<TypeDecl>();
 }
 
 std::vector<const Decl*> Environment::listDecls() const
 {
     std::vector<const Decl*> syms;
-    auto valSyms = P->list<ValueDecl>(&EnvironmentImpl::values_);
+    auto valSyms = P->list<ValueDecl>();
     std::copy(valSyms.begin(), valSyms.end(), std::back_inserter(syms));
-    auto tySyms = P->list<TypeDecl>(&EnvironmentImpl::types_);
+    auto tySyms = P->list<TypeDecl>();
     std::copy(tySyms.begin(), tySyms.end(), std::back_inserter(syms));
 
     return syms;
 }
 
+std::vector<const Decl*> Environment::listOwnDecls() const
+{
+    std::vector<const Decl*> syms;
+    auto valSyms = P->list<ValueDecl>(false);
+    std::copy(valSyms.begin(), valSyms.end(), std::back_inserter(syms));
+    auto tySyms = P->list<TypeDecl>(false);
+    std::copy(tySyms.begin(), tySyms.end(), std::back_inserter(syms));
+
+    return syms;
+}
+
+void Environment::visitSymbols(const std::string& prefix,
+                               SymbolGroups groups,
+                               const std::function<void (const Symbol*)>& visitor) const
+{
+    static_assert(static_cast<int>(SymbolGroup::TypeDecls) == 1 << static_cast<int>(Group::Type)
+                    && static_cast<int>(SymbolGroup::ValueDecls) == 1 << static_cast<int>(Group::Value)
+                    && static_cast<int>(SymbolGroup::Namespaces) == 1 << static_cast<int>(Group::Namespace),
+                  "symbol groups must match the table's");
+
+    EnvironmentImpl::Seen seen;
+    P->visit(prefix, groups, visitor, seen);
+}
+
 void Environment::injectNamespace(std::unique_ptr<Namespace> sym, bool mergeEnv)
 {
+    UAISO_ASSERT(!P->frozen_, return);
+
     if (mergeEnv)
-        P->mergedEnvs_.push_back(sym->env());
+        P->addMergedEnv(sym->env());
+
+    if (!sym->isAnonymous()) {
+        P->table_.insert(std::move(sym), Group::Namespace);
+        P->changed();
+    }
+}
 
-    if (!sym->isAnonymous())
-        P->namespaces_.insert(std::move(sym));
+void Environment::mergeEnv(Environment env)
+{
+    UAISO_ASSERT(!P->frozen_, return);
+    UAISO_ASSERT(env.P != P, return);
+
+    P->addMergedEnv(env);
+}
+
+void Environment::freeze()
+{
+    P->frozen_ = true;
+}
+
+bool Environment::isFrozen() const
+{
+    return P->frozen_;
+}
+
+uint64_t Environment::version() const
+{
+    return P->version_.load(std::memory_order_acquire);
 }
 
 const Namespace* Environment::fetchNamespace(const Ident* name) const
 {
-    return P->recursivelySearch<Namespace>(name, &EnvironmentImpl::namespaces_);
+    return P->recursivelySearch<Namespace>(name);
 }
 
 std::vector<const Namespace *> Environment::listNamespaces() const
 {
-    return P->list<Namespace>(&EnvironmentImpl::namespaces_);
+    return P->list<Namespace>();
 }
 
 namespace uaiso {
@@ -326,35 +804,24 @@ bool operator!=(const Environment& env1, const Environment& env2)
     return !(env1 == env2);
 }
 
-const Ident* nameToIdent(const SimpleNameAst* name, const LexemeMap* lexs)
-{
-    return lexs->findAt<Ident>(name->nameLoc_.fileName_, name->nameLoc_.lineCol());
-}
-
-const ValueDecl* searchValueDecl(const NameAst* name,
-                                 Environment env,
-                                 const LexemeMap* lexs)
+const ValueDecl* searchValueDecl(const NameAst* name, Environment env)
 {
     UAISO_ASSERT(name, return nullptr);
-    UAISO_ASSERT(lexs, return nullptr);
 
     if (name->kind() == Ast::Kind::SimpleName)
-        return env.searchValueDecl(nameToIdent(ConstSimpleName_Cast(name), lexs));
+        return env.searchValueDecl(ConstSimpleName_Cast(name)->ident());
 
     // TODO: Templates, namespaces...
 
     return nullptr;
 }
 
-const TypeDecl* searchTypeDecl(const NameAst* name,
-                               Environment env,
-                               const LexemeMap* lexs)
+const TypeDecl* searchTypeDecl(const NameAst* name, Environment env)
 {
     UAISO_ASSERT(name, return nullptr);
-    UAISO_ASSERT(lexs, return nullptr);
 
     if (name->kind() == Ast::Kind::SimpleName)
-        return env.searchTypeDecl(nameToIdent(ConstSimpleName_Cast(name), lexs));
+        return env.searchTypeDecl(ConstSimpleName_Cast(name)->ident());
 
     // TODO: Namespace...
 
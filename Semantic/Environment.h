@@ -26,18 +26,20 @@
 
 #include "Ast/AstFwd.h"
 #include "Common/Config.h"
+#include "Common/Flag.h"
 #include "Common/Pimpl.h"
 #include "Common/Test.h"
 #include "Semantic/SymbolFwd.h"
+#include <cstdint>
+#include <functional>
 #include <iterator>
-#include <unordered_map>
+#include <string>
 #include <vector>
 
 namespace uaiso {
 
 class Ident;
 class Import;
-class LexemeMap;
 
 /*!
  * \brief The Environment class
@@ -123,6 +125,42 @@ public:
      */
     void injectNamespace(std::unique_ptr<Namespace> sym, bool mergeEnv);
 
+    /*!
+     * \brief mergeEnv
+     * \param env
+     *
+     * Make symbols from environment \a env available in this environment,
+     * behind the ones of its own. Nothing is copied, \a env is referred to.
+     *
+     * When there are several merged environments, their symbols are looked
+     * up through a combined index, built on demand and rebuilt once any of
+     * them changes.
+     */
+    void mergeEnv(Environment env);
+
+    /*!
+     * \brief freeze
+     *
+     * Forbid further insertions into this environment, so it can be shared
+     * (e.g., merged into others) across threads.
+     */
+    void freeze();
+
+    /*!
+     * \brief isFrozen
+     * \return
+     */
+    bool isFrozen() const;
+
+    /*!
+     * \brief version
+     * \return
+     *
+     * Return the number of changes made to the environment (insertions,
+     * merges), which tells whether what was looked up from it still holds.
+     */
+    uint64_t version() const;
+
     /*!
      * \brief fetchNamespace
      * \param name
@@ -177,7 +215,9 @@ public:
      *
      * Search symbol in the type and value environments. If the name is
      * present in both of them, or if there are symbols with duplicate
-     * names, it's unspecified which match will be returned.
+     * names, it's unspecified which match will be returned. Both kinds
+     * of symbols are looked up in a single walk through the environments,
+     * so a symbol of an inner environment hides one of an outer.
      */
     const Decl* searchDecl(const Ident* name) const;
 
@@ -204,24 +244,41 @@ public:
     const ValueDecl* searchValueDecl(const Ident* name) const;
 
 
+private:
+    struct SymbolTable;
+
+    static uint32_t nextSameName(const SymbolTable* table, uint32_t idx);
+    static const Symbol* symbolAt(const SymbolTable* table, uint32_t idx);
+
+public:
     // DESIGN: This iterator doesn't support the implementation well enough.
     template <class SymbolT>
     class Iterator :
             public std::iterator<std::input_iterator_tag, const SymbolT>
     {
     public:
-        Iterator& operator++() { ++it_; return *this; }
-        const SymbolT* operator*() { return it_->second.get(); }
-        bool operator!=(const Iterator& other) const { return it_ != other.it_; }
+        Iterator& operator++()
+        {
+            idx_ = Environment::nextSameName(table_, idx_);
+            return *this;
+        }
+        const SymbolT* operator*()
+        {
+            return static_cast<const SymbolT*>(Environment::symbolAt(table_, idx_));
+        }
+        bool operator!=(const Iterator& other) const
+        {
+            return table_ != other.table_ || idx_ != other.idx_;
+        }
 
     private:
         friend class Environment;
-        using BaseIterator =
-            typename std::unordered_multimap<const Ident*,
-                                             std::unique_ptr<const SymbolT>>::const_iterator;
 
-        Iterator(BaseIterator it) : it_(it) {}
-        BaseIterator it_;
+        Iterator(const SymbolTable* table, uint32_t idx)
+            : table_(table), idx_(idx)
+        {}
+        const SymbolTable* table_;
+        uint32_t idx_;
     };
 
     template <class SymbolT> using Range =
@@ -271,24 +328,70 @@ public:
      */
     std::vector<const Decl*> listDecls() const;
 
+    /*!
+     * \brief listOwnDecls
+     * \return
+     * List symbols of this environment only, not the ones available from
+     * the environments merged into it.
+     */
+    std::vector<const Decl*> listOwnDecls() const;
+
+    /*!
+     * \brief The SymbolGroup enum
+     */
+    enum class SymbolGroup : uint8_t
+    {
+        None       = 0,
+        TypeDecls  = 0x1,
+        ValueDecls = 0x1 << 1,
+        Namespaces = 0x1 << 2,
+    };
+    UAISO_FLAGGED_ENUM(SymbolGroup);
+
+    /*!
+     * \brief visitSymbols
+     * \param prefix
+     * \param groups
+     * \param visitor
+     *
+     * Call \a visitor on each symbol of the given \a groups whose name
+     * starts with \a prefix, among those that would be listed (i.e., the
+     * symbols of this environment and of merged ones). Nothing is copied,
+     * and a large environment is searched through an index sorted by name.
+     * The order in which symbols are visited is unspecified.
+     */
+    void visitSymbols(const std::string& prefix,
+                      SymbolGroups groups,
+                      const std::function<void (const Symbol*)>& visitor) const;
+
 private:
     DECL_CLASS_TEST(Environment)
     DECL_SHARED_DATA(Environment)
 
     friend bool operator==(const Environment& env1, const Environment& env2);
+    friend struct std::hash<Environment>;
 };
 
-bool operator==(const Environment& env1, const Environment& env2);
-bool operator!=(const Environment& env1, const Environment& env2);
+UAISO_API bool operator==(const Environment& env1, const Environment& env2);
+UAISO_API bool operator!=(const Environment& env1, const Environment& env2);
 
-const ValueDecl* searchValueDecl(const NameAst* name,
-                                 Environment env,
-                                 const LexemeMap* lexs);
+const ValueDecl* searchValueDecl(const NameAst* name, Environment env);
 
-const TypeDecl* searchTypeDecl(const NameAst* name,
-                               Environment env,
-                               const LexemeMap* lexs);
+const TypeDecl* searchTypeDecl(const NameAst* name, Environment env);
 
 } // namespace uaiso
 
+namespace std {
+
+template <>
+struct hash<uaiso::Environment>
+{
+    size_t operator()(const uaiso::Environment& env) const
+    {
+        return std::hash<const void*>()(env.impl_.get());
+    }
+};
+
+} // namespace std
+
 #endif
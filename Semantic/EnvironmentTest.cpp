@@ -26,6 +26,7 @@
 #include "Semantic/Type.h"
 #include "Ast/Ast.h"
 #include "Parsing/Lexeme.h"
+#include <algorithm>
 
 using namespace uaiso;
 
@@ -38,6 +39,12 @@ public:
              , &EnvironmentTest::testCase3
              , &EnvironmentTest::testCase4
              , &EnvironmentTest::testCase5
+             , &EnvironmentTest::testCase6
+             , &EnvironmentTest::testCase7
+             , &EnvironmentTest::testCase8
+             , &EnvironmentTest::testCase9
+             , &EnvironmentTest::testCase10
+             , &EnvironmentTest::testCase11
              )
 
     void testCase1()
@@ -124,6 +131,225 @@ public:
         UAISO_EXPECT_INT_EQ(3, total);
     }
 
+    void testCase6()
+    {
+        // Many symbols in one scope, with duplicates of both kinds.
+        std::vector<std::unique_ptr<Ident>> idents;
+        Environment env;
+        for (int i = 0; i < 40; ++i) {
+            idents.emplace_back(new Ident("v" + std::to_string(i)));
+            env.insertValueDecl(std::unique_ptr<const ValueDecl>(new Var(idents.back().get())));
+            if (i % 3 == 0)
+                env.insertTypeDecl(std::unique_ptr<const TypeDecl>(new Record(idents.back().get())));
+            if (i % 5 == 0)
+                env.insertValueDecl(std::unique_ptr<const ValueDecl>(new Var(idents.back().get())));
+        }
+        std::unique_ptr<Ident> missing(new Ident("missing"));
+
+        for (int i = 0; i < 40; ++i) {
+            const Ident* ident = idents[i].get();
+            UAISO_EXPECT_TRUE(env.searchValueDecl(ident));
+            UAISO_EXPECT_TRUE((i % 3 == 0) == (env.searchTypeDecl(ident) != nullptr));
+            UAISO_EXPECT_TRUE(env.searchDecl(ident)->kind() == Symbol::Kind::Var);
+
+            auto vals = env.searchValueDecls(ident);
+            size_t valCnt = std::distance(vals.first, vals.second);
+            UAISO_EXPECT_INT_EQ((i % 5 == 0 ? 2 : 1), valCnt);
+            auto tys = env.searchTypeDecls(ident);
+            size_t tyCnt = std::distance(tys.first, tys.second);
+            UAISO_EXPECT_INT_EQ((i % 3 == 0 ? 1 : 0), tyCnt);
+        }
+        UAISO_EXPECT_FALSE(env.searchDecl(missing.get()));
+        UAISO_EXPECT_INT_EQ(48, env.listValueDecls().size());
+        UAISO_EXPECT_INT_EQ(14, env.listTypeDecls().size());
+    }
+
+    void testCase7()
+    {
+        // Take over a large scope, inner symbols hide outer ones.
+        std::vector<std::unique_ptr<Ident>> idents;
+        Environment outer;
+        Environment other;
+        for (int i = 0; i < 20; ++i) {
+            idents.emplace_back(new Ident("a" + std::to_string(i)));
+            outer.insertValueDecl(std::unique_ptr<const ValueDecl>(new Var(idents.back().get())));
+            other.insertValueDecl(std::unique_ptr<const ValueDecl>(new Var(idents.back().get())));
+        }
+        Environment inner = outer.createSubEnv();
+        inner.takeOver(other);
+        UAISO_EXPECT_TRUE(other.isEmpty());
+        UAISO_EXPECT_INT_EQ(20, inner.listValueDecls().size());
+
+        for (const auto& ident : idents) {
+            UAISO_EXPECT_TRUE(inner.searchValueDecl(ident.get()));
+            UAISO_EXPECT_TRUE(inner.searchValueDecl(ident.get())
+                              != outer.searchValueDecl(ident.get()));
+        }
+
+        std::unique_ptr<Ident> b(new Ident("b"));
+        outer.insertValueDecl(std::unique_ptr<const ValueDecl>(new Var(b.get())));
+        inner.insertTypeDecl(std::unique_ptr<const TypeDecl>(new Record(b.get())));
+        UAISO_EXPECT_TRUE(inner.searchDecl(b.get())->kind() == Symbol::Kind::Record);
+        UAISO_EXPECT_TRUE(outer.searchDecl(b.get())->kind() == Symbol::Kind::Var);
+    }
+
+    void testCase8()
+    {
+        // Many merged environments (star imports).
+        std::vector<std::unique_ptr<Ident>> idents;
+        for (int i = 0; i < 10; ++i)
+            idents.emplace_back(new Ident("m" + std::to_string(i)));
+        std::unique_ptr<Ident> dup(new Ident("dup"));
+        std::unique_ptr<Ident> late(new Ident("late"));
+        std::unique_ptr<Ident> missing(new Ident("missing"));
+
+        std::vector<Environment> modules(10);
+        for (int i = 0; i < 10; ++i) {
+            modules[i].insertValueDecl(std::unique_ptr<const ValueDecl>(new Var(idents[i].get())));
+            modules[i].insertTypeDecl(std::unique_ptr<const TypeDecl>(new Record(dup.get())));
+        }
+        Environment env;
+        for (int i = 0; i < 8; ++i)
+            env.mergeEnv(modules[i]);
+        Environment inner = env.createSubEnv();
+
+        for (int i = 0; i < 8; ++i)
+            UAISO_EXPECT_TRUE(inner.searchValueDecl(idents[i].get()));
+        UAISO_EXPECT_FALSE(inner.searchValueDecl(idents[8].get()));
+        UAISO_EXPECT_FALSE(inner.searchDecl(missing.get()));
+        UAISO_EXPECT_TRUE(inner.searchTypeDecl(dup.get()) == modules[0].searchTypeDecl(dup.get()));
+        UAISO_EXPECT_INT_EQ(8, env.listValueDecls().size());
+        UAISO_EXPECT_INT_EQ(8, env.listTypeDecls().size());
+
+        // Changes to merged environments are seen.
+        std::unique_ptr<Namespace> space(new Namespace);
+        space->setEnv(modules[8]);
+        env.injectNamespace(std::move(space), true);
+        UAISO_EXPECT_TRUE(inner.searchValueDecl(idents[8].get()));
+        modules[3].mergeEnv(modules[9]);
+        UAISO_EXPECT_TRUE(inner.searchValueDecl(idents[9].get()));
+        modules[5].insertValueDecl(std::unique_ptr<const ValueDecl>(new Var(late.get())));
+        UAISO_EXPECT_TRUE(inner.searchDecl(late.get()));
+        UAISO_EXPECT_INT_EQ(11, env.listValueDecls().size());
+
+        // Symbols of the environment itself come first.
+        env.insertTypeDecl(std::unique_ptr<const TypeDecl>(new Record(dup.get())));
+        UAISO_EXPECT_TRUE(inner.searchTypeDecl(dup.get()) != modules[0].searchTypeDecl(dup.get()));
+    }
+
+    void testCase9()
+    {
+        // Visit by prefix, small and large scopes, merged ones included.
+        std::vector<std::unique_ptr<Ident>> idents;
+        auto ident = [&idents] (const std::string& s) {
+            idents.emplace_back(new Ident(s));
+            return idents.back().get();
+        };
+        Environment small;
+        small.insertValueDecl(std::unique_ptr<const ValueDecl>(new Var(ident("path"))));
+        small.insertTypeDecl(std::unique_ptr<const TypeDecl>(new Record(ident("Pair"))));
+        small.injectNamespace(std::unique_ptr<Namespace>(new Namespace(ident("pack"))), false);
+        Environment large;
+        for (int i = 0; i < 30; ++i)
+            large.insertValueDecl(std::unique_ptr<const ValueDecl>(new Var(ident("v" + std::to_string(i)))));
+        large.insertTypeDecl(std::unique_ptr<const TypeDecl>(new Record(ident("pair"))));
+        std::unique_ptr<Var> fake(new Var(ident("pa")));
+        fake->setIsFake(true);
+        large.insertValueDecl(std::unique_ptr<const ValueDecl>(fake.release()));
+        large.mergeEnv(small);
+
+        auto count = [] (Environment env, const std::string& prefix, SymbolGroups groups) {
+            size_t cnt = 0;
+            env.visitSymbols(prefix, groups, [&cnt] (const Symbol*) { ++cnt; });
+            return cnt;
+        };
+        const auto decls = SymbolGroups(SymbolGroup::ValueDecls) | SymbolGroup::TypeDecls;
+        const auto all = SymbolGroups(decls) | SymbolGroup::Namespaces;
+
+        UAISO_EXPECT_INT_EQ(2, count(small, "pa", all));
+        UAISO_EXPECT_INT_EQ(1, count(small, "pa", SymbolGroup::ValueDecls));
+        UAISO_EXPECT_INT_EQ(3, count(small, "", all));
+        UAISO_EXPECT_INT_EQ(0, count(small, "x", all));
+        UAISO_EXPECT_INT_EQ(30, count(large, "v", decls));
+        UAISO_EXPECT_INT_EQ(11, count(large, "v1", decls));
+        UAISO_EXPECT_INT_EQ(1, count(large, "v29", decls));
+        UAISO_EXPECT_INT_EQ(0, count(large, "v299", decls));
+        UAISO_EXPECT_INT_EQ(2, count(large, "pa", decls));
+        UAISO_EXPECT_INT_EQ(3, count(large, "p", all));
+        UAISO_EXPECT_INT_EQ(1, count(large, "P", all));
+        UAISO_EXPECT_INT_EQ(large.listDecls().size(), count(large, "", decls));
+
+        // The sorted index follows insertions.
+        large.insertValueDecl(std::unique_ptr<const ValueDecl>(new Var(ident("v100"))));
+        UAISO_EXPECT_INT_EQ(2, count(large, "v10", decls));
+    }
+
+    void testCase10()
+    {
+        // The index of merged environments follows changes to any of the
+        // environments it's built from, outer ones of them included (frozen
+        // ones, which can't change, aren't tracked).
+        std::vector<std::unique_ptr<Ident>> idents;
+        auto ident = [&idents] (const std::string& s) {
+            idents.emplace_back(new Ident(s));
+            return idents.back().get();
+        };
+        Environment outer;
+        std::vector<Environment> modules;
+        for (int i = 0; i < 8; ++i) {
+            modules.push_back(i ? Environment() : outer.createSubEnv());
+            modules.back().insertValueDecl(
+                std::unique_ptr<const ValueDecl>(new Var(ident("m" + std::to_string(i)))));
+        }
+        Environment env, other;
+        for (const auto& module : modules) {
+            env.mergeEnv(module);
+            other.mergeEnv(module);
+        }
+        Environment unrelated;
+        for (int i = 0; i < 8; ++i) {
+            Environment module;
+            module.insertValueDecl(
+                std::unique_ptr<const ValueDecl>(new Var(ident("u" + std::to_string(i)))));
+            module.freeze();
+            unrelated.mergeEnv(module);
+        }
+
+        auto late = ident("late");
+        UAISO_EXPECT_FALSE(env.searchDecl(late));
+        UAISO_EXPECT_TRUE(unrelated.searchDecl(idents[8].get()));
+        outer.insertValueDecl(std::unique_ptr<const ValueDecl>(new Var(late)));
+        UAISO_EXPECT_TRUE(env.searchDecl(late));
+        UAISO_EXPECT_TRUE(other.searchDecl(late));
+
+        modules[0].detachOuterEnv();
+        UAISO_EXPECT_FALSE(env.searchDecl(late));
+        UAISO_EXPECT_TRUE(env.searchDecl(idents[0].get()));
+    }
+
+    void testCase11()
+    {
+        // An environment merged along several paths is visited once.
+        std::unique_ptr<Ident> shared(new Ident("shared"));
+        std::unique_ptr<Ident> left(new Ident("left"));
+        std::unique_ptr<Ident> right(new Ident("right"));
+        Environment base, a, b, env;
+        base.insertValueDecl(std::unique_ptr<const ValueDecl>(new Var(shared.get())));
+        a.insertValueDecl(std::unique_ptr<const ValueDecl>(new Var(left.get())));
+        b.insertValueDecl(std::unique_ptr<const ValueDecl>(new Var(right.get())));
+        a.mergeEnv(base);
+        b.mergeEnv(base);
+        env.mergeEnv(a);
+        env.mergeEnv(b);
+        env.mergeEnv(base);
+
+        std::vector<const Symbol*> syms;
+        env.visitSymbols("", SymbolGroup::ValueDecls,
+                         [&syms] (const Symbol* sym) { syms.push_back(sym); });
+        UAISO_EXPECT_INT_EQ(3, syms.size());
+        UAISO_EXPECT_INT_EQ(1, std::count(syms.begin(), syms.end(),
+                                          base.searchValueDecl(shared.get())));
+    }
 };
 
 MAKE_CLASS_TEST(Environment)
@@ -36,6 +36,7 @@ struct Import::ImportImpl
         , target_(target)
         , localName_(localName)
         , isEmbedded_(isEmbedded)
+        , isAuto_(false)
     {}
 
     const std::string fromWhere_;
@@ -44,6 +45,7 @@ struct Import::ImportImpl
     std::vector<const Ident*> items_;
     std::unordered_map<const Ident*, const Ident*> nicks_;
     bool isEmbedded_;
+    bool isAuto_;
     TargetEntity entity_;
 };
 
@@ -77,6 +79,16 @@ bool Import::isEmbedded() const
     return P->isEmbedded_;
 }
 
+void Import::markAsAutomatic()
+{
+    P->isAuto_ = true;
+}
+
+bool Import::isAutomatic() const
+{
+    return P->isAuto_;
+}
+
 bool Import::isSelective() const
 {
     return !P->items_.empty();
@@ -69,6 +69,16 @@ public:
 
     bool isEmbedded() const;
 
+    /*!
+     * \brief markAsAutomatic
+     *
+     * Mark the import as not written in the source, but implied by the
+     * language (an automatic module).
+     */
+    void markAsAutomatic();
+
+    bool isAutomatic() const;
+
     bool isSelective() const;
 
     void addSelectedItem(const Ident* actualName);
@@ -31,45 +31,155 @@
 #include "Parsing/Lang.h"
 #include "Parsing/Lexeme.h"
 #include "StringUtils/predicate.hpp"
-#include <fstream>
+#include <algorithm>
 #include <iostream>
+#include <mutex>
+#include <unordered_map>
 #include <unordered_set>
+#include <sys/stat.h>
 
 #define TRACE_NAME "ImportResolver"
 
 using namespace uaiso;
 using namespace str;
 
+namespace {
+
+/*!
+ * \brief The DirListing struct
+ *
+ * The files (not subdirectories) of a directory, in listing order. A
+ * directory which doesn't exist is a (negative) listing as well.
+ */
+struct DirListing
+{
+    std::string path_;
+    bool exists_ { false };
+    long long modTime_ { 0 };
+    std::vector<std::string> files_;
+    std::unordered_set<std::string> lookup_;
+    unsigned version_ { 0 }; //!< Bumped whenever the directory is relisted.
+    unsigned epoch_ { 0 };   //!< Epoch in which it was last validated.
+};
+
+/*!
+ * \brief The Resolution struct
+ *
+ * The files an import is resolved to, with the listings that were consulted.
+ */
+struct Resolution
+{
+    std::vector<std::string> files_;
+    Import::TargetEntity entity_ { Import::Module };
+    std::vector<std::pair<DirListing*, unsigned>> deps_;
+    unsigned epoch_ { 0 };
+};
+
+bool modTime(const std::string& dirPath, long long* time)
+{
+    struct stat st;
+    if (stat(dirPath.c_str(), &st) != 0 || !S_ISDIR(st.st_mode))
+        return false;
+#ifdef __linux__
+    *time = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#else
+    *time = st.st_mtime;
+#endif
+    return true;
+}
+
+} // anonymous
+
 struct ImportResolver::ImportResolverImpl
 {
     ImportResolverImpl(Factory* factory)
         : lang_(factory->makeLang())
     {}
 
-    std::pair<std::vector<std::string>, Import::TargetEntity>
-    resolve(std::string target,
-            const std::string& path,
-            const std::unordered_set<std::string>& fileFilter)
+    /*!
+     * \brief listing
+     *
+     * Return the listing of \a dirPath, from the cache when it's valid (in
+     * which case \a hit is set).
+     */
+    DirListing* listing(const std::string& dirPath, bool* hit)
     {
-        auto pos = target.find(lang_->packageSeparator());
-        while (pos != std::string::npos) {
-            target.replace(pos, 1, std::string(1, FileInfo::dirSeparator()));
-            pos = target.find(lang_->packageSeparator(), pos + 1);
+        const std::string actualPath = dirPath.empty() ? std::string(".") : dirPath;
+        auto& dir = dirs_[dirPath];
+        *hit = true;
+        if (dir.version_) {
+            if (dir.epoch_ == epoch_) {
+                ++stats_.dirHits_;
+                return &dir;
+            }
+            long long time = 0;
+            bool exists = modTime(actualPath, &time);
+            if (exists == dir.exists_ && (!exists || time == dir.modTime_)) {
+                dir.epoch_ = epoch_;
+                ++stats_.dirHits_;
+                return &dir;
+            }
+        }
+
+        *hit = false;
+        ++stats_.dirMisses_;
+        dir.path_ = dirPath;
+        ++dir.version_;
+        dir.epoch_ = epoch_;
+        dir.files_.clear();
+        dir.lookup_.clear();
+        dir.exists_ = modTime(actualPath, &dir.modTime_);
+        if (!dir.exists_)
+            return &dir;
+
+        DEBUG_TRACE("list directory %s\n", actualPath.c_str());
+        tinydir_dir tdir;
+        if (tinydir_open(&tdir, actualPath.c_str()) == -1) {
+            // The directory can't be read, record it as an empty listing,
+            // so its files are negative entries until it's modified.
+            DEBUG_TRACE("can't list directory %s\n", actualPath.c_str());
+            return &dir;
+        }
+        while (tdir.has_next) {
+            tinydir_file fileInDir;
+            tinydir_readfile(&tdir, &fileInDir);
+            if (!fileInDir.is_dir) {
+                dir.files_.emplace_back(fileInDir.name);
+                dir.lookup_.insert(dir.files_.back());
+            }
+            tinydir_next(&tdir);
         }
+        tinydir_close(&tdir);
 
+        return &dir;
+    }
+
+    std::pair<std::vector<std::string>, Import::TargetEntity>
+    resolve(const std::string& target,
+            const std::string& path,
+            const std::unordered_set<std::string>& fileFilter,
+            Resolution& res)
+    {
         std::vector<std::string> result;
 
         if (lang_->importMechanism() == Lang::PerModule
                 || lang_->importMechanism() == Lang::PerModuleAndPackage) {
             auto moduleFile = path + target + lang_->sourceFileSuffix();
             DEBUG_TRACE("search module import %s\n", moduleFile.c_str());
-            std::ifstream ifs(moduleFile);
-            if (ifs.is_open()) {
-                ifs.close();
+            auto sepPos = moduleFile.rfind(FileInfo::dirSeparator());
+            std::string moduleDir;
+            if (sepPos != std::string::npos)
+                moduleDir = moduleFile.substr(0, sepPos + 1);
+            bool hit;
+            DirListing* dir = listing(moduleDir, &hit);
+            res.deps_.emplace_back(dir, dir->version_);
+            if (dir->lookup_.count(moduleFile.substr(moduleDir.size()))) {
                 result.emplace_back(moduleFile);
                 DEBUG_TRACE("module file %s found\n", moduleFile.c_str());
                 return std::make_pair(result, Import::Module);
             }
+            if (hit)
+                ++stats_.negativeHits_;
             // If the language's import mechanism is per module only, there's
             // nothing to do. Otherwise, let it search packages.
             if (lang_->importMechanism() == Lang::PerModule)
@@ -78,15 +188,13 @@ struct ImportResolver::ImportResolverImpl
 
         auto dirPath = path + target;
         DEBUG_TRACE("search package import %s\n", dirPath.c_str());
-        tinydir_dir dir;
-        tinydir_open(&dir, dirPath.c_str());
-        while (dir.has_next) {
-            tinydir_file fileInDir;
-            tinydir_readfile(&dir, &fileInDir);
-
-            std::string fileInDirName(fileInDir.name);
-            if (!fileInDir.is_dir
-                    && iends_with(fileInDirName, lang_->sourceFileSuffix())) {
+        bool hit;
+        DirListing* dir = listing(dirPath, &hit);
+        res.deps_.emplace_back(dir, dir->version_);
+        if (hit && !dir->exists_)
+            ++stats_.negativeHits_;
+        for (const auto& fileInDirName : dir->files_) {
+            if (iends_with(fileInDirName, lang_->sourceFileSuffix())) {
                 // Add as a result if either the filter is completely empty
                 // or if the file in question is filtered in.
                 if (fileFilter.empty() || fileFilter.count(fileInDirName)) {
@@ -95,14 +203,35 @@ struct ImportResolver::ImportResolverImpl
                                 (dirPath + "/" + fileInDirName).c_str());
                 }
             }
-            tinydir_next(&dir);
         }
-        tinydir_close(&dir);
 
         return std::make_pair(result, Import::Package);
     }
 
+    /*!
+     * \brief isValid
+     *
+     * Whether none of the listings the resolution depends on changed.
+     */
+    bool isValid(Resolution& res)
+    {
+        if (res.epoch_ == epoch_)
+            return true;
+        for (const auto& dep : res.deps_) {
+            bool hit;
+            if (listing(dep.first->path_, &hit)->version_ != dep.second)
+                return false;
+        }
+        res.epoch_ = epoch_;
+        return true;
+    }
+
     std::unique_ptr<Lang> lang_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, DirListing> dirs_;
+    std::unordered_map<std::string, Resolution> resolutions_;
+    unsigned epoch_ { 1 };
+    ImportResolver::Stats stats_;
 };
 
 ImportResolver::ImportResolver(Factory *factory)
@@ -122,26 +251,97 @@ std::vector<std::string> ImportResolver::
 resolve(Import* import,
         const std::vector<std::string>& searchPaths) const
 {
-    std::unordered_set<std::string> selected;
+    std::vector<std::string> selected;
     std::for_each(import->selectedItems().begin(),
                   import->selectedItems().end(),
                   [&selected, this](const Ident* name) {
-        selected.insert(name->str() + P->lang_->sourceFileSuffix());
+        selected.push_back(name->str() + P->lang_->sourceFileSuffix());
     });
+    std::sort(selected.begin(), selected.end());
 
-    auto data = P->resolve(import->target(), import->fromWhere(), selected);
-    if (!data.first.empty()) {
-        import->setTargetEntity(data.second);
-        return data.first;
+    // Everything the result depends on goes into the key.
+    std::string key = import->target();
+    key += '\0';
+    key += import->fromWhere();
+    for (const auto& item : selected) {
+        key += '\0';
+        key += item;
     }
-
+    key += '\1';
     for (const auto& searchPath : searchPaths) {
-        data = P->resolve(import->target(), searchPath, selected);
-        if (!data.first.empty()) {
-            import->setTargetEntity(data.second);
-            break;
-        }
+        key += searchPath;
+        key += '\0';
     }
 
+    std::lock_guard<std::mutex> lock(P->mutex_);
+    auto it = P->resolutions_.find(key);
+    if (it != P->resolutions_.end() && P->isValid(it->second)) {
+        ++P->stats_.resolveHits_;
+        if (!it->second.files_.empty())
+            import->setTargetEntity(it->second.entity_);
+        return it->second.files_;
+    }
+    ++P->stats_.resolveMisses_;
+
+    std::string target = import->target();
+    auto pos = target.find(P->lang_->packageSeparator());
+    while (pos != std::string::npos) {
+        target.replace(pos, 1, std::string(1, FileInfo::dirSeparator()));
+        pos = target.find(P->lang_->packageSeparator(), pos + 1);
+    }
+
+    Resolution res;
+    res.epoch_ = P->epoch_;
+    std::unordered_set<std::string> fileFilter(selected.begin(), selected.end());
+    auto data = P->resolve(target, import->fromWhere(), fileFilter, res);
+    for (size_t i = 0; data.first.empty() && i < searchPaths.size(); ++i)
+        data = P->resolve(target, searchPaths[i], fileFilter, res);
+    if (!data.first.empty())
+        import->setTargetEntity(data.second);
+
+    res.files_ = data.first;
+    res.entity_ = data.second;
+    P->resolutions_[key] = std::move(res);
+
     return data.first;
 }
+
+void ImportResolver::revalidate()
+{
+    std::lock_guard<std::mutex> lock(P->mutex_);
+    ++P->epoch_;
+}
+
+void ImportResolver::invalidate()
+{
+    std::lock_guard<std::mutex> lock(P->mutex_);
+    P->resolutions_.clear();
+    P->dirs_.clear();
+}
+
+void ImportResolver::invalidate(const std::string& dirPath)
+{
+    std::lock_guard<std::mutex> lock(P->mutex_);
+    auto it = P->dirs_.find(dirPath);
+    if (it == P->dirs_.end())
+        return;
+
+    const DirListing* dir = &it->second;
+    for (auto resIt = P->resolutions_.begin(); resIt != P->resolutions_.end();) {
+        const auto& deps = resIt->second.deps_;
+        if (std::any_of(deps.begin(), deps.end(),
+                        [dir] (const std::pair<DirListing*, unsigned>& dep) {
+                            return dep.first == dir; })) {
+            resIt = P->resolutions_.erase(resIt);
+        } else {
+            ++resIt;
+        }
+    }
+    P->dirs_.erase(it);
+}
+
+ImportResolver::Stats ImportResolver::stats() const
+{
+    std::lock_guard<std::mutex> lock(P->mutex_);
+    return P->stats_;
+}
@@ -26,6 +26,7 @@
 
 #include "Common/Config.h"
 #include "Common/Pimpl.h"
+#include "Common/Test.h"
 #include <cstdio>
 #include <string>
 #include <vector>
@@ -37,6 +38,12 @@ class Import;
 
 /*!
  * \brief The ImportResolver class
+ *
+ * Resolution is cached: the listings of the directories probed are kept
+ * (including the ones which don't exist), as are the files an import is
+ * resolved to. Cached data is trusted until revalidate() is called, after
+ * which each directory is checked against its modification time once,
+ * when it's next needed.
  */
 class UAISO_API ImportResolver final
 {
@@ -66,8 +73,51 @@ public:
     std::vector<std::string> resolve(Import* import,
                                      const std::vector<std::string>& searchPaths) const;
 
+    /*!
+     * \brief revalidate
+     *
+     * Check cached data against the modification times of the directories
+     * before it's used again.
+     */
+    void revalidate();
+
+    /*!
+     * \brief invalidate
+     *
+     * Drop all cached data.
+     */
+    void invalidate();
+
+    /*!
+     * \brief invalidate
+     * \param dirPath
+     *
+     * Drop the listing of directory \a dirPath and the resolutions which
+     * depend on it.
+     */
+    void invalidate(const std::string& dirPath);
+
+    /*!
+     * \brief The Stats struct
+     */
+    struct Stats
+    {
+        size_t resolveHits_ { 0 };   //!< Imports resolved from the cache.
+        size_t resolveMisses_ { 0 }; //!< Imports resolved by probing directories.
+        size_t dirHits_ { 0 };       //!< Directory probes answered by the cache.
+        size_t dirMisses_ { 0 };     //!< Directories (re)listed.
+        size_t negativeHits_ { 0 };  //!< Cached directory probes of a missing file.
+    };
+
+    /*!
+     * \brief stats
+     * \return
+     */
+    Stats stats() const;
+
 private:
     DECL_PIMPL(ImportResolver)
+    DECL_CLASS_TEST(ImportResolver)
 };
 
 } // namespace uaiso
@@ -0,0 +1,206 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#include "Semantic/ImportResolver.h"
+#include "Semantic/Import.h"
+#include "Parsing/Factory.h"
+#include "Parsing/Lexeme.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace uaiso;
+
+class ImportResolver::ImportResolverTest : public Test
+{
+public:
+    TEST_RUN(ImportResolverTest
+             , &ImportResolverTest::testCase1
+             , &ImportResolverTest::testCase2
+             , &ImportResolverTest::testCase3
+             , &ImportResolverTest::testCase4
+             )
+
+    ImportResolverTest()
+    {
+        char dirTemplate[] = "/tmp/uaiso_import_resolver_XXXXXX";
+        if (mkdtemp(dirTemplate))
+            dirPath_ = std::string(dirTemplate) + "/";
+    }
+
+    ~ImportResolverTest()
+    {
+        std::for_each(written_.rbegin(), written_.rend(),
+                      [] (const std::string& path) {
+            if (std::remove(path.c_str()))
+                rmdir(path.c_str());
+        });
+        rmdir(dirPath_.c_str());
+    }
+
+    void makeDir(const std::string& dirName)
+    {
+        mkdir((base_ + dirName).c_str(), 0700);
+        written_.push_back(base_ + dirName);
+    }
+
+    void write(const std::string& fileName)
+    {
+        std::ofstream(base_ + fileName) << "x = 1\n";
+        written_.push_back(base_ + fileName);
+    }
+
+    void reset() override
+    {
+        // Every test case works in a directory of its own.
+        base_ = dirPath_;
+        makeDir("case" + std::to_string(written_.size()));
+        base_ = written_.back() + "/";
+        factory_ = FactoryCreator::create(LangId::Py);
+    }
+
+    std::string dirPath_;
+    std::string base_;
+    std::vector<std::string> written_;
+    std::unique_ptr<Factory> factory_;
+
+    void testCase1()
+    {
+        makeDir("proj");
+        makeDir("lib1");
+        makeDir("lib2");
+        write("lib2/mod.py");
+        const std::vector<std::string> searchPaths {
+            base_ + "lib1/", base_ + "lib2/"
+        };
+
+        ImportResolver resolver(factory_.get());
+        Import import(base_ + "proj/", "mod", nullptr, false);
+        auto files = resolver.resolve(&import, searchPaths);
+        UAISO_EXPECT_INT_EQ(1, files.size());
+        UAISO_EXPECT_STR_EQ(base_ + "lib2/mod.py", files[0]);
+        UAISO_EXPECT_INT_EQ(Import::Module, import.targetEntity());
+        UAISO_EXPECT_INT_EQ(0, resolver.stats().resolveHits_);
+        UAISO_EXPECT_INT_EQ(1, resolver.stats().resolveMisses_);
+
+        // Another file importing the same module (from the same place).
+        Import other(base_ + "proj/", "mod", nullptr, false);
+        files = resolver.resolve(&other, searchPaths);
+        UAISO_EXPECT_INT_EQ(1, files.size());
+        UAISO_EXPECT_STR_EQ(base_ + "lib2/mod.py", files[0]);
+        UAISO_EXPECT_INT_EQ(1, resolver.stats().resolveHits_);
+        UAISO_EXPECT_INT_EQ(1, resolver.stats().resolveMisses_);
+
+        // Directories already listed aren't listed again.
+        const size_t dirMisses = resolver.stats().dirMisses_;
+        Import another(base_ + "lib1/", "mod", nullptr, false);
+        files = resolver.resolve(&another, searchPaths);
+        UAISO_EXPECT_INT_EQ(1, files.size());
+        UAISO_EXPECT_INT_EQ(dirMisses, resolver.stats().dirMisses_);
+        UAISO_EXPECT_TRUE(resolver.stats().negativeHits_ > 0);
+    }
+
+    void testCase2()
+    {
+        makeDir("proj");
+        makeDir("lib");
+        const std::vector<std::string> searchPaths { base_ + "lib/" };
+
+        ImportResolver resolver(factory_.get());
+        Import import(base_ + "proj/", "mod", nullptr, false);
+        UAISO_EXPECT_TRUE(resolver.resolve(&import, searchPaths).empty());
+        UAISO_EXPECT_TRUE(resolver.resolve(&import, searchPaths).empty());
+        UAISO_EXPECT_INT_EQ(1, resolver.stats().resolveHits_);
+
+        // The miss is remembered until the cache is revalidated.
+        write("lib/mod.py");
+        UAISO_EXPECT_TRUE(resolver.resolve(&import, searchPaths).empty());
+        resolver.revalidate();
+        auto files = resolver.resolve(&import, searchPaths);
+        UAISO_EXPECT_INT_EQ(1, files.size());
+        UAISO_EXPECT_STR_EQ(base_ + "lib/mod.py", files[0]);
+        UAISO_EXPECT_INT_EQ(2, resolver.stats().resolveMisses_);
+
+        // Unchanged directories are revalidated without being listed.
+        const size_t dirMisses = resolver.stats().dirMisses_;
+        resolver.revalidate();
+        UAISO_EXPECT_INT_EQ(1, resolver.resolve(&import, searchPaths).size());
+        UAISO_EXPECT_INT_EQ(dirMisses, resolver.stats().dirMisses_);
+    }
+
+    void testCase3()
+    {
+        makeDir("proj");
+        makeDir("lib");
+
+        ImportResolver resolver(factory_.get());
+        Import import(base_ + "proj/", "mod", nullptr, false);
+        const std::vector<std::string> searchPaths { base_ + "lib/" };
+        UAISO_EXPECT_TRUE(resolver.resolve(&import, searchPaths).empty());
+
+        write("lib/mod.py");
+        resolver.invalidate(base_ + "proj/");
+        UAISO_EXPECT_TRUE(resolver.resolve(&import, searchPaths).empty());
+        resolver.invalidate(base_ + "lib/");
+        UAISO_EXPECT_INT_EQ(1, resolver.resolve(&import, searchPaths).size());
+
+        std::remove((base_ + "lib/mod.py").c_str());
+        resolver.invalidate();
+        UAISO_EXPECT_TRUE(resolver.resolve(&import, searchPaths).empty());
+        UAISO_EXPECT_INT_EQ(0, resolver.stats().resolveHits_);
+    }
+
+    void testCase4()
+    {
+        makeDir("proj");
+        makeDir("proj/pkg");
+        write("proj/pkg/a.py");
+        write("proj/pkg/b.py");
+        write("proj/pkg/c.txt");
+
+        ImportResolver resolver(factory_.get());
+        Import import(base_ + "proj/", "pkg", nullptr, false);
+        auto files = resolver.resolve(&import);
+        std::sort(files.begin(), files.end());
+        UAISO_EXPECT_INT_EQ(2, files.size());
+        UAISO_EXPECT_STR_EQ(base_ + "proj/pkg/a.py", files[0]);
+        UAISO_EXPECT_STR_EQ(base_ + "proj/pkg/b.py", files[1]);
+        UAISO_EXPECT_INT_EQ(Import::Package, import.targetEntity());
+
+        // Selected items are part of what's cached.
+        Ident b("b");
+        Import selective(base_ + "proj/", "pkg", nullptr, false);
+        selective.addSelectedItem(&b);
+        files = resolver.resolve(&selective);
+        UAISO_EXPECT_INT_EQ(1, files.size());
+        UAISO_EXPECT_STR_EQ(base_ + "proj/pkg/b.py", files[0]);
+        UAISO_EXPECT_INT_EQ(0, resolver.stats().resolveHits_);
+        UAISO_EXPECT_INT_EQ(1, resolver.resolve(&selective).size());
+        UAISO_EXPECT_INT_EQ(1, resolver.stats().resolveHits_);
+    }
+};
+
+MAKE_CLASS_TEST(ImportResolver)
@@ -23,22 +23,31 @@
 
 #include "Semantic/Manager.h"
 #include "Semantic/Binder.h"
+#include "Semantic/CompletionProposer.h"
 #include "Semantic/Import.h"
 #include "Semantic/ImportResolver.h"
 #include "Semantic/Program.h"
+#include "Semantic/ProgramCache.h"
 #include "Semantic/Snapshot.h"
 #include "Semantic/Symbol.h"
+#include "Semantic/TypeChecker.h"
 #include "Common/Assert.h"
 #include "Common/FileInfo.h"
 #include "Common/Trace__.h"
 #include "Parsing/Factory.h"
 #include "Parsing/Lexeme.h"
 #include "Parsing/LexemeMap.h"
+#include "Parsing/SourceBuffer.h"
 #include "Parsing/TokenMap.h"
 #include "Parsing/Unit.h"
+#include <algorithm>
+#include <atomic>
 #include <iostream>
-#include <stack>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 
 #define TRACE_NAME "Manager"
 
@@ -57,28 +66,33 @@ struct uaiso::Manager::ManagerImpl
     Snapshot snapshot_;
     std::vector<std::string> searchPaths_;
     char behaviour_ { 0 };
+    unsigned workerCount_ { 0 };
+    std::unique_ptr<ProgramCache> cache_;
+    std::unique_ptr<ImportResolver> resolver_;
 
-    std::unique_ptr<Unit> parse(const std::string& code,
-                                FILE* file,
+    template <class InputT>
+    std::unique_ptr<Unit> parse(InputT&& input,
                                 const std::string& fullFileName,
-                                const LineCol& lineCol = LineCol())
+                                const LineCol& lineCol = LineCol(),
+                                bool isDep = false)
     {
         std::unique_ptr<Unit> unit(factory_->makeUnit());
         unit->setFileName(fullFileName);
+        // Only declarations matter in a dependency.
+        if (unit->canSkipBodies())
+            unit->setSkipBodies(isDep);
+        unit->assignInput(std::forward<InputT>(input));
 
-        if (file)
-            unit->assignInput(file);
-        else
-            unit->assignInput(code);
+        // Tokens and lexemes are looked up by position, so the ones left by
+        // an earlier version of the file would be taken for the new ones.
+        tokens_->clear(unit->fileId());
+        lexs_->clear(unit->fileId());
 
         if (lineCol.isEmpty())
             unit->parse(tokens_, lexs_);
         else
             unit->parse(tokens_, lexs_, lineCol);
 
-        if (file)
-            fclose(file);
-
         return unit;
     }
 
@@ -97,8 +111,227 @@ struct uaiso::Manager::ManagerImpl
             binder.ignoreBuiltins();
         if (isDep || (flags & BehaviourFlag::IgnoreAutomaticModules))
             binder.ignoreAutomaticModules();
+        if (!isDep && (flags & BehaviourFlag::BindBodiesLazily)) {
+            // Deferred bodies keep the AST alive, the unit may be dropped.
+            binder.bindBodiesLazily();
+            return binder.bind(std::static_pointer_cast<ProgramAst>(unit->sharedAst()),
+                               unit->fileName());
+        }
         return binder.bind(Program_Cast(unit->ast()), unit->fileName());
     }
+
+    using Programs = std::vector<std::pair<FileId, std::unique_ptr<Program>>>;
+    using Imports = std::vector<std::pair<FileId, std::vector<FileId>>>;
+
+    // Interface hashes of the programs last bound (complete ones only).
+    std::mutex interfacesMutex_;
+    std::unordered_map<FileId, uint64_t> interfaces_;
+    Manager::ReplacementStats stats_;
+
+    // Source of the programs last bound, and how they were bound, so they
+    // can be bound again without going to the disk (where the file may be
+    // different, if it's being edited).
+    struct Source
+    {
+        std::shared_ptr<const std::string> code_;
+        LineCol lineCol_;
+        bool isDep_;
+    };
+    std::mutex sourcesMutex_;
+    std::unordered_map<FileId, Source> sources_;
+
+    void retain(FileId fileId,
+                std::shared_ptr<const std::string> code,
+                const LineCol& lineCol,
+                bool isDep)
+    {
+        std::lock_guard<std::mutex> lock(sourcesMutex_);
+        sources_[fileId] = Source { std::move(code), lineCol, isDep };
+    }
+
+    /*!
+     * \brief rebind
+     *
+     * Parse and bind the retained source of \a fileId again, with the flags
+     * it was first bound with. Return null if there's no retained source.
+     */
+    std::unique_ptr<Program> rebind(FileId fileId)
+    {
+        Source source;
+        {
+            std::lock_guard<std::mutex> lock(sourcesMutex_);
+            auto it = sources_.find(fileId);
+            if (it == sources_.end())
+                return std::unique_ptr<Program>();
+            source = it->second;
+        }
+
+        std::unique_ptr<Unit> unit = parse(*source.code_, FileRegistry::name(fileId),
+                                           source.lineCol_, source.isDep_);
+        if (!unit->ast())
+            return std::unique_ptr<Program>();
+        return bind(unit.get(), source.isDep_);
+    }
+
+    /*!
+     * \brief reload
+     *
+     * Read the file of \a fileId, which changed on disk, and bind it again
+     * the way it was last bound. A file not bound before is taken as a
+     * dependency.
+     */
+    std::unique_ptr<Program> reload(FileId fileId, const std::string& fullFileName)
+    {
+        Source source { nullptr, LineCol(), true };
+        {
+            std::lock_guard<std::mutex> lock(sourcesMutex_);
+            auto it = sources_.find(fileId);
+            if (it != sources_.end())
+                source = it->second;
+        }
+        if (source.isDep_)
+            return load(fullFileName);
+
+        auto buffer = SourceBuffer::load(fullFileName);
+        if (!buffer)
+            return std::unique_ptr<Program>();
+        retain(fileId,
+               std::make_shared<const std::string>(buffer->data(), buffer->size()),
+               source.lineCol_, false);
+        std::unique_ptr<Program> prog = rebind(fileId);
+        // Only complete programs have their interface recorded.
+        if (prog && source.lineCol_.isEmpty())
+            updateInterface(fileId, prog.get());
+        return prog;
+    }
+
+    std::unique_ptr<Program> load(const std::string& fullFileName)
+    {
+        auto buffer = SourceBuffer::load(fullFileName);
+        if (!buffer)
+            return std::unique_ptr<Program>();
+        retain(FileRegistry::insertOrFind(fullFileName),
+               std::make_shared<const std::string>(buffer->data(), buffer->size()),
+               LineCol(), true);
+
+        std::string key;
+        if (cache_) {
+            key = ProgramCache::key(buffer->data(), buffer->size(),
+                                    factory_->langName());
+            lexs_->clear(FileRegistry::find(fullFileName));
+            if (auto prog = cache_->load(key, fullFileName, lexs_)) {
+                updateInterface(FileRegistry::find(fullFileName), prog.get());
+                return prog;
+            }
+        }
+
+        std::unique_ptr<Unit> unit = parse(buffer.get(), fullFileName,
+                                           LineCol(), true);
+        if (!unit->ast())
+            return std::unique_ptr<Program>();
+
+        std::unique_ptr<Program> prog = bind(unit.get(), true);
+        if (!prog)
+            return prog;
+        if (cache_)
+            cache_->store(key, prog.get(), lexs_);
+        updateInterface(FileRegistry::find(fullFileName), prog.get());
+        return prog;
+    }
+
+    /*!
+     * \brief updateInterface
+     *
+     * Record the interface hash of \a prog, which must not have had its
+     * dependencies processed yet, and return whether it changed.
+     */
+    bool updateInterface(FileId fileId, const Program* prog)
+    {
+        const uint64_t hash = prog->interfaceHash();
+        std::lock_guard<std::mutex> lock(interfacesMutex_);
+        auto it = interfaces_.find(fileId);
+        if (it != interfaces_.end() && it->second == hash)
+            return false;
+        interfaces_[fileId] = hash;
+        return true;
+    }
+
+    /*!
+     * \brief replace
+     *
+     * Account for the replacement of the program of \a fileId and, unless
+     * its interface is the same, bind the programs which import it again.
+     */
+    void replace(FileId fileId, bool isSameInterface, Programs& loaded)
+    {
+        ++stats_.replaced_;
+        if (isSameInterface) {
+            ++stats_.cutoffs_;
+            return;
+        }
+        const size_t count = loaded.size();
+        loadDependents(fileId, loaded);
+        stats_.reloaded_ += loaded.size() - count;
+    }
+
+    void processDeps(const Program* prog, FileId fileId, Programs& loaded, Imports& imports);
+
+    /*!
+     * \brief processDeps
+     *
+     * Process the dependencies of all programs \a loaded so far (a null one
+     * stands for a program to be erased).
+     */
+    void processDeps(Programs& loaded, Imports& imports)
+    {
+        const size_t count = loaded.size();
+        for (size_t i = 0; i < count; ++i) {
+            if (loaded[i].second)
+                processDeps(loaded[i].second.get(), loaded[i].first, loaded, imports);
+        }
+    }
+
+    void loadDependents(FileId fileId, Programs& loaded);
+
+    /*!
+     * \brief publish
+     *
+     * Insert the \a loaded programs into the snapshot, as a single version,
+     * and record their \a imports.
+     */
+    void publish(Programs& loaded, Imports& imports)
+    {
+        snapshot_.insertOrReplace(std::move(loaded));
+        for (auto& edges : imports)
+            snapshot_.setImports(edges.first, std::move(edges.second));
+    }
+
+    /*!
+     * \brief forEachParallel
+     *
+     * Call \a func for every index in [0, count), spreading the calls over
+     * the worker threads (the calling thread is one of them).
+     */
+    template <class FuncT>
+    void forEachParallel(size_t count, FuncT func) const
+    {
+        size_t workers = workerCount_ ? workerCount_
+                                      : std::thread::hardware_concurrency();
+        workers = std::max<size_t>(1, std::min(workers, count));
+
+        std::atomic<size_t> next { 0 };
+        auto work = [&next, count, &func] () {
+            for (size_t i = next++; i < count; i = next++)
+                func(i);
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < workers; ++i)
+            threads.emplace_back(work);
+        work();
+        for (auto& thread : threads)
+            thread.join();
+    }
 };
 
 Manager::Manager()
@@ -113,6 +346,8 @@ void Manager::config(Factory *factory,
                      LexemeMap* lexs,
                      Snapshot snapshot)
 {
+    if (factory != P->factory_)
+        P->resolver_.reset(factory ? new ImportResolver(factory) : nullptr);
     P->factory_ = factory;
     P->tokens_ = tokens;
     P->lexs_ = lexs;
@@ -124,6 +359,19 @@ void Manager::addSearchPath(const std::string& searchPath)
     P->searchPaths_.push_back(searchPath);
 }
 
+void Manager::invalidateImports()
+{
+    if (P->resolver_)
+        P->resolver_->invalidate();
+}
+
+ImportResolver::Stats Manager::importStats() const
+{
+    if (!P->resolver_)
+        return ImportResolver::Stats();
+    return P->resolver_->stats();
+}
+
 void Manager::setBehaviour(BehaviourFlags flags)
 {
     P->behaviour_ = flags;
@@ -134,21 +382,61 @@ Manager::BehaviourFlags Manager::behaviour() const
     return BehaviourFlags(P->behaviour_);
 }
 
-void Manager::processCore(Unit* unit)
+void Manager::setWorkerCount(unsigned count)
+{
+    P->workerCount_ = count;
+}
+
+void Manager::setCacheDir(const std::string& dirPath)
+{
+    if (dirPath.empty())
+        P->cache_.reset();
+    else
+        P->cache_.reset(new ProgramCache(dirPath));
+}
+
+unsigned Manager::workerCount() const
+{
+    return P->workerCount_ ? P->workerCount_
+                           : std::max(1u, std::thread::hardware_concurrency());
+}
+
+void Manager::processCore(Unit* unit, bool isComplete)
 {
     std::unique_ptr<Program> prog = P->bind(unit, false);
     if (!prog)
         return;
 
-    P->snapshot_.insertOrReplace(unit->fileName(), std::move(prog));
-
-    processDeps(unit->fileName());
+    // The program is published, together with its dependencies, only after
+    // its environment is complete. If it replaces another one with a
+    // different interface, so are the programs which import it.
+    P->resolver_->revalidate();
+    const FileId fileId = unit->fileId();
+    const bool isReplacement = isComplete && P->snapshot_.find(fileId);
+    const bool isSameInterface = isComplete && !P->updateInterface(fileId, prog.get());
+    ManagerImpl::Programs progs;
+    ManagerImpl::Imports imports;
+    progs.emplace_back(fileId, std::move(prog));
+    if (isReplacement)
+        P->replace(fileId, isSameInterface, progs);
+    P->processDeps(progs, imports);
+    P->publish(progs, imports);
 }
 
 std::unique_ptr<Unit> Manager::process(const std::string& code,
                                        const std::string& fullFileName)
 {
-    return process(code, fullFileName, LineCol());
+    ENSURE_CONFIG;
+
+    std::unique_ptr<Unit> unit = P->parse(code, fullFileName);
+    if (!unit->ast())
+        return unit;
+
+    P->retain(unit->fileId(), std::make_shared<const std::string>(code),
+              LineCol(), false);
+    processCore(unit.get(), true);
+
+    return unit;
 }
 
 std::unique_ptr<Unit> Manager::process(const std::string& code,
@@ -157,11 +445,13 @@ std::unique_ptr<Unit> Manager::process(const std::string& code,
 {
     ENSURE_CONFIG;
 
-    std::unique_ptr<Unit> unit = P->parse(code, nullptr, fullFileName, lineCol);
+    std::unique_ptr<Unit> unit = P->parse(code, fullFileName, lineCol);
     if (!unit->ast())
         return unit;
 
-    processCore(unit.get());
+    P->retain(unit->fileId(), std::make_shared<const std::string>(code),
+              lineCol, false);
+    processCore(unit.get(), lineCol.isEmpty());
 
     return unit;
 }
@@ -171,104 +461,254 @@ std::unique_ptr<Unit> Manager::process(FILE* file,
 {
     ENSURE_CONFIG;
 
-    std::unique_ptr<Unit> unit = P->parse("", file, fullFileName);
+    // The file is read at once, as its contents are retained.
+    std::unique_ptr<SourceBuffer> buffer = SourceBuffer::read(file);
+    fclose(file);
+    if (!buffer)
+        return std::unique_ptr<Unit>();
+    std::unique_ptr<Unit> unit = P->parse(buffer.get(), fullFileName);
     if (!unit->ast())
         return unit;
 
-    processCore(unit.get());
+    P->retain(unit->fileId(),
+              std::make_shared<const std::string>(buffer->data(), buffer->size()),
+              LineCol(), false);
+    processCore(unit.get(), true);
 
     return unit;
 }
 
 void Manager::processDeps(const std::string& fullFileName) const
 {
-    UAISO_ASSERT(P->snapshot_.find(fullFileName), return);
-
-    ImportResolver resolver(P->factory_);
-
-    std::stack<const Program*> progs;
-    progs.push(P->snapshot_.find(fullFileName));
-    std::unordered_set<std::string> visited;
-    visited.insert(fullFileName);
-    DEBUG_TRACE("process dependencies of %s\n", fullFileName.c_str());
-    while (!progs.empty()) {
-        const Program* curProg = progs.top();
-        progs.pop();
-
-        // Inspect all imports and, if any of them is not already in the
-        // snapshot, parse it, bind it, and start tracking it.
-        auto curProgEnv = curProg->env();
-        auto imports = curProgEnv.imports();
-        for (auto import : imports) {
-            DEBUG_TRACE("imported module name: %s\n", import->target().c_str());
-            auto fileNames = resolver.resolve(const_cast<Import*>(import), P->searchPaths_);
-            for (auto& fileName : fileNames) {
-                if (visited.count(fileName))
-                    continue;
-
-                DEBUG_TRACE("candidate file: %s\n", fileName.c_str());
-                Program* otherProg = P->snapshot_.find(fileName);
-                if (!otherProg) {
-                    FILE* file = fopen(fileName.c_str(), "r");
-                    if (!file)
-                        continue;
+    const FileId fileId = FileRegistry::find(fullFileName);
+    UAISO_ASSERT(P->snapshot_.find(fileId), return);
+
+    // The published program isn't modified, readers may be holding it.
+    std::unique_ptr<Program> prog = P->rebind(fileId);
+    UAISO_ASSERT(prog, return);
+
+    P->resolver_->revalidate();
+    ManagerImpl::Programs progs;
+    ManagerImpl::Imports imports;
+    progs.emplace_back(fileId, std::move(prog));
+    P->processDeps(progs, imports);
+    P->publish(progs, imports);
+}
 
-                    std::unique_ptr<Unit> newUnit = P->parse("", file, fileName);
-                    if (!newUnit->ast())
-                        continue;
+void Manager::invalidate(const std::string& fullFileName)
+{
+    UAISO_ASSERT(P->factory_, return);
+
+    const FileId fileId = FileRegistry::insertOrFind(fullFileName);
+    P->resolver_->revalidate();
+    ManagerImpl::Programs progs;
+    ManagerImpl::Imports imports;
+    const uint64_t* prevHash = nullptr;
+    uint64_t hash = 0;
+    {
+        std::lock_guard<std::mutex> lock(P->interfacesMutex_);
+        auto it = P->interfaces_.find(fileId);
+        if (it != P->interfaces_.end()) {
+            hash = it->second;
+            prevHash = &hash;
+        }
+    }
+    bool isSameInterface = false;
+    if (auto prog = P->reload(fileId, fullFileName)) {
+        isSameInterface = prevHash && *prevHash == prog->interfaceHash();
+        progs.emplace_back(fileId, std::move(prog));
+    } else {
+        {
+            std::lock_guard<std::mutex> lock(P->interfacesMutex_);
+            P->interfaces_.erase(fileId);
+        }
+        {
+            std::lock_guard<std::mutex> lock(P->sourcesMutex_);
+            P->sources_.erase(fileId);
+        }
+        // The program is erased from the next version, and so are its imports.
+        progs.emplace_back(fileId, std::unique_ptr<Program>());
+        imports.emplace_back(fileId, std::vector<FileId>());
+    }
+    P->replace(fileId, isSameInterface, progs);
+    P->processDeps(progs, imports);
+    P->publish(progs, imports);
+}
+
+Manager::ReplacementStats Manager::replacementStats() const
+{
+    return P->stats_;
+}
+
+std::vector<std::string> Manager::dependents(const std::string& fullFileName) const
+{
+    std::vector<std::string> fileNames;
+    const FileId fileId = FileRegistry::find(fullFileName);
+    if (fileId.isUnspecified())
+        return fileNames;
+    for (auto otherFileId : P->snapshot_.dependents(fileId))
+        fileNames.push_back(FileRegistry::name(otherFileId));
+    return fileNames;
+}
 
-                    std::unique_ptr<Program> newProg = P->bind(newUnit.get(), true);
-                    if (!newProg)
+void Manager::setUp(TypeChecker* checker, const Snapshot::Version& version) const
+{
+    UAISO_ASSERT(checker, return);
+
+    checker->setTokens(P->tokens_);
+    checker->setTypeInterner(version.types());
+    checker->setResolutionCache(version.resolutions());
+}
+
+void Manager::setUp(CompletionProposer* proposer, const Snapshot::Version& version) const
+{
+    UAISO_ASSERT(proposer, return);
+
+    proposer->setResolutionCache(version.resolutions());
+}
+
+void Manager::ManagerImpl::loadDependents(FileId fileId, Programs& loaded)
+{
+    // The environments of the programs importing the file (directly or not)
+    // refer to the replaced program, so they're bound again, from the source
+    // they were bound from. Published programs aren't modified.
+    std::vector<FileId> deps = snapshot_.dependents(fileId);
+    std::vector<std::unique_ptr<Program>> progs(deps.size());
+    forEachParallel(deps.size(), [this, &deps, &progs] (size_t i) {
+        progs[i] = rebind(deps[i]);
+    });
+
+    for (size_t i = 0; i < deps.size(); ++i) {
+        if (progs[i])
+            loaded.emplace_back(deps[i], std::move(progs[i]));
+    }
+}
+
+void Manager::ManagerImpl::processDeps(const Program* prog,
+                                       FileId fileId,
+                                       Programs& loaded,
+                                       Imports& imports)
+{
+    // Programs not yet published (or erased) take precedence over the
+    // snapshot's.
+    std::unordered_map<FileId, const Program*> pending;
+    for (const auto& other : loaded)
+        pending.emplace(other.first, other.second.get());
+    auto find = [this, &pending] (FileId otherFileId) {
+        auto it = pending.find(otherFileId);
+        return it != pending.end() ? it->second : snapshot_.find(otherFileId);
+    };
+
+    // A file resolved from an import of a program in the current level.
+    struct Dep
+    {
+        const Program* importer_;
+        const Import* import_;
+        std::string fileName_;
+        FileId fileId_;
+        const Program* prog_;
+    };
+
+    std::vector<std::pair<FileId, const Program*>> level;
+    level.emplace_back(fileId, prog);
+    std::unordered_set<FileId> visited;
+    visited.insert(fileId);
+    DEBUG_TRACE("process dependencies of %s\n", FileRegistry::name(fileId).c_str());
+    while (!level.empty()) {
+        // Inspect all imports of the level and collect the files which are
+        // not already in the snapshot.
+        std::vector<Dep> deps;
+        std::vector<size_t> missing;
+        for (const auto& cur : level) {
+            const Program* curProg = cur.second;
+            imports.emplace_back(cur.first, std::vector<FileId>());
+            for (auto import : curProg->env().imports()) {
+                DEBUG_TRACE("imported module name: %s\n", import->target().c_str());
+                auto fileNames = resolver_->resolve(const_cast<Import*>(import), searchPaths_);
+                for (auto& fileName : fileNames) {
+                    const FileId otherFileId = FileRegistry::insertOrFind(fileName);
+                    imports.back().second.push_back(otherFileId);
+                    if (!visited.insert(otherFileId).second)
                         continue;
 
-                    otherProg = newProg.get();
-                    P->snapshot_.insertOrReplace(fileName, std::move(newProg));
+                    DEBUG_TRACE("candidate file: %s\n", fileName.c_str());
+                    const Program* otherProg = find(otherFileId);
+                    if (!otherProg)
+                        missing.push_back(deps.size());
+                    deps.push_back({ curProg, import, fileName, otherFileId, otherProg });
                 }
-                DEBUG_TRACE("import (partially) resolved: %s\n", fileName.c_str());
-                progs.push(otherProg);
-                visited.insert(fileName);
-
-                if (!import->isSelective()) {
-                    std::unique_ptr<Namespace> space;
-                    if (import->isEmbedded())
-                        space.reset(new Namespace);
+            }
+        }
+
+        // Parse them and bind them concurrently.
+        std::vector<std::unique_ptr<Program>> progs(missing.size());
+        forEachParallel(missing.size(), [this, &deps, &missing, &progs] (size_t i) {
+            progs[i] = load(deps[missing[i]].fileName_);
+        });
+
+        // Finally, start tracking them in the importing environments. The
+        // ones already in the snapshot had their own dependencies processed
+        // when inserted, and published programs aren't modified, so only
+        // the new ones are inspected in the next level.
+        level.clear();
+        for (size_t i = 0; i < missing.size(); ++i) {
+            if (!progs[i])
+                continue;
+            Dep& dep = deps[missing[i]];
+            dep.prog_ = progs[i].get();
+            level.emplace_back(dep.fileId_, dep.prog_);
+            loaded.emplace_back(dep.fileId_, std::move(progs[i]));
+        }
+        for (const auto& dep : deps) {
+            if (!dep.prog_)
+                continue;
+
+            const Import* import = dep.import_;
+            const std::string& fileName = dep.fileName_;
+            const Program* otherProg = dep.prog_;
+            auto curProgEnv = dep.importer_->env();
+            DEBUG_TRACE("import (partially) resolved: %s\n", fileName.c_str());
+
+            if (!import->isSelective()) {
+                std::unique_ptr<Namespace> space;
+                if (import->isEmbedded())
+                    space.reset(new Namespace);
+                else
+                    space.reset(new Namespace(import->localName()));
+                space->setEnv(otherProg->env());
+                curProgEnv.injectNamespace(std::move(space), import->isEmbedded());
+                continue;
+            }
+
+            // When the target of a selective import is a module, the
+            // selected items are symbols be inserted into the current
+            // program's environment (under an alternate name if that's
+            // the case). But when the selective import has a package
+            // target, the selected items are modules (files) themselves,
+            // which have already been filter during import resolution.
+            if (import->targetEntity() == Import::Module) {
+                for (auto actualName : import->selectedItems()) {
+                    auto tySym = otherProg->env().searchTypeDecl(actualName);
+                    if (!tySym)
+                        continue;
+
+                    const TypeDecl* cloned = nullptr;
+                    if (auto altName = import->alternateName(actualName))
+                        cloned = tySym->clone(altName);
                     else
-                        space.reset(new Namespace(import->localName()));
-                    space->setEnv(otherProg->env());
-                    curProgEnv.injectNamespace(std::move(space), import->isEmbedded());
-                    continue;
+                        cloned = TypeDecl_Cast(tySym->clone());
+                    curProgEnv.insertTypeDecl(std::unique_ptr<const TypeDecl>(cloned));
                 }
+            } else {
+                auto baseName = FileInfo(fileName).fileBaseName();
+                for (auto actualName : import->selectedItems()) {
+                    if (baseName != actualName->str())
+                        continue;
 
-                // When the target of a selective import is a module, the
-                // selected items are symbols be inserted into the current
-                // program's environment (under an alternate name if that's
-                // the case). But when the selective import has a package
-                // target, the selected items are modules (files) themselves,
-                // which have already been filter during import resolution.
-                if (import->targetEntity() == Import::Module) {
-                    for (auto actualName : import->selectedItems()) {
-                        auto tySym = otherProg->env().searchTypeDecl(actualName);
-                        if (!tySym)
-                            continue;
-
-                        const TypeDecl* cloned = nullptr;
-                        if (auto altName = import->alternateName(actualName))
-                            cloned = tySym->clone(altName);
-                        else
-                            cloned = TypeDecl_Cast(tySym->clone());
-                        curProgEnv.insertTypeDecl(std::unique_ptr<const TypeDecl>(cloned));
-                    }
-                } else {
-                    auto baseName = FileInfo(fileName).fileBaseName();
-                    for (auto actualName : import->selectedItems()) {
-                        if (baseName != actualName->str())
-                            continue;
-
-                        std::unique_ptr<Namespace> space(new Namespace(actualName));
-                        space->setEnv(otherProg->env());
-                        curProgEnv.injectNamespace(std::move(space), import->isEmbedded());
-                        break;
-                    }
+                    std::unique_ptr<Namespace> space(new Namespace(actualName));
+                    space->setEnv(otherProg->env());
+                    curProgEnv.injectNamespace(std::move(space), import->isEmbedded());
+                    break;
                 }
             }
         }
@@ -27,16 +27,19 @@
 #include "Common/Flag.h"
 #include "Common/LineCol.h"
 #include "Common/Pimpl.h"
+#include "Semantic/ImportResolver.h"
+#include "Semantic/Snapshot.h"
 #include <cstdio>
 #include <string>
 #include <vector>
 
 namespace uaiso {
 
+class CompletionProposer;
 class Factory;
 class LexemeMap;
-class Snapshot;
 class TokenMap;
+class TypeChecker;
 class Unit;
 
 /*!
@@ -55,6 +58,25 @@ public:
 
     void addSearchPath(const std::string& searchPath);
 
+    /*!
+     * \brief invalidateImports
+     *
+     * Drop everything cached about import resolution. Otherwise, cached
+     * directory listings are checked against their modification times on
+     * every processing of dependencies.
+     *
+     * \sa ImportResolver
+     */
+    void invalidateImports();
+
+    /*!
+     * \brief importStats
+     * \return
+     *
+     * Return the counters of the import resolution cache.
+     */
+    ImportResolver::Stats importStats() const;
+
     /*!
      * \brief The BehaviourFlag enum
      */
@@ -63,12 +85,19 @@ public:
         None                   = 0,
         IgnoreBuiltins         = 0x1,
         IgnoreAutomaticModules = 0x1 << 1,
+        BindBodiesLazily       = 0x1 << 2, //!< Of processed files, not of dependencies
     };
     UAISO_FLAGGED_ENUM(BehaviourFlag);
 
     /*!
      * \brief setBehavior
      * \param flags
+     *
+     * With BehaviourFlag::BindBodiesLazily, the function bodies of a program
+     * bound through Manager::process are bound on demand, so the returned
+     * unit must be kept alive while that may happen.
+     *
+     * \sa Binder::bindBodiesLazily
      */
     void setBehaviour(BehaviourFlags flags);
 
@@ -78,6 +107,35 @@ public:
      */
     BehaviourFlags behaviour() const;
 
+    /*!
+     * \brief setWorkerCount
+     * \param count
+     *
+     * Set the number of threads on which dependencies are parsed and bound.
+     * A count of zero (the default) means one per hardware thread.
+     */
+    void setWorkerCount(unsigned count);
+
+    /*!
+     * \brief workerCount
+     * \return
+     *
+     * Return the number of threads on which dependencies are parsed and bound.
+     */
+    unsigned workerCount() const;
+
+    /*!
+     * \brief setCacheDir
+     * \param dirPath
+     *
+     * Cache the programs of dependencies in directory \a dirPath (which must
+     * exist), so they're loaded from there, instead of parsed and bound,
+     * while their source is unchanged. An empty path disables the cache.
+     *
+     * \sa ProgramCache
+     */
+    void setCacheDir(const std::string& dirPath);
+
     /*!
      * \brief process
      * \param code
@@ -122,16 +180,100 @@ public:
      * \param fullFileName
      *
      * Expects that a Program associated with the given name is present
-     * in the snapshot and process its dependencies.
+     * in the snapshot and process its dependencies. The program isn't
+     * modified: a new one is bound, from the source the manager retained
+     * when processing the file, and published with its dependencies as a
+     * new version.
+     *
+     * Dependencies are discovered level by level: the files imported by the
+     * current level which aren't in the snapshot are parsed and bound on the
+     * worker threads, while their insertion into the snapshot and into the
+     * importing environments happens on the calling thread, in import order.
+     * The new programs are published in the snapshot as a single version.
      *
-     * \note This is usefull is the AST has already been gone through the Binder.
+     * \note Manager::process already processes the dependencies of the
+     * program, this is usefull once its imports may be resolved differently
+     * (e.g., after a search path is added).
      */
     void processDeps(const std::string& fullFileName) const;
 
+    /*!
+     * \brief invalidate
+     * \param fullFileName
+     *
+     * Reload the file associated with the given name, which changed on disk,
+     * bind the programs which import it (directly or not) again, and
+     * reprocess their dependencies. Other programs are left alone, as are
+     * the importing ones if the interface of the program didn't change
+     * (their environments keep referring to the previous one).
+     *
+     * The file is bound the way it was last bound (as a dependency or not,
+     * up to the same position), or as a dependency if it wasn't bound yet.
+     * If it can't be read anymore, its program is erased from the snapshot.
+     *
+     * The importing programs are bound from the source they were last bound
+     * from, which the manager retains, and the way they were bound then (as
+     * a dependency or not). Their files aren't read again, so code that is
+     * processed but not saved isn't lost.
+     *
+     * \note A program processed through Manager::process replaces the one in
+     * the snapshot in the same way.
+     *
+     * \sa Program::interfaceHash
+     */
+    void invalidate(const std::string& fullFileName);
+
+    /*!
+     * \brief dependents
+     * \param fullFileName
+     * \return
+     *
+     * Return the names of the files whose programs import the one associated
+     * with the given name, directly or not, the closest ones first.
+     */
+    std::vector<std::string> dependents(const std::string& fullFileName) const;
+
+    /*!
+     * \brief setUp
+     * \param checker
+     * \param version
+     *
+     * Set up \a checker to check programs of \a version (pinned from the
+     * snapshot): types are interned in the version's interner and the
+     * resolution of elaborate types is memoized in the version's cache. The
+     * version must stay pinned while \a checker is used.
+     */
+    void setUp(TypeChecker* checker, const Snapshot::Version& version) const;
+
+    /*!
+     * \brief setUp
+     * \param proposer
+     * \param version
+     *
+     * Set up \a proposer to complete programs of \a version, as above.
+     */
+    void setUp(CompletionProposer* proposer, const Snapshot::Version& version) const;
+
+    /*!
+     * \brief The ReplacementStats struct
+     */
+    struct ReplacementStats
+    {
+        size_t replaced_ { 0 }; //!< Programs replaced (or invalidated).
+        size_t cutoffs_ { 0 };  //!< Replacements whose interface was the same.
+        size_t reloaded_ { 0 }; //!< Dependents bound again.
+    };
+
+    /*!
+     * \brief replacementStats
+     * \return
+     */
+    ReplacementStats replacementStats() const;
+
 private:
     DECL_PIMPL(Manager)
 
-    void processCore(Unit* unit);
+    void processCore(Unit* unit, bool isComplete);
 };
 
 } // namespace uaiso
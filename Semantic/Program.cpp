@@ -23,11 +23,184 @@
 
 #include "Semantic/Program.h"
 #include "Semantic/Environment.h"
+#include "Semantic/Import.h"
+#include "Semantic/Precision.h"
+#include "Semantic/Signedness.h"
+#include "Semantic/Symbol.h"
+#include "Semantic/SymbolCast.h"
+#include "Semantic/Type.h"
+#include "Semantic/TypeCast.h"
 #include "Common/FileInfo.h"
 #include "Parsing/Lexeme.h"
+#include <algorithm>
 
 using namespace uaiso;
 
+namespace {
+
+/*!
+ * \brief The InterfaceHasher class
+ *
+ * FNV-1a over a traversal of declarations. Declarations of an environment
+ * are hashed separately and combined in sorted order, so the result doesn't
+ * depend on the order in which they're listed. Only an environment's own
+ * declarations are hashed, not the ones merged into it (like builtins).
+ */
+class InterfaceHasher
+{
+public:
+    uint64_t hashProgram(const Environment& env)
+    {
+        mixValue(hashEnv(env, false));
+
+        // Namespaces are injected according to the imports, once they're
+        // processed, so the imports stand for them. The automatic ones are
+        // skipped, they're the same for every program of a language (and
+        // absent when a program is loaded as a dependency).
+        for (auto import : env.imports()) {
+            if (import->isAutomatic())
+                continue;
+            mix(import->target().data(), import->target().size());
+            mixValue('\0');
+            mixName(import->localName());
+            mixValue(import->isEmbedded());
+            mixValue(import->selectedItems().size());
+            for (auto item : import->selectedItems()) {
+                mixName(item);
+                mixName(import->alternateName(item));
+            }
+        }
+        return hash_;
+    }
+
+    uint64_t hashEnv(const Environment& env, bool paramsOnly)
+    {
+        std::vector<uint64_t> hashes;
+        for (auto decl : env.listOwnDecls()) {
+            if (paramsOnly && decl->kind() != Symbol::Kind::Param)
+                continue;
+            InterfaceHasher hasher;
+            hasher.decl(decl);
+            hashes.push_back(hasher.hash_);
+        }
+        std::sort(hashes.begin(), hashes.end());
+        InterfaceHasher hasher;
+        for (auto hash : hashes)
+            hasher.mix(&hash, sizeof(hash));
+        return hasher.hash_;
+    }
+
+private:
+    void mix(const void* data, size_t len)
+    {
+        auto bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < len; ++i) {
+            hash_ ^= bytes[i];
+            hash_ *= 0x100000001b3ull;
+        }
+    }
+
+    template <class T>
+    void mixValue(T value)
+    {
+        mix(&value, sizeof(value));
+    }
+
+    void mixName(const Ident* name)
+    {
+        if (!name) {
+            mixValue('\0');
+            return;
+        }
+        mix(name->str().data(), name->str().size());
+        mixValue('\0');
+    }
+
+    void mixEnv(const Environment& env, bool paramsOnly)
+    {
+        mixValue(hashEnv(env, paramsOnly));
+    }
+
+    void decl(const Decl* decl)
+    {
+        mixValue(decl->kind());
+        mixName(decl->name());
+        mixValue(decl->visibility());
+        mixValue(decl->storage());
+        mixValue(decl->declAttrs());
+
+        if (isTypeDecl(decl)) {
+            auto tyDecl = ConstTypeDecl_Cast(decl);
+            type(tyDecl->type());
+            // Only the parameters of a function are visible, not its locals.
+            if (decl->kind() == Symbol::Kind::Func)
+                mixEnv(ConstFunc_Cast(decl)->env(), true);
+            else if (decl->kind() == Symbol::Kind::Enum)
+                type(ConstEnum_Cast(decl)->underlyingType());
+        } else if (decl->kind() != Symbol::Kind::BaseRecord) {
+            type(ConstValueDecl_Cast(decl)->valueType());
+        }
+    }
+
+    void type(const Type* ty)
+    {
+        if (!ty) {
+            mixValue('\0');
+            return;
+        }
+
+        mixValue(ty->kind());
+        switch (ty->kind()) {
+        case Type::Kind::Array:
+            type(ConstArrayType_Cast(ty)->keyType());
+            mixValue(ConstArrayType_Cast(ty)->variety());
+            // Fallthrough.
+        case Type::Kind::Chan:
+        case Type::Kind::Ptr:
+        case Type::Kind::Subrange:
+            type(ConstOpaqueType_Cast(ty)->baseType());
+            break;
+
+        case Type::Kind::Elaborate:
+            mixName(ConstElaborateType_Cast(ty)->name());
+            break;
+
+        case Type::Kind::Enum:
+            mixEnv(ConstEnumType_Cast(ty)->env(), false);
+            break;
+
+        case Type::Kind::Float:
+            mixValue(ConstFloatType_Cast(ty)->precision());
+            break;
+
+        case Type::Kind::Func:
+            type(ConstFuncType_Cast(ty)->returnType());
+            break;
+
+        case Type::Kind::Int:
+            mixValue(ConstIntType_Cast(ty)->signedness());
+            mixValue(ConstIntType_Cast(ty)->precision());
+            break;
+
+        case Type::Kind::Record: {
+            auto recTy = ConstRecordType_Cast(ty);
+            mixValue(recTy->variety());
+            for (auto base : recTy->bases())
+                mixName(base->name());
+            mixEnv(recTy->env(), false);
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+
+    uint64_t hash_ { 0xcbf29ce484222325ull };
+};
+
+} // anonymous
+
 struct uaiso::Program::ModuleImpl
 {
     ModuleImpl(const std::string& fullFileName)
@@ -69,3 +242,8 @@ Environment Program::env() const
 {
     return P->env_;
 }
+
+uint64_t Program::interfaceHash() const
+{
+    return InterfaceHasher().hashProgram(P->env_);
+}
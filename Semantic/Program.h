@@ -26,6 +26,7 @@
 
 #include "Common/Config.h"
 #include "Common/Pimpl.h"
+#include <cstdint>
 #include <string>
 
 namespace uaiso {
@@ -48,6 +49,22 @@ public:
     void setEnv(Environment env);
     Environment env() const;
 
+    /*!
+     * \brief interfaceHash
+     * \return
+     *
+     * Return a hash of what other programs see of this one: the names, kinds,
+     * types, and visibility of its top-level declarations, record members,
+     * and function parameters included, along with its imports. Function
+     * bodies and source locations don't take part, so edits confined to them
+     * keep the hash. Neither do builtins nor automatic imports, so the hash
+     * is the same whether the program is bound as a dependency or not.
+     *
+     * \note Declarations imported into the environment do take part, so
+     * the hash is meant to be taken right after binding.
+     */
+    uint64_t interfaceHash() const;
+
 private:
     DECL_PIMPL(Module)
 };
@@ -0,0 +1,788 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#include "Semantic/ProgramCache.h"
+#include "Semantic/Environment.h"
+#include "Semantic/Import.h"
+#include "Semantic/Program.h"
+#include "Semantic/Symbol.h"
+#include "Semantic/Type.h"
+#include "Common/Assert.h"
+#include "Common/FileInfo.h"
+#include "Common/Trace__.h"
+#include "Parsing/Lexeme.h"
+#include "Parsing/LexemeMap.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#define TRACE_NAME "ProgramCache"
+
+using namespace uaiso;
+
+namespace {
+
+const char kMagic[] = "UAISOPC";
+
+// Bump whenever the binder or the format below changes.
+const uint32_t kFormatVersion = 1;
+
+const char kEntrySuffix[] = ".uaisopc";
+
+/*
+ * Entry layout (all integers as varints, signed ones zigzag-encoded):
+ *
+ *   magic, format version
+ *   identifiers: count, then spelling and line/col (-1 if not in the file)
+ *   program environment (see Writer::env)
+ */
+
+class Writer final
+{
+public:
+    Writer(FileId fileId, const LexemeMap* lexs)
+        : fileId_(fileId)
+    {
+        for (auto info : lexs->list<Ident>(fileId)) {
+            identLocs_.emplace(std::get<0>(info), std::get<1>(info));
+        }
+    }
+
+    std::string finish()
+    {
+        std::string body;
+        std::swap(body, out_);
+        out_.append(kMagic, sizeof(kMagic));
+        uint(kFormatVersion);
+        uint(idents_.size());
+        for (auto ident : idents_) {
+            str(ident->str());
+            auto it = identLocs_.find(ident);
+            if (it != identLocs_.end()) {
+                sint(it->second.line_);
+                sint(it->second.col_);
+            } else {
+                sint(-1);
+                sint(-1);
+            }
+        }
+        out_ += body;
+        return std::move(out_);
+    }
+
+    void uint(uint64_t value)
+    {
+        while (value >= 0x80) {
+            out_.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out_.push_back(static_cast<char>(value));
+    }
+
+    void sint(int64_t value)
+    {
+        uint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    void str(const std::string& s)
+    {
+        uint(s.size());
+        out_ += s;
+    }
+
+    void ident(const Ident* ident)
+    {
+        if (!ident) {
+            uint(0);
+            return;
+        }
+        auto it = identIdx_.find(ident);
+        if (it == identIdx_.end()) {
+            it = identIdx_.emplace(ident, idents_.size() + 1).first;
+            idents_.push_back(ident);
+        }
+        uint(it->second);
+    }
+
+    void loc(const SourceLoc& loc)
+    {
+        if (loc.fileId_.isUnspecified()) {
+            uint(0);
+        } else if (loc.fileId_ == fileId_) {
+            uint(1);
+        } else {
+            uint(2);
+            str(loc.fileName());
+        }
+        sint(loc.line_);
+        sint(loc.col_);
+        sint(loc.lastLine_);
+        sint(loc.lastCol_);
+    }
+
+    void type(const Type* ty)
+    {
+        if (!ty) {
+            uint(0);
+            return;
+        }
+        uint(static_cast<uint64_t>(ty->kind()) + 1);
+        uint(static_cast<unsigned char>(ty->typeQuals()));
+
+        switch (ty->kind()) {
+        case Type::Kind::Array: {
+            auto arrTy = ConstArrayType_Cast(ty);
+            type(arrTy->baseType());
+            uint(static_cast<uint64_t>(arrTy->variety()));
+            type(arrTy->keyType());
+            break;
+        }
+        case Type::Kind::Chan: {
+            auto chanTy = ConstChanType_Cast(ty);
+            type(chanTy->baseType());
+            uint(static_cast<uint64_t>(chanTy->variety()));
+            break;
+        }
+        case Type::Kind::Elaborate:
+            ident(ConstElaborateType_Cast(ty)->name());
+            break;
+        case Type::Kind::Enum:
+            env(ConstEnumType_Cast(ty)->env(), false);
+            break;
+        case Type::Kind::Float:
+            uint(static_cast<uint64_t>(ConstFloatType_Cast(ty)->precision()));
+            break;
+        case Type::Kind::Func:
+            type(ConstFuncType_Cast(ty)->returnType());
+            break;
+        case Type::Kind::Int: {
+            auto intTy = ConstIntType_Cast(ty);
+            uint(static_cast<uint64_t>(intTy->signedness()));
+            uint(static_cast<uint64_t>(intTy->precision()));
+            break;
+        }
+        case Type::Kind::Ptr:
+            type(ConstPtrType_Cast(ty)->baseType());
+            break;
+        case Type::Kind::Subrange:
+            type(ConstSubrangeType_Cast(ty)->baseType());
+            break;
+        case Type::Kind::Record: {
+            auto recTy = ConstRecordType_Cast(ty);
+            uint(static_cast<uint64_t>(recTy->variety()));
+            env(recTy->env(), false);
+            auto bases = recTy->bases();
+            uint(bases.size());
+            for (auto base : bases)
+                symbol(base);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    void symbol(const Symbol* sym)
+    {
+        uint(static_cast<uint64_t>(sym->kind()));
+        uint(sym->isBuiltin() | sym->isFake() << 1);
+        loc(sym->sourceLoc());
+
+        UAISO_ASSERT(isDecl(sym) || sym->kind() == Symbol::Kind::BaseRecord, return);
+        auto decl = ConstDeclSymbol_Cast(sym);
+        ident(decl->name());
+        uint(static_cast<uint64_t>(decl->visibility()));
+        uint(static_cast<uint64_t>(decl->storage()));
+        uint(static_cast<uint64_t>(decl->linkage()));
+        uint(decl->isMarkedAuto());
+        uint(static_cast<uint16_t>(decl->declAttrs()));
+
+        switch (sym->kind()) {
+        case Symbol::Kind::Alias:
+        case Symbol::Kind::Placeholder:
+            type(ConstTypeDecl_Cast(sym)->type());
+            break;
+        case Symbol::Kind::Enum: {
+            auto enumSym = ConstEnum_Cast(sym);
+            type(enumSym->underlyingType());
+            type(enumSym->type());
+            break;
+        }
+        case Symbol::Kind::Func: {
+            auto func = ConstFunc_Cast(sym);
+            type(func->type());
+            env(func->env(), false);
+            break;
+        }
+        case Symbol::Kind::Record:
+            type(ConstRecord_Cast(sym)->type());
+            break;
+        case Symbol::Kind::Param: {
+            auto param = ConstParam_Cast(sym);
+            type(param->valueType());
+            uint(static_cast<uint64_t>(param->direction()));
+            uint(static_cast<uint64_t>(param->evalStrategy()));
+            break;
+        }
+        case Symbol::Kind::EnumItem:
+        case Symbol::Kind::Var:
+            type(ConstValueDecl_Cast(sym)->valueType());
+            break;
+        default:
+            break;
+        }
+    }
+
+    /*
+     * An environment is written once, later occurrences (e.g., a function
+     * sharing the environment of its enclosing scope) refer back to it.
+     */
+    void env(Environment env, bool withImports)
+    {
+        for (size_t i = 0; i < envs_.size(); ++i) {
+            if (envs_[i] == env) {
+                uint(i + 1);
+                return;
+            }
+        }
+        uint(0);
+        envs_.push_back(env);
+
+        uint(env.isRootEnv());
+        auto tyDecls = env.listTypeDecls();
+        uint(tyDecls.size());
+        for (auto decl : tyDecls)
+            symbol(decl);
+        auto valDecls = env.listValueDecls();
+        uint(valDecls.size());
+        for (auto decl : valDecls)
+            symbol(decl);
+
+        if (!withImports)
+            return;
+        auto imports = env.imports();
+        uint(imports.size());
+        for (auto import : imports) {
+            str(import->fromWhere());
+            str(import->target());
+            ident(import->localName());
+            uint(import->isEmbedded());
+            uint(import->selectedItems().size());
+            for (auto item : import->selectedItems()) {
+                ident(item);
+                ident(import->alternateName(item));
+            }
+        }
+    }
+
+private:
+    FileId fileId_;
+    std::string out_;
+    std::unordered_map<const Ident*, LineCol> identLocs_;
+    std::unordered_map<const Ident*, size_t> identIdx_;
+    std::vector<const Ident*> idents_;
+    std::vector<Environment> envs_;
+};
+
+// Whether a type of \a kind may be read as a TypeT.
+template <class TypeT>
+bool isKindOf(Type::Kind) { return true; }
+
+template <>
+bool isKindOf<EnumType>(Type::Kind kind) { return kind == Type::Kind::Enum; }
+
+template <>
+bool isKindOf<FuncType>(Type::Kind kind) { return kind == Type::Kind::Func; }
+
+template <>
+bool isKindOf<RecordType>(Type::Kind kind) { return kind == Type::Kind::Record; }
+
+class Reader final
+{
+public:
+    Reader(const std::string& data, FileId fileId, LexemeMap* lexs)
+        : cur_(data.data())
+        , end_(data.data() + data.size())
+        , fileId_(fileId)
+        , lexs_(lexs)
+    {}
+
+    bool header()
+    {
+        if (size_t(end_ - cur_) < sizeof(kMagic)
+                || memcmp(cur_, kMagic, sizeof(kMagic)))
+            return false;
+        cur_ += sizeof(kMagic);
+        if (uint() != kFormatVersion)
+            return false;
+
+        auto cnt = uint();
+        for (uint64_t i = 0; ok_ && i < cnt; ++i) {
+            const std::string spell = str();
+            const int line = static_cast<int>(sint());
+            const int col = static_cast<int>(sint());
+            const Ident* ident;
+            if (line < 0)
+                ident = lexs_->findAnyOf<Ident>(spell);
+            else
+                ident = lexs_->insertOrFind<Ident>(spell, fileId_, LineCol(line, col));
+            // An identifier from elsewhere which isn't known (yet).
+            if (!ident)
+                ok_ = false;
+            idents_.push_back(ident);
+        }
+        return ok_;
+    }
+
+    bool ok() const { return ok_; }
+
+    uint64_t uint()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (cur_ == end_) {
+                ok_ = false;
+                return 0;
+            }
+            const unsigned char byte = *cur_++;
+            value |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+        ok_ = false;
+        return 0;
+    }
+
+    int64_t sint()
+    {
+        const uint64_t value = uint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    std::string str()
+    {
+        const uint64_t len = uint();
+        if (len > uint64_t(end_ - cur_)) {
+            ok_ = false;
+            return std::string();
+        }
+        std::string s(cur_, len);
+        cur_ += len;
+        return s;
+    }
+
+    const Ident* ident()
+    {
+        const uint64_t idx = uint();
+        if (idx > idents_.size()) {
+            ok_ = false;
+            return nullptr;
+        }
+        return idx ? idents_[idx - 1] : nullptr;
+    }
+
+    SourceLoc loc()
+    {
+        FileId fileId;
+        switch (uint()) {
+        case 0:
+            break;
+        case 1:
+            fileId = fileId_;
+            break;
+        default:
+            fileId = FileRegistry::insertOrFind(str());
+            break;
+        }
+        const int line = static_cast<int>(sint());
+        const int col = static_cast<int>(sint());
+        const int lastLine = static_cast<int>(sint());
+        const int lastCol = static_cast<int>(sint());
+        return SourceLoc(line, col, lastLine, lastCol, fileId);
+    }
+
+    template <class TypeT = Type>
+    std::unique_ptr<TypeT> type(Environment outer)
+    {
+        const uint64_t tag = uint();
+        if (!tag || !ok_)
+            return std::unique_ptr<TypeT>();
+        const auto kind = static_cast<Type::Kind>(tag - 1);
+        const TypeQualFlags quals(static_cast<char>(uint()));
+
+        std::unique_ptr<Type> ty;
+        switch (kind) {
+        case Type::Kind::Array: {
+            std::unique_ptr<ArrayType> arrTy(new ArrayType(type(outer)));
+            arrTy->setVariety(static_cast<ArrayVariety>(uint()));
+            arrTy->setKeyType(type(outer));
+            ty = std::move(arrTy);
+            break;
+        }
+        case Type::Kind::Bool:
+            ty.reset(new BoolType);
+            break;
+        case Type::Kind::Chan: {
+            std::unique_ptr<ChanType> chanTy(new ChanType(type(outer)));
+            chanTy->setVariety(static_cast<ChanVariety>(uint()));
+            ty = std::move(chanTy);
+            break;
+        }
+        case Type::Kind::Elaborate:
+            ty.reset(new ElaborateType(ident()));
+            break;
+        case Type::Kind::Enum: {
+            std::unique_ptr<EnumType> enumTy(new EnumType);
+            enumTy->setEnv(env(outer, false));
+            ty = std::move(enumTy);
+            break;
+        }
+        case Type::Kind::Float:
+            ty.reset(new FloatType(static_cast<Precision>(uint())));
+            break;
+        case Type::Kind::Func: {
+            std::unique_ptr<FuncType> funcTy(new FuncType);
+            funcTy->setReturnType(type(outer));
+            ty = std::move(funcTy);
+            break;
+        }
+        case Type::Kind::Inferred:
+            ty.reset(new InferredType);
+            break;
+        case Type::Kind::Int: {
+            const auto signedness = static_cast<Signedness>(uint());
+            ty.reset(new IntType(signedness, static_cast<Precision>(uint())));
+            break;
+        }
+        case Type::Kind::Ptr:
+            ty.reset(new PtrType(type(outer)));
+            break;
+        case Type::Kind::Record: {
+            std::unique_ptr<RecordType> recTy(new RecordType);
+            recTy->setVariety(static_cast<RecordVariety>(uint()));
+            recTy->setEnv(env(outer, false));
+            const uint64_t cnt = uint();
+            for (uint64_t i = 0; ok_ && i < cnt; ++i) {
+                auto base = symbol(outer);
+                if (base && base->kind() == Symbol::Kind::BaseRecord)
+                    recTy->addBase(std::unique_ptr<BaseRecord>(BaseRecord_Cast(base.release())));
+                else
+                    ok_ = false;
+            }
+            ty = std::move(recTy);
+            break;
+        }
+        case Type::Kind::Str:
+            ty.reset(new StrType);
+            break;
+        case Type::Kind::Subrange:
+            ty.reset(new SubrangeType(type(outer)));
+            break;
+        case Type::Kind::Void:
+            ty.reset(new VoidType);
+            break;
+        default:
+            ok_ = false;
+            return std::unique_ptr<TypeT>();
+        }
+        ty->setTypeQuals(quals);
+
+        // A corrupt entry may have a different type where a specific one
+        // is expected.
+        if (!isKindOf<TypeT>(ty->kind())) {
+            ok_ = false;
+            return std::unique_ptr<TypeT>();
+        }
+
+        return std::unique_ptr<TypeT>(static_cast<TypeT*>(ty.release()));
+    }
+
+    std::unique_ptr<Symbol> symbol(Environment outer)
+    {
+        const auto kind = static_cast<Symbol::Kind>(uint());
+        const uint64_t bits = uint();
+        const SourceLoc sourceLoc = loc();
+        const Ident* name = ident();
+
+        std::unique_ptr<Decl> decl;
+        switch (kind) {
+        case Symbol::Kind::Alias:
+            decl.reset(new Alias(name));
+            break;
+        case Symbol::Kind::BaseRecord:
+            decl.reset(new BaseRecord(name));
+            break;
+        case Symbol::Kind::Enum:
+            decl.reset(new Enum(name));
+            break;
+        case Symbol::Kind::EnumItem:
+            decl.reset(new EnumItem(name));
+            break;
+        case Symbol::Kind::Func:
+            decl.reset(new Func(name));
+            break;
+        case Symbol::Kind::Param:
+            decl.reset(new Param(name));
+            break;
+        case Symbol::Kind::Placeholder:
+            decl.reset(new Placeholder(name));
+            break;
+        case Symbol::Kind::Record:
+            decl.reset(new Record(name));
+            break;
+        case Symbol::Kind::Var:
+            decl.reset(new Var(name));
+            break;
+        default:
+            ok_ = false;
+            return std::unique_ptr<Symbol>();
+        }
+
+        decl->setIsBuiltin(bits & 0x1);
+        decl->setIsFake(bits & 0x2);
+        decl->setSourceLoc(sourceLoc);
+        decl->setVisibility(static_cast<Decl::Visibility>(uint()));
+        decl->setStorage(static_cast<Decl::Storage>(uint()));
+        decl->setLinkage(static_cast<Decl::Linkage>(uint()));
+        if (uint())
+            decl->markAsAuto();
+        decl->setDeclAttrs(DeclAttrFlags(static_cast<uint16_t>(uint())));
+
+        switch (kind) {
+        case Symbol::Kind::Alias:
+        case Symbol::Kind::Placeholder:
+            TypeDecl_Cast(decl.get())->setType(type(outer));
+            break;
+        case Symbol::Kind::Enum: {
+            auto enumSym = Enum_Cast(decl.get());
+            enumSym->setUnderlyingType(type(outer));
+            enumSym->setType(type<EnumType>(outer));
+            break;
+        }
+        case Symbol::Kind::Func: {
+            auto func = Func_Cast(decl.get());
+            func->setType(type<FuncType>(outer));
+            func->setEnv(env(outer, false));
+            break;
+        }
+        case Symbol::Kind::Record:
+            Record_Cast(decl.get())->setType(type<RecordType>(outer));
+            break;
+        case Symbol::Kind::Param: {
+            auto param = Param_Cast(decl.get());
+            param->setValueType(type(outer));
+            param->setDirection(static_cast<Param::Direction>(uint()));
+            param->setEvalStrategy(static_cast<Param::EvalStrategy>(uint()));
+            break;
+        }
+        case Symbol::Kind::EnumItem:
+        case Symbol::Kind::Var:
+            ValueDecl_Cast(decl.get())->setValueType(type(outer));
+            break;
+        default:
+            break;
+        }
+
+        return decl;
+    }
+
+    Environment env(Environment outer, bool withImports)
+    {
+        const uint64_t ref = uint();
+        if (ref) {
+            if (ref > envs_.size()) {
+                ok_ = false;
+                return Environment();
+            }
+            return envs_[ref - 1];
+        }
+
+        Environment env = uint() ? Environment() : outer.createSubEnv();
+        envs_.push_back(env);
+
+        uint64_t cnt = uint();
+        for (uint64_t i = 0; ok_ && i < cnt; ++i) {
+            auto sym = symbol(env);
+            if (sym && isTypeDecl(sym.get()))
+                env.insertTypeDecl(std::unique_ptr<const TypeDecl>(TypeDecl_Cast(sym.release())));
+            else
+                ok_ = false;
+        }
+        cnt = uint();
+        for (uint64_t i = 0; ok_ && i < cnt; ++i) {
+            auto sym = symbol(env);
+            if (sym && isValueDecl(sym.get()))
+                env.insertValueDecl(std::unique_ptr<const ValueDecl>(ValueDecl_Cast(sym.release())));
+            else
+                ok_ = false;
+        }
+
+        if (!withImports)
+            return env;
+        cnt = uint();
+        for (uint64_t i = 0; ok_ && i < cnt; ++i) {
+            const std::string fromWhere = str();
+            const std::string target = str();
+            const Ident* localName = ident();
+            const bool isEmbedded = uint();
+            std::unique_ptr<Import> import(new Import(fromWhere, target, localName, isEmbedded));
+            const uint64_t itemCnt = uint();
+            for (uint64_t j = 0; ok_ && j < itemCnt; ++j) {
+                auto actualName = ident();
+                auto alternateName = ident();
+                if (alternateName)
+                    import->addSelectedItem(actualName, alternateName);
+                else
+                    import->addSelectedItem(actualName);
+            }
+            env.includeImport(std::move(import));
+        }
+        return env;
+    }
+
+private:
+    const char* cur_;
+    const char* end_;
+    FileId fileId_;
+    LexemeMap* lexs_;
+    bool ok_ { true };
+    std::vector<const Ident*> idents_;
+    std::vector<Environment> envs_;
+};
+
+} // anonymous
+
+struct uaiso::ProgramCache::ProgramCacheImpl
+{
+    ProgramCacheImpl(const std::string& dirPath)
+        : dirPath_(dirPath)
+    {
+        if (!dirPath_.empty() && dirPath_.back() != FileInfo::dirSeparator())
+            dirPath_ += FileInfo::dirSeparator();
+    }
+
+    std::string entryPath(const std::string& key) const
+    {
+        return dirPath_ + key + kEntrySuffix;
+    }
+
+    std::string dirPath_;
+};
+
+ProgramCache::ProgramCache(const std::string& dirPath)
+    : P(new ProgramCacheImpl(dirPath))
+{}
+
+ProgramCache::~ProgramCache()
+{}
+
+const std::string& ProgramCache::dirPath() const
+{
+    return P->dirPath_;
+}
+
+std::string ProgramCache::key(const char* code, size_t len, LangId langId)
+{
+    // FNV-1a, over the code and then the language and format version.
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash] (unsigned char byte) {
+        hash ^= byte;
+        hash *= 0x100000001b3ull;
+    };
+    for (size_t i = 0; i < len; ++i)
+        mix(code[i]);
+    mix(static_cast<unsigned char>(langId));
+    for (int i = 0; i < 4; ++i)
+        mix(static_cast<unsigned char>(kFormatVersion >> (8 * i)));
+
+    char buff[24];
+    snprintf(buff, sizeof(buff), "%016llx%02x",
+             static_cast<unsigned long long>(hash),
+             static_cast<unsigned>(len & 0xff));
+    return buff;
+}
+
+std::unique_ptr<Program> ProgramCache::load(const std::string& key,
+                                            const std::string& fullFileName,
+                                            LexemeMap* lexs) const
+{
+    std::ifstream ifs(P->entryPath(key), std::ios::binary);
+    if (!ifs.is_open())
+        return std::unique_ptr<Program>();
+    std::ostringstream oss;
+    oss << ifs.rdbuf();
+    const std::string data = oss.str();
+
+    Reader reader(data, FileRegistry::insertOrFind(fullFileName), lexs);
+    if (!reader.header()) {
+        DEBUG_TRACE("discard entry %s\n", key.c_str());
+        return std::unique_ptr<Program>();
+    }
+
+    Environment env = reader.env(Environment(), true);
+    if (!reader.ok()) {
+        DEBUG_TRACE("discard entry %s\n", key.c_str());
+        return std::unique_ptr<Program>();
+    }
+
+    std::unique_ptr<Program> prog(new Program(fullFileName));
+    prog->setEnv(env);
+    return prog;
+}
+
+bool ProgramCache::store(const std::string& key,
+                         const Program* prog,
+                         const LexemeMap* lexs) const
+{
+    const std::string fullFileName = prog->fileInfo().fullFileName();
+    Writer writer(FileRegistry::find(fullFileName), lexs);
+    writer.env(prog->env(), true);
+    const std::string data = writer.finish();
+
+    // Write to a name unique to this thread (and process), then publish the
+    // entry under its actual name.
+    static const unsigned salt = std::random_device()();
+    static std::atomic<unsigned> tmpCnt { 0 };
+    std::ostringstream tmpPath;
+    tmpPath << P->entryPath(key) << "." << std::hex << salt << "."
+            << std::this_thread::get_id() << "." << tmpCnt++;
+    {
+        std::ofstream ofs(tmpPath.str(), std::ios::binary | std::ios::trunc);
+        if (!ofs.is_open())
+            return false;
+        ofs.write(data.data(), data.size());
+        if (!ofs)
+            return false;
+    }
+    if (std::rename(tmpPath.str().c_str(), P->entryPath(key).c_str())) {
+        std::remove(tmpPath.str().c_str());
+        return false;
+    }
+    return true;
+}
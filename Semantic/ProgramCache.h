@@ -0,0 +1,104 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#ifndef UAISO_PROGRAMCACHE_H__
+#define UAISO_PROGRAMCACHE_H__
+
+#include "Common/Config.h"
+#include "Common/Pimpl.h"
+#include "Common/Test.h"
+#include "Parsing/LangId.h"
+#include <memory>
+#include <string>
+
+namespace uaiso {
+
+class LexemeMap;
+class Program;
+
+/*!
+ * \brief The ProgramCache class
+ *
+ * An on-disk cache of bound programs, one file per program in the cache
+ * directory, named after a key which is a hash of the source code, its
+ * language, and the format version (bumped whenever binding or the format
+ * itself changes).
+ *
+ * What's stored is the program's interface: the symbols of its environment
+ * (and of the environments of records, enums and functions), with their
+ * types and source locations, together with the imports. Environments of
+ * nested blocks are not.
+ *
+ * Entries are written to a temporary file and renamed, so a cache directory
+ * can be shared by concurrent threads and processes.
+ */
+class UAISO_API ProgramCache final
+{
+public:
+    /*!
+     * \brief ProgramCache
+     *
+     * Create a cache at directory \a dirPath, which must exist.
+     */
+    ProgramCache(const std::string& dirPath);
+    ~ProgramCache();
+
+    const std::string& dirPath() const;
+
+    /*!
+     * \brief key
+     *
+     * Return the key of the \a len chars of source \a code in language
+     * \a langId.
+     */
+    static std::string key(const char* code, size_t len, LangId langId);
+
+    /*!
+     * \brief load
+     *
+     * Return the program of file \a fullFileName stored under \a key, with
+     * its identifiers interned in \a lexs. If there's no such entry, or if
+     * it can't be read, return null.
+     */
+    std::unique_ptr<Program> load(const std::string& key,
+                                  const std::string& fullFileName,
+                                  LexemeMap* lexs) const;
+
+    /*!
+     * \brief store
+     *
+     * Store program \a prog, whose identifiers are interned in \a lexs,
+     * under \a key. Return whether the entry could be written.
+     */
+    bool store(const std::string& key,
+               const Program* prog,
+               const LexemeMap* lexs) const;
+
+private:
+    DECL_PIMPL(ProgramCache)
+    DECL_CLASS_TEST(ProgramCache)
+};
+
+} // namespace uaiso
+
+#endif
@@ -0,0 +1,293 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#include "Semantic/ProgramCache.h"
+#include "Semantic/Binder.h"
+#include "Semantic/Environment.h"
+#include "Semantic/Import.h"
+#include "Semantic/Program.h"
+#include "Semantic/Symbol.h"
+#include "Semantic/Type.h"
+#include "Ast/Ast.h"
+#include "Common/FileInfo.h"
+#include "Parsing/Factory.h"
+#include "Parsing/Lexeme.h"
+#include "Parsing/LexemeMap.h"
+#include "Parsing/TokenMap.h"
+#include "Parsing/Unit.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+using namespace uaiso;
+
+class ProgramCache::ProgramCacheTest : public Test
+{
+public:
+    TEST_RUN(ProgramCacheTest
+             , &ProgramCacheTest::testCase1
+             , &ProgramCacheTest::testCase2
+             , &ProgramCacheTest::testCase3
+             , &ProgramCacheTest::testCase4
+             )
+
+    ProgramCacheTest()
+    {
+        char dirTemplate[] = "/tmp/uaiso_program_cache_XXXXXX";
+        if (mkdtemp(dirTemplate))
+            dirPath_ = dirTemplate;
+    }
+
+    ~ProgramCacheTest()
+    {
+        for (const auto& fileName : written_)
+            std::remove(fileName.c_str());
+        rmdir(dirPath_.c_str());
+    }
+
+    std::string dirPath_;
+    std::vector<std::string> written_;
+
+    const std::string source_ =
+        "import os\n"
+        "from pkg.mod import a as b, c\n"
+        "\n"
+        "class C(Base):\n"
+        "    def __init__(self, x):\n"
+        "        self.x = x\n"
+        "    def m(self, y=1):\n"
+        "        return y\n"
+        "\n"
+        "def f(p, q):\n"
+        "    return p\n"
+        "\n"
+        "v = 10\n";
+
+    std::unique_ptr<Program> bind(const std::string& fileName,
+                                  TokenMap* tokens,
+                                  LexemeMap* lexs)
+    {
+        auto factory = FactoryCreator::create(LangId::Py);
+        std::unique_ptr<Unit> unit = factory->makeUnit();
+        unit->setFileName(fileName);
+        unit->assignInput(source_);
+        unit->parse(tokens, lexs);
+        UAISO_EXPECT_TRUE(unit->ast());
+
+        Binder binder(factory.get());
+        binder.setLexemes(lexs);
+        binder.setTokens(tokens);
+        binder.ignoreBuiltins();
+        binder.ignoreAutomaticModules();
+        return binder.bind(Program_Cast(unit->ast()), fileName);
+    }
+
+    std::string keyOf(const std::string& code, LangId langId)
+    {
+        auto key = ProgramCache::key(code.c_str(), code.size(), langId);
+        written_.push_back(dirPath_ + "/" + key + ".uaisopc");
+        return key;
+    }
+
+    // Environments are dumped in a canonical form (sorted by name), so the
+    // original and the reloaded programs can be compared.
+    static void dumpType(const Type* ty, std::ostream& os, int depth)
+    {
+        if (!ty) {
+            os << "-";
+            return;
+        }
+        os << "ty" << static_cast<int>(ty->kind());
+        if (ty->kind() == Type::Kind::Elaborate)
+            os << "(" << ConstElaborateType_Cast(ty)->name()->str() << ")";
+        if (ty->kind() == Type::Kind::Record) {
+            auto recTy = ConstRecordType_Cast(ty);
+            for (auto base : recTy->bases())
+                os << " <" << base->name()->str() << ">";
+            dumpEnv(recTy->env(), os, depth + 1);
+        }
+        if (ty->kind() == Type::Kind::Func)
+            dumpType(ConstFuncType_Cast(ty)->returnType(), os, depth);
+    }
+
+    static void dumpEnv(Environment env, std::ostream& os, int depth)
+    {
+        if (depth > 4)
+            return;
+        std::vector<std::string> lines;
+        for (auto decl : env.listDecls()) {
+            std::ostringstream line;
+            line << std::string(depth * 2, ' ')
+                 << (decl->name() ? decl->name()->str() : "<anon>")
+                 << " k" << static_cast<int>(decl->kind())
+                 << " @" << decl->sourceLoc().line_ << ":" << decl->sourceLoc().col_
+                 << " ";
+            if (isTypeDecl(decl))
+                dumpType(ConstTypeDecl_Cast(decl)->type(), line, depth);
+            else
+                dumpType(ConstValueDecl_Cast(decl)->valueType(), line, depth);
+            if (decl->kind() == Symbol::Kind::Func
+                    && ConstFunc_Cast(decl)->env() != env) {
+                dumpEnv(ConstFunc_Cast(decl)->env(), line, depth + 1);
+            }
+            lines.push_back(line.str());
+        }
+        std::sort(lines.begin(), lines.end());
+        for (const auto& line : lines)
+            os << "\n" << line;
+    }
+
+    static std::string dump(const Program* prog)
+    {
+        std::ostringstream os;
+        dumpEnv(prog->env(), os, 0);
+        for (auto import : prog->env().imports()) {
+            os << "\nimport " << import->target() << " "
+               << (import->localName() ? import->localName()->str() : "-");
+            for (auto item : import->selectedItems()) {
+                os << " " << item->str();
+                if (auto alt = import->alternateName(item))
+                    os << "/" << alt->str();
+            }
+        }
+        return os.str();
+    }
+
+    void testCase1()
+    {
+        // Round trip: the program reloaded (into another lexeme map) is
+        // equivalent to the original one.
+        const std::string fileName = "/program_cache_test/a.py";
+        TokenMap tokens;
+        LexemeMap lexs;
+        auto prog = bind(fileName, &tokens, &lexs);
+        UAISO_EXPECT_TRUE(prog);
+
+        ProgramCache cache(dirPath_);
+        auto key = keyOf(source_, LangId::Py);
+        UAISO_EXPECT_TRUE(cache.store(key, prog.get(), &lexs));
+
+        LexemeMap otherLexs;
+        auto loaded = cache.load(key, fileName, &otherLexs);
+        UAISO_EXPECT_TRUE(loaded);
+        UAISO_EXPECT_STR_EQ(dump(prog.get()), dump(loaded.get()));
+        UAISO_EXPECT_STR_EQ(fileName, loaded->fileInfo().fullFileName());
+        UAISO_EXPECT_INT_EQ(2, loaded->env().imports().size());
+
+        // Identifiers are interned at their positions.
+        auto C = otherLexs.findAnyOf<Ident>("C");
+        UAISO_EXPECT_TRUE(C);
+        UAISO_EXPECT_PTR_EQ(C, otherLexs.findAt<Ident>(FileRegistry::find(fileName),
+                                                       LineCol(3, 6)));
+        auto rec = loaded->env().searchTypeDecl(C);
+        UAISO_EXPECT_TRUE(rec);
+        auto origRec = prog->env().searchTypeDecl(lexs.findAnyOf<Ident>("C"));
+        UAISO_EXPECT_TRUE(origRec);
+        UAISO_EXPECT_TRUE(origRec->sourceLoc() == rec->sourceLoc());
+    }
+
+    void testCase2()
+    {
+        // Keys depend on both the code and the language.
+        auto py = ProgramCache::key(source_.c_str(), source_.size(), LangId::Py);
+        auto go = ProgramCache::key(source_.c_str(), source_.size(), LangId::Go);
+        auto other = ProgramCache::key(source_.c_str(), source_.size() - 1, LangId::Py);
+        UAISO_EXPECT_TRUE(py != go);
+        UAISO_EXPECT_TRUE(py != other);
+        UAISO_EXPECT_STR_EQ(py, ProgramCache::key(source_.c_str(), source_.size(), LangId::Py));
+    }
+
+    void testCase3()
+    {
+        // Missing and corrupted entries are misses.
+        const std::string fileName = "/program_cache_test/b.py";
+        TokenMap tokens;
+        LexemeMap lexs;
+        auto prog = bind(fileName, &tokens, &lexs);
+        ProgramCache cache(dirPath_);
+        auto key = keyOf(source_ + "\n", LangId::Py);
+        UAISO_EXPECT_FALSE(cache.load(key, fileName, &lexs));
+
+        UAISO_EXPECT_TRUE(cache.store(key, prog.get(), &lexs));
+        std::string data;
+        {
+            std::ifstream ifs(written_.back(), std::ios::binary);
+            std::ostringstream oss;
+            oss << ifs.rdbuf();
+            data = oss.str();
+        }
+        UAISO_EXPECT_TRUE(data.size() > 16);
+        std::ofstream(written_.back(), std::ios::binary | std::ios::trunc)
+                << data.substr(0, data.size() / 2);
+        UAISO_EXPECT_FALSE(cache.load(key, fileName, &lexs));
+
+        std::ofstream(written_.back(), std::ios::binary | std::ios::trunc)
+                << "garbage";
+        UAISO_EXPECT_FALSE(cache.load(key, fileName, &lexs));
+    }
+
+    void testCase4()
+    {
+        // An entry with a byte altered (for instance, into the tag of a type
+        // of another kind where a function type is expected) either loads
+        // consistently or is a miss.
+        const std::string fileName = "/program_cache_test/c.py";
+        TokenMap tokens;
+        LexemeMap lexs;
+        auto prog = bind(fileName, &tokens, &lexs);
+        ProgramCache cache(dirPath_);
+        auto key = keyOf(source_ + "\n\n", LangId::Py);
+        UAISO_EXPECT_TRUE(cache.store(key, prog.get(), &lexs));
+        std::string data;
+        {
+            std::ifstream ifs(written_.back(), std::ios::binary);
+            std::ostringstream oss;
+            oss << ifs.rdbuf();
+            data = oss.str();
+        }
+
+        for (size_t i = 16; i < data.size(); ++i) {
+            for (char value = 0; value < 16; ++value) {
+                std::string altered = data;
+                altered[i] = value;
+                std::ofstream(written_.back(), std::ios::binary | std::ios::trunc)
+                        << altered;
+                LexemeMap otherLexs;
+                auto loaded = cache.load(key, fileName, &otherLexs);
+                if (!loaded)
+                    continue;
+                for (auto decl : loaded->env().listDecls()) {
+                    if (decl->kind() == Symbol::Kind::Func) {
+                        auto ty = ConstFunc_Cast(decl)->type();
+                        UAISO_EXPECT_TRUE(!ty || ty->kind() == Type::Kind::Func);
+                    }
+                }
+            }
+        }
+    }
+};
+
+MAKE_CLASS_TEST(ProgramCache)
@@ -24,34 +24,257 @@
 #include "Semantic/Snapshot.h"
 #include "Semantic/Program.h"
 #include "Semantic/Symbol.h"
+#include "Semantic/TypeInterner.h"
+#include "Semantic/TypeResolutionCache.h"
 #include "Ast/Ast.h"
 #include "Common/Assert.h"
 #include "Parsing/LexemeMap.h"
 #include "Parsing/TokenMap.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
 #include <unordered_map>
 #include <vector>
 
 using namespace uaiso;
 
+namespace {
+
+/*
+ * Programs are spread over shards, so a write copies only the shards it
+ * touches (the others are shared with the previous version).
+ */
+const size_t kShardCnt = 64;
+
+using Shard = std::unordered_map<FileId, std::shared_ptr<Program>>;
+
+size_t shardOf(FileId fileId)
+{
+    return std::hash<FileId>()(fileId) % kShardCnt;
+}
+
+} // anonymous
+
+struct uaiso::Snapshot::Version::VersionImpl
+{
+    uint64_t number_ { 0 };
+    size_t size_ { 0 };
+    std::array<std::shared_ptr<const Shard>, kShardCnt> shards_;
+    std::shared_ptr<TypeResolutionCache> resolutions_ {
+        std::make_shared<TypeResolutionCache>()
+    };
+    std::shared_ptr<TypeInterner> types_ { std::make_shared<TypeInterner>() };
+
+    const Program* find(FileId fileId) const
+    {
+        const auto& shard = shards_[shardOf(fileId)];
+        if (!shard)
+            return nullptr;
+        auto it = shard->find(fileId);
+        if (it != shard->end())
+            return (it->second).get();
+        return nullptr;
+    }
+};
+
 struct uaiso::Snapshot::SnapshotImpl
 {
-    std::unordered_map<std::string, std::unique_ptr<Program> > programs_;
+    SnapshotImpl()
+        : latest_(std::make_shared<Version::VersionImpl>())
+    {}
+
+    std::shared_ptr<const Version::VersionImpl> latest() const
+    {
+        return std::atomic_load(&latest_);
+    }
+
+    std::shared_ptr<const Version::VersionImpl> latest_;
+    std::mutex writeMutex_;
+
+    // Forward and reverse import edges.
+    mutable std::mutex graphMutex_;
+    std::unordered_map<FileId, std::vector<FileId>> imports_;
+    std::unordered_map<FileId, std::vector<FileId>> importers_;
 };
 
+Snapshot::Version::Version()
+    : impl_(std::make_shared<VersionImpl>())
+{}
+
+const Program* Snapshot::Version::find(FileId fileId) const
+{
+    return impl_->find(fileId);
+}
+
+const Program* Snapshot::Version::find(const std::string& fullFileName) const
+{
+    auto fileId = FileRegistry::find(fullFileName);
+    if (fileId.isUnspecified())
+        return nullptr;
+    return find(fileId);
+}
+
+size_t Snapshot::Version::size() const
+{
+    return impl_->size_;
+}
+
+uint64_t Snapshot::Version::number() const
+{
+    return impl_->number_;
+}
+
+TypeResolutionCache* Snapshot::Version::resolutions() const
+{
+    return impl_->resolutions_.get();
+}
+
+TypeInterner* Snapshot::Version::types() const
+{
+    return impl_->types_.get();
+}
+
 Snapshot::Snapshot()
     : impl_(new SnapshotImpl)
 {}
 
+Snapshot::Version Snapshot::pin() const
+{
+    Version version;
+    version.impl_ = P->latest();
+    return version;
+}
+
+void Snapshot::insertOrReplace(FileId fileId, std::unique_ptr<Program> program)
+{
+    std::vector<std::pair<FileId, std::unique_ptr<Program>>> programs;
+    programs.emplace_back(fileId, std::move(program));
+    insertOrReplace(std::move(programs));
+}
+
 void Snapshot::insertOrReplace(const std::string& fullFileName,
                                std::unique_ptr<Program> program)
 {
-    impl_->programs_[fullFileName] = std::move(program);
+    insertOrReplace(FileRegistry::insertOrFind(fullFileName), std::move(program));
+}
+
+void Snapshot::insertOrReplace(std::vector<std::pair<FileId, std::unique_ptr<Program>>> programs)
+{
+    std::lock_guard<std::mutex> lock(P->writeMutex_);
+
+    auto prev = P->latest();
+    std::shared_ptr<Version::VersionImpl> next(new Version::VersionImpl(*prev));
+    ++next->number_;
+
+    // Copy each touched shard only once.
+    std::array<Shard*, kShardCnt> copied {};
+    bool replaced = false;
+    for (auto& program : programs) {
+        const size_t idx = shardOf(program.first);
+        if (!copied[idx]) {
+            auto shard = prev->shards_[idx] ? std::make_shared<Shard>(*prev->shards_[idx])
+                                            : std::make_shared<Shard>();
+            copied[idx] = shard.get();
+            next->shards_[idx] = std::move(shard);
+        }
+        if (!program.second) {
+            if (copied[idx]->erase(program.first)) {
+                --next->size_;
+                replaced = true;
+            }
+            continue;
+        }
+        auto& slot = (*copied[idx])[program.first];
+        if (!slot)
+            ++next->size_;
+        else
+            replaced = true;
+        slot = std::shared_ptr<Program>(std::move(program.second));
+    }
+
+    // Resolutions may refer to types of the programs replaced (or erased),
+    // and interned types may have been so only for them.
+    if (replaced) {
+        next->resolutions_ = std::make_shared<TypeResolutionCache>();
+        next->types_ = std::make_shared<TypeInterner>();
+    }
+
+    std::atomic_store(&P->latest_,
+                      std::shared_ptr<const Version::VersionImpl>(std::move(next)));
+
+    // The previous version goes away (together with the programs replaced)
+    // here, unless it's pinned.
+}
+
+const Program* Snapshot::find(FileId fileId) const
+{
+    return P->latest()->find(fileId);
+}
+
+const Program* Snapshot::find(const std::string& fullFileName) const
+{
+    auto fileId = FileRegistry::find(fullFileName);
+    if (fileId.isUnspecified())
+        return nullptr;
+    return find(fileId);
+}
+
+void Snapshot::setImports(FileId fileId, std::vector<FileId> imported)
+{
+    std::sort(imported.begin(), imported.end());
+    imported.erase(std::unique(imported.begin(), imported.end()), imported.end());
+
+    std::lock_guard<std::mutex> lock(P->graphMutex_);
+    auto& prev = P->imports_[fileId];
+    for (auto otherFileId : prev) {
+        auto& importers = P->importers_[otherFileId];
+        importers.erase(std::remove(importers.begin(), importers.end(), fileId),
+                        importers.end());
+    }
+    for (auto otherFileId : imported)
+        P->importers_[otherFileId].push_back(fileId);
+    prev = std::move(imported);
+}
+
+std::vector<FileId> Snapshot::imports(FileId fileId) const
+{
+    std::lock_guard<std::mutex> lock(P->graphMutex_);
+    auto it = P->imports_.find(fileId);
+    if (it == P->imports_.end())
+        return std::vector<FileId>();
+    return it->second;
+}
+
+std::vector<FileId> Snapshot::importers(FileId fileId) const
+{
+    std::lock_guard<std::mutex> lock(P->graphMutex_);
+    auto it = P->importers_.find(fileId);
+    if (it == P->importers_.end())
+        return std::vector<FileId>();
+    return it->second;
 }
 
-Program* Snapshot::find(const std::string& fullFileName) const
+std::vector<FileId> Snapshot::dependents(FileId fileId) const
 {
-    auto it = impl_->programs_.find(fullFileName);
-    if (it != impl_->programs_.end())
-        return (it->second).get();
-    return nullptr;
+    std::lock_guard<std::mutex> lock(P->graphMutex_);
+    std::vector<FileId> deps;
+    std::unordered_set<FileId> visited { fileId };
+    std::vector<FileId> level { fileId };
+    while (!level.empty()) {
+        std::vector<FileId> next;
+        for (auto curFileId : level) {
+            auto it = P->importers_.find(curFileId);
+            if (it == P->importers_.end())
+                continue;
+            for (auto otherFileId : it->second) {
+                if (visited.insert(otherFileId).second)
+                    next.push_back(otherFileId);
+            }
+        }
+        deps.insert(deps.end(), next.begin(), next.end());
+        level = std::move(next);
+    }
+    return deps;
 }
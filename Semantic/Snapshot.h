@@ -26,15 +26,30 @@
 
 #include "Common/Config.h"
 #include "Common/Pimpl.h"
+#include "Common/Test.h"
+#include "Parsing/FileRegistry.h"
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace uaiso {
 
 class Program;
+class TypeInterner;
+class TypeResolutionCache;
 
 /*!
  * \brief The Snapshot class
  *
+ * A snapshot is a sequence of immutable versions of the programs known to
+ * the engine. Every write builds a new version, sharing whatever it didn't
+ * change with the previous one, and publishes it atomically. Readers pin a
+ * version and keep working on it, regardless of later writes, while the
+ * programs replaced in the meantime are only destroyed once no pinned
+ * version refers to them. Writes are serialized.
+ *
  * \note This is an implictly shared type.
  */
 class UAISO_API Snapshot final
@@ -42,12 +57,127 @@ class UAISO_API Snapshot final
 public:
     Snapshot();
 
+    /*!
+     * \brief The Version class
+     *
+     * An immutable view of the snapshot, which keeps its programs alive.
+     */
+    class UAISO_API Version final
+    {
+    public:
+        Version();
+
+        const Program* find(FileId fileId) const;
+
+        const Program* find(const std::string& fullFileName) const;
+
+        /*!
+         * \brief size
+         *
+         * Return the number of programs in the version.
+         */
+        size_t size() const;
+
+        /*!
+         * \brief number
+         *
+         * Return the number of the version, which increases with every write.
+         */
+        uint64_t number() const;
+
+        /*!
+         * \brief resolutions
+         *
+         * Return the cache of elaborate type resolutions of the version. It's
+         * carried over to later versions while they only add programs, and
+         * starts over once a program is replaced (since the types it refers
+         * to may be gone).
+         */
+        TypeResolutionCache* resolutions() const;
+
+        /*!
+         * \brief types
+         *
+         * Return the interner of the types of the version's programs. Like
+         * the resolutions, it's carried over to later versions while they
+         * only add programs, and starts over once a program is replaced, so
+         * types interned for programs that are gone are released together
+         * with the last version which refers to them.
+         */
+        TypeInterner* types() const;
+
+    private:
+        friend class Snapshot;
+        struct VersionImpl;
+        std::shared_ptr<const VersionImpl> impl_;
+    };
+
+    /*!
+     * \brief pin
+     *
+     * Return the latest version published.
+     */
+    Version pin() const;
+
+    void insertOrReplace(FileId fileId, std::unique_ptr<Program> program);
+
     void insertOrReplace(const std::string& fullFileName,
                          std::unique_ptr<Program> program);
 
-    Program* find(const std::string& fullFileName) const;
+    /*!
+     * \brief insertOrReplace
+     *
+     * Insert all \a programs at once, publishing a single version. A null
+     * program erases the one of its file, if there's any.
+     */
+    void insertOrReplace(std::vector<std::pair<FileId, std::unique_ptr<Program>>> programs);
+
+    /*!
+     * \brief find
+     *
+     * Return the program from the latest version published.
+     *
+     * \note The program is only guaranteed to stay alive until it's replaced
+     * in the snapshot; readers on other threads should pin() a version.
+     */
+    const Program* find(FileId fileId) const;
+
+    const Program* find(const std::string& fullFileName) const;
+
+    /*!
+     * \brief setImports
+     *
+     * Record that the program of \a fileId imports the files \a imported
+     * (replacing whatever was recorded before for it).
+     *
+     * \note The import graph isn't versioned, it reflects the latest writes.
+     */
+    void setImports(FileId fileId, std::vector<FileId> imported);
+
+    /*!
+     * \brief imports
+     *
+     * Return the files imported by the program of \a fileId.
+     */
+    std::vector<FileId> imports(FileId fileId) const;
+
+    /*!
+     * \brief importers
+     *
+     * Return the files whose programs import \a fileId directly.
+     */
+    std::vector<FileId> importers(FileId fileId) const;
+
+    /*!
+     * \brief dependents
+     *
+     * Return the files whose programs import \a fileId, directly or not,
+     * the closest ones first (\a fileId itself is not included).
+     */
+    std::vector<FileId> dependents(FileId fileId) const;
 
 private:
+    DECL_CLASS_TEST(Snapshot)
     DECL_SHARED_DATA(Snapshot)
 };
 
@@ -0,0 +1,622 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#include "Semantic/Snapshot.h"
+#include "Semantic/Environment.h"
+#include "Semantic/Manager.h"
+#include "Semantic/Program.h"
+#include "Semantic/Symbol.h"
+#include "Semantic/Type.h"
+#include "Semantic/TypeInterner.h"
+#include "Semantic/TypeResolutionCache.h"
+#include "Semantic/TypeResolver.h"
+#include "Common/FileInfo.h"
+#include "Parsing/Factory.h"
+#include "Parsing/Lexeme.h"
+#include "Parsing/LexemeMap.h"
+#include "Parsing/TokenMap.h"
+#include "Parsing/Unit.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+using namespace uaiso;
+
+class Snapshot::SnapshotTest : public Test
+{
+public:
+    TEST_RUN(SnapshotTest
+             , &SnapshotTest::testCase1
+             , &SnapshotTest::testCase2
+             , &SnapshotTest::testCase3
+             , &SnapshotTest::testCase4
+             , &SnapshotTest::testCase5
+             , &SnapshotTest::testCase6
+             , &SnapshotTest::testCase7
+             , &SnapshotTest::testCase8
+             , &SnapshotTest::testCase9
+             , &SnapshotTest::testCase10
+             , &SnapshotTest::testCase11
+             , &SnapshotTest::testCase12
+             )
+
+    void testCase1()
+    {
+        // A pinned version is not affected by later writes.
+        auto a = FileRegistry::insertOrFind("/snapshot_test/a.py");
+        auto b = FileRegistry::insertOrFind("/snapshot_test/b.py");
+        Snapshot snapshot;
+        Version empty = snapshot.pin();
+        UAISO_EXPECT_INT_EQ(0, empty.size());
+
+        std::unique_ptr<Program> prog(new Program("/snapshot_test/a.py"));
+        auto oldA = prog.get();
+        snapshot.insertOrReplace(a, std::move(prog));
+        Version v1 = snapshot.pin();
+        UAISO_EXPECT_INT_EQ(1, v1.size());
+        UAISO_EXPECT_TRUE(v1.number() > empty.number());
+
+        prog.reset(new Program("/snapshot_test/a.py"));
+        auto newA = prog.get();
+        snapshot.insertOrReplace(a, std::move(prog));
+        snapshot.insertOrReplace(b, std::unique_ptr<Program>(new Program("/snapshot_test/b.py")));
+        Version v2 = snapshot.pin();
+        UAISO_EXPECT_INT_EQ(2, v2.size());
+        UAISO_EXPECT_TRUE(v2.number() > v1.number());
+
+        UAISO_EXPECT_FALSE(empty.find(a));
+        UAISO_EXPECT_PTR_EQ(oldA, v1.find(a));
+        UAISO_EXPECT_FALSE(v1.find(b));
+        UAISO_EXPECT_PTR_EQ(newA, v2.find(a));
+        UAISO_EXPECT_PTR_EQ(newA, snapshot.find(a));
+        UAISO_EXPECT_TRUE(v2.find("/snapshot_test/b.py"));
+        UAISO_EXPECT_STR_EQ("/snapshot_test/a.py", v1.find(a)->fileInfo().fullFileName());
+    }
+
+    void testCase2()
+    {
+        // Programs inserted together are published in a single version.
+        Snapshot snapshot;
+        Version v0 = snapshot.pin();
+        std::vector<std::pair<FileId, std::unique_ptr<Program>>> progs;
+        for (int i = 0; i < 100; ++i) {
+            auto name = "/snapshot_test/batch" + std::to_string(i) + ".py";
+            progs.emplace_back(FileRegistry::insertOrFind(name),
+                               std::unique_ptr<Program>(new Program(name)));
+        }
+        snapshot.insertOrReplace(std::move(progs));
+        Version v1 = snapshot.pin();
+        UAISO_EXPECT_INT_EQ(v0.number() + 1, v1.number());
+        UAISO_EXPECT_INT_EQ(100, v1.size());
+        for (int i = 0; i < 100; ++i) {
+            auto name = "/snapshot_test/batch" + std::to_string(i) + ".py";
+            auto prog = v1.find(name);
+            UAISO_EXPECT_TRUE(prog);
+            UAISO_EXPECT_STR_EQ(name, prog->fileInfo().fullFileName());
+        }
+    }
+
+    void testCase3()
+    {
+        // A writer keeps replacing programs while readers pin versions and
+        // inspect them. Readers must always see complete programs, and
+        // versions must never go back.
+        const int kFiles = 32;
+        const int kWrites = 2000;
+        const int kReaders = 4;
+        std::vector<FileId> fileIds;
+        std::vector<std::string> names;
+        for (int i = 0; i < kFiles; ++i) {
+            names.push_back("/snapshot_test/hammer" + std::to_string(i) + ".py");
+            fileIds.push_back(FileRegistry::insertOrFind(names.back()));
+        }
+
+        Snapshot snapshot;
+        std::atomic<bool> done { false };
+        std::atomic<int> errors { 0 };
+        std::atomic<int> reads { 0 };
+        std::vector<std::thread> readers;
+        for (int t = 0; t < kReaders; ++t) {
+            readers.emplace_back([&] () {
+                uint64_t last = 0;
+                do {
+                    Version version = snapshot.pin();
+                    if (version.number() < last)
+                        ++errors;
+                    last = version.number();
+                    size_t found = 0;
+                    for (int i = 0; i < kFiles; ++i) {
+                        auto prog = version.find(fileIds[i]);
+                        if (!prog)
+                            continue;
+                        ++found;
+                        if (prog->fileInfo().fullFileName() != names[i])
+                            ++errors;
+                    }
+                    if (found != version.size())
+                        ++errors;
+                    ++reads;
+                } while (!done);
+            });
+        }
+
+        for (int w = 0; w < kWrites; ++w) {
+            const int i = (w * 7) % kFiles;
+            if (w % 10) {
+                snapshot.insertOrReplace(fileIds[i],
+                    std::unique_ptr<Program>(new Program(names[i])));
+                continue;
+            }
+            std::vector<std::pair<FileId, std::unique_ptr<Program>>> progs;
+            for (int j = 0; j < 4; ++j) {
+                const int k = (i + j) % kFiles;
+                progs.emplace_back(fileIds[k],
+                                   std::unique_ptr<Program>(new Program(names[k])));
+            }
+            snapshot.insertOrReplace(std::move(progs));
+        }
+        done = true;
+        for (auto& reader : readers)
+            reader.join();
+
+        UAISO_EXPECT_INT_EQ(0, errors);
+        UAISO_EXPECT_TRUE(reads > 0);
+        UAISO_EXPECT_INT_EQ(kFiles, snapshot.pin().size());
+    }
+
+    void testCase4()
+    {
+        auto a = FileRegistry::insertOrFind("/snapshot_test/graph/a.py");
+        auto b = FileRegistry::insertOrFind("/snapshot_test/graph/b.py");
+        auto c = FileRegistry::insertOrFind("/snapshot_test/graph/c.py");
+        auto d = FileRegistry::insertOrFind("/snapshot_test/graph/d.py");
+        Snapshot snapshot;
+        snapshot.setImports(a, { b, c, b });
+        snapshot.setImports(b, { c });
+        snapshot.setImports(c, { a }); // A cycle.
+        snapshot.setImports(d, { c });
+
+        UAISO_EXPECT_INT_EQ(2, snapshot.imports(a).size());
+        auto importers = snapshot.importers(c);
+        std::sort(importers.begin(), importers.end());
+        UAISO_EXPECT_TRUE((std::vector<FileId> { a, b, d }) == importers);
+        UAISO_EXPECT_INT_EQ(1, snapshot.importers(b).size());
+
+        auto deps = snapshot.dependents(b);
+        UAISO_EXPECT_INT_EQ(3, deps.size());
+        UAISO_EXPECT_TRUE(deps[0] == a);
+        UAISO_EXPECT_TRUE(std::find(deps.begin(), deps.end(), b) == deps.end());
+
+        // Edges are replaced, not accumulated.
+        snapshot.setImports(d, { });
+        snapshot.setImports(a, { b });
+        UAISO_EXPECT_INT_EQ(1, snapshot.importers(c).size());
+        UAISO_EXPECT_TRUE(snapshot.dependents(d).empty());
+        UAISO_EXPECT_INT_EQ(2, snapshot.dependents(a).size());
+    }
+
+    void testCase5()
+    {
+        // Replacing a program binds the ones importing it again, and only
+        // them, from the code they were bound from.
+        char dirTemplate[] = "/tmp/uaiso_snapshot_XXXXXX";
+        UAISO_EXPECT_TRUE(mkdtemp(dirTemplate));
+        const std::string dirPath = std::string(dirTemplate) + "/";
+        auto write = [&dirPath] (const std::string& name, const std::string& code) {
+            std::ofstream(dirPath + name) << code;
+            return dirPath + name;
+        };
+        const std::string a = write("a.py", "import b\n");
+        const std::string b = write("b.py", "import c\n");
+        const std::string c = write("c.py", "class C:\n    pass\n");
+        const std::string d = write("d.py", "import c\n");
+        const std::string e = write("e.py", "class E:\n    pass\n");
+
+        std::unique_ptr<Factory> factory = FactoryCreator::create(LangId::Py);
+        TokenMap tokens;
+        LexemeMap lexs;
+        Snapshot snapshot;
+        Manager manager;
+        manager.config(factory.get(), &tokens, &lexs, snapshot);
+        Manager::BehaviourFlags flags = 0;
+        flags |= Manager::BehaviourFlag::IgnoreBuiltins;
+        flags |= Manager::BehaviourFlag::IgnoreAutomaticModules;
+        flags |= Manager::BehaviourFlag::BindBodiesLazily;
+        manager.setBehaviour(flags);
+        manager.process("import b\ndef f():\n    pass\n", a);
+        manager.process("import c\n", d);
+        manager.process("class E:\n    pass\n", e);
+
+        auto deps = manager.dependents(c);
+        UAISO_EXPECT_INT_EQ(3, deps.size());
+        UAISO_EXPECT_STR_EQ(b, deps[0]);
+        UAISO_EXPECT_STR_EQ(a, deps[2]);
+        UAISO_EXPECT_TRUE(manager.dependents(a).empty());
+        UAISO_EXPECT_TRUE(manager.dependents(e).empty());
+
+        auto typeNames = [] (const Program* prog) {
+            std::vector<std::string> names;
+            auto spaces = prog->env().listNamespaces();
+            if (spaces.size() != 1)
+                return names;
+            auto env = spaces[0]->env();
+            for (auto tySym : env.listTypeDecls())
+                names.push_back(tySym->name()->str());
+            return names;
+        };
+        UAISO_EXPECT_TRUE(typeNames(snapshot.find(b)) == std::vector<std::string> { "C" });
+
+        const Program* oldA = snapshot.find(a);
+        const Program* oldB = snapshot.find(b);
+        const Program* oldE = snapshot.find(e);
+        write("c.py", "class D:\n    pass\n");
+        manager.invalidate(c);
+        UAISO_EXPECT_TRUE(typeNames(snapshot.find(b)) == std::vector<std::string> { "D" });
+        UAISO_EXPECT_TRUE(typeNames(snapshot.find(d)) == std::vector<std::string> { "D" });
+        UAISO_EXPECT_TRUE(snapshot.find(b) != oldB);
+        UAISO_EXPECT_TRUE(snapshot.find(a) != oldA);
+        UAISO_EXPECT_TRUE(snapshot.find(e) == oldE);
+        UAISO_EXPECT_INT_EQ(3, manager.dependents(c).size());
+
+        // The program of a is bound again from the code it was processed
+        // with, not from its file (which now imports nothing), and as it
+        // was then: with its function's body deferred.
+        write("a.py", "x = 1\n");
+        manager.process("class B:\n    pass\n", b);
+        UAISO_EXPECT_INT_EQ(1, manager.dependents(b).size());
+        UAISO_EXPECT_INT_EQ(1, manager.dependents(c).size());
+        UAISO_EXPECT_TRUE(snapshot.find(a) != oldA);
+        const Func* func = ConstFunc_Cast(
+                snapshot.find(a)->env().searchTypeDecl(lexs.findAnyOf<Ident>("f")));
+        UAISO_EXPECT_TRUE(func);
+        UAISO_EXPECT_FALSE(func->isBodyBound());
+
+        for (const auto& fileName : { a, b, c, d, e })
+            std::remove(fileName.c_str());
+        rmdir(dirPath.c_str());
+    }
+
+    void testCase6()
+    {
+        // Edits which keep the interface of a program don't reach the ones
+        // importing it.
+        char dirTemplate[] = "/tmp/uaiso_snapshot_XXXXXX";
+        UAISO_EXPECT_TRUE(mkdtemp(dirTemplate));
+        const std::string dirPath = std::string(dirTemplate) + "/";
+        auto write = [&dirPath] (const std::string& name, const std::string& code) {
+            std::ofstream(dirPath + name) << code;
+            return dirPath + name;
+        };
+        const std::string a = write("a.py", "import c\n");
+        const std::string c = write("c.py", "def f(x):\n    return x\n");
+
+        std::unique_ptr<Factory> factory = FactoryCreator::create(LangId::Py);
+        TokenMap tokens;
+        LexemeMap lexs;
+        Snapshot snapshot;
+        Manager manager;
+        manager.config(factory.get(), &tokens, &lexs, snapshot);
+        Manager::BehaviourFlags flags = 0;
+        flags |= Manager::BehaviourFlag::IgnoreBuiltins;
+        flags |= Manager::BehaviourFlag::IgnoreAutomaticModules;
+        manager.setBehaviour(flags);
+        manager.process("import c\n", a);
+        const Program* oldA = snapshot.find(a);
+        const uint64_t hash = snapshot.find(c)->interfaceHash();
+
+        manager.process("def f(x):\n    y = x * 2\n    return y\n", c);
+        UAISO_EXPECT_INT_EQ(hash, snapshot.find(c)->interfaceHash());
+        UAISO_EXPECT_TRUE(snapshot.find(a) == oldA);
+        UAISO_EXPECT_INT_EQ(1, manager.replacementStats().replaced_);
+        UAISO_EXPECT_INT_EQ(1, manager.replacementStats().cutoffs_);
+        UAISO_EXPECT_INT_EQ(0, manager.replacementStats().reloaded_);
+
+        // A partial program (as for completion) doesn't count.
+        manager.process("def f(x):\n    return ", c, LineCol(1, 11));
+        UAISO_EXPECT_INT_EQ(1, manager.replacementStats().replaced_);
+
+        manager.process("def f(x, z):\n    return x\n", c);
+        UAISO_EXPECT_TRUE(hash != snapshot.find(c)->interfaceHash());
+        UAISO_EXPECT_TRUE(snapshot.find(a) != oldA);
+        UAISO_EXPECT_INT_EQ(2, manager.replacementStats().replaced_);
+        UAISO_EXPECT_INT_EQ(1, manager.replacementStats().cutoffs_);
+        UAISO_EXPECT_INT_EQ(1, manager.replacementStats().reloaded_);
+
+        // Likewise, through invalidation.
+        oldA = snapshot.find(a);
+        write("c.py", "def f(x, z):\n    return z\n");
+        manager.invalidate(c);
+        UAISO_EXPECT_TRUE(snapshot.find(a) == oldA);
+        UAISO_EXPECT_INT_EQ(2, manager.replacementStats().cutoffs_);
+        write("c.py", "def g(x, z):\n    return z\n");
+        manager.invalidate(c);
+        UAISO_EXPECT_TRUE(snapshot.find(a) != oldA);
+        UAISO_EXPECT_INT_EQ(2, manager.replacementStats().cutoffs_);
+
+        for (const auto& fileName : { a, c })
+            std::remove(fileName.c_str());
+        rmdir(dirPath.c_str());
+    }
+
+    void testCase7()
+    {
+        // Resolutions are cached while programs are only added, and start
+        // over once one is replaced.
+        auto a = FileRegistry::insertOrFind("/snapshot_test/a7.py");
+        auto b = FileRegistry::insertOrFind("/snapshot_test/b7.py");
+        std::unique_ptr<Ident> name(new Ident("T"));
+        Environment env;
+        Record* rec = new Record(name.get());
+        rec->setType(std::unique_ptr<RecordType>(new RecordType));
+        env.insertTypeDecl(std::unique_ptr<const TypeDecl>(rec));
+
+        Snapshot snapshot;
+        snapshot.insertOrReplace(a, std::unique_ptr<Program>(new Program("/snapshot_test/a7.py")));
+        Version v1 = snapshot.pin();
+        UAISO_EXPECT_INT_EQ(0, v1.resolutions()->size());
+
+        std::unique_ptr<Factory> factory = FactoryCreator::create(LangId::Py);
+        TypeResolver resolver(factory.get());
+        resolver.setResolutionCache(v1.resolutions());
+        ElaborateType elabTy(name.get());
+        auto ty = std::get<0>(resolver.resolve(&elabTy, env));
+        UAISO_EXPECT_TRUE(ty == rec->type());
+        UAISO_EXPECT_FALSE(elabTy.isResolved()); // Not annotated with a copy.
+        UAISO_EXPECT_INT_EQ(1, v1.resolutions()->size());
+        UAISO_EXPECT_TRUE(v1.resolutions()->find(env, name.get()) == rec->type());
+        UAISO_EXPECT_TRUE(std::get<0>(resolver.resolve(&elabTy, env)) == ty);
+        UAISO_EXPECT_INT_EQ(1, v1.resolutions()->size());
+
+        snapshot.insertOrReplace(b, std::unique_ptr<Program>(new Program("/snapshot_test/b7.py")));
+        Version v2 = snapshot.pin();
+        UAISO_EXPECT_TRUE(v2.resolutions() == v1.resolutions());
+
+        snapshot.insertOrReplace(a, std::unique_ptr<Program>(new Program("/snapshot_test/a7.py")));
+        Version v3 = snapshot.pin();
+        UAISO_EXPECT_TRUE(v3.resolutions() != v1.resolutions());
+        UAISO_EXPECT_INT_EQ(0, v3.resolutions()->size());
+        UAISO_EXPECT_FALSE(v3.resolutions()->find(env, name.get()));
+        UAISO_EXPECT_INT_EQ(1, v1.resolutions()->size()); // Still pinned.
+    }
+
+    void testCase8()
+    {
+        // The interface of a program loaded as a dependency (without
+        // builtins) is the same once it's processed, but not once its
+        // imports change.
+        char dirTemplate[] = "/tmp/uaiso_snapshot_XXXXXX";
+        UAISO_EXPECT_TRUE(mkdtemp(dirTemplate));
+        const std::string dirPath = std::string(dirTemplate) + "/";
+        auto write = [&dirPath] (const std::string& name, const std::string& code) {
+            std::ofstream(dirPath + name) << code;
+            return dirPath + name;
+        };
+        const std::string code = "class C:\n    def __init__(self, x):\n        self.x = x\n";
+        const std::string a = write("a.py", "import c\n");
+        const std::string c = write("c.py", code);
+        const std::string d = write("d.py", "v = 1\n");
+
+        std::unique_ptr<Factory> factory = FactoryCreator::create(LangId::Py);
+        TokenMap tokens;
+        LexemeMap lexs;
+        Snapshot snapshot;
+        Manager manager;
+        manager.config(factory.get(), &tokens, &lexs, snapshot);
+        manager.process("import c\n", a);
+        const uint64_t hash = snapshot.find(c)->interfaceHash();
+
+        manager.process(code, c);
+        UAISO_EXPECT_INT_EQ(hash, snapshot.find(c)->interfaceHash());
+        UAISO_EXPECT_INT_EQ(1, manager.replacementStats().cutoffs_);
+        UAISO_EXPECT_INT_EQ(0, manager.replacementStats().reloaded_);
+
+        manager.process("import d\n" + code, c);
+        UAISO_EXPECT_TRUE(hash != snapshot.find(c)->interfaceHash());
+        UAISO_EXPECT_INT_EQ(1, manager.replacementStats().cutoffs_);
+        UAISO_EXPECT_INT_EQ(1, manager.replacementStats().reloaded_);
+
+        manager.process("from d import v\n" + code, c);
+        UAISO_EXPECT_INT_EQ(1, manager.replacementStats().cutoffs_);
+
+        for (const auto& fileName : { a, c, d })
+            std::remove(fileName.c_str());
+        rmdir(dirPath.c_str());
+    }
+
+    void testCase9()
+    {
+        // Processing the dependencies of a program again publishes a new
+        // one, the published program isn't modified.
+        char dirTemplate[] = "/tmp/uaiso_snapshot_XXXXXX";
+        char libTemplate[] = "/tmp/uaiso_snapshot_XXXXXX";
+        UAISO_EXPECT_TRUE(mkdtemp(dirTemplate));
+        UAISO_EXPECT_TRUE(mkdtemp(libTemplate));
+        const std::string dirPath = std::string(dirTemplate) + "/";
+        const std::string libPath = std::string(libTemplate) + "/";
+        const std::string a = dirPath + "a.py";
+        const std::string b = libPath + "b.py";
+        std::ofstream(b) << "class B:\n    pass\n";
+
+        std::unique_ptr<Factory> factory = FactoryCreator::create(LangId::Py);
+        TokenMap tokens;
+        LexemeMap lexs;
+        Snapshot snapshot;
+        Manager manager;
+        manager.config(factory.get(), &tokens, &lexs, snapshot);
+        Manager::BehaviourFlags flags = 0;
+        flags |= Manager::BehaviourFlag::IgnoreBuiltins;
+        flags |= Manager::BehaviourFlag::IgnoreAutomaticModules;
+        manager.setBehaviour(flags);
+        manager.process("import b\n", a);
+
+        Version v1 = snapshot.pin();
+        const Program* oldA = v1.find(a);
+        UAISO_EXPECT_TRUE(oldA);
+        UAISO_EXPECT_TRUE(oldA->env().listNamespaces().empty());
+        UAISO_EXPECT_FALSE(v1.find(b));
+
+        // With the library in the search paths, the import resolves.
+        manager.addSearchPath(libPath);
+        manager.processDeps(a);
+        Version v2 = snapshot.pin();
+        UAISO_EXPECT_TRUE(v2.number() > v1.number());
+        UAISO_EXPECT_TRUE(v2.find(b));
+        UAISO_EXPECT_TRUE(v2.find(a) != oldA);
+        UAISO_EXPECT_INT_EQ(1, v2.find(a)->env().listNamespaces().size());
+        UAISO_EXPECT_PTR_EQ(oldA, v1.find(a));
+        UAISO_EXPECT_TRUE(oldA->env().listNamespaces().empty());
+        UAISO_EXPECT_INT_EQ(1, manager.dependents(b).size());
+
+        std::remove(b.c_str());
+        rmdir(dirPath.c_str());
+        rmdir(libPath.c_str());
+    }
+    void testCase10()
+    {
+        // A file which changed on disk is bound the way it was last bound,
+        // and its program is erased once the file is gone.
+        char dirTemplate[] = "/tmp/uaiso_snapshot_XXXXXX";
+        UAISO_EXPECT_TRUE(mkdtemp(dirTemplate));
+        const std::string dirPath = std::string(dirTemplate) + "/";
+        auto write = [&dirPath] (const std::string& name, const std::string& code) {
+            std::ofstream(dirPath + name) << code;
+            return dirPath + name;
+        };
+        const std::string a = write("a.py", "import b\ndef f():\n    pass\n");
+        const std::string b = write("b.py", "class B:\n    pass\n");
+
+        std::unique_ptr<Factory> factory = FactoryCreator::create(LangId::Py);
+        TokenMap tokens;
+        LexemeMap lexs;
+        Snapshot snapshot;
+        Manager manager;
+        manager.config(factory.get(), &tokens, &lexs, snapshot);
+        Manager::BehaviourFlags flags = 0;
+        flags |= Manager::BehaviourFlag::IgnoreBuiltins;
+        flags |= Manager::BehaviourFlag::IgnoreAutomaticModules;
+        flags |= Manager::BehaviourFlag::BindBodiesLazily;
+        manager.setBehaviour(flags);
+        manager.process("import b\ndef f():\n    pass\n", a);
+        UAISO_EXPECT_INT_EQ(1, manager.dependents(b).size());
+
+        // Not as a dependency, whose function bodies wouldn't be deferred.
+        write("a.py", "import b\ndef g():\n    pass\n");
+        manager.invalidate(a);
+        const Func* func = ConstFunc_Cast(
+                snapshot.find(a)->env().searchTypeDecl(lexs.findAnyOf<Ident>("g")));
+        UAISO_EXPECT_TRUE(func);
+        UAISO_EXPECT_FALSE(func->isBodyBound());
+
+        // The deleted dependency is gone from the next version, and the
+        // program importing it no longer refers to it.
+        Version v1 = snapshot.pin();
+        const Program* oldA = snapshot.find(a);
+        std::remove(b.c_str());
+        manager.invalidate(b);
+        Version v2 = snapshot.pin();
+        UAISO_EXPECT_TRUE(v1.find(b));
+        UAISO_EXPECT_FALSE(v2.find(b));
+        UAISO_EXPECT_INT_EQ(v1.size() - 1, v2.size());
+        UAISO_EXPECT_TRUE(v2.find(a) != oldA);
+        UAISO_EXPECT_TRUE(v2.find(a)->env().listNamespaces().empty());
+
+        std::remove(a.c_str());
+        rmdir(dirPath.c_str());
+    }
+
+    void testCase11()
+    {
+        // A resolution cached before a function's body is bound (lazily)
+        // doesn't hide a type which the body declares.
+        const std::string code = "class T:\n"
+                                 "    pass\n"
+                                 "def f():\n"
+                                 "    class T:\n"
+                                 "        pass\n";
+        const std::string fileName = "/snapshot_test/a11.py";
+        std::unique_ptr<Factory> factory = FactoryCreator::create(LangId::Py);
+        TokenMap tokens;
+        LexemeMap lexs;
+        Snapshot snapshot;
+        Manager manager;
+        manager.config(factory.get(), &tokens, &lexs, snapshot);
+        Manager::BehaviourFlags flags = 0;
+        flags |= Manager::BehaviourFlag::IgnoreBuiltins;
+        flags |= Manager::BehaviourFlag::IgnoreAutomaticModules;
+        flags |= Manager::BehaviourFlag::BindBodiesLazily;
+        manager.setBehaviour(flags);
+        std::unique_ptr<Unit> unit = manager.process(code, fileName);
+        UAISO_EXPECT_TRUE(unit->ast());
+
+        Version version = snapshot.pin();
+        const Ident* name = lexs.findAnyOf<Ident>("T");
+        const Environment env = version.find(fileName)->env();
+        const Func* func = ConstFunc_Cast(env.searchTypeDecl(lexs.findAnyOf<Ident>("f")));
+        UAISO_EXPECT_TRUE(func);
+        UAISO_EXPECT_FALSE(func->isBodyBound());
+
+        TypeResolver resolver(factory.get());
+        resolver.setResolutionCache(version.resolutions());
+        ElaborateType elabTy(name);
+        const Type* outerTy = env.searchTypeDecl(name)->type();
+        UAISO_EXPECT_TRUE(std::get<0>(resolver.resolve(&elabTy, func->env())) == outerTy);
+        UAISO_EXPECT_TRUE(version.resolutions()->find(func->env(), name) == outerTy);
+
+        func->bindBody();
+        const Type* innerTy = std::get<0>(resolver.resolve(&elabTy, func->env()));
+        UAISO_EXPECT_TRUE(innerTy);
+        UAISO_EXPECT_TRUE(innerTy != outerTy);
+        UAISO_EXPECT_TRUE(innerTy == func->env().searchTypeDecl(name)->type());
+        UAISO_EXPECT_TRUE(version.resolutions()->find(func->env(), name) == innerTy);
+    }
+
+    void testCase12()
+    {
+        // Types are interned per version: the interner is carried over while
+        // programs are only added, and starts over once one is replaced.
+        auto a = FileRegistry::insertOrFind("/snapshot_test/a12.py");
+        auto b = FileRegistry::insertOrFind("/snapshot_test/b12.py");
+        Snapshot snapshot;
+        snapshot.insertOrReplace(a, std::unique_ptr<Program>(new Program("/snapshot_test/a12.py")));
+        Version v1 = snapshot.pin();
+        PtrType ptrTy(std::unique_ptr<Type>(new IntType));
+        const Type* canon = v1.types()->intern(&ptrTy);
+        UAISO_EXPECT_TRUE(v1.types()->isCanonical(canon));
+
+        snapshot.insertOrReplace(b, std::unique_ptr<Program>(new Program("/snapshot_test/b12.py")));
+        Version v2 = snapshot.pin();
+        UAISO_EXPECT_TRUE(v2.types() == v1.types());
+
+        snapshot.insertOrReplace(a, std::unique_ptr<Program>(new Program("/snapshot_test/a12.py")));
+        Version v3 = snapshot.pin();
+        UAISO_EXPECT_TRUE(v3.types() != v1.types());
+        UAISO_EXPECT_FALSE(v3.types()->isCanonical(canon));
+        UAISO_EXPECT_TRUE(v1.types()->isCanonical(canon)); // Still pinned.
+    }
+};
+
+MAKE_CLASS_TEST(Snapshot)
@@ -29,6 +29,8 @@
 #include "Semantic/TypeCast.h"
 #include "Ast/AstVariety.h"
 #include "Parsing/Lexeme.h"
+#include <atomic>
+#include <mutex>
 #include <utility>
 
 using namespace uaiso;
@@ -288,7 +290,17 @@ struct uaiso::Func::FuncImpl : TypeDecl::TypeDeclImpl
 {
     using TypeDeclImpl::TypeDeclImpl;
 
+    //! A deferred body, shared by the function and its clones, which
+    //! refer to the same environment.
+    struct Body
+    {
+        std::function<void ()> binder_;
+        std::once_flag once_;
+        std::atomic<bool> bound_ { false };
+    };
+
     Environment env_;
+    std::shared_ptr<Body> body_;
 };
 
 DEF_PIMPL_CAST(Func)
@@ -320,6 +332,30 @@ Environment Func::env() const
     return P_CAST->env_;
 }
 
+void Func::setBodyBinder(std::function<void ()> binder)
+{
+    P_CAST->body_ = std::make_shared<FuncImpl::Body>();
+    P_CAST->body_->binder_ = std::move(binder);
+}
+
+void Func::bindBody() const
+{
+    auto body = P_CAST->body_.get();
+    if (!body || body->bound_.load(std::memory_order_acquire))
+        return;
+
+    std::call_once(body->once_, [body] () {
+        body->binder_();
+        body->binder_ = nullptr; // Let go of what it retains.
+        body->bound_.store(true, std::memory_order_release);
+    });
+}
+
+bool Func::isBodyBound() const
+{
+    return !P_CAST->body_ || P_CAST->body_->bound_.load(std::memory_order_acquire);
+}
+
 Func* Func::clone() const
 {
     return clone(P_CAST->name_);
@@ -330,6 +366,7 @@ Func* Func::clone(const Ident* alternateName) const
     auto func = trivialClone<Func>(alternateName);
     func->P_CAST->ty_ = std::unique_ptr<Type>(P_CAST->ty_->clone());
     func->P_CAST->env_ = P_CAST->env_;
+    func->P_CAST->body_ = P_CAST->body_;
     return func;
 }
 
@@ -30,6 +30,7 @@
 #include "Semantic/DeclAttrs.h"
 #include "Semantic/TypeFwd.h"
 #include "Semantic/SymbolCast.h"
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -311,6 +312,34 @@ public:
     void setEnv(Environment env);
     Environment env() const;
 
+    /*!
+     * \brief setBodyBinder
+     * \param binder
+     *
+     * Defer the binding of the function's body to \a binder, which is run
+     * the first time the body is needed. Whatever \a binder captures is
+     * released once it's run.
+     *
+     * \sa bindBody
+     */
+    void setBodyBinder(std::function<void ()> binder);
+
+    /*!
+     * \brief bindBody
+     *
+     * Bind the function's body, if that was deferred and hasn't happened
+     * yet, completing its environment and the annotations of the body's AST.
+     * Concurrent calls, for the function or its clones, are serialized: the
+     * body is bound once and each call returns only after that.
+     */
+    void bindBody() const;
+
+    /*!
+     * \brief isBodyBound
+     * \return
+     */
+    bool isBodyBound() const;
+
     Func* clone() const override;
     Func* clone(const Ident* alternateName) const override;
 
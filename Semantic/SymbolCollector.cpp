@@ -29,7 +29,6 @@
 #include "Common/Assert.h"
 #include "Parsing/Factory.h"
 #include "Parsing/Lexeme.h"
-#include "Parsing/LexemeMap.h"
 #include "Parsing/Lang.h"
 #include <iterator>
 #include <unordered_set>
@@ -77,6 +76,8 @@ public:
         : locator_(locator)
     {}
 
+    using Base = AstVisitor<SymbolDefVisitor>;
+
     const AstLocator* locator_;
     std::vector<SymbolCollector::MentionInfo> refs_;
 
@@ -92,6 +93,15 @@ public:
 
     //--- Declarations ---//
 
+    VisitResult traverseFuncDecl(FuncDeclAst* ast)
+    {
+        // Mentions are collected throughout the program, so every body
+        // is needed (and bound by the time uses are collected too).
+        ENSURE_ANNOTATED_SYMBOL;
+        ast->sym_->bindBody();
+        return Base::traverseFuncDecl(ast);
+    }
+
     VisitResult visitEnumDecl(EnumDeclAst* ast) { return collectDef(ast); }
     VisitResult visitEnumMemberDecl(EnumMemberDeclAst* ast) { return collectDef(ast); }
     VisitResult visitFuncDecl(FuncDeclAst* ast) { return collectDef(ast); }
@@ -105,12 +115,10 @@ public:
     SymbolUseVisitor(Environment env,
                      const AstLocator* locator,
                      const Lang* lang,
-                     const LexemeMap* lexs,
                      const std::vector<SymbolCollector::MentionInfo>& defs)
         : env_(env)
         , locator_(locator)
         , lang_(lang)
-        , lexs_(lexs)
     {
         // We want only uses that are not defs.
         for (const auto& def : defs)
@@ -122,7 +130,6 @@ public:
     Environment env_;
     const AstLocator* locator_;
     const Lang* lang_;
-    const LexemeMap* lexs_;
     std::vector<SymbolCollector::MentionInfo> refs_;
     std::unordered_set<LineCol> known_;
 
@@ -167,9 +174,9 @@ public:
 
     VisitResult visitSimpleName(SimpleNameAst* ast)
     {
-        const Decl* sym = searchValueDecl(ast, env_, lexs_);
+        const Decl* sym = searchValueDecl(ast, env_);
         if (!sym) {
-            sym = searchTypeDecl(ast, env_, lexs_);
+            sym = searchTypeDecl(ast, env_);
             if (!sym)
                 return Continue;
         }
@@ -208,12 +215,12 @@ SymbolCollector::collectDefs(ProgramAst* progAst)
 }
 
 std::vector<SymbolCollector::MentionInfo>
-SymbolCollector::collect(ProgramAst* progAst, const LexemeMap* lexs)
+SymbolCollector::collect(ProgramAst* progAst)
 {
     auto refs = collectDefs(progAst);
 
     SymbolUseVisitor vis(progAst->program_->env(), P->locator_.get(),
-                         P->lang_.get(), lexs, refs);
+                         P->lang_.get(), refs);
     auto uses = collectCore(progAst, vis);
 
     refs.reserve(refs.size() + uses.size());
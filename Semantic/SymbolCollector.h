@@ -35,7 +35,6 @@ namespace uaiso {
 
 class Decl;
 class Factory;
-class LexemeMap;
 
 class UAISO_API SymbolCollector final
 {
@@ -68,13 +67,12 @@ public:
      * \brief collect
      * \param ast
      * \param context
-     * \param lexs
      * \pre The AST must have already been gone through the Binder.
      * \return
      *
      * Collect symbol definitions and uses.
      */
-    std::vector<MentionInfo> collect(ProgramAst* ast, const LexemeMap* lexs);
+    std::vector<MentionInfo> collect(ProgramAst* ast);
 
 private:
     DECL_PIMPL(SymbolCollector)
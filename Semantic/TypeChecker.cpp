@@ -21,6 +21,8 @@
 #include "Semantic/Program.h"
 #include "Semantic/Symbol.h"
 #include "Semantic/Type.h"
+#include "Semantic/TypeInterner.h"
+#include "Semantic/TypeResolutionCache.h"
 #include "Semantic/TypeSystem.h"
 #include "Ast/Ast.h"
 #include "Ast/AstLocator.h"
@@ -56,14 +58,17 @@ using namespace uaiso;
 struct uaiso::TypeChecker::TypeCheckerImpl
 {
     TypeCheckerImpl(Factory* factory)
-        : lexs_(nullptr)
-        , tokens_(nullptr)
+        : tokens_(nullptr)
         , prevSym_(nullptr)
         , keepSym_(false)
         , locator_(factory->makeAstLocator())
         , typeSystem_(factory->makeTypeSystem())
         , lang_(factory->makeLang())
         , reports_(nullptr)
+        , types_(&ownTypes_)
+        , resolutions_(nullptr)
+        , anonRecordTy_(new RecordType)
+        , anonFuncTy_(new FuncType)
     {}
 
     void keepNextSymbol()
@@ -72,20 +77,41 @@ struct uaiso::TypeChecker::TypeCheckerImpl
         prevSym_ = nullptr;
     }
 
-    std::unique_ptr<Type> popExprType()
+    const Type* popExprType()
     {
-        std::unique_ptr<Type> ty = std::move(exprTy_.top());
+        const Type* ty = exprTy_.top();
         exprTy_.pop();
         return ty;
     }
 
-    template <class TypeT>
-    void pushExprType(std::unique_ptr<Type> ty)
+    void pushExprType(const Type* ty)
+    {
+        exprTy_.push(types_->intern(ty));
+    }
+
+    void pushExprType(Type::Kind kind)
+    {
+        exprTy_.push(types_->basicType(kind));
+    }
+
+    void pushExprType(const Type* ty, Type::Kind fallback)
     {
         if (ty)
-            exprTy_.push(std::move(ty));
+            exprTy_.push(ty);
         else
-            exprTy_.emplace(new TypeT);
+            pushExprType(fallback);
+    }
+
+    /*!
+     * Push a type built during checking, which (unless it's structural,
+     * thus interned) is kept alive until the checker is done.
+     */
+    void pushExprType(std::unique_ptr<Type> ty)
+    {
+        const Type* canon = types_->intern(ty.get());
+        if (canon == ty.get())
+            built_.push_back(std::move(ty));
+        exprTy_.push(canon);
     }
 
     template <class... Args>
@@ -100,9 +126,6 @@ struct uaiso::TypeChecker::TypeCheckerImpl
             reports_->add(std::forward<Args>(args)...);
     }
 
-     //!< Lexeme map of all AST locations.
-    const LexemeMap* lexs_;
-
     //!< Token map of all AST locations.
     const TokenMap* tokens_;
 
@@ -111,14 +134,14 @@ struct uaiso::TypeChecker::TypeCheckerImpl
 
     //! Type of the expr under process. If more than one value results out
     //! of evaluating an expr, only one type is to be pushed onto here. The
-    //! others, if desired, may be pushed onto the alternative stack.
-    std::stack<std::unique_ptr<Type>> exprTy_;
+    //! others, if desired, may be pushed onto the alternative stack. Types
+    //! are not owned: they're either interned or belong to symbols/ASTs.
+    std::stack<const Type*> exprTy_;
 
     //! If evaluation of an expr results in more than one value, this stack
-    //! may be used for the "extra" types. An empty type must be used as a
-    //! separator. As opposed to the main "type of expr" stack, this one is
-    //! unmanaged: types pushed but not popped will simply die in the end.
-    std::stack<std::unique_ptr<Type>> exprMultiTy_;
+    //! may be used for the "extra" types. A null type must be used as a
+    //! separator. Types pushed but not popped are simply left behind.
+    std::stack<const Type*> exprMultiTy_;
 
     //!@{
     //! A rudimentary mechanism to allow "passing" a symbol represented
@@ -138,6 +161,25 @@ struct uaiso::TypeChecker::TypeCheckerImpl
 
     //! Diagnostic reports collected.
     DiagnosticReports* reports_;
+
+    //!@{
+    //! Interner of the types of expressions, the checker's own one unless
+    //! an external one (e.g., of a snapshot) is given.
+    TypeInterner ownTypes_;
+    TypeInterner* types_;
+    //!@}
+
+    //! Memoized resolutions of elaborate types, if any.
+    TypeResolutionCache* resolutions_;
+
+    //! Nominal types built during checking, which can't be interned.
+    std::vector<std::unique_ptr<Type>> built_;
+
+    //!@{
+    //! Types of expressions whose type isn't (yet) worked out.
+    std::unique_ptr<const Type> anonRecordTy_;
+    std::unique_ptr<const Type> anonFuncTy_;
+    //!@}
 };
 
 TypeChecker::TypeChecker(Factory* factory)
@@ -147,11 +189,6 @@ TypeChecker::TypeChecker(Factory* factory)
 TypeChecker::~TypeChecker()
 {}
 
-void TypeChecker::setLexemes(const LexemeMap* lexs)
-{
-    P->lexs_ = lexs;
-}
-
 void TypeChecker::setTokens(const TokenMap* tokens)
 {
     P->tokens_ = tokens;
@@ -162,6 +199,16 @@ void TypeChecker::collectDiagnostics(DiagnosticReports* reports)
     P->reports_ = reports;
 }
 
+void TypeChecker::setTypeInterner(TypeInterner* types)
+{
+    P->types_ = types ? types : &P->ownTypes_;
+}
+
+void TypeChecker::setResolutionCache(TypeResolutionCache* cache)
+{
+    P->resolutions_ = cache;
+}
+
 void TypeChecker::check(ProgramAst *progAst)
 {
     UAISO_ASSERT(progAst, return);
@@ -177,6 +224,7 @@ void TypeChecker::check(FuncDeclAst* ast)
     UAISO_ASSERT(ast, return);
     UAISO_ASSERT(ast->sym_, return);
 
+    ast->sym_->bindBody();
     P->env_ = ast->sym_->env();
 
     traverseStmt(ast->stmt());
@@ -211,19 +259,31 @@ const Type* TypeChecker::maybeResolve(const Type* ty, const SourceLoc& loc)
             return ty;
         }
         prevName = elab->name();
+        prevTy = ElaborateType_ConstCast(elab);
+
+        // Each step is memoized, if there's a cache.
+        if (P->resolutions_) {
+            if (auto resolvedTy = P->resolutions_->find(P->env_, elab->name())) {
+                ty = resolvedTy;
+                continue;
+            }
+        }
 
         auto sym = P->env_.searchTypeDecl(elab->name());
         if (!sym) {
             P->report(Diagnostic::UnknownType, loc);
             return ty;
         }
-        prevTy = ElaborateType_ConstCast(elab);
         ty = sym->type();
         UAISO_ASSERT(ty, return ty);
+        if (P->resolutions_)
+            P->resolutions_->insert(P->env_, elab->name(), ty);
     }
 
-    // Annotate the actual type for further reference.
-    prevTy->resolveType(std::unique_ptr<Type>(ty->clone()));
+    // Annotate the actual type for further reference (unless resolutions
+    // are cached, the types of declarations are then referred to instead).
+    if (!P->resolutions_)
+        prevTy->resolveType(std::unique_ptr<Type>(ty->clone()));
 
     return ty;
 }
@@ -243,6 +303,14 @@ bool TypeChecker::analyseAssign(const Type* lhsTy,
     if (escapeCheck(rhsTy))
         return true;
 
+    // Types are interned, the very same basic type is trivially assignable.
+    if (lhsTy == rhsTy
+            && (isNumType(lhsTy->kind())
+                || lhsTy->kind() == Type::Kind::Bool
+                || lhsTy->kind() == Type::Kind::Str)) {
+        return true;
+    }
+
     bool ok = false;
     rhsTy = maybeResolve(rhsTy, loc);
     switch (lhsTy->kind()) {
@@ -349,9 +417,9 @@ TypeChecker::VisitResult TypeChecker::traverseEnumDecl(EnumDeclAst* ast)
         if (enumMemberDecl->hasInit()) {
             VIS_CALL(traverseExpr(enumMemberDecl->init()));
             ENSURE_NONEMPTY_STACK;
-            std::unique_ptr<Type> ty = P->popExprType();
+            const Type* ty = P->popExprType();
 
-            analyseInit(ast->sym_->underlyingType(), ty.get(), fullLoc(ast, P->locator_));
+            analyseInit(ast->sym_->underlyingType(), ty, fullLoc(ast, P->locator_));
         }
     }
 
@@ -375,6 +443,8 @@ TypeChecker::VisitResult TypeChecker::traverseFuncDecl(FuncDeclAst* ast)
 {
     ENSURE_VALID_TYPE_SYMBOL;
 
+    ast->sym_->bindBody();
+
     if (P->lang_->hasFuncLevelScope()) {
         P->env_ = ast->sym_->env();
         VIS_CALL(Base::traverseFuncDecl(ast));
@@ -433,10 +503,10 @@ TypeChecker::VisitResult TypeChecker::traverseVarDecl(VarDeclAst* ast)
     if (ast->hasInit()) {
         VIS_CALL(traverseExpr(ast->init()));
         ENSURE_NONEMPTY_STACK;
-        std::unique_ptr<Type> ty = P->popExprType();
+        const Type* ty = P->popExprType();
 
         Var* var = ast->sym_;
-        analyseInit(var->valueType(), ty.get(), fullLoc(ast, P->locator_));
+        analyseInit(var->valueType(), ty, fullLoc(ast, P->locator_));
         if (var->valueType()->kind() == Type::Kind::Inferred)
             var->setValueType(std::unique_ptr<Type>(ty->clone()));
     }
@@ -457,14 +527,14 @@ TypeChecker::VisitResult TypeChecker::traverseVarGroupDecl(VarGroupDeclAst* grou
 
             VIS_CALL(traverseExpr(init));
             ENSURE_NONEMPTY_STACK;
-            std::unique_ptr<Type> ty = P->popExprType();
+            const Type* ty = P->popExprType();
 
             UAISO_ASSERT(decls->head()->kind() == Ast::Kind::VarDecl, return Skip);
             VarDeclAst* varDecl = VarDecl_Cast(decls->head());
             UAISO_ASSERT(varDecl->sym_, return Skip);
             const Type* declTy = varDecl->sym_->valueType();
 
-            analyseInit(declTy, ty.get(), fullLoc(varDecl, P->locator_));
+            analyseInit(declTy, ty, fullLoc(varDecl, P->locator_));
             if (varDecl->sym_->valueType()->kind() == Type::Kind::Inferred)
                 varDecl->sym_->setValueType(std::unique_ptr<Type>(ty->clone()));
 
@@ -502,14 +572,12 @@ TypeChecker::VisitResult TypeChecker::traverseUnitTestDecl(UnitTestDeclAst* ast)
 
 TypeChecker::VisitResult TypeChecker::visitNumLitExpr(NumLitExprAst* ast)
 {
-    Token tk = P->tokens_->findAt(ast->litLoc_.fileName_, ast->litLoc_.lineCol());
-
-    switch (tk) {
-    case TK_INT_LIT:
-        P->exprTy_.emplace(new IntType);
+    switch (ast->variety()) {
+    case NumLitVariety::IntFormat:
+        P->pushExprType(Type::Kind::Int);
         break;
-    case TK_FLOAT_LIT:
-        P->exprTy_.emplace(new FloatType);
+    case NumLitVariety::FloatFormat:
+        P->pushExprType(Type::Kind::Float);
         break;
     default:
         UAISO_ASSERT(false, {});
@@ -521,12 +589,12 @@ TypeChecker::VisitResult TypeChecker::visitNumLitExpr(NumLitExprAst* ast)
 
 TypeChecker::VisitResult TypeChecker::visitBoolLitExpr(BoolLitExprAst* ast)
 {
-    Token tk = P->tokens_->findAt(ast->litLoc_.fileName_, ast->litLoc_.lineCol());
+    Token tk = P->tokens_->findAt(ast->litLoc_.fileId_, ast->litLoc_.lineCol());
 
     switch (tk) {
     case TK_TRUE_VALUE:
     case TK_FALSE_VALUE:
-        P->exprTy_.emplace(new BoolType);
+        P->pushExprType(Type::Kind::Bool);
         break;
     default:
         UAISO_ASSERT(false, {});
@@ -537,11 +605,11 @@ TypeChecker::VisitResult TypeChecker::visitBoolLitExpr(BoolLitExprAst* ast)
 
 TypeChecker::VisitResult TypeChecker::visitCharLitExpr(CharLitExprAst* ast)
 {
-    Token tk = P->tokens_->findAt(ast->litLoc_.fileName_, ast->litLoc_.lineCol());
+    Token tk = P->tokens_->findAt(ast->litLoc_.fileId_, ast->litLoc_.lineCol());
 
     switch (tk) {
     case TK_CHAR_LIT:
-        P->exprTy_.emplace(new IntType);
+        P->pushExprType(Type::Kind::Int);
         break;
     default:
         UAISO_ASSERT(false, {});
@@ -552,11 +620,11 @@ TypeChecker::VisitResult TypeChecker::visitCharLitExpr(CharLitExprAst* ast)
 
 TypeChecker::VisitResult TypeChecker::visitStrLitExpr(StrLitExprAst* ast)
 {
-    Token tk = P->tokens_->findAt(ast->litLoc_.fileName_, ast->litLoc_.lineCol());
+    Token tk = P->tokens_->findAt(ast->litLoc_.fileId_, ast->litLoc_.lineCol());
 
     switch (tk) {
     case TK_STR_LIT:
-        P->exprTy_.emplace(new StrType);
+        P->pushExprType(Type::Kind::Str);
         break;
     default:
         UAISO_ASSERT(false, return Abort, "SourceLoc:", ast->litLoc());
@@ -567,11 +635,11 @@ TypeChecker::VisitResult TypeChecker::visitStrLitExpr(StrLitExprAst* ast)
 
 TypeChecker::VisitResult TypeChecker::visitNullLitExpr(NullLitExprAst* ast)
 {
-    Token tk = P->tokens_->findAt(ast->litLoc_.fileName_, ast->litLoc_.lineCol());
+    Token tk = P->tokens_->findAt(ast->litLoc_.fileId_, ast->litLoc_.lineCol());
 
     switch (tk) {
     case TK_NULL_VALUE:
-        P->exprTy_.emplace(new PtrType(std::unique_ptr<Type>(new InferredType)));
+        P->pushExprType(std::unique_ptr<Type>(new PtrType(std::unique_ptr<Type>(new InferredType))));
         break;
     default:
         UAISO_ASSERT(false, {});
@@ -583,7 +651,7 @@ TypeChecker::VisitResult TypeChecker::visitNullLitExpr(NullLitExprAst* ast)
 
 TypeChecker::VisitResult TypeChecker::visitArrayLengthExpr(ArrayLengthExprAst* ast)
 {
-    P->exprTy_.emplace(new IntType);
+    P->pushExprType(Type::Kind::Int);
 
     return Continue;
 }
@@ -592,21 +660,21 @@ TypeChecker::VisitResult TypeChecker::processArithmetic(ExprAst* expr1,
                                                         ExprAst* expr2)
 {
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty = P->popExprType();
+    const Type* ty = P->popExprType();
     if (!isNumType(ty->kind())) {
         P->report(Diagnostic::NumericValueExpected, expr2, P->locator_);
-        ty.reset(nullptr);
+        ty = nullptr;
     }
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty2 = P->popExprType();
+    const Type* ty2 = P->popExprType();
     if (!isNumType(ty2->kind())) {
         P->report(Diagnostic::NumericValueExpected, expr1, P->locator_);
     } else if (!ty) {
-        ty = std::move(ty2);
+        ty = ty2;
     }
 
-    P->pushExprType<IntType>(std::move(ty));
+    P->pushExprType(ty, Type::Kind::Int);
 
     return Continue;
 }
@@ -658,21 +726,21 @@ TypeChecker::VisitResult TypeChecker::traverseConcatExpr(ConcatExprAst* ast)
     VIS_CALL(Base::traverseConcatExpr(ast));
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty = P->popExprType();
+    const Type* ty = P->popExprType();
     if (ty->kind() != Type::Kind::Str) {
         P->report(Diagnostic::StringValueExpected, ast->expr1(), P->locator_);
-        ty.reset(nullptr);
+        ty = nullptr;
     }
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty2 = P->popExprType();
+    const Type* ty2 = P->popExprType();
     if (ty2->kind() != Type::Kind::Str) {
         P->report(Diagnostic::StringValueExpected, ast->expr2(), P->locator_);
     } else if (!ty) {
-        ty = std::move(ty2);
+        ty = ty2;
     }
 
-    P->pushExprType<StrType>(std::move(ty));
+    P->pushExprType(ty, Type::Kind::Str);
 
     return Continue;
 }
@@ -723,7 +791,11 @@ TypeChecker::VisitResult TypeChecker::traverseAddrOfExpr(AddrOfExprAst* ast)
 {
     VIS_CALL(Base::traverseAddrOfExpr(ast));
     ENSURE_NONEMPTY_STACK;
-    P->exprTy_.emplace(new PtrType(P->popExprType()));
+    const Type* ty = P->popExprType();
+    if (auto ptrTy = P->types_->ptrType(ty))
+        P->exprTy_.push(ptrTy);
+    else
+        P->pushExprType(std::unique_ptr<Type>(new PtrType(std::unique_ptr<Type>(ty->clone()))));
 
     return Continue;
 }
@@ -734,11 +806,15 @@ TypeChecker::VisitResult TypeChecker::traverseArrayInitExpr(ArrayInitExprAst* as
     if (ast->inits()) {
         VIS_CALL(traverseExpr(ast->inits()->head()));
         ENSURE_NONEMPTY_STACK;
-        P->exprTy_.emplace(new ArrayType(P->popExprType()));
+        const Type* ty = P->popExprType();
+        if (auto arrayTy = P->types_->arrayType(ty))
+            P->exprTy_.push(arrayTy);
+        else
+            P->pushExprType(std::unique_ptr<Type>(new ArrayType(std::unique_ptr<Type>(ty->clone()))));
         return Continue;
     }
 
-    P->exprTy_.emplace(new InferredType);
+    P->pushExprType(Type::Kind::Inferred);
 
     return Continue;
 }
@@ -748,17 +824,17 @@ TypeChecker::VisitResult TypeChecker::traverseArraySliceExpr(ArraySliceExprAst*
     VIS_CALL(Base::traverseArraySliceExpr(ast));
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> rangeTy = P->popExprType();
+    const Type* rangeTy = P->popExprType();
     if (rangeTy->kind() != Type::Kind::Subrange)
         P->report(Diagnostic::SubrangeValueExpected, ast->range(), P->locator_);
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> baseTy = P->popExprType();
+    const Type* baseTy = P->popExprType();
     if (baseTy->kind() != Type::Kind::Array) {
         P->report(Diagnostic::ArrayValueExpected, ast->base(), P->locator_);
-        P->exprTy_.emplace(new InferredType);
+        P->pushExprType(Type::Kind::Inferred);
     } else {
-        P->exprTy_.push(std::move(baseTy));
+        P->exprTy_.push(baseTy);
     }
 
     return Continue;
@@ -769,21 +845,21 @@ TypeChecker::VisitResult TypeChecker::traverseArrayIndexExpr(ArrayIndexExprAst*
     VIS_CALL(Base::traverseArrayIndexExpr(ast));
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> indexTy = P->popExprType();
+    const Type* indexTy = P->popExprType();
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> baseTy = P->popExprType();
+    const Type* baseTy = P->popExprType();
     if (baseTy->kind() != Type::Kind::Array) {
         P->report(Diagnostic::ArrayValueExpected, ast->base(), P->locator_);
-        P->exprTy_.emplace(new InferredType);
+        P->pushExprType(Type::Kind::Inferred);
     } else {
-        ArrayType* arrTy = ArrayType_Cast(baseTy.get());
+        auto arrTy = ConstArrayType_Cast(baseTy);
         if (arrTy->variety() == ArrayVariety::Plain
                 && !isNumType(indexTy->kind())) {
             P->report(Diagnostic::IntegerValueExpected, ast->index(),
                       P->locator_);
         }
-        P->exprTy_.emplace(arrTy->baseType()->clone());
+        P->pushExprType(arrTy->baseType());
     }
 
     return Continue;
@@ -791,21 +867,21 @@ TypeChecker::VisitResult TypeChecker::traverseArrayIndexExpr(ArrayIndexExprAst*
 
 TypeChecker::VisitResult TypeChecker::visitAssertExpr(AssertExprAst* ast)
 {
-    P->exprTy_.emplace(new VoidType);
+    P->pushExprType(Type::Kind::Void);
 
     return Continue;
 }
 
 TypeChecker::VisitResult TypeChecker::visitVoidInitExpr(VoidInitExprAst* ast)
 {
-    P->exprTy_.emplace(new VoidType);
+    P->pushExprType(Type::Kind::Void);
 
     return Continue;
 }
 
 TypeChecker::VisitResult TypeChecker::visitDelExpr(DelExprAst* ast)
 {
-    P->exprTy_.emplace(new VoidType);
+    P->pushExprType(Type::Kind::Void);
 
     return Continue;
 }
@@ -814,7 +890,7 @@ TypeChecker::VisitResult TypeChecker::traverseAssignExpr(AssignExprAst* ast)
 {
     if (!ast->exprs1() || !ast->exprs2()) {
         // TODO: Either void or the assigned type.
-        P->exprTy_.emplace(new VoidType);
+        P->pushExprType(Type::Kind::Void);
         return Continue;
     }
 
@@ -822,21 +898,29 @@ TypeChecker::VisitResult TypeChecker::traverseAssignExpr(AssignExprAst* ast)
     // traverse all exprs and keep every type in a sequence. For each expr
     // one type is retrieved from the main expr type stack and the other(s),
     // if any, from the multivaled stack.
-    std::vector<std::unique_ptr<Type>> exprTy;
+    std::vector<const Type*> exprTy;
     for (auto expr2 : *ast->exprs2()) {
         VIS_CALL(traverseExpr(expr2));
         ENSURE_NONEMPTY_STACK;
         exprTy.push_back(P->popExprType());
 
         while (!P->exprMultiTy_.empty()) {
-            auto extraTy = std::move(P->exprMultiTy_.top());
+            auto extraTy = P->exprMultiTy_.top();
             P->exprMultiTy_.pop();
             if (!extraTy)
                 break; // Reached separator.
-            exprTy.push_back(std::move(extraTy));
+            exprTy.push_back(extraTy);
         }
     }
 
+    // Types set to symbols (see below) are copied upfront, since a type
+    // collected above may belong to a symbol which is about to be updated.
+    std::vector<std::unique_ptr<Type>> newTy;
+    if (P->typeSystem_->isDynamic()) {
+        for (auto ty : exprTy)
+            newTy.emplace_back(ty->clone());
+    }
+
     // Proceed as long as there are types to be checked against. More work
     // is required to properly diagnose issues of multivalue mismatch.
     size_t idx = 0;
@@ -844,7 +928,7 @@ TypeChecker::VisitResult TypeChecker::traverseAssignExpr(AssignExprAst* ast)
         P->keepNextSymbol();
         traverseExpr(expr1);
         ENSURE_NONEMPTY_STACK;
-        std::unique_ptr<Type> ty = P->popExprType();
+        const Type* ty = P->popExprType();
 
         if (exprTy.size() <= idx)
             break;
@@ -853,14 +937,14 @@ TypeChecker::VisitResult TypeChecker::traverseAssignExpr(AssignExprAst* ast)
         // symbol. In static type systems, there's an assignment check.
         if (P->typeSystem_->isDynamic()) {
             if (P->prevSym_)
-                ValueDecl_ConstCast(P->prevSym_)->setValueType(std::move(exprTy[idx]));
+                ValueDecl_ConstCast(P->prevSym_)->setValueType(std::move(newTy[idx]));
         } else {
-            analyseAssign(ty.get(), exprTy[idx].get(), fullLoc(ast, P->locator_));
+            analyseAssign(ty, exprTy[idx], fullLoc(ast, P->locator_));
         }
         ++idx;
     }
 
-    P->exprTy_.emplace(new VoidType);
+    P->pushExprType(Type::Kind::Void);
 
     return Continue;
 }
@@ -870,13 +954,13 @@ TypeChecker::VisitResult TypeChecker::traverseEqExpr(EqExprAst* ast)
     VIS_CALL(Base::traverseEqExpr(ast));
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty1 = P->popExprType();
+    const Type* ty1 = P->popExprType();
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty2 = P->popExprType();
+    const Type* ty2 = P->popExprType();
 
-    analyseEq(ty1.get(), ty2.get(), fullLoc(ast, P->locator_));
+    analyseEq(ty1, ty2, fullLoc(ast, P->locator_));
 
-    P->exprTy_.emplace(new BoolType);
+    P->pushExprType(Type::Kind::Bool);
 
     return Continue;
 }
@@ -886,13 +970,13 @@ TypeChecker::VisitResult TypeChecker::traverseInExpr(InExprAst* ast)
     VIS_CALL(Base::traverseInExpr(ast));
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty1 = P->popExprType();
+    P->popExprType();
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty2 = P->popExprType();
+    P->popExprType();
 
     // TODO: Check types
 
-    P->exprTy_.emplace(new BoolType);
+    P->pushExprType(Type::Kind::Bool);
 
     return Continue;
 }
@@ -902,13 +986,13 @@ TypeChecker::VisitResult TypeChecker::traverseIsExpr(IsExprAst* ast)
     VIS_CALL(Base::traverseIsExpr(ast));
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty1 = P->popExprType();
+    P->popExprType();
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty2 = P->popExprType();
+    P->popExprType();
 
     // TODO: Check types
 
-    P->exprTy_.emplace(new BoolType);
+    P->pushExprType(Type::Kind::Bool);
 
     return Continue;
 }
@@ -918,11 +1002,11 @@ TypeChecker::VisitResult TypeChecker::traverseCommaExpr(CommaExprAst* ast)
     VIS_CALL(Base::traverseCommaExpr(ast));
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty1 = P->popExprType();
+    P->popExprType();
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty2 = P->popExprType();
+    const Type* ty2 = P->popExprType();
 
-    P->exprTy_.push(std::move(ty2));
+    P->exprTy_.push(ty2);
 
     return Continue;
 }
@@ -932,11 +1016,11 @@ TypeChecker::VisitResult TypeChecker::traverseDesignateExpr(DesignateExprAst* as
     VIS_CALL(Base::traverseDesignateExpr(ast));
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty1 = P->popExprType();
+    P->popExprType();
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty2 = P->popExprType();
+    const Type* ty2 = P->popExprType();
 
-    P->exprTy_.push(std::move(ty2));
+    P->exprTy_.push(ty2);
 
     return Continue;
 }
@@ -944,20 +1028,20 @@ TypeChecker::VisitResult TypeChecker::traverseDesignateExpr(DesignateExprAst* as
 TypeChecker::VisitResult TypeChecker::processLogical(ExprAst* expr1, ExprAst* expr2)
 {
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty = P->popExprType();
+    const Type* ty = P->popExprType();
     if (ty->kind() != Type::Kind::Bool) {
         P->report(Diagnostic::BooleanValueExpected, expr2, P->locator_);
-        ty.reset(nullptr);
+        ty = nullptr;
     }
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty2 = P->popExprType();
+    const Type* ty2 = P->popExprType();
     if (ty2->kind() != Type::Kind::Bool)
         P->report(Diagnostic::BooleanValueExpected, expr1, P->locator_);
     else if (!ty)
-        ty = std::move(ty2);
+        ty = ty2;
 
-    P->pushExprType<BoolType>(std::move(ty));
+    P->pushExprType(ty, Type::Kind::Bool);
 
     return Continue;
 }
@@ -981,12 +1065,12 @@ TypeChecker::VisitResult TypeChecker::traverseLogicNotExpr(LogicNotExprAst* ast)
     VIS_CALL(Base::traverseLogicNotExpr(ast));
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty = P->popExprType();
+    const Type* ty = P->popExprType();
     if (ty->kind() != Type::Kind::Bool) {
         P->report(Diagnostic::BooleanValueExpected, ast, P->locator_);
-        P->exprTy_.emplace(new BoolType);
+        P->pushExprType(Type::Kind::Bool);
     } else {
-        P->exprTy_.push(std::move(ty));
+        P->exprTy_.push(ty);
     }
 
     return Continue;
@@ -997,16 +1081,16 @@ TypeChecker::VisitResult TypeChecker::traverseRelExpr(RelExprAst* ast)
     VIS_CALL(Base::traverseRelExpr(ast));
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty1 = P->popExprType();
+    const Type* ty1 = P->popExprType();
     if (!isNumType(ty1->kind()))
         P->report(Diagnostic::NumericValueExpected, ast->expr1(), P->locator_);
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty2 = P->popExprType();
+    const Type* ty2 = P->popExprType();
     if (!isNumType(ty2->kind()))
         P->report(Diagnostic::NumericValueExpected, ast->expr2(), P->locator_);
 
-    P->exprTy_.emplace(new BoolType);
+    P->pushExprType(Type::Kind::Bool);
 
     return Continue;
 }
@@ -1016,17 +1100,17 @@ TypeChecker::VisitResult TypeChecker::traverseCondExpr(CondExprAst* ast)
     VIS_CALL(Base::traverseCondExpr(ast));
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty = P->popExprType();
+    const Type* ty = P->popExprType();
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty2 = P->popExprType();
+    P->popExprType();
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty3 = P->popExprType();
+    const Type* ty3 = P->popExprType();
     if (ty3->kind() != Type::Kind::Bool)
         P->report(Diagnostic::BooleanValueExpected, ast->yes(), P->locator_);
 
-    P->exprTy_.push(std::move(ty));
+    P->exprTy_.push(ty);
 
     return Continue;
 }
@@ -1034,20 +1118,20 @@ TypeChecker::VisitResult TypeChecker::traverseCondExpr(CondExprAst* ast)
 TypeChecker::VisitResult TypeChecker::processBitwise(ExprAst* expr1, ExprAst* expr2)
 {
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty = P->popExprType();
+    const Type* ty = P->popExprType();
     if (ty->kind() != Type::Kind::Int) {
         P->report(Diagnostic::IntegerValueExpected, expr2, P->locator_);
-        ty.reset(nullptr);
+        ty = nullptr;
     }
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty2 = P->popExprType();
+    const Type* ty2 = P->popExprType();
     if (ty2->kind() != Type::Kind::Int)
         P->report(Diagnostic::IntegerValueExpected, expr1, P->locator_);
     else if (!ty)
-        ty = std::move(ty2);
+        ty = ty2;
 
-    P->pushExprType<IntType>(std::move(ty));
+    P->pushExprType(ty, Type::Kind::Int);
 
     return Continue;
 }
@@ -1085,13 +1169,13 @@ TypeChecker::VisitResult TypeChecker::traverseBitCompExpr(BitCompExprAst* ast)
     VIS_CALL(Base::traverseBitCompExpr(ast));
 
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty = P->popExprType();
+    const Type* ty = P->popExprType();
     if (ty->kind() != Type::Kind::Int) {
         P->report(Diagnostic::IntegerValueExpected, ast, P->locator_);
-        ty.reset(nullptr);
+        ty = nullptr;
     }
 
-    P->pushExprType<IntType>(std::move(ty));
+    P->pushExprType(ty, Type::Kind::Int);
 
     return Continue;
 }
@@ -1099,7 +1183,7 @@ TypeChecker::VisitResult TypeChecker::traverseBitCompExpr(BitCompExprAst* ast)
 template <class AstT>
 TypeChecker::VisitResult TypeChecker::takeAnnotatedType(AstT* ast)
 {
-    P->exprTy_.emplace(ast->ty_.release());
+    P->pushExprType(ast->ty_.get());
 
     return Continue;
 }
@@ -1144,7 +1228,7 @@ TypeChecker::VisitResult TypeChecker::traverseTypeAssertExpr(TypeAssertExprAst*
 
     VIS_CALL(traverseExpr(ast->base()));
     ENSURE_NONEMPTY_STACK;
-    P->exprMultiTy_.push(std::unique_ptr<Type>());
+    P->exprMultiTy_.push(nullptr);
     P->exprMultiTy_.push(P->popExprType());
 
     ENSURE_ANNOTATED_TYPE;
@@ -1155,7 +1239,7 @@ TypeChecker::VisitResult TypeChecker::traverseTypeAssertExpr(TypeAssertExprAst*
 TypeChecker::VisitResult TypeChecker::traverseTypeQueryExpr(TypeQueryExprAst* ast)
 {
     // TODO
-    P->exprTy_.emplace(new BoolType);
+    P->pushExprType(Type::Kind::Bool);
 
     return Continue;
 }
@@ -1164,18 +1248,18 @@ TypeChecker::VisitResult TypeChecker::traverseCallExpr(CallExprAst* ast)
 {
     VIS_CALL(traverseExpr(ast->base()));
     ENSURE_NONEMPTY_STACK;
-    std::unique_ptr<Type> ty = P->popExprType();
+    const Type* ty = P->popExprType();
     if (ty->kind() == Type::Kind::Func) {
-        FuncType* funcTy = FuncType_Cast(ty.get());
+        auto funcTy = ConstFuncType_Cast(ty);
         if (funcTy->returnType()) {
-            P->exprTy_.emplace(funcTy->returnType()->clone());
+            P->pushExprType(funcTy->returnType());
             return Continue;
         }
     }
 
     // Perhaps we're "lucky" if this is a constructor call. The name of the
     // function will be the name of the type, push original expr back.
-    P->exprTy_.push(std::move(ty));
+    P->exprTy_.push(ty);
 
     return Continue;
 }
@@ -1183,15 +1267,14 @@ TypeChecker::VisitResult TypeChecker::traverseCallExpr(CallExprAst* ast)
 TypeChecker::VisitResult TypeChecker::traverseRecordInitExpr(RecordInitExprAst* ast)
 {
     if (ast->spec_ && ast->spec_->kind() == Ast::Kind::NamedSpec) {
-        auto tySym = searchTypeDecl(NamedSpec_Cast(ast->spec())->name(),
-                                    P->env_, P->lexs_);
+        auto tySym = searchTypeDecl(NamedSpec_Cast(ast->spec())->name(), P->env_);
         if (tySym) {
-            P->exprTy_.emplace(tySym->type()->clone());
+            P->pushExprType(tySym->type());
             return Continue;
         }
     }
 
-    P->exprTy_.emplace(new RecordType);
+    P->pushExprType(P->anonRecordTy_.get());
 
     return Continue;
 }
@@ -1200,7 +1283,7 @@ TypeChecker::VisitResult TypeChecker::traverseRecordLitExpr(RecordLitExprAst* as
 {
     // TODO: See RecordLitExprAst's comment.
 
-    P->exprTy_.emplace(new RecordType);
+    P->pushExprType(P->anonRecordTy_.get());
 
     return Continue;
 }
@@ -1209,14 +1292,14 @@ TypeChecker::VisitResult TypeChecker::traverseFuncLitExpr(FuncLitExprAst* ast)
 {
     // TODO
 
-    P->exprTy_.emplace(new FuncType);
+    P->pushExprType(P->anonFuncTy_.get());
 
     return Continue;
 }
 
 TypeChecker::VisitResult TypeChecker::traverseTypeidExpr(TypeidExprAst* ast)
 {
-    P->exprTy_.emplace(new RecordType);
+    P->pushExprType(P->anonRecordTy_.get());
 
     return Continue;
 }
@@ -1225,7 +1308,7 @@ TypeChecker::VisitResult TypeChecker::traverseMixinExpr(MixinExprAst* ast)
 {
     // TODO: Inject the mixin expression.
 
-    P->exprTy_.emplace(new VoidType);
+    P->pushExprType(Type::Kind::Void);
 
     return Continue;
 }
@@ -1234,7 +1317,7 @@ TypeChecker::VisitResult TypeChecker::traverseMemberAccessExpr(MemberAccessExprA
 {
     // TODO
 
-    P->exprTy_.emplace(new InferredType);
+    P->pushExprType(Type::Kind::Inferred);
 
     return Continue;
 }
@@ -1260,7 +1343,7 @@ TypeChecker::VisitResult TypeChecker::traverseSubrangeExpr(SubrangeExprAst* ast)
 
     // TODO
 
-    P->exprTy_.emplace(new InferredType);
+    P->pushExprType(Type::Kind::Inferred);
 
     return Continue;
 }
@@ -1268,34 +1351,34 @@ TypeChecker::VisitResult TypeChecker::traverseSubrangeExpr(SubrangeExprAst* ast)
 
 TypeChecker::VisitResult TypeChecker::visitSuperExpr(SuperExprAst* ast)
 {
-    P->exprTy_.emplace(new RecordType);
+    P->pushExprType(P->anonRecordTy_.get());
 
     return Continue;
 }
 
 TypeChecker::VisitResult TypeChecker::visitThisExpr(ThisExprAst* ast)
 {
-    P->exprTy_.emplace(new RecordType);
+    P->pushExprType(P->anonRecordTy_.get());
 
     return Continue;
 }
 
 TypeChecker::VisitResult TypeChecker::visitIdentExpr(IdentExprAst* ast)
 {
-    auto valSym = searchValueDecl(ast->name(), P->env_, P->lexs_);
+    auto valSym = searchValueDecl(ast->name(), P->env_);
     if (!valSym) {
-        auto tySym = searchTypeDecl(ast->name(), P->env_, P->lexs_);
+        auto tySym = searchTypeDecl(ast->name(), P->env_);
         if (!tySym) {
             P->report(Diagnostic::UndeclaredIdentifier, ast->name(), P->locator_);
-            P->exprTy_.emplace(new InferredType);
+            P->pushExprType(Type::Kind::Inferred);
         } else {
             UAISO_ASSERT(tySym->type(), return Abort);
-            P->exprTy_.emplace(tySym->type()->clone());
+            P->pushExprType(tySym->type());
         }
     } else if (!valSym->valueType()) {
-        P->exprTy_.emplace(new InferredType);
+        P->pushExprType(Type::Kind::Inferred);
     } else {
-        P->exprTy_.emplace(valSym->valueType()->clone());
+        P->pushExprType(valSym->valueType());
     }
 
     // Keep the symbol around when there's a request.
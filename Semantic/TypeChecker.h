@@ -31,8 +31,9 @@
 namespace uaiso {
 
 class Factory;
-class LexemeMap;
 class TokenMap;
+class TypeInterner;
+class TypeResolutionCache;
 
 /*!
  * \brief The TypeChecker class
@@ -43,12 +44,31 @@ public:
     TypeChecker(Factory* factory);
     ~TypeChecker();
 
-    void setLexemes(const LexemeMap* lexs);
-
     void setTokens(const TokenMap* tokens);
 
     void collectDiagnostics(DiagnosticReports* reports);
 
+    /*!
+     * \brief setTypeInterner
+     * \param types
+     *
+     * Intern the types of expressions in \a types (e.g., the one of a
+     * snapshot version),
+     * instead of in the checker's own interner.
+     */
+    void setTypeInterner(TypeInterner* types);
+
+    /*!
+     * \brief setResolutionCache
+     * \param cache
+     *
+     * Memoize the resolution of elaborate types in \a cache (e.g., the one
+     * of a snapshot version), which is then shared with other checkers and
+     * proposers, instead of annotating each type with a copy of the resolved
+     * one.
+     */
+    void setResolutionCache(TypeResolutionCache* cache);
+
     /*!
      * \brief analyse
      * \param ast
@@ -59,11 +59,10 @@ TypeChecker::TypeCheckerTest::runCore(std::unique_ptr<Factory> factory,
 
     std::unique_ptr<Unit> unit = manager.process(code, fullFileName);
     UAISO_EXPECT_TRUE(unit->ast());
-    Program* prog = snapshot.find(fullFileName);
+    const Program* prog = snapshot.find(fullFileName);
     UAISO_EXPECT_TRUE(prog);
 
     TypeChecker typeChecker(factory.get());
-    typeChecker.setLexemes(&lexs);
     typeChecker.setTokens(&tokens);
     typeChecker.collectDiagnostics(&reports);
     typeChecker.check(Program_Cast(unit->ast()));
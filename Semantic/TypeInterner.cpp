@@ -0,0 +1,247 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#include "Semantic/TypeInterner.h"
+#include "Semantic/Precision.h"
+#include "Semantic/Signedness.h"
+#include "Semantic/TypeCast.h"
+#include "Common/Assert.h"
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace uaiso;
+
+namespace {
+
+/*
+ * The structure of a type: its kind, attributes (qualifiers, precision,
+ * etc.) and components, which are canonical instances themselves.
+ */
+struct Shape
+{
+    Type::Kind kind_;
+    uint32_t attrs_;
+    const Type* sub1_;
+    const Type* sub2_;
+
+    bool operator==(const Shape& other) const
+    {
+        return kind_ == other.kind_
+                && attrs_ == other.attrs_
+                && sub1_ == other.sub1_
+                && sub2_ == other.sub2_;
+    }
+};
+
+struct ShapeHash
+{
+    size_t operator()(const Shape& shape) const
+    {
+        size_t h = std::hash<uint32_t>()((uint32_t(shape.kind_) << 24) ^ shape.attrs_);
+        h ^= std::hash<const Type*>()(shape.sub1_) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        h ^= std::hash<const Type*>()(shape.sub2_) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+uint32_t attrsOf(const Type* ty)
+{
+    uint32_t attrs = static_cast<unsigned char>(ty->typeQuals());
+    switch (ty->kind()) {
+    case Type::Kind::Int: {
+        auto intTy = ConstIntType_Cast(ty);
+        attrs |= uint32_t(intTy->signedness()) << 8;
+        attrs |= uint32_t(intTy->precision()) << 12;
+        break;
+    }
+    case Type::Kind::Float:
+        attrs |= uint32_t(ConstFloatType_Cast(ty)->precision()) << 12;
+        break;
+    case Type::Kind::Array:
+        attrs |= uint32_t(ConstArrayType_Cast(ty)->variety()) << 16;
+        break;
+    case Type::Kind::Chan:
+        attrs |= uint32_t(ConstChanType_Cast(ty)->variety()) << 16;
+        break;
+    default:
+        break;
+    }
+    return attrs;
+}
+
+const size_t kKindCount = size_t(Type::Kind::Void) + 1;
+
+} // anonymous
+
+struct uaiso::TypeInterner::TypeInternerImpl
+{
+    /*
+     * Return the canonical instance of \a ty, or null if it's not a
+     * structural type. The lock must be held.
+     */
+    const Type* canonical(const Type* ty)
+    {
+        Shape shape { ty->kind(), attrsOf(ty), nullptr, nullptr };
+        switch (ty->kind()) {
+        case Type::Kind::Elaborate:
+        case Type::Kind::Enum:
+        case Type::Kind::Record:
+            return nullptr;
+
+        case Type::Kind::Array:
+            if (auto keyTy = ConstArrayType_Cast(ty)->keyType()) {
+                shape.sub2_ = canonical(keyTy);
+                if (!shape.sub2_)
+                    return nullptr;
+            }
+            // Fallthrough
+        case Type::Kind::Chan:
+        case Type::Kind::Ptr:
+        case Type::Kind::Subrange: {
+            auto baseTy = ConstOpaqueType_Cast(ty)->baseType();
+            if (!baseTy)
+                return nullptr;
+            shape.sub1_ = canonical(baseTy);
+            if (!shape.sub1_)
+                return nullptr;
+            break;
+        }
+
+        case Type::Kind::Func:
+            if (auto retTy = ConstFuncType_Cast(ty)->returnType()) {
+                shape.sub1_ = canonical(retTy);
+                if (!shape.sub1_)
+                    return nullptr;
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        auto it = types_.find(shape);
+        if (it != types_.end())
+            return it->second.get();
+
+        return insert(shape, std::unique_ptr<Type>(ty->clone()));
+    }
+
+    /*
+     * Return the canonical instance of a composition \a TypeT of \a ty (in
+     * its default form), which is looked up before it's built. The lock must
+     * be held.
+     */
+    template <class TypeT>
+    const Type* canonicalOf(const Type* ty, Type::Kind kind, uint32_t attrs)
+    {
+        Shape shape { kind, attrs, nullptr, nullptr };
+        shape.sub1_ = canonicals_.count(ty) ? ty : canonical(ty);
+        if (!shape.sub1_)
+            return nullptr;
+
+        auto it = types_.find(shape);
+        if (it != types_.end())
+            return it->second.get();
+
+        return insert(shape, std::unique_ptr<Type>(
+                          new TypeT(std::unique_ptr<Type>(shape.sub1_->clone()))));
+    }
+
+    const Type* insert(const Shape& shape, std::unique_ptr<Type> ty)
+    {
+        const Type* canon = ty.get();
+        types_.emplace(shape, std::move(ty));
+        canonicals_.insert(canon);
+        return canon;
+    }
+
+    mutable std::mutex mutex_;
+    std::unordered_map<Shape, std::unique_ptr<const Type>, ShapeHash> types_;
+    std::unordered_set<const Type*> canonicals_;
+    std::array<const Type*, kKindCount> basics_ {};
+};
+
+TypeInterner::TypeInterner()
+    : P(new TypeInternerImpl)
+{
+    auto internBasic = [this](Type* ty) {
+        std::unique_ptr<Type> guard(ty);
+        P->basics_[size_t(ty->kind())] = P->canonical(ty);
+    };
+    internBasic(new VoidType);
+    internBasic(new BoolType);
+    internBasic(new IntType);
+    internBasic(new FloatType);
+    internBasic(new StrType);
+    internBasic(new InferredType);
+}
+
+TypeInterner::~TypeInterner()
+{}
+
+const Type* TypeInterner::intern(const Type* ty)
+{
+    UAISO_ASSERT(ty, return nullptr);
+
+    std::lock_guard<std::mutex> lock(P->mutex_);
+    const Type* canon = P->canonical(ty);
+    return canon ? canon : ty;
+}
+
+const Type* TypeInterner::ptrType(const Type* ty)
+{
+    UAISO_ASSERT(ty, return nullptr);
+
+    std::lock_guard<std::mutex> lock(P->mutex_);
+    return P->canonicalOf<PtrType>(ty, Type::Kind::Ptr, 0);
+}
+
+const Type* TypeInterner::arrayType(const Type* ty)
+{
+    UAISO_ASSERT(ty, return nullptr);
+
+    std::lock_guard<std::mutex> lock(P->mutex_);
+    return P->canonicalOf<ArrayType>(ty, Type::Kind::Array,
+                                     uint32_t(ArrayVariety::Unknown) << 16);
+}
+
+const Type* TypeInterner::basicType(Type::Kind kind) const
+{
+    const Type* ty = P->basics_[size_t(kind)];
+    UAISO_ASSERT(ty, return nullptr, "not a basic type");
+    return ty;
+}
+
+bool TypeInterner::isCanonical(const Type* ty) const
+{
+    std::lock_guard<std::mutex> lock(P->mutex_);
+    return P->canonicals_.count(ty) != 0;
+}
+
+size_t TypeInterner::size() const
+{
+    std::lock_guard<std::mutex> lock(P->mutex_);
+    return P->types_.size();
+}
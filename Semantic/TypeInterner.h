@@ -0,0 +1,117 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#ifndef UAISO_TYPEINTERNER_H__
+#define UAISO_TYPEINTERNER_H__
+
+#include "Common/Config.h"
+#include "Common/Pimpl.h"
+#include "Common/Test.h"
+#include "Semantic/Type.h"
+#include <cstddef>
+
+namespace uaiso {
+
+/*!
+ * \brief The TypeInterner class
+ *
+ * Types are hash-consed: there's a single, immutable, instance of every
+ * structural type (basic types, with their precision and signedness, and
+ * pointers, arrays, channels, subranges and functions composed of them), so
+ * they can be compared by pointer. Nominal types (records, enums and
+ * elaborate types) are not interned, their identity is the one of their
+ * declaration. Interning may happen concurrently from several threads.
+ */
+class UAISO_API TypeInterner final
+{
+public:
+    TypeInterner();
+    ~TypeInterner();
+
+    TypeInterner(const TypeInterner&) = delete;
+    TypeInterner& operator=(const TypeInterner&) = delete;
+
+    /*!
+     * \brief intern
+     * \param ty
+     * \return
+     *
+     * Return the canonical instance of the type \a ty. If \a ty is nominal,
+     * or composed of a nominal type, return it as is.
+     */
+    const Type* intern(const Type* ty);
+
+    /*!
+     * \brief ptrType
+     * \param ty
+     * \return
+     *
+     * Return the canonical instance of a pointer to \a ty, which is built
+     * (out of a copy of \a ty) only if it's not interned yet. If \a ty is
+     * nominal, or composed of a nominal type, return null.
+     */
+    const Type* ptrType(const Type* ty);
+
+    /*!
+     * \brief arrayType
+     * \param ty
+     * \return
+     *
+     * Return the canonical instance of an array of \a ty, as above.
+     */
+    const Type* arrayType(const Type* ty);
+
+    /*!
+     * \brief basicType
+     * \param kind
+     * \return
+     *
+     * Return the canonical instance of the basic type of \a kind in its
+     * default form (e.g., a signed 32-bit int). Retrieving it doesn't lock.
+     */
+    const Type* basicType(Type::Kind kind) const;
+
+    /*!
+     * \brief isCanonical
+     * \param ty
+     * \return
+     *
+     * Return whether \a ty is an instance owned by this interner.
+     */
+    bool isCanonical(const Type* ty) const;
+
+    /*!
+     * \brief size
+     * \return
+     *
+     * Return the number of interned types.
+     */
+    size_t size() const;
+
+private:
+    DECL_PIMPL(TypeInterner)
+    DECL_CLASS_TEST(TypeInterner)
+};
+
+} // namespace uaiso
+
+#endif
@@ -0,0 +1,169 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#include "Semantic/TypeInterner.h"
+#include "Semantic/Environment.h"
+#include "Semantic/Precision.h"
+#include "Semantic/Signedness.h"
+#include "Semantic/TypeCast.h"
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace uaiso;
+
+class TypeInterner::TypeInternerTest final : public Test
+{
+public:
+    TEST_RUN(TypeInternerTest
+             , &TypeInternerTest::testCase1
+             , &TypeInternerTest::testCase2
+             , &TypeInternerTest::testCase3
+             , &TypeInternerTest::testCase4
+             , &TypeInternerTest::testCase5
+             )
+
+    void testCase1()
+    {
+        // Structurally equal basic types are the same instance.
+        TypeInterner types;
+        IntType int32;
+        IntType uint32(Signedness::Unsigned, Precision::BitSize32);
+        IntType int64(Signedness::Signed, Precision::BitSize64);
+        const Type* canon = types.intern(&int32);
+        UAISO_EXPECT_TRUE(canon != &int32);
+        UAISO_EXPECT_TRUE(types.isCanonical(canon));
+        UAISO_EXPECT_FALSE(types.isCanonical(&int32));
+        UAISO_EXPECT_PTR_EQ(canon, types.basicType(Type::Kind::Int));
+        UAISO_EXPECT_PTR_EQ(canon, types.intern(canon));
+        UAISO_EXPECT_TRUE(canon != types.intern(&uint32));
+        UAISO_EXPECT_TRUE(canon != types.intern(&int64));
+        UAISO_EXPECT_PTR_EQ(types.intern(&int64), types.intern(&int64));
+
+        FloatType float64;
+        FloatType float32(Precision::BitSize32);
+        UAISO_EXPECT_PTR_EQ(types.basicType(Type::Kind::Float), types.intern(&float64));
+        UAISO_EXPECT_TRUE(types.intern(&float32) != types.intern(&float64));
+
+        StrType str;
+        str.setTypeQuals(TypeQualFlag::Const);
+        UAISO_EXPECT_TRUE(types.intern(&str) != types.basicType(Type::Kind::Str));
+    }
+
+    void testCase2()
+    {
+        // Compositions are interned by their (canonical) components.
+        TypeInterner types;
+        PtrType ptrInt1(std::unique_ptr<Type>(new IntType));
+        PtrType ptrInt2(std::unique_ptr<Type>(new IntType));
+        PtrType ptrFloat(std::unique_ptr<Type>(new FloatType));
+        const Type* canon = types.intern(&ptrInt1);
+        UAISO_EXPECT_PTR_EQ(canon, types.intern(&ptrInt2));
+        UAISO_EXPECT_TRUE(canon != types.intern(&ptrFloat));
+        UAISO_EXPECT_PTR_EQ(types.basicType(Type::Kind::Int),
+                            types.intern(ConstPtrType_Cast(canon)->baseType()));
+
+        ArrayType arr(std::unique_ptr<Type>(new StrType));
+        ArrayType map(std::unique_ptr<Type>(new StrType));
+        map.setVariety(ArrayVariety::Associative);
+        map.setKeyType(std::unique_ptr<Type>(new IntType));
+        UAISO_EXPECT_TRUE(types.intern(&arr) != types.intern(&map));
+        UAISO_EXPECT_PTR_EQ(types.intern(&map), types.intern(&map));
+
+        FuncType func1;
+        func1.setReturnType(std::unique_ptr<Type>(new BoolType));
+        FuncType func2;
+        func2.setReturnType(std::unique_ptr<Type>(new BoolType));
+        FuncType proc;
+        UAISO_EXPECT_PTR_EQ(types.intern(&func1), types.intern(&func2));
+        UAISO_EXPECT_TRUE(types.intern(&func1) != types.intern(&proc));
+    }
+
+    void testCase3()
+    {
+        // Nominal types, or compositions of them, keep their identity.
+        TypeInterner types;
+        size_t size = types.size();
+        RecordType rec;
+        PtrType ptrRec(std::unique_ptr<Type>(new RecordType));
+        EnumType enumTy;
+        UAISO_EXPECT_PTR_EQ(&rec, types.intern(&rec));
+        UAISO_EXPECT_PTR_EQ(&ptrRec, types.intern(&ptrRec));
+        UAISO_EXPECT_PTR_EQ(&enumTy, types.intern(&enumTy));
+        UAISO_EXPECT_FALSE(types.isCanonical(&rec));
+        UAISO_EXPECT_INT_EQ(size, types.size());
+    }
+
+    void testCase4()
+    {
+        // Threads interning the same types agree on the instances.
+        const int kThreads = 8;
+        TypeInterner types;
+        std::vector<std::vector<const Type*>> seen(kThreads);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&types, &seen, t] () {
+                for (int i = 0; i < 100; ++i) {
+                    std::unique_ptr<Type> ty(new IntType);
+                    for (int j = 0; j < i % 10; ++j)
+                        ty.reset(new PtrType(std::move(ty)));
+                    seen[t].push_back(types.intern(ty.get()));
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        for (int t = 1; t < kThreads; ++t) {
+            for (int i = 0; i < 100; ++i)
+                UAISO_EXPECT_PTR_EQ(seen[0][i], seen[t][i]);
+        }
+        UAISO_EXPECT_PTR_EQ(seen[0][0], seen[0][10]);
+    }
+
+    void testCase5()
+    {
+        // Pointers to, and arrays of, a type are the ones it would intern,
+        // and are built only once.
+        TypeInterner types;
+        const Type* intTy = types.basicType(Type::Kind::Int);
+        PtrType ptrInt(std::unique_ptr<Type>(new IntType));
+        ArrayType arrayInt(std::unique_ptr<Type>(new IntType));
+        const Type* ptrTy = types.ptrType(intTy);
+        UAISO_EXPECT_TRUE(ptrTy);
+        UAISO_EXPECT_PTR_EQ(ptrTy, types.intern(&ptrInt));
+        UAISO_EXPECT_PTR_EQ(types.arrayType(intTy), types.intern(&arrayInt));
+        UAISO_EXPECT_TRUE(types.arrayType(intTy) != ptrTy);
+
+        size_t size = types.size();
+        IntType otherInt;
+        UAISO_EXPECT_PTR_EQ(ptrTy, types.ptrType(&otherInt));
+        UAISO_EXPECT_PTR_EQ(types.ptrType(ptrTy), types.ptrType(types.ptrType(intTy)));
+        UAISO_EXPECT_INT_EQ(size + 1, types.size());
+
+        RecordType rec;
+        UAISO_EXPECT_FALSE(types.ptrType(&rec));
+        UAISO_EXPECT_FALSE(types.arrayType(&rec));
+    }
+};
+
+MAKE_CLASS_TEST(TypeInterner)
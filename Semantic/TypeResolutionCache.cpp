@@ -0,0 +1,101 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#include "Semantic/TypeResolutionCache.h"
+#include "Common/Assert.h"
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+using namespace uaiso;
+
+namespace {
+
+// The environment is kept in the key, so that its address isn't reused
+// while the entry is around.
+using Key = std::pair<Environment, const Ident*>;
+
+struct KeyHash
+{
+    size_t operator()(const Key& key) const
+    {
+        const size_t h = std::hash<Environment>()(key.first);
+        return h ^ (std::hash<const Ident*>()(key.second) + 0x9e3779b9 + (h << 6) + (h >> 2));
+    }
+};
+
+// Versions only increase, so the sum of the ones of an environment and its
+// outer environments changes whenever any of them does.
+uint64_t stampOf(Environment env)
+{
+    uint64_t stamp = env.version();
+    while (!env.isRootEnv()) {
+        env = env.outerEnv();
+        stamp += env.version();
+    }
+    return stamp;
+}
+
+} // anonymous
+
+struct uaiso::TypeResolutionCache::TypeResolutionCacheImpl
+{
+    mutable std::mutex mutex_;
+    std::unordered_map<Key, std::pair<const Type*, uint64_t>, KeyHash> types_;
+};
+
+TypeResolutionCache::TypeResolutionCache()
+    : P(new TypeResolutionCacheImpl)
+{}
+
+TypeResolutionCache::~TypeResolutionCache()
+{}
+
+const Type* TypeResolutionCache::find(const Environment& env, const Ident* name) const
+{
+    UAISO_ASSERT(name, return nullptr);
+
+    const uint64_t stamp = stampOf(env);
+    std::lock_guard<std::mutex> lock(P->mutex_);
+    auto it = P->types_.find(Key(env, name));
+    if (it == P->types_.end() || it->second.second != stamp)
+        return nullptr;
+    return it->second.first;
+}
+
+void TypeResolutionCache::insert(const Environment& env, const Ident* name, const Type* ty)
+{
+    UAISO_ASSERT(name, return);
+    UAISO_ASSERT(ty, return);
+
+    const uint64_t stamp = stampOf(env);
+    std::lock_guard<std::mutex> lock(P->mutex_);
+    P->types_[Key(env, name)] = std::make_pair(ty, stamp);
+}
+
+size_t TypeResolutionCache::size() const
+{
+    std::lock_guard<std::mutex> lock(P->mutex_);
+    return P->types_.size();
+}
@@ -0,0 +1,93 @@
+/******************************************************************************
+ * Copyright (c) 2014-2016 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+/*--------------------------*/
+/*--- The UaiSo! Project ---*/
+/*--------------------------*/
+
+#ifndef UAISO_TYPERESOLUTIONCACHE_H__
+#define UAISO_TYPERESOLUTIONCACHE_H__
+
+#include "Common/Config.h"
+#include "Common/Pimpl.h"
+#include "Semantic/Environment.h"
+#include "Semantic/TypeFwd.h"
+#include <cstddef>
+
+namespace uaiso {
+
+/*!
+ * \brief The TypeResolutionCache class
+ *
+ * Memoize the resolution of elaborate types: the type declared under a
+ * name, as looked up from a given environment. Entries refer to the type
+ * of the declaration (nothing is cloned), so the cache must not outlive the
+ * programs it was filled from; a snapshot keeps one per version for that
+ * matter. Only successful lookups are cached. An entry is dropped once the
+ * environment it was looked up from, or an outer one, changes (e.g., when
+ * the body of a function is bound lazily and declares a shadowing type).
+ * Lookups and insertions may happen concurrently from several threads.
+ *
+ * \sa Snapshot::Version::resolutions
+ */
+class UAISO_API TypeResolutionCache final
+{
+public:
+    TypeResolutionCache();
+    ~TypeResolutionCache();
+
+    TypeResolutionCache(const TypeResolutionCache&) = delete;
+    TypeResolutionCache& operator=(const TypeResolutionCache&) = delete;
+
+    /*!
+     * \brief find
+     * \param env
+     * \param name
+     * \return
+     *
+     * Return the type \a name resolved to when looked up from \a env, or
+     * null if that's not cached (or no longer holds).
+     */
+    const Type* find(const Environment& env, const Ident* name) const;
+
+    /*!
+     * \brief insert
+     * \param env
+     * \param name
+     * \param ty
+     *
+     * Cache that \a name resolves to \a ty when looked up from \a env.
+     */
+    void insert(const Environment& env, const Ident* name, const Type* ty);
+
+    /*!
+     * \brief size
+     * \return
+     *
+     * Return the number of cached resolutions.
+     */
+    size_t size() const;
+
+private:
+    DECL_PIMPL(TypeResolutionCache)
+};
+
+} // namespace uaiso
+
+#endif
@@ -25,6 +25,7 @@
 #include "Semantic/Symbol.h"
 #include "Semantic/Type.h"
 #include "Semantic/TypeCast.h"
+#include "Semantic/TypeResolutionCache.h"
 #include "Common/Trace__.h"
 
 #define TRACE_NAME "TypeResolver"
@@ -35,6 +36,8 @@ struct uaiso::TypeResolver::TypeResolverImpl
 {
     TypeResolverImpl(Factory*)
     {}
+
+    TypeResolutionCache* cache_ { nullptr };
 };
 
 TypeResolver::TypeResolver(Factory* factory)
@@ -44,6 +47,11 @@ TypeResolver::TypeResolver(Factory* factory)
 TypeResolver::~TypeResolver()
 {}
 
+void TypeResolver::setResolutionCache(TypeResolutionCache* cache)
+{
+    P->cache_ = cache;
+}
+
 TypeResolver::Result TypeResolver::resolve(ElaborateType* elabTy,
                                            Environment env) const
 {
@@ -52,6 +60,11 @@ TypeResolver::Result TypeResolver::resolve(ElaborateType* elabTy,
     if (elabTy->isResolved())
         return Result(elabTy->canonicalType(), Success);
 
+    if (P->cache_) {
+        if (auto ty = P->cache_->find(env, elabTy->name()))
+            return Result(ty, Success);
+    }
+
     auto tySym = env.searchTypeDecl(elabTy->name());
     if (!tySym) {
         DEBUG_TRACE("type decl symbol lookup failed");
@@ -60,7 +73,10 @@ TypeResolver::Result TypeResolver::resolve(ElaborateType* elabTy,
 
     UAISO_ASSERT(tySym->type(), return Result(nullptr, InternalError));
     auto ty = tySym->type();
-    elabTy->resolveType(std::unique_ptr<Type>(ty->clone()));
+    if (P->cache_)
+        P->cache_->insert(env, elabTy->name(), ty);
+    else
+        elabTy->resolveType(std::unique_ptr<Type>(ty->clone()));
 
     return Result(ty, Success);
 }
@@ -33,6 +33,7 @@
 namespace uaiso {
 
 class Factory;
+class TypeResolutionCache;
 
 class UAISO_API TypeResolver final
 {
@@ -49,6 +50,16 @@ public:
 
     using Result = std::tuple<const Type*, ResultCode>;
 
+    /*!
+     * \brief setResolutionCache
+     * \param cache
+     *
+     * Memoize resolutions in \a cache (e.g., the one of a snapshot version).
+     * Elaborate types resolved through it are not annotated with a copy of
+     * their canonical type.
+     */
+    void setResolutionCache(TypeResolutionCache* cache);
+
     Result resolve(ElaborateType* elabTy, Environment env) const;
 
 private: